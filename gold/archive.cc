@@ -23,9 +23,13 @@
 #include "gold.h"
 
 #include <cerrno>
+#include <cstdio>
 #include <cstring>
 #include <climits>
 #include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "libiberty.h"
 #include "filenames.h"
 
@@ -40,6 +44,7 @@
 #include "archive.h"
 #include "plugin.h"
 #include "incremental.h"
+#include "gold-threads.h"
 
 namespace gold
 {
@@ -174,6 +179,76 @@ struct Archive::Archive_header
 unsigned int Archive::total_archives;
 unsigned int Archive::total_members;
 unsigned int Archive::total_members_loaded;
+unsigned int Archive::armap_cache_hits;
+unsigned int Archive::armap_cache_misses;
+unsigned int Archive::armap_probes;
+
+// A lock for the --input-cache statistics and temporary file names.
+static Lock* armap_cache_lock = NULL;
+static Initialize_lock armap_cache_initialize_lock(&armap_cache_lock);
+
+// The --input-cache directory holds a copy of the symbol map of each
+// archive seen in earlier links, so that it need not be parsed again.
+// Each cache file is named after the device and inode number of the
+// archive.  It starts with an Armap_cache_header, which records the
+// size and modification time of the archive; the entry is only used
+// if these still match.  The header is followed by NSYMS pairs of
+// 64-bit name and file offsets, and then by the symbol names.
+// Everything is in host byte order, so the file can be mapped and
+// used without scanning the names.
+
+struct Armap_cache_header
+{
+  // ARMAP_CACHE_MAGIC.
+  char magic[8];
+  // The size and modification time of the archive.
+  uint64_t file_size;
+  uint64_t mtime_seconds;
+  uint64_t mtime_nanoseconds;
+  // The size of the symbol map in the archive.
+  uint64_t armap_size;
+  // The number of symbols.
+  uint64_t nsyms;
+  // The size of the symbol names.
+  uint64_t names_size;
+  // The number of archive members, as counted by read_armap.
+  uint64_t num_members;
+};
+
+static const char armap_cache_magic[8] =
+{
+  'g', 'o', 'l', 'd', 'a', 'r', 'm', '1'
+};
+
+// Return the name of the --input-cache file for the archive open in
+// FILE, and fill in the fields of *HDR which identify the archive.
+// Return the empty string if the archive can not be identified.
+
+static std::string
+armap_cache_filename(File_read* file, section_size_type armap_size,
+		     Armap_cache_header* hdr)
+{
+  struct stat st;
+  if (::fstat(file->descriptor(), &st) < 0)
+    return std::string();
+
+  memset(hdr, 0, sizeof(*hdr));
+  memcpy(hdr->magic, armap_cache_magic, sizeof(armap_cache_magic));
+  hdr->file_size = st.st_size;
+#ifdef HAVE_STAT_ST_MTIM
+  hdr->mtime_seconds = st.st_mtim.tv_sec;
+  hdr->mtime_nanoseconds = st.st_mtim.tv_nsec;
+#else
+  hdr->mtime_seconds = st.st_mtime;
+#endif
+  hdr->armap_size = armap_size;
+
+  char buf[64];
+  snprintf(buf, sizeof(buf), "/%llx-%llx.armap",
+	   static_cast<unsigned long long>(st.st_dev),
+	   static_cast<unsigned long long>(st.st_ino));
+  return std::string(parameters->options().input_cache()) + buf;
+}
 
 // Archive methods.
 
@@ -193,7 +268,8 @@ Archive::Archive(const std::string& name, Input_file* input_file,
                  bool is_thin_archive, Dirsearch* dirpath, Task* task)
   : Library_base(task), name_(name), input_file_(input_file), armap_(),
     armap_names_(), extended_names_(), armap_checked_(), seen_offsets_(),
-    members_(), is_thin_archive_(is_thin_archive), included_member_(false),
+    armap_buckets_(), armap_chain_(), members_(),
+    is_thin_archive_(is_thin_archive), included_member_(false),
     nested_archives_(), dirpath_(dirpath), num_members_(0),
     included_all_members_(false)
 {
@@ -221,7 +297,11 @@ Archive::setup()
   off_t off = sarmag;
   if (armap_name.empty())
     {
-      this->read_armap(sarmag + sizeof(Archive_header), armap_size);
+      if (!this->read_armap_cache(armap_size))
+	{
+	  this->read_armap(sarmag + sizeof(Archive_header), armap_size);
+	  this->write_armap_cache(armap_size);
+	}
       off = sarmag + sizeof(Archive_header) + armap_size;
     }
   else if (!this->input_file_->options().whole_archive())
@@ -321,6 +401,149 @@ Archive::read_armap(off_t start, section_size_type size)
   this->armap_checked_.resize(nsyms);
 }
 
+// Read the archive symbol map from the --input-cache directory.
+
+bool
+Archive::read_armap_cache(section_size_type size)
+{
+  if (parameters->options().input_cache() == NULL)
+    return false;
+
+  Armap_cache_header key;
+  std::string filename = armap_cache_filename(&this->input_file_->file(),
+					      size, &key);
+  if (filename.empty())
+    return false;
+
+  File_read cache_file;
+  if (!cache_file.open(this->task_, filename))
+    return false;
+
+  bool found = false;
+  const off_t header_size = sizeof(Armap_cache_header);
+  const off_t cache_size = cache_file.filesize();
+  if (cache_size >= header_size)
+    {
+      const unsigned char* p = cache_file.get_view(0, 0, cache_size, true,
+						   false);
+      Armap_cache_header hdr;
+      memcpy(&hdr, p, sizeof(hdr));
+      uint64_t max_syms = (cache_size - header_size) / (2 * sizeof(uint64_t));
+      if (memcmp(hdr.magic, key.magic, sizeof(hdr.magic)) == 0
+	  && hdr.file_size == key.file_size
+	  && hdr.mtime_seconds == key.mtime_seconds
+	  && hdr.mtime_nanoseconds == key.mtime_nanoseconds
+	  && hdr.armap_size == key.armap_size
+	  && hdr.nsyms <= max_syms
+	  && (header_size + hdr.nsyms * 2 * sizeof(uint64_t) + hdr.names_size
+	      == static_cast<uint64_t>(cache_size)))
+	{
+	  const unsigned char* pentries = p + header_size;
+	  const char* pnames =
+	    reinterpret_cast<const char*>(pentries
+					  + hdr.nsyms * 2 * sizeof(uint64_t));
+	  this->armap_names_.assign(pnames, hdr.names_size);
+	  this->armap_.resize(hdr.nsyms);
+	  found = true;
+	  for (uint64_t i = 0; i < hdr.nsyms; ++i)
+	    {
+	      uint64_t offsets[2];
+	      memcpy(offsets, pentries, sizeof(offsets));
+	      pentries += sizeof(offsets);
+	      if (offsets[0] >= hdr.names_size)
+		{
+		  found = false;
+		  break;
+		}
+	      this->armap_[i].name_offset = offsets[0];
+	      this->armap_[i].file_offset = offsets[1];
+	    }
+	  if (found)
+	    this->num_members_ = hdr.num_members;
+	  else
+	    {
+	      this->armap_.clear();
+	      this->armap_names_.clear();
+	    }
+	}
+    }
+  cache_file.unlock(this->task_);
+
+  if (!found)
+    return false;
+
+  this->armap_checked_.resize(this->armap_.size());
+
+  armap_cache_initialize_lock.initialize();
+  Hold_optional_lock hl(armap_cache_lock);
+  ++Archive::armap_cache_hits;
+  return true;
+}
+
+// Write the archive symbol map to the --input-cache directory.  We
+// write to a temporary file and rename it, so that a concurrent link
+// never sees a partial entry.
+
+void
+Archive::write_armap_cache(section_size_type size)
+{
+  if (parameters->options().input_cache() == NULL)
+    return;
+
+  Armap_cache_header hdr;
+  std::string filename = armap_cache_filename(&this->input_file_->file(),
+					      size, &hdr);
+  if (filename.empty())
+    return;
+  hdr.nsyms = this->armap_.size();
+  hdr.names_size = this->armap_names_.size();
+  hdr.num_members = this->num_members_;
+
+  unsigned int serial;
+  armap_cache_initialize_lock.initialize();
+  {
+    Hold_optional_lock hl(armap_cache_lock);
+    serial = ++Archive::armap_cache_misses;
+  }
+
+  char suffix[32];
+  snprintf(suffix, sizeof(suffix), ".%ld.%u",
+	   static_cast<long>(getpid()), serial);
+  std::string tmpname = filename + suffix;
+
+  int fd = ::open(tmpname.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0644);
+  FILE* f = fd < 0 ? NULL : fdopen(fd, "wb");
+  if (f == NULL)
+    {
+      gold_warning(_("%s: cannot create %s: %s"), this->name().c_str(),
+		   tmpname.c_str(), strerror(errno));
+      if (fd >= 0)
+	::close(fd);
+      return;
+    }
+
+  bool ok = fwrite(&hdr, sizeof(hdr), 1, f) == 1;
+  for (size_t i = 0; ok && i < this->armap_.size(); ++i)
+    {
+      uint64_t offsets[2];
+      offsets[0] = this->armap_[i].name_offset;
+      offsets[1] = this->armap_[i].file_offset;
+      ok = fwrite(offsets, sizeof(offsets), 1, f) == 1;
+    }
+  if (ok && !this->armap_names_.empty())
+    ok = fwrite(this->armap_names_.data(), this->armap_names_.size(), 1,
+		f) == 1;
+  if (fclose(f) != 0)
+    ok = false;
+
+  if (!ok || ::rename(tmpname.c_str(), filename.c_str()) < 0)
+    {
+      gold_warning(_("%s: cannot write %s: %s"), this->name().c_str(),
+		   filename.c_str(), strerror(errno));
+      ::unlink(tmpname.c_str());
+    }
+}
+
 // Read the header of an archive member at OFF.  Fail if something
 // goes wrong.  Return the size of the member.  Set *PNAME to the name
 // of the member.
@@ -736,14 +959,40 @@ Archive::read_symbols(off_t off)
   this->members_[off] = member;
 }
 
+// Add the undefined global symbols of OBJ, an object we have just
+// included in the link, to UNDEFS.  We can't get at the symbols of a
+// plugin object, so for one of those we add NULL, which asks for every
+// archive map entry to be checked again.
+
+static void
+add_undefined_symbols(Object* obj, std::vector<Symbol*>* undefs)
+{
+  if (obj->pluginobj() != NULL)
+    {
+      undefs->push_back(NULL);
+      return;
+    }
+  const Object::Symbols* syms = obj->get_global_symbols();
+  if (syms == NULL)
+    return;
+  for (Object::Symbols::const_iterator p = syms->begin();
+       p != syms->end();
+       ++p)
+    if (*p != NULL && (*p)->is_undefined())
+      undefs->push_back(*p);
+}
+
 // Select members from the archive and add them to the link.  We walk
 // through the elements in the archive map, and look each one up in
 // the symbol table.  If it exists as a strong undefined symbol, we
-// pull in the corresponding element.  We have to do this in a loop,
-// since pulling in one element may create new undefined symbols which
-// may be satisfied by other objects in the archive.  Return true in
-// the normal case, false if the first member we tried to add from
-// this archive had an incompatible target.
+// pull in the corresponding element.  Pulling in one element may
+// create new undefined symbols which may be satisfied by other
+// objects in the archive.  Rather than walking the whole archive map
+// again, we look up just those symbols in a hash index of the map,
+// and check the entries we find in the order that repeated walks
+// would have checked them.  Return true in the normal case, false if
+// the first member we tried to add from this archive had an
+// incompatible target.
 
 bool
 Archive::add_symbols(Symbol_table* symtab, Layout* layout,
@@ -766,72 +1015,180 @@ Archive::add_symbols(Symbol_table* symtab, Layout* layout,
   // offset we saw that was present in the seen_offsets_ set.
   off_t last_seen_offset = -1;
 
-  // Track which symbols in the symbol table we've already found to be
-  // defined.
-
   char* tmpbuf = NULL;
   size_t tmpbuflen = 0;
-  bool added_new_object;
-  do
+  bool ok = true;
+
+  // The undefined symbols of the members we have included, which we
+  // have not yet looked up in the archive map.
+  std::vector<Symbol*> undefs;
+
+  for (size_t i = 0; ok && i < armap_size; ++i)
+    ok = this->check_armap_entry(symtab, layout, input_objects, mapfile, i,
+				 &last_seen_offset, &tmpbuf, &tmpbuflen,
+				 &undefs);
+
+  // The archive map entries which may now name a needed member.  Each
+  // walk of the archive map starts at the lowest entry, and goes on
+  // past NEXT.
+  std::set<size_t> candidates;
+  size_t next = 0;
+  while (ok && (!undefs.empty() || !candidates.empty()))
     {
-      added_new_object = false;
-      for (size_t i = 0; i < armap_size; ++i)
+      if (!undefs.empty())
 	{
-          if (this->armap_checked_[i])
-            continue;
-	  if (this->armap_[i].file_offset == last_seen_offset)
-            {
-              this->armap_checked_[i] = true;
-              continue;
-            }
-	  if (this->seen_offsets_.find(this->armap_[i].file_offset)
-              != this->seen_offsets_.end())
-	    {
-              this->armap_checked_[i] = true;
-	      last_seen_offset = this->armap_[i].file_offset;
-	      continue;
-	    }
+	  this->find_armap_entries(undefs, &candidates);
+	  undefs.clear();
+	  continue;
+	}
 
-	  const char* sym_name = (this->armap_names_.data()
-				  + this->armap_[i].name_offset);
+      std::set<size_t>::iterator p = candidates.lower_bound(next);
+      if (p == candidates.end())
+	{
+	  next = 0;
+	  continue;
+	}
+      size_t i = *p;
+      candidates.erase(p);
+      next = i + 1;
+      ok = this->check_armap_entry(symtab, layout, input_objects, mapfile, i,
+				   &last_seen_offset, &tmpbuf, &tmpbuflen,
+				   &undefs);
+    }
 
-          Symbol* sym;
-          std::string why;
-          Archive::Should_include t =
-	    Archive::should_include_member(symtab, layout, sym_name, &sym,
-					   &why, &tmpbuf, &tmpbuflen);
+  if (tmpbuf != NULL)
+    free(tmpbuf);
 
-	  if (t == Archive::SHOULD_INCLUDE_NO
-              || t == Archive::SHOULD_INCLUDE_YES)
-	    this->armap_checked_[i] = true;
+  if (!ok)
+    return false;
 
-	  if (t != Archive::SHOULD_INCLUDE_YES)
-	    continue;
+  input_objects->archive_stop(this);
 
-	  // We want to include this object in the link.
-	  last_seen_offset = this->armap_[i].file_offset;
-	  this->seen_offsets_.insert(last_seen_offset);
+  return true;
+}
 
-	  if (!this->include_member(symtab, layout, input_objects,
-				    last_seen_offset, mapfile, sym,
-				    why.c_str()))
-	    {
-	      if (tmpbuf != NULL)
-		free(tmpbuf);
-	      return false;
-	    }
+// Check archive map entry I.  If it names a member we have not
+// included, and the symbol table needs the symbol, include the member
+// and add its undefined symbols to UNDEFS.  Return false if the member
+// had an incompatible target.
 
-	  added_new_object = true;
-	}
+bool
+Archive::check_armap_entry(Symbol_table* symtab, Layout* layout,
+			   Input_objects* input_objects, Mapfile* mapfile,
+			   size_t i, off_t* last_seen_offset, char** tmpbufp,
+			   size_t* tmpbuflen, std::vector<Symbol*>* undefs)
+{
+  if (this->armap_checked_[i])
+    return true;
+  if (this->armap_[i].file_offset == *last_seen_offset)
+    {
+      this->armap_checked_[i] = true;
+      return true;
+    }
+  if (this->seen_offsets_.find(this->armap_[i].file_offset)
+      != this->seen_offsets_.end())
+    {
+      this->armap_checked_[i] = true;
+      *last_seen_offset = this->armap_[i].file_offset;
+      return true;
     }
-  while (added_new_object);
 
-  if (tmpbuf != NULL)
-    free(tmpbuf);
+  const char* sym_name = (this->armap_names_.data()
+			  + this->armap_[i].name_offset);
 
-  input_objects->archive_stop(this);
+  ++Archive::armap_probes;
 
-  return true;
+  Symbol* sym;
+  std::string why;
+  Archive::Should_include t =
+    Archive::should_include_member(symtab, layout, sym_name, &sym,
+				   &why, tmpbufp, tmpbuflen);
+
+  if (t == Archive::SHOULD_INCLUDE_NO
+      || t == Archive::SHOULD_INCLUDE_YES)
+    this->armap_checked_[i] = true;
+
+  if (t != Archive::SHOULD_INCLUDE_YES)
+    return true;
+
+  // We want to include this object in the link.
+  *last_seen_offset = this->armap_[i].file_offset;
+  this->seen_offsets_.insert(*last_seen_offset);
+
+  return this->include_member(symtab, layout, input_objects,
+			      *last_seen_offset, mapfile, sym, why.c_str(),
+			      undefs);
+}
+
+// Build the hash index of the archive map.  The index is keyed by
+// the symbol name without any version, since that is how we look
+// symbols up.
+
+void
+Archive::build_armap_index()
+{
+  const size_t armap_size = this->armap_.size();
+  this->armap_buckets_.assign(armap_size | 1, 0);
+  this->armap_chain_.assign(armap_size, 0);
+
+  // Insert the entries in reverse order, so that each chain is in
+  // archive map order.
+  const char* names = this->armap_names_.data();
+  for (size_t i = armap_size; i > 0; --i)
+    {
+      const char* name = names + this->armap_[i - 1].name_offset;
+      size_t len = strcspn(name, "@");
+      size_t bucket = (Stringpool::string_hash(name, len)
+		       % this->armap_buckets_.size());
+      this->armap_chain_[i - 1] = this->armap_buckets_[bucket];
+      this->armap_buckets_[bucket] = i;
+    }
+}
+
+// Add to CANDIDATES the unchecked archive map entries which name one
+// of the symbols in UNDEFS.  A NULL symbol stands for symbols we could
+// not see, and matches every entry.
+
+void
+Archive::find_armap_entries(const std::vector<Symbol*>& undefs,
+			    std::set<size_t>* candidates)
+{
+  if (this->armap_.empty())
+    return;
+  if (this->armap_buckets_.empty())
+    this->build_armap_index();
+
+  const char* names = this->armap_names_.data();
+  for (std::vector<Symbol*>::const_iterator p = undefs.begin();
+       p != undefs.end();
+       ++p)
+    {
+      if (*p == NULL)
+	{
+	  for (size_t i = 0; i < this->armap_.size(); ++i)
+	    if (!this->armap_checked_[i])
+	      candidates->insert(i);
+	  return;
+	}
+      if (!(*p)->is_undefined())
+	continue;
+      const char* name = (*p)->name();
+      size_t len = strlen(name);
+      size_t bucket = (Stringpool::string_hash(name, len)
+		       % this->armap_buckets_.size());
+      for (unsigned int e = this->armap_buckets_[bucket];
+	   e != 0;
+	   e = this->armap_chain_[e - 1])
+	{
+	  size_t i = e - 1;
+	  if (this->armap_checked_[i])
+	    continue;
+	  const char* armap_name = names + this->armap_[i].name_offset;
+	  if (strncmp(armap_name, name, len) == 0
+	      && (armap_name[len] == '\0' || armap_name[len] == '@'))
+	    candidates->insert(i);
+	}
+    }
 }
 
 // Return whether the archive includes a member which defines the
@@ -893,7 +1250,7 @@ Archive::include_all_members(Symbol_table* symtab, Layout* layout,
            ++p)
         {
           if (!this->include_member(symtab, layout, input_objects, p->first,
-				    mapfile, NULL, "--whole-archive"))
+				    mapfile, NULL, "--whole-archive", NULL))
 	    return false;
           ++Archive::total_members;
         }
@@ -905,7 +1262,7 @@ Archive::include_all_members(Symbol_table* symtab, Layout* layout,
            ++p)
         {
           if (!this->include_member(symtab, layout, input_objects, p->off,
-				    mapfile, NULL, "--whole-archive"))
+				    mapfile, NULL, "--whole-archive", NULL))
 	    return false;
           ++Archive::total_members;
         }
@@ -965,7 +1322,8 @@ class Thin_archive_object_unlocker
 bool
 Archive::include_member(Symbol_table* symtab, Layout* layout,
 			Input_objects* input_objects, off_t off,
-			Mapfile* mapfile, Symbol* sym, const char* why)
+			Mapfile* mapfile, Symbol* sym, const char* why,
+			std::vector<Symbol*>* undefs)
 {
   ++Archive::total_members_loaded;
 
@@ -982,6 +1340,8 @@ Archive::include_member(Symbol_table* symtab, Layout* layout,
           obj->layout(symtab, layout, sd);
           obj->add_symbols(symtab, sd, layout);
 	  this->included_member_ = true;
+	  if (undefs != NULL)
+	    add_undefined_symbols(obj, undefs);
         }
       delete sd;
       return true;
@@ -1016,6 +1376,8 @@ Archive::include_member(Symbol_table* symtab, Layout* layout,
     {
       pluginobj->add_symbols(symtab, NULL, layout);
       this->included_member_ = true;
+      if (undefs != NULL)
+	add_undefined_symbols(obj, undefs);
       return true;
     }
 
@@ -1036,6 +1398,8 @@ Archive::include_member(Symbol_table* symtab, Layout* layout,
   }
 
   this->included_member_ = true;
+  if (undefs != NULL)
+    add_undefined_symbols(obj, undefs);
   return true;
 }
 
@@ -1065,6 +1429,15 @@ Archive::print_stats()
           program_name, Archive::total_members);
   fprintf(stderr, _("%s: loaded archive members: %u\n"),
           program_name, Archive::total_members_loaded);
+  fprintf(stderr, _("%s: archive symbol map probes: %u\n"),
+          program_name, Archive::armap_probes);
+  if (parameters->options().input_cache() != NULL)
+    {
+      fprintf(stderr, _("%s: archive symbol maps read from cache: %u\n"),
+	      program_name, Archive::armap_cache_hits);
+      fprintf(stderr, _("%s: archive symbol maps written to cache: %u\n"),
+	      program_name, Archive::armap_cache_misses);
+    }
 }
 
 // Add_archive_symbols methods.
@@ -1078,13 +1451,17 @@ Add_archive_symbols::~Add_archive_symbols()
 }
 
 // Return whether we can add the archive symbols.  We are blocked by
-// this_blocker_.  We block next_blocker_.  We also lock the file.
+// this_blocker_, and by any symbols being added to a sharded symbol
+// table.  We block next_blocker_.  We also lock the file.
 
 Task_token*
 Add_archive_symbols::is_runnable()
 {
   if (this->this_blocker_ != NULL && this->this_blocker_->is_blocked())
     return this->this_blocker_;
+  Task_token* shard_blocker = this->symtab_->shard_tasks_blocker();
+  if (shard_blocker != NULL)
+    return shard_blocker;
   return NULL;
 }
 
@@ -1308,6 +1685,9 @@ Add_lib_group_symbols::is_runnable()
     return this->readsyms_blocker_;
   if (this->this_blocker_ != NULL && this->this_blocker_->is_blocked())
     return this->this_blocker_;
+  Task_token* shard_blocker = this->symtab_->shard_tasks_blocker();
+  if (shard_blocker != NULL)
+    return shard_blocker;
   return NULL;
 }
 
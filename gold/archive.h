@@ -23,6 +23,7 @@
 #ifndef GOLD_ARCHIVE_H
 #define GOLD_ARCHIVE_H
 
+#include <set>
 #include <string>
 #include <vector>
 
@@ -283,6 +284,12 @@ class Archive : public Library_base
   static unsigned int total_members;
   // Number of archive members loaded.
   static unsigned int total_members_loaded;
+  // Number of archive symbol maps read from the --input-cache directory.
+  static unsigned int armap_cache_hits;
+  // Number of archive symbol maps written to the --input-cache directory.
+  static unsigned int armap_cache_misses;
+  // Number of archive map entries checked against the symbol table.
+  static unsigned int armap_probes;
 
   // Get a view into the underlying file.
   const unsigned char*
@@ -293,6 +300,16 @@ class Archive : public Library_base
   void
   read_armap(off_t start, section_size_type size);
 
+  // Read the archive symbol map from the --input-cache directory.
+  // SIZE is the size of the symbol map in the archive.  Return false
+  // if there is no valid cache entry.
+  bool
+  read_armap_cache(section_size_type size);
+
+  // Write the archive symbol map to the --input-cache directory.
+  void
+  write_armap_cache(section_size_type size);
+
   // Read an archive member header at OFF.  CACHE is whether to cache
   // the file view.  Return the size of the member, and set *PNAME to
   // the name.
@@ -331,10 +348,29 @@ class Archive : public Library_base
   bool
   include_all_members(Symbol_table*, Layout*, Input_objects*, Mapfile*);
 
-  // Include an archive member in the link.
+  // Include an archive member in the link.  If UNDEFS is not NULL,
+  // add the undefined symbols of the member to it.
   bool
   include_member(Symbol_table*, Layout*, Input_objects*, off_t off,
-		 Mapfile*, Symbol*, const char* why);
+		 Mapfile*, Symbol*, const char* why,
+		 std::vector<Symbol*>* undefs);
+
+  // Check archive map entry I, and include the member it names if
+  // that member is needed.
+  bool
+  check_armap_entry(Symbol_table*, Layout*, Input_objects*, Mapfile*,
+		    size_t i, off_t* last_seen_offset, char** tmpbufp,
+		    size_t* tmpbuflen, std::vector<Symbol*>* undefs);
+
+  // Build the hash index of the archive map.
+  void
+  build_armap_index();
+
+  // Add to CANDIDATES the unchecked archive map entries for the
+  // symbols in UNDEFS.
+  void
+  find_armap_entries(const std::vector<Symbol*>& undefs,
+		     std::set<size_t>* candidates);
 
   // Return whether we found this archive by searching a directory.
   bool
@@ -391,6 +427,13 @@ class Archive : public Library_base
   std::vector<bool> armap_checked_;
   // Track which elements have been included by offset.
   Unordered_set<off_t, Seen_hash> seen_offsets_;
+  // Hash index of the archive map by symbol name, ignoring any
+  // version.  This is built the first time an included member leaves
+  // undefined symbols.  Each bucket and each chain link holds one more
+  // than the index of an archive map entry, or zero at the end of a
+  // chain.
+  std::vector<unsigned int> armap_buckets_;
+  std::vector<unsigned int> armap_chain_;
   // Table of objects whose symbols have been pre-read.
   std::map<off_t, Archive_member> members_;
   // True if this is a thin archive.
@@ -0,0 +1,467 @@
+// call-graph.cc -- order functions using a call graph profile
+
+// Copyright (C) 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+#include "gold.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <fstream>
+#include <set>
+#include <sstream>
+
+#include "parameters.h"
+#include "target.h"
+#include "symtab.h"
+#include "output.h"
+#include "layout.h"
+#include "call-graph.h"
+
+namespace gold
+{
+
+// Read the profile from FILENAME.  Each line has the form
+//   CALLER CALLEE COUNT
+// Empty lines and lines starting with '#' are ignored.
+
+void
+Call_graph_ordering::read(const char* filename)
+{
+  std::ifstream in(filename);
+  if (!in)
+    gold_fatal(_("unable to open --call-graph-ordering-file file %s: %s"),
+	       filename, strerror(errno));
+
+  std::string line;
+  unsigned int lineno = 0;
+  while (std::getline(in, line))
+    {
+      ++lineno;
+      if (!line.empty() && line[line.length() - 1] == '\r')   // Windows
+	line.resize(line.length() - 1);
+      if (line.empty() || line[0] == '#')
+	continue;
+
+      std::istringstream fields(line);
+      std::string caller;
+      std::string callee;
+      uint64_t weight;
+      std::string extra;
+      if (!(fields >> caller >> callee >> weight) || (fields >> extra))
+	{
+	  gold_error(_("%s:%u: expected CALLER CALLEE COUNT"), filename,
+		     lineno);
+	  continue;
+	}
+      this->edges_.push_back(Edge(caller, callee, weight));
+    }
+}
+
+// Return the node for the section which defines the symbol NAME,
+// adding it to NODES_ if necessary.  NODE_MAP maps sections to nodes.
+// Return -1U if the symbol is not defined in an input section of a
+// relocatable object.
+
+unsigned int
+Call_graph_ordering::find_node(
+    const Symbol_table* symtab,
+    const std::string& name,
+    Unordered_map<Section_id, unsigned int, Section_id_hash>* node_map)
+{
+  const Symbol* sym = symtab->lookup(name.c_str());
+  if (sym == NULL
+      || sym->source() != Symbol::FROM_OBJECT
+      || !sym->is_defined()
+      || sym->is_from_dynobj()
+      || sym->is_placeholder())
+    return -1U;
+
+  bool is_ordinary;
+  unsigned int shndx = sym->shndx(&is_ordinary);
+  if (!is_ordinary)
+    return -1U;
+
+  Relobj* relobj = static_cast<Relobj*>(sym->object());
+  std::pair<Unordered_map<Section_id, unsigned int,
+			  Section_id_hash>::iterator, bool> ins =
+    node_map->insert(std::make_pair(Section_id(relobj, shndx),
+				    this->nodes_.size()));
+  if (ins.second)
+    this->nodes_.push_back(Node(relobj, shndx));
+  return ins.first->second;
+}
+
+// Set the output section, size, and input order offset of each node.
+// We only order sections in executable output sections.  The offsets
+// are those the sections have before they are sorted, which is the
+// order in which they were added.
+
+void
+Call_graph_ordering::set_input_layout(Layout* layout)
+{
+  Unordered_map<Section_id, unsigned int, Section_id_hash> node_map;
+  for (unsigned int i = 0; i < this->nodes_.size(); ++i)
+    node_map[Section_id(this->nodes_[i].relobj, this->nodes_[i].shndx)] = i;
+
+  for (Layout::Section_list::const_iterator p = layout->section_list().begin();
+       p != layout->section_list().end();
+       ++p)
+    {
+      Output_section* os = *p;
+      if ((os->flags() & elfcpp::SHF_EXECINSTR) == 0)
+	continue;
+
+      uint64_t offset = 0;
+      const Output_section::Input_section_list& sections(os->input_sections());
+      for (Output_section::Input_section_list::const_iterator q =
+	     sections.begin();
+	   q != sections.end();
+	   ++q)
+	{
+	  offset = align_address(offset, q->addralign());
+	  uint64_t size = q->current_data_size();
+	  if (q->is_input_section() || q->is_relaxed_input_section())
+	    {
+	      Relobj* relobj = (q->is_input_section()
+				? q->relobj()
+				: q->relaxed_input_section()->relobj());
+	      Unordered_map<Section_id, unsigned int,
+			    Section_id_hash>::const_iterator n =
+		node_map.find(Section_id(relobj, q->shndx()));
+	      if (n != node_map.end())
+		{
+		  Node* node = &this->nodes_[n->second];
+		  node->output_section = os;
+		  node->size = size;
+		  node->input_offset = offset;
+		}
+	    }
+	  offset += size;
+	}
+    }
+}
+
+// A cluster of sections for the C3 heuristic.  The sections of a
+// cluster form a circular list, and the cluster is represented by
+// its first section, the leader.
+
+struct C3_cluster
+{
+  C3_cluster(unsigned int index, uint64_t section_size)
+    : next(index), prev(index), size(section_size), weight(0),
+      initial_weight(0), best_pred(-1U), best_pred_weight(0)
+  { }
+
+  // The density of the cluster: the number of calls to it per byte.
+  double
+  density() const
+  {
+    if (this->size == 0)
+      return 0;
+    return static_cast<double>(this->weight) / this->size;
+  }
+
+  // The next and previous sections of the cluster.
+  unsigned int next;
+  unsigned int prev;
+  // The size of the cluster.
+  uint64_t size;
+  // The number of calls to sections of the cluster.
+  uint64_t weight;
+  // The number of calls to the leader, before any merging.
+  uint64_t initial_weight;
+  // The most frequent caller of the leader, or -1U.
+  unsigned int best_pred;
+  // The number of calls from BEST_PRED.
+  uint64_t best_pred_weight;
+};
+
+// Sort clusters by decreasing density.
+
+class C3_density_compare
+{
+ public:
+  C3_density_compare(const std::vector<C3_cluster>& clusters)
+    : clusters_(clusters)
+  { }
+
+  bool
+  operator()(unsigned int i1, unsigned int i2) const
+  { return this->clusters_[i1].density() > this->clusters_[i2].density(); }
+
+ private:
+  const std::vector<C3_cluster>& clusters_;
+};
+
+// Return the leader of the cluster holding section I, compressing
+// the path in LEADERS as we go.
+
+static unsigned int
+c3_leader(std::vector<unsigned int>* leaders, unsigned int i)
+{
+  while ((*leaders)[i] != i)
+    {
+      (*leaders)[i] = (*leaders)[(*leaders)[i]];
+      i = (*leaders)[i];
+    }
+  return i;
+}
+
+// Run the C3 heuristic.  Every section starts in its own cluster.  We
+// visit the clusters by decreasing density, and append each one to
+// the cluster of the most frequent caller of its leader, unless that
+// would make the merged cluster too large or much less dense.  The
+// resulting clusters are placed by decreasing density.
+
+std::vector<unsigned int>
+Call_graph_ordering::cluster() const
+{
+  // Don't let a cluster grow beyond this size.  The aim is to keep
+  // the hot callers and callees in the same pages.
+  const uint64_t max_cluster_size = 1024 * 1024;
+  // Don't merge clusters if the density of the result falls below
+  // the density of the caller cluster divided by this.
+  const double max_density_degradation = 8.0;
+
+  std::vector<C3_cluster> clusters;
+  clusters.reserve(this->nodes_.size());
+  for (unsigned int i = 0; i < this->nodes_.size(); ++i)
+    clusters.push_back(C3_cluster(i, this->nodes_[i].size));
+
+  for (std::vector<Node_edge>::const_iterator p = this->node_edges_.begin();
+       p != this->node_edges_.end();
+       ++p)
+    {
+      const Node& caller(this->nodes_[p->caller]);
+      const Node& callee(this->nodes_[p->callee]);
+      if (callee.output_section == NULL
+	  || caller.output_section != callee.output_section)
+	continue;
+      C3_cluster* c = &clusters[p->callee];
+      c->weight += p->weight;
+      if (p->caller == p->callee)
+	continue;
+      if (c->best_pred == -1U || c->best_pred_weight < p->weight)
+	{
+	  c->best_pred = p->caller;
+	  c->best_pred_weight = p->weight;
+	}
+    }
+  for (unsigned int i = 0; i < clusters.size(); ++i)
+    clusters[i].initial_weight = clusters[i].weight;
+
+  std::vector<unsigned int> sorted;
+  for (unsigned int i = 0; i < clusters.size(); ++i)
+    sorted.push_back(i);
+  std::stable_sort(sorted.begin(), sorted.end(),
+		   C3_density_compare(clusters));
+
+  std::vector<unsigned int> leaders(sorted.size());
+  for (unsigned int i = 0; i < leaders.size(); ++i)
+    leaders[i] = i;
+
+  for (std::vector<unsigned int>::const_iterator p = sorted.begin();
+       p != sorted.end();
+       ++p)
+    {
+      // Nothing has been merged into cluster *P yet, so *P is its
+      // own leader.
+      unsigned int l = *p;
+      C3_cluster* c = &clusters[l];
+
+      // Don't merge along an edge which carries few of the calls.
+      if (c->best_pred == -1U || c->best_pred_weight * 10 <= c->initial_weight)
+	continue;
+
+      unsigned int pred_l = c3_leader(&leaders, c->best_pred);
+      if (pred_l == l)
+	continue;
+      C3_cluster* pred = &clusters[pred_l];
+      if (c->size + pred->size > max_cluster_size)
+	continue;
+      double new_density = (static_cast<double>(pred->weight + c->weight)
+			    / (pred->size + c->size));
+      if (new_density < pred->density() / max_density_degradation)
+	continue;
+
+      // Append the sections of C to those of PRED.
+      leaders[l] = pred_l;
+      unsigned int tail1 = pred->prev;
+      unsigned int tail2 = c->prev;
+      pred->prev = tail2;
+      clusters[tail2].next = pred_l;
+      c->prev = tail1;
+      clusters[tail1].next = l;
+      pred->size += c->size;
+      pred->weight += c->weight;
+      c->size = 0;
+      c->weight = 0;
+    }
+
+  sorted.clear();
+  for (unsigned int i = 0; i < clusters.size(); ++i)
+    if (leaders[i] == i && this->nodes_[i].output_section != NULL)
+      sorted.push_back(i);
+  std::stable_sort(sorted.begin(), sorted.end(),
+		   C3_density_compare(clusters));
+
+  std::vector<unsigned int> order;
+  for (std::vector<unsigned int>::const_iterator p = sorted.begin();
+       p != sorted.end();
+       ++p)
+    {
+      unsigned int i = *p;
+      do
+	{
+	  order.push_back(i);
+	  i = clusters[i].next;
+	}
+      while (i != *p);
+    }
+  return order;
+}
+
+// Compute the order of the sections which define the functions of
+// the profile, and apply it to the executable output sections.
+
+void
+Call_graph_ordering::apply(const Symbol_table* symtab, Layout* layout)
+{
+  Unordered_map<Section_id, unsigned int, Section_id_hash> node_map;
+  for (std::vector<Edge>::const_iterator p = this->edges_.begin();
+       p != this->edges_.end();
+       ++p)
+    {
+      unsigned int caller = this->find_node(symtab, p->caller, &node_map);
+      unsigned int callee = this->find_node(symtab, p->callee, &node_map);
+      if (caller == -1U || callee == -1U)
+	++this->unresolved_count_;
+      else
+	this->node_edges_.push_back(Node_edge(caller, callee, p->weight));
+    }
+  if (this->nodes_.empty())
+    return;
+
+  this->set_input_layout(layout);
+  std::vector<unsigned int> order(this->cluster());
+
+  Output_section::Section_layout_order* order_map =
+    layout->get_section_order_map();
+  unsigned int index = 1;
+  for (std::vector<unsigned int>::const_iterator p = order.begin();
+       p != order.end();
+       ++p)
+    {
+      const Node& node(this->nodes_[*p]);
+      (*order_map)[Section_id(node.relobj, node.shndx)] = index;
+      ++index;
+    }
+
+  for (Layout::Section_list::const_iterator p = layout->section_list().begin();
+       p != layout->section_list().end();
+       ++p)
+    if (((*p)->flags() & elfcpp::SHF_EXECINSTR) != 0)
+      (*p)->update_section_layout(order_map);
+}
+
+// Print the footprint of the functions of the profile when the
+// section of each node is at OFFSETS in its output section: the
+// number of pages and cache lines they touch, which is the number of
+// page faults and cache misses to expect when they are all first
+// called, and the fraction of the calls which go to another page.
+// The offsets are relative to the output section, which we assume to
+// be page aligned.
+
+void
+Call_graph_ordering::print_footprint(const char* what,
+				     const std::vector<uint64_t>& offsets)
+  const
+{
+  const uint64_t page_size = parameters->target().common_pagesize();
+  const uint64_t line_size = 64;
+
+  typedef std::set<std::pair<const Output_section*, uint64_t> > Block_set;
+  Block_set pages;
+  Block_set lines;
+  for (unsigned int i = 0; i < this->nodes_.size(); ++i)
+    {
+      const Node& node(this->nodes_[i]);
+      if (node.output_section == NULL || offsets[i] == -1ULL)
+	continue;
+      uint64_t end = offsets[i] + std::max(node.size, static_cast<uint64_t>(1));
+      for (uint64_t p = offsets[i] / page_size; p * page_size < end; ++p)
+	pages.insert(std::make_pair(node.output_section, p));
+      for (uint64_t l = offsets[i] / line_size; l * line_size < end; ++l)
+	lines.insert(std::make_pair(node.output_section, l));
+    }
+
+  uint64_t calls = 0;
+  uint64_t far_calls = 0;
+  for (std::vector<Node_edge>::const_iterator p = this->node_edges_.begin();
+       p != this->node_edges_.end();
+       ++p)
+    {
+      const Node& caller(this->nodes_[p->caller]);
+      const Node& callee(this->nodes_[p->callee]);
+      if (caller.output_section == NULL
+	  || caller.output_section != callee.output_section
+	  || offsets[p->caller] == -1ULL
+	  || offsets[p->callee] == -1ULL)
+	continue;
+      calls += p->weight;
+      if (offsets[p->caller] / page_size != offsets[p->callee] / page_size)
+	far_calls += p->weight;
+    }
+
+  fprintf(stderr, _("%s: call graph %s: %zu pages, %zu cache lines, "
+		    "%.1f%% of calls to another page\n"),
+	  program_name, what, pages.size(), lines.size(),
+	  calls == 0 ? 0.0 : 100.0 * far_calls / calls);
+}
+
+// Print the footprint of the functions of the profile, for the input
+// order and for the final order.
+
+void
+Call_graph_ordering::print_stats() const
+{
+  fprintf(stderr, _("%s: call graph edges: %zu; unresolved: %u; "
+		    "sections: %zu\n"),
+	  program_name, this->edges_.size(), this->unresolved_count_,
+	  this->nodes_.size());
+  if (this->nodes_.empty())
+    return;
+
+  std::vector<uint64_t> offsets;
+  offsets.reserve(this->nodes_.size());
+  for (unsigned int i = 0; i < this->nodes_.size(); ++i)
+    offsets.push_back(this->nodes_[i].input_offset);
+  this->print_footprint("input order", offsets);
+
+  offsets.clear();
+  for (unsigned int i = 0; i < this->nodes_.size(); ++i)
+    offsets.push_back(this->nodes_[i].relobj->output_section_offset(
+			this->nodes_[i].shndx));
+  this->print_footprint("profile order", offsets);
+}
+
+} // End namespace gold.
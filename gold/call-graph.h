@@ -0,0 +1,151 @@
+// call-graph.h -- order functions using a call graph profile  -*- C++ -*-
+
+// Copyright (C) 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+#ifndef GOLD_CALL_GRAPH_H
+#define GOLD_CALL_GRAPH_H
+
+#include <string>
+#include <vector>
+
+#include "object.h"
+
+namespace gold
+{
+
+class Layout;
+class Output_section;
+class Symbol_table;
+
+// The call graph profile given by --call-graph-ordering-file.  Each
+// line of the file names a caller, a callee, and the number of calls
+// from the caller to the callee.  We use the profile to order the
+// sections which define the functions so that callers and their
+// callees are placed near each other, using the Call-Chain
+// Clustering (C3) heuristic of Ottoni and Maher, which is a variant
+// of the Pettis-Hansen algorithm.  The profile gives the order of
+// the sections in the same way as --section-ordering-file, and the
+// remaining sections are placed ahead of them.
+
+class Call_graph_ordering
+{
+ public:
+  Call_graph_ordering()
+    : edges_(), nodes_(), node_edges_(), unresolved_count_(0)
+  { }
+
+  // Read the profile from FILENAME.
+  void
+  read(const char* filename);
+
+  // Compute the order of the sections which define the functions of
+  // the profile, and apply it to the output sections of LAYOUT.
+  // This is called after all the input sections have been laid out.
+  void
+  apply(const Symbol_table*, Layout*);
+
+  // Print the expected page and cache line footprint of the
+  // functions in the profile, for the input order and for the order
+  // we computed.  This is called after the section offsets are final.
+  void
+  print_stats() const;
+
+ private:
+  // A line of the profile.
+  struct Edge
+  {
+    Edge(const std::string& from, const std::string& to, uint64_t w)
+      : caller(from), callee(to), weight(w)
+    { }
+
+    std::string caller;
+    std::string callee;
+    uint64_t weight;
+  };
+
+  // A section which defines a function in the profile.
+  struct Node
+  {
+    Node(Relobj* object, unsigned int index)
+      : relobj(object), shndx(index), output_section(NULL), size(0),
+	input_offset(0)
+    { }
+
+    // The section.
+    Relobj* relobj;
+    unsigned int shndx;
+    // The output section, or NULL if the section is not in an output
+    // section we can order.
+    Output_section* output_section;
+    // The size of the section.
+    uint64_t size;
+    // The offset of the section in the output section, in the input
+    // order.
+    uint64_t input_offset;
+  };
+
+  // An edge of the profile between two nodes.
+  struct Node_edge
+  {
+    Node_edge(unsigned int from, unsigned int to, uint64_t w)
+      : caller(from), callee(to), weight(w)
+    { }
+
+    unsigned int caller;
+    unsigned int callee;
+    uint64_t weight;
+  };
+
+  // Return the section which defines the symbol NAME, with its index
+  // in NODES_, or -1U if it is not defined in an input section.
+  unsigned int
+  find_node(const Symbol_table*, const std::string& name,
+	    Unordered_map<Section_id, unsigned int, Section_id_hash>*);
+
+  // Set the output section, size, and input order offset of each
+  // node, from the input sections of the output sections of LAYOUT.
+  void
+  set_input_layout(Layout*);
+
+  // Run the C3 heuristic, and return the nodes in the order in which
+  // they should be placed.
+  std::vector<unsigned int>
+  cluster() const;
+
+  // Print the footprint of the nodes, with the offset of each node
+  // given by OFFSETS.
+  void
+  print_footprint(const char* what, const std::vector<uint64_t>& offsets)
+    const;
+
+  // The lines of the profile.
+  std::vector<Edge> edges_;
+  // The sections which define the functions in the profile.
+  std::vector<Node> nodes_;
+  // The edges between the nodes.
+  std::vector<Node_edge> node_edges_;
+  // The number of lines of the profile for which we did not find
+  // both functions.
+  unsigned int unresolved_count_;
+};
+
+} // End namespace gold.
+
+#endif // !defined(GOLD_CALL_GRAPH_H)
@@ -36,12 +36,20 @@ namespace gold
 
 // Allocate_commons_task methods.
 
+Allocate_commons_task::~Allocate_commons_task()
+{
+  if (this->this_blocker_ != NULL)
+    delete this->this_blocker_;
+}
+
 // This task allocates the common symbols.  We arrange to run it
-// before anything else which needs to access the symbol table.
+// before anything else which needs to change the symbol table.
 
 Task_token*
 Allocate_commons_task::is_runnable()
 {
+  if (this->this_blocker_ != NULL && this->this_blocker_->is_blocked())
+    return this->this_blocker_;
   return NULL;
 }
 
@@ -192,21 +200,45 @@ void
 Symbol_table::do_allocate_commons(Layout* layout, Mapfile* mapfile,
 				  Sort_commons_order sort_order)
 {
-  if (!this->commons_.empty())
+  // When the symbol table is sharded, gather the common symbols into
+  // the lists of the first shard.  The lists are sorted below, so the
+  // shard order does not matter.
+  Symbol_table_shard* first = this->shards_[0];
+  for (size_t i = 1; i < this->shards_.size(); ++i)
+    {
+      Symbol_table_shard* shard = this->shards_[i];
+      first->commons.insert(first->commons.end(), shard->commons.begin(),
+			    shard->commons.end());
+      first->tls_commons.insert(first->tls_commons.end(),
+				shard->tls_commons.begin(),
+				shard->tls_commons.end());
+      first->small_commons.insert(first->small_commons.end(),
+				  shard->small_commons.begin(),
+				  shard->small_commons.end());
+      first->large_commons.insert(first->large_commons.end(),
+				  shard->large_commons.begin(),
+				  shard->large_commons.end());
+      Commons_type().swap(shard->commons);
+      Commons_type().swap(shard->tls_commons);
+      Commons_type().swap(shard->small_commons);
+      Commons_type().swap(shard->large_commons);
+    }
+
+  if (!first->commons.empty())
     this->do_allocate_commons_list<size>(layout, COMMONS_NORMAL,
-					 &this->commons_, mapfile,
+					 &first->commons, mapfile,
 					 sort_order);
-  if (!this->tls_commons_.empty())
+  if (!first->tls_commons.empty())
     this->do_allocate_commons_list<size>(layout, COMMONS_TLS,
-					 &this->tls_commons_, mapfile,
+					 &first->tls_commons, mapfile,
 					 sort_order);
-  if (!this->small_commons_.empty())
+  if (!first->small_commons.empty())
     this->do_allocate_commons_list<size>(layout, COMMONS_SMALL,
-					 &this->small_commons_, mapfile,
+					 &first->small_commons, mapfile,
 					 sort_order);
-  if (!this->large_commons_.empty())
+  if (!first->large_commons.empty())
     this->do_allocate_commons_list<size>(layout, COMMONS_LARGE,
-					 &this->large_commons_, mapfile,
+					 &first->large_commons, mapfile,
 					 sort_order);
 }
 
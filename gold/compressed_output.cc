@@ -22,59 +22,17 @@
 
 #include "gold.h"
 #include <zlib.h>
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
 #include "parameters.h"
 #include "options.h"
+#include "workqueue.h"
 #include "compressed_output.h"
 
 namespace gold
 {
 
-// Compress UNCOMPRESSED_DATA of size UNCOMPRESSED_SIZE.  Returns true
-// if it successfully compressed, false if it failed for any reason
-// (including not having zlib support in the library).  If it returns
-// true, it allocates memory for the compressed data using new, and
-// sets *COMPRESSED_DATA and *COMPRESSED_SIZE to appropriate values.
-// It also writes a header before COMPRESSED_DATA: 4 bytes saying
-// "ZLIB", and 8 bytes indicating the uncompressed size, in big-endian
-// order.
-
-static bool
-zlib_compress(const unsigned char* uncompressed_data,
-              unsigned long uncompressed_size,
-              unsigned char** compressed_data,
-              unsigned long* compressed_size)
-{
-  const int header_size = 12;
-  *compressed_size = uncompressed_size + uncompressed_size / 1000 + 128;
-  *compressed_data = new unsigned char[*compressed_size + header_size];
-
-  int compress_level;
-  if (parameters->options().optimize() >= 1)
-    compress_level = 9;
-  else
-    compress_level = 1;
-
-  int rc = compress2(reinterpret_cast<Bytef*>(*compressed_data) + header_size,
-                     compressed_size,
-                     reinterpret_cast<const Bytef*>(uncompressed_data),
-                     uncompressed_size,
-                     compress_level);
-  if (rc == Z_OK)
-    {
-      memcpy(*compressed_data, "ZLIB", 4);
-      elfcpp::Swap_unaligned<64, true>::writeval(*compressed_data + 4,
-						 uncompressed_size);
-      *compressed_size += header_size;
-      return true;
-    }
-  else
-    {
-      delete[] *compressed_data;
-      *compressed_data = NULL;
-      return false;
-    }
-}
-
 // Decompress COMPRESSED_DATA of size COMPRESSED_SIZE, into a buffer
 // UNCOMPRESSED_DATA of size UNCOMPRESSED_SIZE.  Returns TRUE if it
 // decompressed successfully, false if it failed.  The buffer, of
@@ -165,40 +123,382 @@ decompress_input_section(const unsigned char* compressed_data,
   return false;
 }
 
-// Class Output_compressed_section.
+// Compressing a section in chunks.
 
-// Set the final data size of a compressed section.  This is where
-// we actually compress the section data.
+// The size of the pieces into which we split a section before
+// compressing it.  Each piece is compressed independently, so that the
+// pieces of a large section can be compressed on separate threads.
+// The pieces are large enough that the effect on the compression
+// ratio is negligible.  A section no larger than this is compressed
+// exactly as it would be in one piece.
 
-void
-Output_compressed_section::set_final_data_size()
+static const off_t compress_chunk_size = 1 << 20;
+
+// The zlib compression level to use.  As before chunked compression
+// was added, this is 9 with -O1 and 1 otherwise.
+
+static int
+zlib_compress_level()
 {
-  off_t uncompressed_size = this->postprocessing_buffer_size();
+  return parameters->options().optimize() >= 1 ? 9 : 1;
+}
 
-  // (Try to) compress the data.
-  unsigned long compressed_size;
-  unsigned char* uncompressed_data = this->postprocessing_buffer();
+// Compress UNCOMPRESSED_SIZE bytes at UNCOMPRESSED_DATA as raw deflate
+// data, which is one piece of a zlib stream.  If IS_LAST is false,
+// finish with a sync flush, so that the next piece may be appended
+// directly.  Returns true on success, in which case it allocates
+// memory for the compressed data using new and sets *COMPRESSED_DATA
+// and *COMPRESSED_SIZE.
+
+static bool
+zlib_compress_chunk(const unsigned char* uncompressed_data,
+		    unsigned long uncompressed_size,
+		    bool is_last,
+		    unsigned char** compressed_data,
+		    unsigned long* compressed_size)
+{
+  z_stream strm;
+  memset(&strm, 0, sizeof strm);
+  if (deflateInit2(&strm, zlib_compress_level(), Z_DEFLATED, -MAX_WBITS,
+		   8, Z_DEFAULT_STRATEGY) != Z_OK)
+    return false;
+
+  // The sync flush adds at most a few bytes to the bound, which
+  // assumes Z_FINISH.
+  unsigned long buffer_size = deflateBound(&strm, uncompressed_size) + 16;
+  *compressed_data = new unsigned char[buffer_size];
+
+  strm.next_in = const_cast<Bytef*>(uncompressed_data);
+  strm.avail_in = uncompressed_size;
+  strm.next_out = *compressed_data;
+  strm.avail_out = buffer_size;
+  int rc = deflate(&strm, is_last ? Z_FINISH : Z_SYNC_FLUSH);
+  bool ok = (is_last
+	     ? rc == Z_STREAM_END
+	     : rc == Z_OK && strm.avail_in == 0 && strm.avail_out > 0);
+  if (deflateEnd(&strm) != Z_OK && is_last)
+    ok = false;
+  if (!ok)
+    {
+      delete[] *compressed_data;
+      *compressed_data = NULL;
+      return false;
+    }
+  *compressed_size = buffer_size - strm.avail_out;
+  return true;
+}
+
+#ifdef HAVE_ZSTD
+
+// Compress UNCOMPRESSED_SIZE bytes at UNCOMPRESSED_DATA as a zstd
+// frame.  A zstd stream may consist of several frames, so the frames
+// for each piece are simply concatenated.  Returns as for
+// zlib_compress_chunk.
+
+static bool
+zstd_compress_chunk(const unsigned char* uncompressed_data,
+		    unsigned long uncompressed_size,
+		    unsigned char** compressed_data,
+		    unsigned long* compressed_size)
+{
+  size_t buffer_size = ZSTD_compressBound(uncompressed_size);
+  *compressed_data = new unsigned char[buffer_size];
+  int level = parameters->options().optimize() >= 1 ? 9 : 1;
+  size_t rc = ZSTD_compress(*compressed_data, buffer_size,
+			    uncompressed_data, uncompressed_size, level);
+  if (ZSTD_isError(rc))
+    {
+      delete[] *compressed_data;
+      *compressed_data = NULL;
+      return false;
+    }
+  *compressed_size = rc;
+  return true;
+}
+
+#endif // defined(HAVE_ZSTD)
+
+// Write an ELF compression header to P.  The 64-bit header has a
+// reserved word after ch_type.
+
+template<bool big_endian>
+static void
+write_compression_header(unsigned char* p, int size, unsigned int ch_type,
+			 uint64_t ch_size, uint64_t ch_addralign)
+{
+  if (size == 32)
+    {
+      elfcpp::Swap_unaligned<32, big_endian>::writeval(p, ch_type);
+      elfcpp::Swap_unaligned<32, big_endian>::writeval(p + 4, ch_size);
+      elfcpp::Swap_unaligned<32, big_endian>::writeval(p + 8, ch_addralign);
+    }
+  else
+    {
+      elfcpp::Swap_unaligned<32, big_endian>::writeval(p, ch_type);
+      elfcpp::Swap_unaligned<32, big_endian>::writeval(p + 4, 0);
+      elfcpp::Swap_unaligned<64, big_endian>::writeval(p + 8, ch_size);
+      elfcpp::Swap_unaligned<64, big_endian>::writeval(p + 16, ch_addralign);
+    }
+}
+
+// A Compress_chunk_task compresses one chunk of a section.
+
+class Compress_chunk_task : public Task
+{
+ public:
+  Compress_chunk_task(Output_compressed_section* os, unsigned int chunk,
+		      Task_token* blocker)
+    : os_(os), chunk_(chunk), blocker_(blocker)
+  { }
+
+  void
+  run(Workqueue*)
+  { this->os_->compress_chunk(this->chunk_); }
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
 
+  // Unblock BLOCKER_ when done.
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->blocker_); }
+
+  std::string
+  get_name() const
+  { return "Compress_chunk_task"; }
+
+ private:
+  Output_compressed_section* os_;
+  unsigned int chunk_;
+  Task_token* blocker_;
+};
+
+// Class Output_compressed_section.
+
+unsigned int Output_compressed_section::section_count;
+unsigned int Output_compressed_section::chunk_count;
+unsigned int Output_compressed_section::task_count;
+
+// Split the section data into chunks.
+
+void
+Output_compressed_section::prepare_chunks()
+{
   // At this point the contents of all regular input sections will
   // have been copied into the postprocessing buffer, and relocations
   // will have been applied.  Now we need to copy in the contents of
   // anything other than a regular input section.
   this->write_to_postprocessing_buffer();
 
-  bool success = false;
-  if (strcmp(this->options_->compress_debug_sections(), "zlib") == 0)
-    success = zlib_compress(uncompressed_data, uncompressed_size,
-                            &this->data_, &compressed_size);
-  if (success)
+  off_t uncompressed_size = this->postprocessing_buffer_size();
+  size_t count = (uncompressed_size + compress_chunk_size - 1)
+		  / compress_chunk_size;
+  if (count == 0)
+    count = 1;
+  this->chunks_.resize(count);
+  ++section_count;
+  chunk_count += count;
+
+  // In the gABI format the original alignment goes in the compression
+  // header, and the section is aligned for the header.  We change the
+  // alignment here, before the section offsets are set.
+  if (strcmp(this->options_->compress_debug_sections(), "zlib") != 0
+      && this->uncompressed_addralign_ == 0)
+    {
+      this->uncompressed_addralign_ = this->addralign();
+      this->set_addralign(parameters->target().get_size() / 8);
+    }
+}
+
+// Compress chunk I.
+
+void
+Output_compressed_section::compress_chunk(unsigned int i)
+{
+  gold_assert(i < this->chunks_.size());
+  Chunk* chunk = &this->chunks_[i];
+
+  off_t uncompressed_size = this->postprocessing_buffer_size();
+  off_t start = static_cast<off_t>(i) * compress_chunk_size;
+  unsigned long len = std::min(uncompressed_size - start,
+			       compress_chunk_size);
+  const unsigned char* data = this->postprocessing_buffer() + start;
+
+  const char* type = this->options_->compress_debug_sections();
+  if (strcmp(type, "zlib") == 0)
+    {
+      bool is_last = i + 1 == this->chunks_.size();
+      if (zlib_compress_chunk(data, len, is_last, &chunk->data, &chunk->size))
+	chunk->checksum = adler32(adler32(0, NULL, 0), data, len);
+    }
+#ifdef HAVE_ZSTD
+  else if (strcmp(type, "zstd") == 0)
+    zstd_compress_chunk(data, len, &chunk->data, &chunk->size);
+#endif
+}
+
+// Queue a task to compress each chunk.
+
+void
+Output_compressed_section::queue_compression_tasks(Workqueue* workqueue,
+						   Task_token* blocker)
+{
+  gold_assert(!this->chunks_compressed_);
+  this->prepare_chunks();
+  for (unsigned int i = 0; i < this->chunks_.size(); ++i)
+    {
+      workqueue->add_blocker(blocker);
+      workqueue->queue(new Compress_chunk_task(this, i, blocker));
+    }
+  task_count += this->chunks_.size();
+  this->chunks_compressed_ = true;
+}
+
+// Print statistics to stderr.
+
+void
+Output_compressed_section::print_stats()
+{
+  if (section_count == 0)
+    return;
+  fprintf(stderr, _("%s: compressed sections: %u; chunks: %u; tasks: %u\n"),
+	  program_name, section_count, chunk_count, task_count);
+}
+
+// Put the compressed chunks together into data_, with the header
+// appropriate to the compression type.  Set *COMPRESSED_SIZE to the
+// size of the result.  Free the chunks.
+
+bool
+Output_compressed_section::assemble_chunks(off_t uncompressed_size,
+					   unsigned long* compressed_size)
+{
+  bool ok = true;
+  unsigned long size = 0;
+  for (std::vector<Chunk>::const_iterator p = this->chunks_.begin();
+       p != this->chunks_.end();
+       ++p)
+    {
+      if (p->data == NULL)
+	ok = false;
+      size += p->size;
+    }
+
+  const char* type = this->options_->compress_debug_sections();
+  bool is_zlib = strcmp(type, "zlib") == 0;
+  unsigned char* pov = NULL;
+  if (ok)
+    {
+      if (is_zlib)
+	{
+	  // A "ZLIB" header giving the uncompressed size, followed by
+	  // one zlib stream: a two byte header, the raw deflate data,
+	  // and the Adler-32 checksum.
+	  const int header_size = 12 + 2;
+	  this->data_ = new unsigned char[header_size + size + 4];
+	  memcpy(this->data_, "ZLIB", 4);
+	  elfcpp::Swap_unaligned<64, true>::writeval(this->data_ + 4,
+						     uncompressed_size);
+	  int level = zlib_compress_level();
+	  unsigned int header = (Z_DEFLATED + ((MAX_WBITS - 8) << 4)) << 8;
+	  header |= (level < 2 ? 0 : level < 6 ? 1 : level == 6 ? 2 : 3) << 6;
+	  header += 31 - header % 31;
+	  elfcpp::Swap_unaligned<16, true>::writeval(this->data_ + 12, header);
+	  pov = this->data_ + header_size;
+	  *compressed_size = header_size + size + 4;
+	}
+      else
+	{
+	  // An ELF compression header, followed by the zstd frames.
+	  int elfsize = parameters->target().get_size();
+	  const int header_size = (elfsize == 32
+				   ? elfcpp::Elf_sizes<32>::chdr_size
+				   : elfcpp::Elf_sizes<64>::chdr_size);
+	  this->data_ = new unsigned char[header_size + size];
+	  if (parameters->target().is_big_endian())
+	    write_compression_header<true>(this->data_, elfsize,
+					   elfcpp::ELFCOMPRESS_ZSTD,
+					   uncompressed_size,
+					   this->uncompressed_addralign_);
+	  else
+	    write_compression_header<false>(this->data_, elfsize,
+					    elfcpp::ELFCOMPRESS_ZSTD,
+					    uncompressed_size,
+					    this->uncompressed_addralign_);
+	  pov = this->data_ + header_size;
+	  *compressed_size = header_size + size;
+	}
+    }
+
+  unsigned long checksum = 0;
+  for (std::vector<Chunk>::iterator p = this->chunks_.begin();
+       p != this->chunks_.end();
+       ++p)
+    {
+      if (ok)
+	{
+	  memcpy(pov, p->data, p->size);
+	  pov += p->size;
+	  if (p == this->chunks_.begin())
+	    checksum = p->checksum;
+	  else
+	    {
+	      off_t start = (p - this->chunks_.begin()) * compress_chunk_size;
+	      off_t len = std::min(uncompressed_size - start,
+				   compress_chunk_size);
+	      checksum = adler32_combine(checksum, p->checksum, len);
+	    }
+	}
+      delete[] p->data;
+    }
+  this->chunks_.clear();
+  this->chunks_compressed_ = false;
+
+  if (ok && is_zlib)
+    elfcpp::Swap_unaligned<32, true>::writeval(pov, checksum);
+
+  return ok;
+}
+
+// Set the final data size of a compressed section.  The section data
+// is normally compressed by the tasks queued by queue_compression_tasks;
+// if not, we compress it here.
+
+void
+Output_compressed_section::set_final_data_size()
+{
+  off_t uncompressed_size = this->postprocessing_buffer_size();
+
+  if (!this->chunks_compressed_)
+    {
+      this->prepare_chunks();
+      for (unsigned int i = 0; i < this->chunks_.size(); ++i)
+	this->compress_chunk(i);
+      this->chunks_compressed_ = true;
+    }
+
+  unsigned long compressed_size;
+  if (this->assemble_chunks(uncompressed_size, &compressed_size))
     {
-      // This converts .debug_foo to .zdebug_foo
-      this->new_section_name_ = std::string(".z") + (this->name() + 1);
-      this->set_name(this->new_section_name_.c_str());
+      if (strcmp(this->options_->compress_debug_sections(), "zlib") == 0)
+	{
+	  // This converts .debug_foo to .zdebug_foo
+	  this->new_section_name_ = std::string(".z") + (this->name() + 1);
+	  this->set_name(this->new_section_name_.c_str());
+	}
+      else
+	{
+	  // The gABI format keeps the name, and instead sets
+	  // SHF_COMPRESSED.
+	  this->add_flags(elfcpp::SHF_COMPRESSED);
+	}
       this->set_data_size(compressed_size);
     }
   else
     {
-      gold_warning(_("not compressing section data: zlib error"));
+      gold_warning(_("not compressing section data: %s error"),
+		   this->options_->compress_debug_sections());
       gold_assert(this->data_ == NULL);
       this->set_data_size(uncompressed_size);
     }
@@ -29,6 +29,7 @@
 #define GOLD_COMPRESSED_OUTPUT_H
 
 #include <string>
+#include <vector>
 
 #include "output.h"
 
@@ -36,6 +37,8 @@ namespace gold
 {
 
 class General_options;
+class Workqueue;
+class Task_token;
 
 // Read the compression header of a compressed debug section and return
 // the uncompressed size.
@@ -60,9 +63,25 @@ class Output_compressed_section : public Output_section
 			    const char* name, elfcpp::Elf_Word flags,
 			    elfcpp::Elf_Xword type)
     : Output_section(name, flags, type),
-      options_(options)
+      options_(options), data_(NULL), chunks_(), chunks_compressed_(false),
+      uncompressed_addralign_(0)
   { this->set_requires_postprocessing(); }
 
+  // Queue a task on WORKQUEUE to compress each chunk of the section.
+  // Each task unblocks BLOCKER when it is done.  This may only be
+  // called once all the input sections have been written.
+  void
+  queue_compression_tasks(Workqueue* workqueue, Task_token* blocker);
+
+  // Compress chunk I of the section.  This is called by the tasks
+  // queued by queue_compression_tasks.
+  void
+  compress_chunk(unsigned int i);
+
+  // Print statistics about compressed sections to stderr.
+  static void
+  print_stats();
+
  protected:
   // Set the final data size.
   void
@@ -73,12 +92,50 @@ class Output_compressed_section : public Output_section
   do_write(Output_file*);
 
  private:
+  // A piece of the section data which is compressed independently of
+  // the others, so that the pieces can be compressed in parallel.
+  struct Chunk
+  {
+    Chunk()
+      : data(NULL), size(0), checksum(0)
+    { }
+
+    // The compressed data, allocated with new[], or NULL if the
+    // compression failed.
+    unsigned char* data;
+    // The size of the compressed data.
+    unsigned long size;
+    // The Adler-32 checksum of the uncompressed data, used for zlib.
+    unsigned long checksum;
+  };
+
+  // Split the section data into chunks.
+  void
+  prepare_chunks();
+
+  // Put the compressed chunks together into data_.  Return false if
+  // any of them failed to compress.
+  bool
+  assemble_chunks(off_t uncompressed_size, unsigned long* compressed_size);
+
   // The options--this includes the compression type.
   const General_options* options_;
   // The compressed data.
   unsigned char* data_;
   // The new section name if we do compress.
   std::string new_section_name_;
+  // The chunks of the section.
+  std::vector<Chunk> chunks_;
+  // Whether the chunks have been compressed.
+  bool chunks_compressed_;
+  // For the gABI format, the alignment of the uncompressed data.
+  uint64_t uncompressed_addralign_;
+
+  // The number of sections and chunks compressed, and the number of
+  // chunks compressed by tasks, for --stats.
+  static unsigned int section_count;
+  static unsigned int chunk_count;
+  static unsigned int task_count;
 };
 
 } // End namespace gold.
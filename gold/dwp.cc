@@ -28,6 +28,7 @@
 #include <cstdlib>
 #include <cstring>
 #include <cerrno>
+#include <unistd.h>
 
 #include <vector>
 #include <algorithm>
@@ -45,6 +46,7 @@
 #include "compressed_output.h"
 #include "stringpool.h"
 #include "dwarf_reader.h"
+#include "workqueue.h"
 
 static void
 usage(FILE* fd, int) ATTRIBUTE_NORETURN;
@@ -108,9 +110,14 @@ class Dwo_file
 {
  public:
   Dwo_file(const char* name)
-    : name_(name), obj_(NULL), input_file_(NULL), is_compressed_(),
-      sect_offsets_(), str_offset_map_()
-  { }
+    : name_(name), obj_(NULL), input_file_(NULL), machine_(0), size_(0),
+      big_endian_(false), osabi_(0), abiversion_(0), is_compressed_(),
+      sect_offsets_(), debug_types_(), debug_str_(0), debug_cu_index_(0),
+      debug_tu_index_(0), loaded_(), strings_(), str_offset_map_()
+  {
+    for (unsigned int i = 0; i <= elfcpp::DW_SECT_MAX; i++)
+      this->debug_shndx_[i] = 0;
+  }
 
   ~Dwo_file();
 
@@ -119,7 +126,15 @@ class Dwo_file
   void
   read_executable(File_list* files);
 
+  // Open the input file, find its debug sections, and load the
+  // contents of the sections that will be copied to the output file.
+  // This does not touch the output file, so several input files may
+  // be prepared in parallel.
+  void
+  prepare();
+
   // Read the input file and send its contents to OUTPUT_FILE.
+  // This calls prepare if it has not already been called.
   void
   read(Dwp_output_file* output_file);
 
@@ -144,16 +159,57 @@ class Dwo_file
     { return i1.first < i2.first; }
   };
 
+  // The contents of a section loaded by prepare.  The memory is
+  // allocated via new and is owned by this object until it is
+  // taken by copy_section.
+  struct Loaded_section
+  {
+    unsigned char* contents;
+    section_size_type len;
+
+    Loaded_section()
+      : contents(NULL), len(0)
+    { }
+  };
+
+  // A string from the input .debug_str.dwo section, with its
+  // Stringpool hash code.
+  struct Input_string
+  {
+    const char* str;
+    size_t len;
+    size_t hash_code;
+  };
+
+  typedef std::vector<unsigned int> Types_list;
+
   // Create a Sized_relobj_dwo of the given size and endianness,
   // and record the target info.  P is a pointer to the ELF header
   // in memory.
   Relobj*
-  make_object(Dwp_output_file* output_file);
+  make_object();
 
   template <int size, bool big_endian>
   Relobj*
-  sized_make_object(const unsigned char* p, Input_file* input_file,
-		    Dwp_output_file* output_file);
+  sized_make_object(const unsigned char* p, Input_file* input_file);
+
+  // Scan the section table and record the debug sections.
+  void
+  find_debug_sections();
+
+  // Load the contents of section SHNDX into memory owned by this object.
+  void
+  load_section(unsigned int shndx);
+
+  // Return the contents of section SHNDX in memory that the caller
+  // must free with delete[].  Set *PLEN to the size.
+  unsigned char*
+  take_section_contents(unsigned int shndx, section_size_type* plen);
+
+  // Split the loaded .debug_str.dwo section into strings and compute
+  // their hash codes.
+  void
+  split_strings();
 
   // Return the number of sections in the input object file.
   unsigned int
@@ -200,20 +256,21 @@ class Dwo_file
 
   // Merge the input string table section into the output file.
   void
-  add_strings(Dwp_output_file*, unsigned int);
+  add_strings(Dwp_output_file*);
 
   // Copy a section from the input file to the output file.
   Section_bounds
   copy_section(Dwp_output_file* output_file, unsigned int shndx,
 	       elfcpp::DW_SECT section_id);
 
-  // Remap the string offsets in the .debug_str_offsets.dwo section.
-  const unsigned char*
-  remap_str_offsets(const unsigned char* contents, section_size_type len);
+  // Remap the string offsets in the .debug_str_offsets.dwo section
+  // in place.
+  void
+  remap_str_offsets(unsigned char* contents, section_size_type len);
 
   template <bool big_endian>
-  const unsigned char*
-  sized_remap_str_offsets(const unsigned char* contents, section_size_type len);
+  void
+  sized_remap_str_offsets(unsigned char* contents, section_size_type len);
 
   // Remap a single string offsets from an offset in the input string table
   // to an offset in the output string table.
@@ -232,10 +289,29 @@ class Dwo_file
   Relobj* obj_;
   // The Input_file object.
   Input_file* input_file_;
+  // ELF header parameters, recorded by make_object.
+  int machine_;
+  int size_;
+  bool big_endian_;
+  int osabi_;
+  int abiversion_;
   // Flags indicating which sections are compressed.
   std::vector<bool> is_compressed_;
   // Map input section index onto output section offset and size.
   std::vector<Section_bounds> sect_offsets_;
+  // Section indexes of the debug sections, indexed by DW_SECT.
+  unsigned int debug_shndx_[elfcpp::DW_SECT_MAX + 1];
+  // Section indexes of the .debug_types.dwo sections.
+  Types_list debug_types_;
+  // Section indexes of the .debug_str.dwo, .debug_cu_index, and
+  // .debug_tu_index sections.
+  unsigned int debug_str_;
+  unsigned int debug_cu_index_;
+  unsigned int debug_tu_index_;
+  // Section contents loaded by prepare, indexed by section index.
+  std::vector<Loaded_section> loaded_;
+  // The strings in the .debug_str.dwo section.
+  std::vector<Input_string> strings_;
   // Map input string offsets to output string offsets.
   Str_offset_map str_offset_map_;
 };
@@ -463,9 +539,10 @@ class Dwp_output_file
   record_target_info(const char* name, int machine, int size, bool big_endian,
 		     int osabi, int abiversion);
 
-  // Add a string to the debug strings section.
+  // Add a string to the debug strings section.  HASH_CODE is the
+  // Stringpool hash code for the string.
   section_offset_type
-  add_string(const char* str, size_t len);
+  add_string(const char* str, size_t len, size_t hash_code);
 
   // Add a section to the output file, and return the new section offset.
   section_offset_type
@@ -490,25 +567,20 @@ class Dwp_output_file
   finalize();
 
  private:
-  // Contributions to output sections.
-  struct Contribution
-  {
-    section_offset_type output_offset;
-    section_size_type size;
-    const unsigned char* contents;
-  };
-
-  // Sections in the output file.
+  // Sections in the output file.  Until the final layout is known,
+  // contributions to a section other than .debug_info.dwo are written
+  // to a temporary spill file, so that we do not have to hold them
+  // in memory.
   struct Section
   {
     const char* name;
     off_t offset;
     section_size_type size;
     int align;
-    std::vector<Contribution> contributions;
+    FILE* spill;
 
     Section(const char* n, int a)
-      : name(n), offset(0), size(0), align(a), contributions()
+      : name(n), offset(0), size(0), align(a), spill(NULL)
     { }
   };
 
@@ -632,9 +704,9 @@ class Dwp_output_file
 		   unsigned int link, unsigned int info,
 		   unsigned int align, unsigned int ent_size);
 
-  // Write the contributions to an output section.
+  // Copy the contributions to an output section from its spill file.
   void
-  write_contributions(const Section& sect);
+  write_contributions(Section& sect);
 
   // Write a CU or TU index section.
   template<bool big_endian>
@@ -744,6 +816,137 @@ class Unit_reader : public Dwarf_info_reader
   Section_bounds* sections_;
 };
 
+// This class queues the tasks that process the input files.  Each
+// input file is opened and its sections are loaded by a Dwo_read_task,
+// and these run in parallel.  The contents are then added to the
+// output file by a Dwo_add_task; these run one at a time, in the order
+// of the input files, so that the output does not depend on the number
+// of threads.  To bound the memory used, only WINDOW input files are
+// read ahead of the one being added to the output file.
+
+class Dwo_task_queue
+{
+ public:
+  Dwo_task_queue(const File_list& files, Dwp_output_file* output_file,
+		 bool verbose)
+    : files_(files), output_file_(output_file), verbose_(verbose),
+      next_file_(0), next_blocker_(NULL)
+  { }
+
+  ~Dwo_task_queue()
+  {
+    if (this->next_blocker_ != NULL)
+      delete this->next_blocker_;
+  }
+
+  // Queue the tasks to read the first WINDOW input files.
+  void
+  queue_initial_tasks(Workqueue*, unsigned int window);
+
+  // Queue the task to read the next input file, if there is one.
+  // This is called when the previous file has been added to the
+  // output file.
+  void
+  queue_next_read(Workqueue*);
+
+  // The output file.
+  Dwp_output_file*
+  output_file() const
+  { return this->output_file_; }
+
+  // Whether to print the name of each input file.
+  bool
+  verbose() const
+  { return this->verbose_; }
+
+ private:
+  // The list of input files.
+  const File_list& files_;
+  // The output file.
+  Dwp_output_file* output_file_;
+  // Whether to print the name of each input file.
+  bool verbose_;
+  // The index in FILES_ of the next file to read.
+  size_t next_file_;
+  // The blocker released when the last file queued so far has been
+  // added to the output file.
+  Task_token* next_blocker_;
+};
+
+// A task to open an input file and load its sections.
+
+class Dwo_read_task : public Task
+{
+ public:
+  Dwo_read_task(Dwo_task_queue* queue, const char* name,
+		Task_token* this_blocker, Task_token* next_blocker)
+    : queue_(queue), name_(name), this_blocker_(this_blocker),
+      next_blocker_(next_blocker)
+  { }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  void
+  locks(Task_locker*)
+  { }
+
+  void
+  run(Workqueue*);
+
+  std::string
+  get_name() const
+  { return std::string("Dwo_read_task ") + this->name_; }
+
+ private:
+  Dwo_task_queue* queue_;
+  const char* name_;
+  Task_token* this_blocker_;
+  Task_token* next_blocker_;
+};
+
+// A task to add the contents of an input file to the output file.
+
+class Dwo_add_task : public Task
+{
+ public:
+  // THIS_BLOCKER is used to prevent this task from running before the
+  // one for the previous input file.  NEXT_BLOCKER is used to prevent
+  // the next task from running.
+  Dwo_add_task(Dwo_task_queue* queue, Dwo_file* dwo_file, const char* name,
+	       Task_token* this_blocker, Task_token* next_blocker)
+    : queue_(queue), dwo_file_(dwo_file), name_(name),
+      this_blocker_(this_blocker), next_blocker_(next_blocker)
+  { }
+
+  ~Dwo_add_task();
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable();
+
+  void
+  locks(Task_locker*);
+
+  void
+  run(Workqueue*);
+
+  std::string
+  get_name() const
+  { return std::string("Dwo_add_task ") + this->name_; }
+
+ private:
+  Dwo_task_queue* queue_;
+  Dwo_file* dwo_file_;
+  const char* name_;
+  Task_token* this_blocker_;
+  Task_token* next_blocker_;
+};
+
 // Return the name of a DWARF .dwo section.
 
 static const char*
@@ -828,6 +1031,8 @@ Sized_relobj_dwo<size, big_endian>::do_section_contents(
 
 Dwo_file::~Dwo_file()
 {
+  for (unsigned int i = 0; i < this->loaded_.size(); ++i)
+    delete[] this->loaded_[i].contents;
   if (this->obj_ != NULL)
     delete this->obj_;
   if (this->input_file_ != NULL)
@@ -840,7 +1045,7 @@ Dwo_file::~Dwo_file()
 void
 Dwo_file::read_executable(File_list* files)
 {
-  this->obj_ = this->make_object(NULL);
+  this->obj_ = this->make_object();
 
   unsigned int shnum = this->shnum();
   this->is_compressed_.resize(shnum);
@@ -880,27 +1085,40 @@ Dwo_file::read_executable(File_list* files)
     }
 }
 
-// Read the input file and send its contents to OUTPUT_FILE.
+// Open the input file, find its debug sections, and load the contents
+// of the sections that will be copied to the output file.  The string
+// table is split into strings and hashed here, so that the serial part
+// of the work in read is mostly hash table lookups and file writes.
 
 void
-Dwo_file::read(Dwp_output_file* output_file)
+Dwo_file::prepare()
 {
-  this->obj_ = this->make_object(output_file);
+  this->obj_ = this->make_object();
+  this->find_debug_sections();
 
+  for (int i = elfcpp::DW_SECT_ABBREV; i <= elfcpp::DW_SECT_MAX; ++i)
+    {
+      if (this->debug_shndx_[i] > 0)
+	this->load_section(this->debug_shndx_[i]);
+    }
+
+  if (this->debug_str_ > 0)
+    {
+      this->load_section(this->debug_str_);
+      this->split_strings();
+    }
+}
+
+// Scan the section table and record the debug sections.
+
+void
+Dwo_file::find_debug_sections()
+{
   unsigned int shnum = this->shnum();
   this->is_compressed_.resize(shnum);
   this->sect_offsets_.resize(shnum);
+  this->loaded_.resize(shnum);
 
-  typedef std::vector<unsigned int> Types_list;
-  Types_list debug_types;
-  unsigned int debug_shndx[elfcpp::DW_SECT_MAX + 1];
-  for (unsigned int i = 0; i <= elfcpp::DW_SECT_MAX; i++)
-    debug_shndx[i] = 0;
-  unsigned int debug_str = 0;
-  unsigned int debug_cu_index = 0;
-  unsigned int debug_tu_index = 0;
-
-  // Scan the section table and collect debug sections.
   // (Section index 0 is a dummy section; skip it.)
   for (unsigned int i = 1; i < shnum; i++)
     {
@@ -918,39 +1136,127 @@ Dwo_file::read(Dwp_output_file* output_file)
       else
 	continue;
       if (strcmp(suffix, "info.dwo") == 0)
-	debug_shndx[elfcpp::DW_SECT_INFO] = i;
+	this->debug_shndx_[elfcpp::DW_SECT_INFO] = i;
       else if (strcmp(suffix, "types.dwo") == 0)
-	debug_types.push_back(i);
+	this->debug_types_.push_back(i);
       else if (strcmp(suffix, "abbrev.dwo") == 0)
-	debug_shndx[elfcpp::DW_SECT_ABBREV] = i;
+	this->debug_shndx_[elfcpp::DW_SECT_ABBREV] = i;
       else if (strcmp(suffix, "line.dwo") == 0)
-	debug_shndx[elfcpp::DW_SECT_LINE] = i;
+	this->debug_shndx_[elfcpp::DW_SECT_LINE] = i;
       else if (strcmp(suffix, "loc.dwo") == 0)
-	debug_shndx[elfcpp::DW_SECT_LOC] = i;
+	this->debug_shndx_[elfcpp::DW_SECT_LOC] = i;
       else if (strcmp(suffix, "str.dwo") == 0)
-	debug_str = i;
+	this->debug_str_ = i;
       else if (strcmp(suffix, "str_offsets.dwo") == 0)
-	debug_shndx[elfcpp::DW_SECT_STR_OFFSETS] = i;
+	this->debug_shndx_[elfcpp::DW_SECT_STR_OFFSETS] = i;
       else if (strcmp(suffix, "macinfo.dwo") == 0)
-	debug_shndx[elfcpp::DW_SECT_MACINFO] = i;
+	this->debug_shndx_[elfcpp::DW_SECT_MACINFO] = i;
       else if (strcmp(suffix, "macro.dwo") == 0)
-	debug_shndx[elfcpp::DW_SECT_MACRO] = i;
+	this->debug_shndx_[elfcpp::DW_SECT_MACRO] = i;
       else if (strcmp(suffix, "cu_index") == 0)
-	debug_cu_index = i;
+	this->debug_cu_index_ = i;
       else if (strcmp(suffix, "tu_index") == 0)
-	debug_tu_index = i;
+	this->debug_tu_index_ = i;
+    }
+}
+
+// Load the contents of section SHNDX, decompressing if necessary,
+// into memory owned by this object.  We copy sections that are
+// mapped from the input file, so the input file is read here
+// rather than when the section is written to the output file.
+
+void
+Dwo_file::load_section(unsigned int shndx)
+{
+  Loaded_section& loaded(this->loaded_[shndx]);
+  if (loaded.contents != NULL)
+    return;
+
+  section_size_type len;
+  bool is_new;
+  const unsigned char* contents = this->section_contents(shndx, &len, &is_new);
+  if (is_new)
+    loaded.contents = const_cast<unsigned char*>(contents);
+  else
+    {
+      loaded.contents = new unsigned char[len];
+      memcpy(loaded.contents, contents, len);
+    }
+  loaded.len = len;
+}
+
+// Return the contents of section SHNDX in memory that the caller must
+// free with delete[].  This hands over the contents loaded by prepare,
+// or loads them now.
+
+unsigned char*
+Dwo_file::take_section_contents(unsigned int shndx, section_size_type* plen)
+{
+  this->load_section(shndx);
+  Loaded_section& loaded(this->loaded_[shndx]);
+  unsigned char* contents = loaded.contents;
+  *plen = loaded.len;
+  loaded.contents = NULL;
+  loaded.len = 0;
+  return contents;
+}
+
+// Split the loaded .debug_str.dwo section into strings, and compute
+// the hash code that the output Stringpool will use for each one.
+
+void
+Dwo_file::split_strings()
+{
+  const Loaded_section& loaded(this->loaded_[this->debug_str_]);
+  const char* p = reinterpret_cast<const char*>(loaded.contents);
+  const char* pend = p + loaded.len;
+
+  // Check that the last string is null terminated.
+  if (loaded.len == 0 || pend[-1] != '\0')
+    gold_fatal(_("%s: last entry in string section '%s' "
+		 "is not null terminated"),
+	       this->name_,
+	       this->section_name(this->debug_str_).c_str());
+
+  while (p < pend)
+    {
+      Input_string is;
+      is.str = p;
+      is.len = strlen(p);
+      is.hash_code = Stringpool::string_hash(p, is.len);
+      this->strings_.push_back(is);
+      p += is.len + 1;
     }
+}
+
+// Read the input file and send its contents to OUTPUT_FILE.
+
+void
+Dwo_file::read(Dwp_output_file* output_file)
+{
+  if (this->obj_ == NULL)
+    this->prepare();
+
+  output_file->record_target_info(this->name_, this->machine_, this->size_,
+				  this->big_endian_, this->osabi_,
+				  this->abiversion_);
+
+  unsigned int debug_shndx[elfcpp::DW_SECT_MAX + 1];
+  for (unsigned int i = 0; i <= elfcpp::DW_SECT_MAX; i++)
+    debug_shndx[i] = this->debug_shndx_[i];
+  const Types_list& debug_types(this->debug_types_);
 
   // Merge the input string table into the output string table.
-  this->add_strings(output_file, debug_str);
+  this->add_strings(output_file);
 
   // If we found any .dwp index sections, read those and add the section
   // sets to the output file.
-  if (debug_cu_index > 0 || debug_tu_index > 0)
+  if (this->debug_cu_index_ > 0 || this->debug_tu_index_ > 0)
     {
-      if (debug_cu_index > 0)
-	this->read_unit_index(debug_cu_index, debug_shndx, output_file, false);
-      if (debug_tu_index > 0)
+      if (this->debug_cu_index_ > 0)
+	this->read_unit_index(this->debug_cu_index_, debug_shndx, output_file,
+			      false);
+      if (this->debug_tu_index_ > 0)
         {
 	  if (debug_types.size() > 1)
 	    gold_fatal(_("%s: .dwp file must have no more than one "
@@ -959,7 +1265,8 @@ Dwo_file::read(Dwp_output_file* output_file)
             debug_shndx[elfcpp::DW_SECT_TYPES] = debug_types[0];
           else
             debug_shndx[elfcpp::DW_SECT_TYPES] = 0;
-	  this->read_unit_index(debug_tu_index, debug_shndx, output_file, true);
+	  this->read_unit_index(this->debug_tu_index_, debug_shndx, output_file,
+				true);
 	}
       return;
     }
@@ -985,7 +1292,7 @@ Dwo_file::read(Dwp_output_file* output_file)
 bool
 Dwo_file::verify(const File_list& files)
 {
-  this->obj_ = this->make_object(NULL);
+  this->obj_ = this->make_object();
 
   unsigned int shnum = this->shnum();
   this->is_compressed_.resize(shnum);
@@ -1024,7 +1331,7 @@ Dwo_file::verify(const File_list& files)
 // and record the target info.
 
 Relobj*
-Dwo_file::make_object(Dwp_output_file* output_file)
+Dwo_file::make_object()
 {
   // Open the input file.
   Input_file* input_file = new Input_file(this->name_);
@@ -1058,15 +1365,13 @@ Dwo_file::make_object(Dwp_output_file* output_file)
     {
       if (big_endian)
 #ifdef HAVE_TARGET_32_BIG
-	return this->sized_make_object<32, true>(elf_header, input_file,
-						 output_file);
+	return this->sized_make_object<32, true>(elf_header, input_file);
 #else
 	gold_unreachable();
 #endif
       else
 #ifdef HAVE_TARGET_32_LITTLE
-	return this->sized_make_object<32, false>(elf_header, input_file,
-						  output_file);
+	return this->sized_make_object<32, false>(elf_header, input_file);
 #else
 	gold_unreachable();
 #endif
@@ -1075,15 +1380,13 @@ Dwo_file::make_object(Dwp_output_file* output_file)
     {
       if (big_endian)
 #ifdef HAVE_TARGET_64_BIG
-	return this->sized_make_object<64, true>(elf_header, input_file,
-						 output_file);
+	return this->sized_make_object<64, true>(elf_header, input_file);
 #else
 	gold_unreachable();
 #endif
       else
 #ifdef HAVE_TARGET_64_LITTLE
-	return this->sized_make_object<64, false>(elf_header, input_file,
-						  output_file);
+	return this->sized_make_object<64, false>(elf_header, input_file);
 #else
 	gold_unreachable();
 #endif
@@ -1093,22 +1396,22 @@ Dwo_file::make_object(Dwp_output_file* output_file)
 }
 
 // Function template to create a Sized_relobj_dwo and record the target info.
-// P is a pointer to the ELF header in memory.
+// P is a pointer to the ELF header in memory.  The target info is passed
+// on to the output file by read.
 
 template <int size, bool big_endian>
 Relobj*
-Dwo_file::sized_make_object(const unsigned char* p, Input_file* input_file,
-			    Dwp_output_file* output_file)
+Dwo_file::sized_make_object(const unsigned char* p, Input_file* input_file)
 {
   elfcpp::Ehdr<size, big_endian> ehdr(p);
   Sized_relobj_dwo<size, big_endian>* obj =
       new Sized_relobj_dwo<size, big_endian>(this->name_, input_file, ehdr);
   obj->setup();
-  if (output_file != NULL)
-    output_file->record_target_info(
-	this->name_, ehdr.get_e_machine(), size, big_endian,
-	ehdr.get_e_ident()[elfcpp::EI_OSABI],
-	ehdr.get_e_ident()[elfcpp::EI_ABIVERSION]);
+  this->machine_ = ehdr.get_e_machine();
+  this->size_ = size;
+  this->big_endian_ = big_endian;
+  this->osabi_ = ehdr.get_e_ident()[elfcpp::EI_OSABI];
+  this->abiversion_ = ehdr.get_e_ident()[elfcpp::EI_ABIVERSION];
   return obj;
 }
 
@@ -1361,45 +1664,37 @@ Dwo_file::sized_verify_dwo_list(unsigned int shndx, const File_list& files)
 }
 
 // Merge the input string table section into the output file.
+// The strings were split and hashed by prepare.
 
 void
-Dwo_file::add_strings(Dwp_output_file* output_file, unsigned int debug_str)
+Dwo_file::add_strings(Dwp_output_file* output_file)
 {
-  section_size_type len;
-  bool is_new;
-  const unsigned char* pdata = this->section_contents(debug_str, &len, &is_new);
-  const char* p = reinterpret_cast<const char*>(pdata);
-  const char* pend = p + len;
-
-  // Check that the last string is null terminated.
-  if (pend[-1] != '\0')
-    gold_fatal(_("%s: last entry in string section '%s' "
-		 "is not null terminated"),
-	       this->name_,
-	       this->section_name(debug_str).c_str());
-
-  // Count the number of strings in the section, and size the map.
-  size_t count = 0;
-  for (const char* pt = p; pt < pend; pt += strlen(pt) + 1)
-    ++count;
-  this->str_offset_map_.reserve(count + 1);
+  this->str_offset_map_.reserve(this->strings_.size() + 1);
 
   // Add the strings to the output string table, and record the new offsets
   // in the map.
   section_offset_type i = 0;
   section_offset_type new_offset;
-  while (p < pend)
+  for (std::vector<Input_string>::const_iterator p = this->strings_.begin();
+       p != this->strings_.end();
+       ++p)
     {
-      size_t len = strlen(p);
-      new_offset = output_file->add_string(p, len);
+      new_offset = output_file->add_string(p->str, p->len, p->hash_code);
       this->str_offset_map_.push_back(std::make_pair(i, new_offset));
-      p += len + 1;
-      i += len + 1;
+      i += p->len + 1;
     }
   new_offset = 0;
   this->str_offset_map_.push_back(std::make_pair(i, new_offset));
-  if (is_new)
-    delete[] pdata;
+
+  // We no longer need the string section contents.
+  this->strings_.clear();
+  if (this->debug_str_ > 0)
+    {
+      Loaded_section& loaded(this->loaded_[this->debug_str_]);
+      delete[] loaded.contents;
+      loaded.contents = NULL;
+      loaded.len = 0;
+    }
 }
 
 // Copy a section from the input file to the output file.
@@ -1416,27 +1711,13 @@ Dwo_file::copy_section(Dwp_output_file* output_file, unsigned int shndx,
   if (this->sect_offsets_[shndx].size > 0)
     return this->sect_offsets_[shndx];
 
-  // Get the section contents. Upon return, if IS_NEW is true, the memory
-  // has been allocated via new; if false, the memory is part of the mapped
-  // input file, and we will need to duplicate it so that it will persist
-  // after we close the input file.
+  // Get the section contents, normally loaded already by prepare.
+  // The memory has been allocated via new.
   section_size_type len;
-  bool is_new;
-  const unsigned char* contents = this->section_contents(shndx, &len, &is_new);
+  unsigned char* contents = this->take_section_contents(shndx, &len);
 
   if (section_id == elfcpp::DW_SECT_STR_OFFSETS)
-    {
-      const unsigned char* remapped = this->remap_str_offsets(contents, len);
-      if (is_new)
-	delete[] contents;
-      contents = remapped;
-    }
-  else if (!is_new)
-    {
-      unsigned char* copy = new unsigned char[len];
-      memcpy(copy, contents, len);
-      contents = copy;
-    }
+    this->remap_str_offsets(contents, len);
 
   // Add the contents of the input section to the output section.
   // The output file takes ownership of the memory pointed to by CONTENTS.
@@ -1450,39 +1731,36 @@ Dwo_file::copy_section(Dwp_output_file* output_file, unsigned int shndx,
   return bounds;
 }
 
-// Remap the 
-const unsigned char*
-Dwo_file::remap_str_offsets(const unsigned char* contents,
-			    section_size_type len)
+// Remap the string offsets in the .debug_str_offsets.dwo section
+// in place.
+
+void
+Dwo_file::remap_str_offsets(unsigned char* contents, section_size_type len)
 {
   if ((len & 3) != 0)
     gold_fatal(_("%s: .debug_str_offsets.dwo section size not a multiple of 4"),
 	       this->name_);
 
   if (this->obj_->is_big_endian())
-    return this->sized_remap_str_offsets<true>(contents, len);
+    this->sized_remap_str_offsets<true>(contents, len);
   else
-    return this->sized_remap_str_offsets<false>(contents, len);
+    this->sized_remap_str_offsets<false>(contents, len);
 }
 
 template <bool big_endian>
-const unsigned char*
-Dwo_file::sized_remap_str_offsets(const unsigned char* contents,
+void
+Dwo_file::sized_remap_str_offsets(unsigned char* contents,
 				  section_size_type len)
 {
-  unsigned char* remapped = new unsigned char[len];
-  const unsigned char* p = contents;
-  unsigned char* q = remapped;
+  unsigned char* p = contents;
   while (len > 0)
     {
       unsigned int val = elfcpp::Swap_unaligned<32, big_endian>::readval(p);
       val = this->remap_str_offset(val);
-      elfcpp::Swap_unaligned<32, big_endian>::writeval(q, val);
+      elfcpp::Swap_unaligned<32, big_endian>::writeval(p, val);
       len -= 4;
       p += 4;
-      q += 4;
     }
-  return remapped;
 }
 
 unsigned int
@@ -1582,10 +1860,10 @@ Dwp_output_file::record_target_info(const char*, int machine,
 // Add a string to the debug strings section.
 
 section_offset_type
-Dwp_output_file::add_string(const char* str, size_t len)
+Dwp_output_file::add_string(const char* str, size_t len, size_t hash_code)
 {
   Stringpool::Key key;
-  this->stringpool_.add_with_length(str, len, true, &key);
+  this->stringpool_.add_with_hash(str, len, hash_code, true, &key);
   this->have_strings_ = true;
   // We aren't supposed to call get_offset() until after
   // calling set_string_offsets(), but the offsets will
@@ -1614,9 +1892,11 @@ Dwp_output_file::add_output_section(const char* section_name, int align)
 // Add a contribution to a section in the output file, and return the offset
 // of the contribution within the output section.  The .debug_info.dwo section
 // is expected to be the largest one, so we will write the contents of this
-// section directly to the output file as we receive contributions, allowing
-// us to free that memory as soon as possible. We will save the remaining
-// contributions until we finalize the layout of the output file.
+// section directly to the output file as we receive contributions.  The
+// remaining contributions are written to a spill file for each section,
+// and copied to the output file when we finalize the layout.  In both
+// cases we free the memory (except for .debug_info.dwo, which the caller
+// owns) as soon as the contribution has been written.
 
 section_offset_type
 Dwp_output_file::add_contribution(elfcpp::DW_SECT section_id,
@@ -1676,13 +1956,24 @@ Dwp_output_file::add_contribution(elfcpp::DW_SECT section_id,
     }
   else
     {
-      // Collect the contributions and keep track of the total size.
+      // Spill the contribution and keep track of the total size.
+      if (section.spill == NULL)
+	{
+	  section.spill = ::tmpfile();
+	  if (section.spill == NULL)
+	    gold_fatal(_("%s: cannot create temporary file for section '%s': "
+			 "%s"),
+		       this->name_, section_name, strerror(errno));
+	}
       if (align > section.align)
 	section.align = align;
       section_offset = align_offset(section.size, align);
       section.size = section_offset + len;
-      Contribution contrib = { section_offset, len, contents };
-      section.contributions.push_back(contrib);
+      ::fseek(section.spill, section_offset, SEEK_SET);
+      if (::fwrite(contents, 1, len, section.spill) < len)
+	gold_fatal(_("%s: error writing temporary file for section '%s'"),
+		   this->name_, section_name);
+      delete[] contents;
     }
 
   return section_offset;
@@ -1927,19 +2218,33 @@ Dwp_output_file::finalize()
   this->fd_ = NULL;
 }
 
-// Write the contributions to an output section.
+// Copy the contributions to an output section from its spill file,
+// and close the spill file.
 
 void
-Dwp_output_file::write_contributions(const Section& sect)
+Dwp_output_file::write_contributions(Section& sect)
 {
-  for (unsigned int i = 0; i < sect.contributions.size(); ++i)
+  if (sect.spill == NULL)
+    return;
+
+  const size_t bufsize = 1024 * 1024;
+  unsigned char* buf = new unsigned char[bufsize];
+  ::rewind(sect.spill);
+  ::fseek(this->fd_, sect.offset, SEEK_SET);
+  section_size_type remaining = sect.size;
+  while (remaining > 0)
     {
-      const Contribution& c = sect.contributions[i];
-      ::fseek(this->fd_, sect.offset + c.output_offset, SEEK_SET);
-      if (::fwrite(c.contents, 1, c.size, this->fd_) < c.size)
+      size_t n = std::min(static_cast<size_t>(remaining), bufsize);
+      if (::fread(buf, 1, n, sect.spill) < n)
+	gold_fatal(_("%s: error reading temporary file for section '%s'"),
+		   this->name_, sect.name);
+      if (::fwrite(buf, 1, n, this->fd_) < n)
 	gold_fatal(_("%s: error writing section '%s'"), this->name_, sect.name);
-      delete[] c.contents;
+      remaining -= n;
     }
+  delete[] buf;
+  ::fclose(sect.spill);
+  sect.spill = NULL;
 }
 
 // Write a new section to the output file.
@@ -2284,6 +2589,93 @@ Unit_reader::visit_type_unit(off_t, off_t tu_length, off_t,
   this->output_file_->add_tu_set(unit_set);
 }
 
+// Class Dwo_task_queue.
+
+// Queue the tasks to read the first WINDOW input files.
+
+void
+Dwo_task_queue::queue_initial_tasks(Workqueue* workqueue, unsigned int window)
+{
+  for (unsigned int i = 0; i < window; ++i)
+    this->queue_next_read(workqueue);
+}
+
+// Queue the task to read the next input file.  This is only called
+// before the workqueue starts running and from Dwo_add_task, which
+// runs one at a time, so it needs no lock.
+
+void
+Dwo_task_queue::queue_next_read(Workqueue* workqueue)
+{
+  if (this->next_file_ >= this->files_.size())
+    return;
+
+  const char* name = this->files_[this->next_file_].dwo_name.c_str();
+  ++this->next_file_;
+
+  Task_token* this_blocker = this->next_blocker_;
+  Task_token* next_blocker = new Task_token(true);
+  next_blocker->add_blocker();
+  this->next_blocker_ = next_blocker;
+
+  workqueue->queue(new Dwo_read_task(this, name, this_blocker, next_blocker));
+}
+
+// Class Dwo_read_task.
+
+// Open the input file and load its sections, then queue the task to
+// add it to the output file.
+
+void
+Dwo_read_task::run(Workqueue* workqueue)
+{
+  Dwo_file* dwo_file = new Dwo_file(this->name_);
+  dwo_file->prepare();
+  workqueue->queue_soon(new Dwo_add_task(this->queue_, dwo_file, this->name_,
+					 this->this_blocker_,
+					 this->next_blocker_));
+}
+
+// Class Dwo_add_task.
+
+Dwo_add_task::~Dwo_add_task()
+{
+  if (this->this_blocker_ != NULL)
+    delete this->this_blocker_;
+  // next_blocker_ is deleted by the task associated with the next
+  // input file.
+}
+
+// We are blocked by this_blocker_.  We block next_blocker_.
+
+Task_token*
+Dwo_add_task::is_runnable()
+{
+  if (this->this_blocker_ != NULL && this->this_blocker_->is_blocked())
+    return this->this_blocker_;
+  return NULL;
+}
+
+void
+Dwo_add_task::locks(Task_locker* tl)
+{
+  tl->add(this, this->next_blocker_);
+}
+
+// Add the contents of the input file to the output file, and start
+// reading the next one.
+
+void
+Dwo_add_task::run(Workqueue* workqueue)
+{
+  if (this->queue_->verbose())
+    fprintf(stderr, "%s\n", this->name_);
+  this->dwo_file_->read(this->queue_->output_file());
+  delete this->dwo_file_;
+  this->dwo_file_ = NULL;
+  this->queue_->queue_next_read(workqueue);
+}
+
 }; // End namespace gold
 
 using namespace gold;
@@ -2292,6 +2684,8 @@ using namespace gold;
 
 enum Dwp_options {
   VERIFY_ONLY = 0x101,
+  THREADS,
+  THREAD_COUNT,
 };
 
 struct option dwp_options[] =
@@ -2299,6 +2693,8 @@ struct option dwp_options[] =
     { "exec", required_argument, NULL, 'e' },
     { "help", no_argument, NULL, 'h' },
     { "output", required_argument, NULL, 'o' },
+    { "threads", no_argument, NULL, THREADS },
+    { "thread-count", required_argument, NULL, THREAD_COUNT },
     { "verbose", no_argument, NULL, 'v' },
     { "verify-only", no_argument, NULL, VERIFY_ONLY },
     { "version", no_argument, NULL, 'V' },
@@ -2315,6 +2711,8 @@ usage(FILE* fd, int exit_status)
   fprintf(fd, _("  -e EXE, --exec EXE       Get list of dwo files from EXE"
 					   " (defaults output to EXE.dwp)\n"));
   fprintf(fd, _("  -o FILE, --output FILE   Set output dwp file name\n"));
+  fprintf(fd, _("  --threads                Read input files in parallel\n"));
+  fprintf(fd, _("  --thread-count COUNT     Number of threads to use\n"));
   fprintf(fd, _("  -v, --verbose            Verbose output\n"));
   fprintf(fd, _("  --verify-only            Verify output file against"
 					   " exec file\n"));
@@ -2342,6 +2740,17 @@ This program has absolutely no warranty.\n"));
   exit(EXIT_SUCCESS);
 }
 
+// Set a gold option by parsing OPTION as if it were on the linker
+// command line.
+
+static void
+set_gold_option(Command_line* command_line, const char* option)
+{
+  const char* argv[2] = { program_name, option };
+  bool no_more_options;
+  command_line->process_one_option(2, argv, 1, &no_more_options);
+}
+
 // Main program.
 
 int
@@ -2363,10 +2772,11 @@ main(int argc, char** argv)
   Errors errors(program_name);
   set_parameters_errors(&errors);
 
-  // Initialize gold's global options.  We don't use these in
-  // this program, but they need to be initialized so that
+  // Initialize gold's global options.  We only use the threading
+  // options in this program, but they need to be initialized so that
   // functions we call from libgold work properly.
-  General_options options;
+  Command_line command_line;
+  const General_options& options(command_line.options());
   set_parameters_options(&options);
 
   // In libiberty; expands @filename to the args in "filename".
@@ -2378,6 +2788,7 @@ main(int argc, char** argv)
   const char* exe_filename = NULL;
   bool verbose = false;
   bool verify_only = false;
+  std::string thread_count_option;
   int c;
   while ((c = getopt_long(argc, argv, "e:ho:vV", dwp_options, NULL)) != -1)
     {
@@ -2397,6 +2808,15 @@ main(int argc, char** argv)
 	  case VERIFY_ONLY:
 	    verify_only = true;
 	    break;
+	  case THREADS:
+	    set_gold_option(&command_line, "--threads");
+	    break;
+	  case THREAD_COUNT:
+	    set_gold_option(&command_line, "--threads");
+	    thread_count_option.assign("--thread-count=");
+	    thread_count_option.append(optarg);
+	    set_gold_option(&command_line, thread_count_option.c_str());
+	    break;
 	  case 'V':
 	    print_version();
 	  case '?':
@@ -2436,15 +2856,22 @@ main(int argc, char** argv)
       return ok ? EXIT_SUCCESS : EXIT_FAILURE;
     }
 
-  // Process each file, adding its contents to the output file.
+  // Process each file, adding its contents to the output file.  The
+  // input files are read in parallel when using threads, but they are
+  // added to the output file in order.
+  int thread_count = options.thread_count();
+#ifdef _SC_NPROCESSORS_ONLN
+  if (options.threads() && thread_count == 0)
+    thread_count = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+  if (thread_count <= 0)
+    thread_count = 1;
+  Workqueue workqueue(options);
+  workqueue.set_thread_count(thread_count);
   Dwp_output_file output_file(output_filename.c_str());
-  for (File_list::const_iterator f = files.begin(); f != files.end(); ++f)
-    {
-      if (verbose)
-	fprintf(stderr, "%s\n", f->dwo_name.c_str());
-      Dwo_file dwo_file(f->dwo_name.c_str());
-      dwo_file.read(&output_file);
-    }
+  Dwo_task_queue task_queue(files, &output_file, verbose);
+  task_queue.queue_initial_tasks(&workqueue, 2 * thread_count);
+  workqueue.process(0);
   output_file.finalize();
 
   return EXIT_SUCCESS;
@@ -22,6 +22,7 @@
 
 #include "gold.h"
 
+#include <algorithm>
 #include <vector>
 #include <cstring>
 
@@ -857,8 +858,6 @@ unsigned int
 Dynobj::compute_bucket_count(const std::vector<uint32_t>& hashcodes,
 			     bool for_gnu_hash_table)
 {
-  // FIXME: Implement optional hash table optimization.
-
   // Array used to determine the number of hash table buckets to use
   // based on the number of symbols there are.  If there are fewer
   // than 3 symbols we use 1 bucket, fewer than 17 symbols we use 3
@@ -886,9 +885,147 @@ Dynobj::compute_bucket_count(const std::vector<uint32_t>& hashcodes,
   if (for_gnu_hash_table && ret < 2)
     ret = 2;
 
+  if (parameters->options().hash_optimize())
+    ret = Dynobj::optimize_bucket_count(hashcodes, for_gnu_hash_table, ret);
+
+  return ret;
+}
+
+// Return whether N is prime.
+
+static bool
+is_prime(unsigned int n)
+{
+  if (n < 2)
+    return false;
+  for (unsigned int d = 2; d <= n / d; ++d)
+    if (n % d == 0)
+      return false;
+  return true;
+}
+
+// Choose the number of hash buckets for --hash-optimize by trying
+// prime bucket counts from a quarter of the number of symbols up to
+// MAX_BUCKETS, the count chosen by the default heuristic, and
+// MAX_BUCKETS itself, and measuring the chains that each one produces
+// for HASHCODES.  The table is never larger than the default one.
+// The cost of a bucket count is the average number of chain entries
+// that a successful lookup examines.  For the SysV table we add the
+// average chain length, which is what an unsuccessful lookup
+// examines; the GNU table relies on its bloom filter to reject most
+// of those.  Each bucket per symbol adds half a probe to the cost, to
+// account for the size of the table.
+
+unsigned int
+Dynobj::optimize_bucket_count(const std::vector<uint32_t>& hashcodes,
+			      bool for_gnu_hash_table, unsigned int max_buckets)
+{
+  const unsigned int symcount = hashcodes.size();
+  const unsigned int min_buckets = for_gnu_hash_table ? 2 : 1;
+  if (symcount <= min_buckets || max_buckets <= min_buckets)
+    return max_buckets;
+
+  const double nsyms = symcount;
+  std::vector<unsigned int> candidates;
+  for (double want = std::max(nsyms / 4, 1.0);
+       want < max_buckets;
+       want *= 1.1)
+    {
+      unsigned int bucketcount = static_cast<unsigned int>(want);
+      if (bucketcount < min_buckets)
+	bucketcount = min_buckets;
+      while (bucketcount > 2 && !is_prime(bucketcount))
+	++bucketcount;
+      if (bucketcount >= max_buckets)
+	break;
+      if (candidates.empty() || bucketcount > candidates.back())
+	candidates.push_back(bucketcount);
+    }
+  candidates.push_back(max_buckets);
+
+  std::vector<unsigned int> counts;
+  unsigned int ret = 0;
+  double best_cost = 0;
+  for (std::vector<unsigned int>::const_iterator p = candidates.begin();
+       p != candidates.end();
+       ++p)
+    {
+      const unsigned int bucketcount = *p;
+      counts.assign(bucketcount, 0);
+      for (unsigned int i = 0; i < symcount; ++i)
+	++counts[hashcodes[i] % bucketcount];
+
+      // A symbol that is the Nth entry in its chain takes N probes
+      // to find.
+      double probes = 0;
+      for (unsigned int i = 0; i < bucketcount; ++i)
+	probes += static_cast<double>(counts[i]) * (counts[i] + 1) / 2;
+
+      double cost = probes / nsyms + 0.5 * bucketcount / nsyms;
+      if (!for_gnu_hash_table)
+	cost += nsyms / bucketcount;
+      if (ret == 0 || cost < best_cost)
+	{
+	  ret = bucketcount;
+	  best_cost = cost;
+	}
+    }
+
   return ret;
 }
 
+// Choose the size of the GNU hash bloom filter for --hash-optimize.
+// MASKBITSLOG2 is the size chosen by the default heuristic, and
+// SHIFT1 is the log2 of the number of bits in a bloom filter word.
+// Each symbol sets two bits in one word, so a lookup of a name which
+// is not in the table gets past the filter with probability
+// (B / WORDBITS)**2, where B is the number of bits set in the word
+// the name selects.  We average that over the words for the default
+// size and for two and four times the default, and return the first
+// of those sizes for which that false positive rate is at most 2%.
+// If none of them is good enough, we return eight times the default
+// without measuring it.  That is a fixed cap on the size of the
+// filter, not a measured choice, although doubling the filter should
+// only lower the rate.  No size is larger than 2**31 bits.
+
+uint32_t
+Dynobj::optimize_maskbitslog2(const std::vector<uint32_t>& hashcodes,
+			      uint32_t maskbitslog2, uint32_t shift1)
+{
+  const unsigned int symcount = hashcodes.size();
+  const uint32_t wordbits = 1U << shift1;
+  const uint32_t mask = wordbits - 1U;
+  const uint32_t max_maskbitslog2 = std::min(maskbitslog2 + 3, 31U);
+  std::vector<uint64_t> bitmask;
+  for (; maskbitslog2 < max_maskbitslog2; ++maskbitslog2)
+    {
+      const uint32_t shift2 = maskbitslog2;
+      const uint32_t maskwords = 1U << (maskbitslog2 - shift1);
+      bitmask.assign(maskwords, 0);
+      for (unsigned int i = 0; i < symcount; ++i)
+	{
+	  uint32_t hashval = hashcodes[i];
+	  uint32_t val = (hashval >> shift1) & (maskwords - 1);
+	  bitmask[val] |= static_cast<uint64_t>(1U) << (hashval & mask);
+	  bitmask[val] |= (static_cast<uint64_t>(1U)
+			   << ((hashval >> shift2) & mask));
+	}
+
+      double false_positives = 0;
+      for (uint32_t i = 0; i < maskwords; ++i)
+	{
+	  unsigned int bits = 0;
+	  for (uint64_t w = bitmask[i]; w != 0; w &= w - 1)
+	    ++bits;
+	  double fraction = static_cast<double>(bits) / wordbits;
+	  false_positives += fraction * fraction;
+	}
+      if (false_positives / maskwords <= 0.02)
+	break;
+    }
+  return maskbitslog2;
+}
+
 // The standard ELF hash function.  This hash function must not
 // change, as the dynamic linker uses it also.
 
@@ -1207,6 +1344,9 @@ Dynobj::sized_create_gnu_hash_table(
 	maskbitslog2 = 6;
       shift1 = 6;
     }
+  if (parameters->options().hash_optimize())
+    maskbitslog2 = Dynobj::optimize_maskbitslog2(dynsym_hashvals,
+						 maskbitslog2, shift1);
   uint32_t mask = (1U << shift1) - 1U;
   uint32_t shift2 = maskbitslog2;
   uint32_t maskbits = 1U << maskbitslog2;
@@ -1515,6 +1655,32 @@ Versions::record_version(const Symbol_table* symtab,
     }
 }
 
+// Record a reference to the GLIBC_ABI_DT_RELR version.  The C
+// library defines it along with an absolute symbol of the same name.
+// The symbol table records version definition symbols like that one
+// without a version, so we look for the symbol rather than the
+// version.
+
+void
+Versions::add_glibc_abi_dt_relr(const Symbol_table* symtab,
+				Stringpool* dynpool)
+{
+  gold_assert(!this->is_finalized_);
+
+  const char* name = "GLIBC_ABI_DT_RELR";
+  const Symbol* sym = symtab->lookup(name);
+  if (sym == NULL || !sym->is_from_dynobj() || !sym->is_absolute())
+    return;
+
+  Dynobj* dynobj = this->get_dynobj_for_sym(symtab, sym);
+  if (!dynobj->is_needed() && dynobj->as_needed())
+    return;
+
+  Stringpool::Key version_key;
+  const char* version = dynpool->add(name, false, &version_key);
+  this->add_need(dynpool, dynobj->soname(), version, version_key);
+}
+
 // We've found a symbol SYM defined in version VERSION.
 
 void
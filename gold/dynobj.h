@@ -121,6 +121,18 @@ class Dynobj : public Object
   compute_bucket_count(const std::vector<uint32_t>& hashcodes,
 		       bool for_gnu_hash_table);
 
+  // Compute the number of hash buckets to use for --hash-optimize,
+  // given the number the default heuristic chose.
+  static unsigned int
+  optimize_bucket_count(const std::vector<uint32_t>& hashcodes,
+			bool for_gnu_hash_table, unsigned int max_buckets);
+
+  // Compute the size of the GNU hash bloom filter to use for
+  // --hash-optimize.
+  static uint32_t
+  optimize_maskbitslog2(const std::vector<uint32_t>& hashcodes,
+			uint32_t maskbitslog2, uint32_t shift1);
+
   // Sized version of create_elf_hash_table.
   template<bool big_endian>
   static void
@@ -559,6 +571,12 @@ class Versions
   void
   record_version(const Symbol_table* symtab, Stringpool*, const Symbol* sym);
 
+  // Record a reference to the GLIBC_ABI_DT_RELR version, which the
+  // GNU dynamic linker requires before it will process DT_RELR.
+  // This does nothing if no shared library defines that version.
+  void
+  add_glibc_abi_dt_relr(const Symbol_table* symtab, Stringpool*);
+
   // Set the version indexes.  DYNSYM_INDEX is the index we should use
   // for the next dynamic symbol.  We add new dynamic symbols to SYMS
   // and return an updated DYNSYM_INDEX.
@@ -188,8 +188,7 @@ Eh_frame_hdr::do_sized_write(Output_file* of)
       this->get_fde_addresses<size, big_endian>(of, &this->fde_offsets_,
 						&fde_addresses);
 
-      std::sort(fde_addresses.begin(), fde_addresses.end(),
-		Fde_address_compare<size>());
+      fde_addresses.sort();
 
       typename elfcpp::Elf_types<size>::Elf_Addr output_address;
       output_address = this->address();
@@ -212,6 +211,68 @@ Eh_frame_hdr::do_sized_write(Output_file* of)
   of->write_output_view(off, oview_size, oview);
 }
 
+// Sort the FDE addresses by PC.  There is one entry for each FDE in
+// the output file, which for a large C++ program can be millions, so
+// for all but short lists we use a least significant digit radix sort
+// on the PC, one byte at a time, rather than a comparison sort.  We
+// skip the bytes which are the same for every PC, such as the high
+// bytes of the addresses in a 64-bit program.  The sort is stable, so
+// FDEs with the same PC stay in the order of the .eh_frame section.
+
+template<int size>
+void
+Eh_frame_hdr::Fde_addresses<size>::sort()
+{
+  Fde_address_list& list(this->fde_addresses_);
+  const size_t count = list.size();
+  if (count < 256)
+    {
+      std::stable_sort(list.begin(), list.end(), Fde_address_compare<size>());
+      return;
+    }
+
+  // Count the values of each byte of the PCs in a single pass.
+  const int bytes = size / 8;
+  std::vector<size_t> counts(bytes * 256, 0);
+  for (typename Fde_address_list::const_iterator p = list.begin();
+       p != list.end();
+       ++p)
+    {
+      Address pc = p->first;
+      for (int i = 0; i < bytes; ++i, pc >>= 8)
+	++counts[i * 256 + (pc & 0xff)];
+    }
+
+  Fde_address_list other(count);
+  Fde_address_list* from = &list;
+  Fde_address_list* to = &other;
+  for (int i = 0; i < bytes; ++i)
+    {
+      size_t* c = &counts[i * 256];
+      const int shift = i * 8;
+      if (c[(from->front().first >> shift) & 0xff] == count)
+	continue;
+
+      size_t offset = 0;
+      for (int j = 0; j < 256; ++j)
+	{
+	  size_t n = c[j];
+	  c[j] = offset;
+	  offset += n;
+	}
+
+      for (typename Fde_address_list::const_iterator p = from->begin();
+	   p != from->end();
+	   ++p)
+	(*to)[c[(p->first >> shift) & 0xff]++] = *p;
+
+      std::swap(from, to);
+    }
+
+  if (from != &list)
+    list.swap(other);
+}
+
 // Given the offset FDE_OFFSET of an FDE in the .eh_frame section, and
 // the contents of the .eh_frame section EH_FRAME_CONTENTS, where the
 // FDE's encoding is FDE_ENCODING, return the output address of the
@@ -555,20 +616,20 @@ Eh_frame::skip_leb128(const unsigned char** pp, const unsigned char* pend)
   return false;
 }
 
-// Add input section SHNDX in OBJECT to an exception frame section.
+// Parse input section SHNDX in OBJECT as an exception frame section.
 // SYMBOLS is the contents of the symbol table section (size
 // SYMBOLS_SIZE), SYMBOL_NAMES is the symbol names section (size
 // SYMBOL_NAMES_SIZE).  RELOC_SHNDX is the index of a relocation
 // section applying to SHNDX, or 0 if none, or -1U if more than one.
 // RELOC_TYPE is the type of the reloc section if there is one, either
 // SHT_REL or SHT_RELA.  We try to parse the input exception frame
-// data into our data structures.  If we can't do it, we return false
-// to mean that the section should be handled as a normal input
-// section.
+// data into CIEs and FDEs.  If we can't do it, the disposition of the
+// result is EH_UNRECOGNIZED_SECTION, meaning that the section should
+// be handled as a normal input section.
 
 template<int size, bool big_endian>
-Eh_frame::Eh_frame_section_disposition
-Eh_frame::add_ehframe_input_section(
+Eh_frame_input*
+Eh_frame::read_ehframe_input_section(
     Sized_relobj_file<size, big_endian>* object,
     const unsigned char* symbols,
     section_size_type symbols_size,
@@ -578,60 +639,174 @@ Eh_frame::add_ehframe_input_section(
     unsigned int reloc_shndx,
     unsigned int reloc_type)
 {
+  Eh_frame_input* input = new Eh_frame_input(shndx, reloc_shndx,
+					     reloc_type);
+
   // Get the section contents.
   section_size_type contents_len;
   const unsigned char* pcontents = object->section_contents(shndx,
 							    &contents_len,
 							    false);
   if (contents_len == 0)
-    return EH_EMPTY_SECTION;
+    input->disposition_ = EH_EMPTY_SECTION;
 
   // If this is the marker section for the end of the data, then
   // return false to force it to be handled as an ordinary input
   // section.  If we don't do this, we won't correctly handle the case
   // of unrecognized .eh_frame sections.
-  if (contents_len == 4
-      && elfcpp::Swap<32, big_endian>::readval(pcontents) == 0)
-    return EH_END_MARKER_SECTION;
-
-  New_cies new_cies;
-  if (!this->do_add_ehframe_input_section(object, symbols, symbols_size,
-					  symbol_names, symbol_names_size,
-					  shndx, reloc_shndx,
-					  reloc_type, pcontents,
-					  contents_len, &new_cies))
+  else if (contents_len == 4
+	   && elfcpp::Swap<32, big_endian>::readval(pcontents) == 0)
+    input->disposition_ = EH_END_MARKER_SECTION;
+
+  else if (Eh_frame::do_read_ehframe_input_section(object, symbols,
+						   symbols_size, symbol_names,
+						   symbol_names_size, shndx,
+						   reloc_shndx, reloc_type,
+						   pcontents, contents_len,
+						   input))
+    input->disposition_ = EH_OPTIMIZABLE_SECTION;
+
+  return input;
+}
+
+// Add input section SHNDX in OBJECT to an exception frame section.
+// The arguments are as for read_ehframe_input_section.  INPUT is the
+// section as already parsed by read_ehframe_input_section, or NULL;
+// we take over its CIEs and FDEs.  We merge the CIEs with the ones we
+// have already seen, and discard the FDEs for discarded sections.
+// If we can't parse the section, we return EH_UNRECOGNIZED_SECTION
+// to mean that the section should be handled as a normal input
+// section.
+
+template<int size, bool big_endian>
+Eh_frame::Eh_frame_section_disposition
+Eh_frame::add_ehframe_input_section(
+    Sized_relobj_file<size, big_endian>* object,
+    const unsigned char* symbols,
+    section_size_type symbols_size,
+    const unsigned char* symbol_names,
+    section_size_type symbol_names_size,
+    unsigned int shndx,
+    unsigned int reloc_shndx,
+    unsigned int reloc_type,
+    Eh_frame_input* input)
+{
+  Eh_frame_input* local_input = NULL;
+  if (input == NULL || !input->is_section(shndx, reloc_shndx, reloc_type))
+    {
+      local_input = Eh_frame::read_ehframe_input_section(object, symbols,
+							 symbols_size,
+							 symbol_names,
+							 symbol_names_size,
+							 shndx, reloc_shndx,
+							 reloc_type);
+      input = local_input;
+    }
+
+  Eh_frame_section_disposition disposition = input->disposition_;
+  if (disposition == EH_UNRECOGNIZED_SECTION)
     {
       if (this->eh_frame_hdr_ != NULL)
 	this->eh_frame_hdr_->found_unrecognized_eh_frame_section();
+    }
+  else if (disposition == EH_OPTIMIZABLE_SECTION)
+    {
+      Eh_frame_input::Entries& entries(input->entries_);
+      std::vector<Cie*> cies(entries.size(), NULL);
+      New_cies new_cies;
+      for (size_t i = 0; i < entries.size(); ++i)
+	{
+	  Eh_frame_input::Entry* entry = &entries[i];
+	  if (entry->cie != NULL)
+	    {
+	      Cie* cie = entry->cie;
+	      entry->cie = NULL;
+
+	      Cie* cie_pointer = NULL;
+	      if (entry->mergeable)
+		{
+		  Cie_offsets::iterator find_cie = this->cie_offsets_.find(cie);
+		  if (find_cie != this->cie_offsets_.end())
+		    cie_pointer = *find_cie;
+		  else
+		    {
+		      // See if we already saw this CIE in this object
+		      // file.
+		      for (New_cies::const_iterator pc = new_cies.begin();
+			   pc != new_cies.end();
+			   ++pc)
+			{
+			  if (*(pc->first) == *cie)
+			    {
+			      cie_pointer = pc->first;
+			      break;
+			    }
+			}
+		    }
+		}
+
+	      if (cie_pointer == NULL)
+		{
+		  cie_pointer = cie;
+		  new_cies.push_back(std::make_pair(cie, entry->mergeable));
+		}
+	      else
+		{
+		  // We are deleting this CIE.  Record that in our
+		  // mapping from input sections to the output section.
+		  object->add_merge_mapping(this, shndx, entry->offset,
+					    entry->length, -1);
+		  delete cie;
+		}
+
+	      cies[i] = cie_pointer;
+	    }
+	  else
+	    {
+	      Fde* fde = entry->fde;
+	      entry->fde = NULL;
 
-      for (New_cies::iterator p = new_cies.begin();
+	      if (entry->fde_shndx_is_ordinary
+		  && entry->fde_shndx != elfcpp::SHN_UNDEF
+		  && entry->fde_shndx < object->shnum()
+		  && !object->is_section_included(entry->fde_shndx))
+		{
+		  // This FDE applies to a section which we are
+		  // discarding.  We can discard this FDE.
+		  object->add_merge_mapping(this, shndx, entry->offset,
+					    entry->length, -1);
+		  delete fde;
+		}
+	      else
+		{
+		  gold_assert(cies[entry->cie_index] != NULL);
+		  cies[entry->cie_index]->add_fde(fde);
+		}
+	    }
+	}
+
+      // Now record any new CIEs that we found.
+      for (New_cies::const_iterator p = new_cies.begin();
 	   p != new_cies.end();
 	   ++p)
-	delete p->first;
-
-      return EH_UNRECOGNIZED_SECTION;
+	{
+	  if (p->second)
+	    this->cie_offsets_.insert(p->first);
+	  else
+	    this->unmergeable_cie_offsets_.push_back(p->first);
+	}
     }
 
-  // Now that we know we are using this section, record any new CIEs
-  // that we found.
-  for (New_cies::const_iterator p = new_cies.begin();
-       p != new_cies.end();
-       ++p)
-    {
-      if (p->second)
-	this->cie_offsets_.insert(p->first);
-      else
-	this->unmergeable_cie_offsets_.push_back(p->first);
-    }
+  delete local_input;
 
-  return EH_OPTIMIZABLE_SECTION;
+  return disposition;
 }
 
-// The bulk of the implementation of add_ehframe_input_section.
+// The bulk of the implementation of read_ehframe_input_section.
 
 template<int size, bool big_endian>
 bool
-Eh_frame::do_add_ehframe_input_section(
+Eh_frame::do_read_ehframe_input_section(
     Sized_relobj_file<size, big_endian>* object,
     const unsigned char* symbols,
     section_size_type symbols_size,
@@ -642,7 +817,7 @@ Eh_frame::do_add_ehframe_input_section(
     unsigned int reloc_type,
     const unsigned char* pcontents,
     section_size_type contents_len,
-    New_cies* new_cies)
+    Eh_frame_input* input)
 {
   Track_relocs<size, big_endian> relocs;
 
@@ -694,17 +869,18 @@ Eh_frame::do_add_ehframe_input_section(
       if (id == 0)
 	{
 	  // CIE.
-	  if (!this->read_cie(object, shndx, symbols, symbols_size,
-			      symbol_names, symbol_names_size,
-			      pcontents, p, pentend, &relocs, &cies,
-			      new_cies))
+	  if (!Eh_frame::read_cie(object, shndx, symbols, symbols_size,
+				  symbol_names, symbol_names_size,
+				  pcontents, p, pentend, &relocs, &cies,
+				  input))
 	    return false;
 	}
       else
 	{
 	  // FDE.
-	  if (!this->read_fde(object, shndx, symbols, symbols_size,
-			      pcontents, id, p, pentend, &relocs, &cies))
+	  if (!Eh_frame::read_fde(object, shndx, symbols, symbols_size,
+				  pcontents, id, p, pentend, &relocs, &cies,
+				  input))
 	    return false;
 	}
 
@@ -729,7 +905,7 @@ Eh_frame::read_cie(Sized_relobj_file<size, big_endian>* object,
 		   const unsigned char* pcieend,
 		   Track_relocs<size, big_endian>* relocs,
 		   Offsets_to_cie* cies,
-		   New_cies* new_cies)
+		   Eh_frame_input* input)
 {
   bool mergeable = true;
 
@@ -922,48 +1098,14 @@ Eh_frame::read_cie(Sized_relobj_file<size, big_endian>* object,
   if (relocs->advance(pcieend - pcontents) > 0)
     return false;
 
-  Cie cie(object, shndx, (pcie - 8) - pcontents, fde_encoding, 
-	  personality_name, pcie, pcieend - pcie);
-  Cie* cie_pointer = NULL;
-  if (mergeable)
-    {
-      Cie_offsets::iterator find_cie = this->cie_offsets_.find(&cie);
-      if (find_cie != this->cie_offsets_.end())
-	cie_pointer = *find_cie;
-      else
-	{
-	  // See if we already saw this CIE in this object file.
-	  for (New_cies::const_iterator pc = new_cies->begin();
-	       pc != new_cies->end();
-	       ++pc)
-	    {
-	      if (*(pc->first) == cie)
-		{
-		  cie_pointer = pc->first;
-		  break;
-		}
-	    }
-	}
-    }
-
-  if (cie_pointer == NULL)
-    {
-      cie_pointer = new Cie(cie);
-      new_cies->push_back(std::make_pair(cie_pointer, mergeable));
-    }
-  else
-    {
-      // We are deleting this CIE.  Record that in our mapping from
-      // input sections to the output section.  At this point we don't
-      // know for sure that we are doing a special mapping for this
-      // input section, but that's OK--if we don't do a special
-      // mapping, nobody will ever ask for the mapping we add here.
-      object->add_merge_mapping(this, shndx, (pcie - 8) - pcontents,
-                                pcieend - (pcie - 8), -1);
-    }
-
-  // Record this CIE plus the offset in the input section.
-  cies->insert(std::make_pair(pcie - pcontents, cie_pointer));
+  // Record this CIE plus the offset in the input section.  We merge
+  // it with other CIEs in add_ehframe_input_section.
+  Cie* cie = new Cie(object, shndx, (pcie - 8) - pcontents, fde_encoding,
+		     personality_name, pcie, pcieend - pcie);
+  cies->insert(std::make_pair(pcie - pcontents, input->entries_.size()));
+  input->entries_.push_back(Eh_frame_input::Entry(cie, mergeable,
+						  (pcie - 8) - pcontents,
+						  pcieend - (pcie - 8)));
 
   return true;
 }
@@ -981,7 +1123,8 @@ Eh_frame::read_fde(Sized_relobj_file<size, big_endian>* object,
 		   const unsigned char* pfde,
 		   const unsigned char* pfdeend,
 		   Track_relocs<size, big_endian>* relocs,
-		   Offsets_to_cie* cies)
+		   Offsets_to_cie* cies,
+		   Eh_frame_input* input)
 {
   // OFFSET is the distance between the 4 bytes before PFDE to the
   // start of the CIE.  The offset we recorded for the CIE is 8 bytes
@@ -990,7 +1133,6 @@ Eh_frame::read_fde(Sized_relobj_file<size, big_endian>* object,
   Offsets_to_cie::const_iterator pcie = cies->find(cie_offset);
   if (pcie == cies->end())
     return false;
-  Cie* cie = pcie->second;
 
   // The FDE should start with a reloc to the start of the code which
   // it describes.
@@ -1019,20 +1161,14 @@ Eh_frame::read_fde(Sized_relobj_file<size, big_endian>* object,
   fde_shndx = object->adjust_sym_shndx(symndx, sym.get_st_shndx(),
 				       &is_ordinary);
 
-  if (is_ordinary
-      && fde_shndx != elfcpp::SHN_UNDEF
-      && fde_shndx < object->shnum()
-      && !object->is_section_included(fde_shndx))
-    {
-      // This FDE applies to a section which we are discarding.  We
-      // can discard this FDE.
-      object->add_merge_mapping(this, shndx, (pfde - 8) - pcontents,
-                                pfdeend - (pfde - 8), -1);
-      return true;
-    }
-
-  cie->add_fde(new Fde(object, shndx, (pfde - 8) - pcontents,
-		       pfde, pfdeend - pfde));
+  // We discard the FDE in add_ehframe_input_section if it applies to
+  // a section which we are discarding.
+  Fde* fde = new Fde(object, shndx, (pfde - 8) - pcontents,
+		     pfde, pfdeend - pfde);
+  input->entries_.push_back(Eh_frame_input::Entry(fde, pcie->second,
+						  fde_shndx, is_ordinary,
+						  (pfde - 8) - pcontents,
+						  pfdeend - (pfde - 8)));
 
   return true;
 }
@@ -1204,10 +1340,39 @@ Eh_frame::do_sized_write(unsigned char* oview)
 					  this->eh_frame_hdr_);
 }
 
+// Class Eh_frame_input.
+
+// Delete the CIEs and FDEs which were not taken over by
+// Eh_frame::add_ehframe_input_section.
+
+Eh_frame_input::~Eh_frame_input()
+{
+  for (Entries::iterator p = this->entries_.begin();
+       p != this->entries_.end();
+       ++p)
+    {
+      delete p->cie;
+      delete p->fde;
+    }
+}
+
 #ifdef HAVE_TARGET_32_LITTLE
 template
 Eh_frame::Eh_frame_section_disposition
 Eh_frame::add_ehframe_input_section<32, false>(
+    Sized_relobj_file<32, false>* object,
+    const unsigned char* symbols,
+    section_size_type symbols_size,
+    const unsigned char* symbol_names,
+    section_size_type symbol_names_size,
+    unsigned int shndx,
+    unsigned int reloc_shndx,
+    unsigned int reloc_type,
+    Eh_frame_input* input);
+
+template
+Eh_frame_input*
+Eh_frame::read_ehframe_input_section<32, false>(
     Sized_relobj_file<32, false>* object,
     const unsigned char* symbols,
     section_size_type symbols_size,
@@ -1222,6 +1387,19 @@ Eh_frame::add_ehframe_input_section<32, false>(
 template
 Eh_frame::Eh_frame_section_disposition
 Eh_frame::add_ehframe_input_section<32, true>(
+    Sized_relobj_file<32, true>* object,
+    const unsigned char* symbols,
+    section_size_type symbols_size,
+    const unsigned char* symbol_names,
+    section_size_type symbol_names_size,
+    unsigned int shndx,
+    unsigned int reloc_shndx,
+    unsigned int reloc_type,
+    Eh_frame_input* input);
+
+template
+Eh_frame_input*
+Eh_frame::read_ehframe_input_section<32, true>(
     Sized_relobj_file<32, true>* object,
     const unsigned char* symbols,
     section_size_type symbols_size,
@@ -1236,6 +1414,19 @@ Eh_frame::add_ehframe_input_section<32, true>(
 template
 Eh_frame::Eh_frame_section_disposition
 Eh_frame::add_ehframe_input_section<64, false>(
+    Sized_relobj_file<64, false>* object,
+    const unsigned char* symbols,
+    section_size_type symbols_size,
+    const unsigned char* symbol_names,
+    section_size_type symbol_names_size,
+    unsigned int shndx,
+    unsigned int reloc_shndx,
+    unsigned int reloc_type,
+    Eh_frame_input* input);
+
+template
+Eh_frame_input*
+Eh_frame::read_ehframe_input_section<64, false>(
     Sized_relobj_file<64, false>* object,
     const unsigned char* symbols,
     section_size_type symbols_size,
@@ -1250,6 +1441,19 @@ Eh_frame::add_ehframe_input_section<64, false>(
 template
 Eh_frame::Eh_frame_section_disposition
 Eh_frame::add_ehframe_input_section<64, true>(
+    Sized_relobj_file<64, true>* object,
+    const unsigned char* symbols,
+    section_size_type symbols_size,
+    const unsigned char* symbol_names,
+    section_size_type symbol_names_size,
+    unsigned int shndx,
+    unsigned int reloc_shndx,
+    unsigned int reloc_type,
+    Eh_frame_input* input);
+
+template
+Eh_frame_input*
+Eh_frame::read_ehframe_input_section<64, true>(
     Sized_relobj_file<64, true>* object,
     const unsigned char* symbols,
     section_size_type symbols_size,
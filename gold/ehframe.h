@@ -37,6 +37,7 @@ template<int size, bool big_endian>
 class Track_relocs;
 
 class Eh_frame;
+class Eh_frame_input;
 
 // This class manages the .eh_frame_hdr section, which holds the data
 // for the PT_GNU_EH_FRAME segment.  gcc's unwind support code uses
@@ -120,6 +121,10 @@ class Eh_frame_hdr : public Output_section_data
     end()
     { return this->fde_addresses_.end(); }
 
+    // Sort the list by PC.
+    void
+    sort();
+
    private:
     Fde_address_list fde_addresses_;
   };
@@ -378,9 +383,10 @@ class Eh_frame : public Output_section_data
   // of the symbol table section (size SYMBOLS_SIZE), SYMBOL_NAMES is
   // the symbol names section (size SYMBOL_NAMES_SIZE).  RELOC_SHNDX
   // is the relocation section if any (0 for none, -1U for multiple).
-  // RELOC_TYPE is the type of the relocation section if any.  This
-  // returns whether the section was incorporated into the .eh_frame
-  // data.
+  // RELOC_TYPE is the type of the relocation section if any.  INPUT
+  // is the section as parsed by read_ehframe_input_section, or NULL
+  // if it has not been parsed.  This returns whether the section was
+  // incorporated into the .eh_frame data.
   template<int size, bool big_endian>
   Eh_frame_section_disposition
   add_ehframe_input_section(Sized_relobj_file<size, big_endian>* object,
@@ -389,7 +395,22 @@ class Eh_frame : public Output_section_data
 			    const unsigned char* symbol_names,
 			    section_size_type symbol_names_size,
 			    unsigned int shndx, unsigned int reloc_shndx,
-			    unsigned int reloc_type);
+			    unsigned int reloc_type, Eh_frame_input* input);
+
+  // Parse the input section SHNDX in OBJECT, with arguments as for
+  // add_ehframe_input_section, without merging it into any Eh_frame.
+  // This only looks at OBJECT, so it may be called while reading the
+  // symbols of OBJECT, in parallel with other objects.  The caller
+  // owns the result.
+  template<int size, bool big_endian>
+  static Eh_frame_input*
+  read_ehframe_input_section(Sized_relobj_file<size, big_endian>* object,
+			     const unsigned char* symbols,
+			     section_size_type symbols_size,
+			     const unsigned char* symbol_names,
+			     section_size_type symbol_names_size,
+			     unsigned int shndx, unsigned int reloc_shndx,
+			     unsigned int reloc_type);
 
   // Add a CIE and an FDE for a PLT section, to permit unwinding
   // through a PLT.  The FDE data should start with 8 bytes of zero,
@@ -439,9 +460,9 @@ class Eh_frame : public Output_section_data
   // A list of unmergeable CIEs.
   typedef std::vector<Cie*> Unmergeable_cie_offsets;
 
-  // A mapping from offsets to CIEs.  This is used while reading an
-  // input section.
-  typedef std::map<uint64_t, Cie*> Offsets_to_cie;
+  // A mapping from offsets to the index of a CIE in the entries of
+  // an Eh_frame_input.  This is used while reading an input section.
+  typedef std::map<uint64_t, size_t> Offsets_to_cie;
 
   // A list of CIEs, and a bool indicating whether the CIE is
   // mergeable.
@@ -451,24 +472,24 @@ class Eh_frame : public Output_section_data
   static bool
   skip_leb128(const unsigned char**, const unsigned char*);
 
-  // The implementation of add_ehframe_input_section.
+  // The implementation of read_ehframe_input_section.
   template<int size, bool big_endian>
-  bool
-  do_add_ehframe_input_section(Sized_relobj_file<size, big_endian>* object,
-			       const unsigned char* symbols,
-			       section_size_type symbols_size,
-			       const unsigned char* symbol_names,
-			       section_size_type symbol_names_size,
-			       unsigned int shndx,
-			       unsigned int reloc_shndx,
-			       unsigned int reloc_type,
-			       const unsigned char* pcontents,
-			       section_size_type contents_len,
-			       New_cies*);
+  static bool
+  do_read_ehframe_input_section(Sized_relobj_file<size, big_endian>* object,
+				const unsigned char* symbols,
+				section_size_type symbols_size,
+				const unsigned char* symbol_names,
+				section_size_type symbol_names_size,
+				unsigned int shndx,
+				unsigned int reloc_shndx,
+				unsigned int reloc_type,
+				const unsigned char* pcontents,
+				section_size_type contents_len,
+				Eh_frame_input*);
 
   // Read a CIE.
   template<int size, bool big_endian>
-  bool
+  static bool
   read_cie(Sized_relobj_file<size, big_endian>* object,
 	   unsigned int shndx,
 	   const unsigned char* symbols,
@@ -480,11 +501,11 @@ class Eh_frame : public Output_section_data
 	   const unsigned char* pcieend,
 	   Track_relocs<size, big_endian>* relocs,
 	   Offsets_to_cie* cies,
-	   New_cies* new_cies);
+	   Eh_frame_input* input);
 
   // Read an FDE.
   template<int size, bool big_endian>
-  bool
+  static bool
   read_fde(Sized_relobj_file<size, big_endian>* object,
 	   unsigned int shndx,
 	   const unsigned char* symbols,
@@ -494,7 +515,8 @@ class Eh_frame : public Output_section_data
 	   const unsigned char* pfde,
 	   const unsigned char* pfdeend,
 	   Track_relocs<size, big_endian>* relocs,
-	   Offsets_to_cie* cies);
+	   Offsets_to_cie* cies,
+	   Eh_frame_input* input);
 
   // Template version of write function.
   template<int size, bool big_endian>
@@ -516,6 +538,85 @@ class Eh_frame : public Output_section_data
   section_size_type final_data_size_;
 };
 
+// An input .eh_frame section which has been parsed into CIEs and
+// FDEs, but not yet merged into the output .eh_frame section.  The
+// CIEs and FDEs are owned by this object until
+// Eh_frame::add_ehframe_input_section takes them over.
+
+class Eh_frame_input
+{
+ public:
+  Eh_frame_input(unsigned int shndx, unsigned int reloc_shndx,
+		 unsigned int reloc_type)
+    : shndx_(shndx), reloc_shndx_(reloc_shndx), reloc_type_(reloc_type),
+      disposition_(Eh_frame::EH_UNRECOGNIZED_SECTION), entries_()
+  { }
+
+  ~Eh_frame_input();
+
+  // Return whether this is the parse of input section SHNDX with
+  // relocation section RELOC_SHNDX of type RELOC_TYPE.
+  bool
+  is_section(unsigned int shndx, unsigned int reloc_shndx,
+	     unsigned int reloc_type) const
+  {
+    return (this->shndx_ == shndx
+	    && this->reloc_shndx_ == reloc_shndx
+	    && this->reloc_type_ == reloc_type);
+  }
+
+ private:
+  friend class Eh_frame;
+
+  // This class can not be copied.
+  Eh_frame_input(const Eh_frame_input&);
+  Eh_frame_input& operator=(const Eh_frame_input&);
+
+  // A CIE or an FDE, in the order in which they appear in the input
+  // section.
+  struct Entry
+  {
+    Entry(Cie* c, bool m, section_offset_type o, section_size_type l)
+      : cie(c), fde(NULL), mergeable(m), cie_index(0), fde_shndx(0),
+	fde_shndx_is_ordinary(false), offset(o), length(l)
+    { }
+
+    Entry(Fde* f, size_t c, unsigned int s, bool is_ordinary,
+	  section_offset_type o, section_size_type l)
+      : cie(NULL), fde(f), mergeable(false), cie_index(c), fde_shndx(s),
+	fde_shndx_is_ordinary(is_ordinary), offset(o), length(l)
+    { }
+
+    // The CIE, or NULL if this is an FDE.
+    Cie* cie;
+    // The FDE, or NULL if this is a CIE.
+    Fde* fde;
+    // For a CIE, whether it may be merged with other CIEs.
+    bool mergeable;
+    // For an FDE, the index in the entries of its CIE.
+    size_t cie_index;
+    // For an FDE, the section holding the code it describes.
+    unsigned int fde_shndx;
+    bool fde_shndx_is_ordinary;
+    // The offset and length of the entry in the input section.
+    section_offset_type offset;
+    section_size_type length;
+  };
+
+  typedef std::vector<Entry> Entries;
+
+  // The input section.
+  unsigned int shndx_;
+  // The relocation section, as for add_ehframe_input_section.
+  unsigned int reloc_shndx_;
+  unsigned int reloc_type_;
+  // What to do with the section.  The entries are only meaningful
+  // if this is EH_OPTIMIZABLE_SECTION.
+  Eh_frame::Eh_frame_section_disposition disposition_;
+  // The CIEs and FDEs.
+  Entries entries_;
+};
+
 } // End namespace gold.
 
 #endif // !defined(GOLD_EHFRAME_H)
@@ -37,8 +37,13 @@
 #endif
 
 #include <sys/stat.h>
+#include <sys/time.h>
 #include "filenames.h"
 
+#ifdef ENABLE_THREADS
+#include <pthread.h>
+#endif
+
 #include "debug.h"
 #include "parameters.h"
 #include "options.h"
@@ -124,6 +129,370 @@ static Initialize_lock file_counts_initialize_lock(&file_counts_lock);
 unsigned long long File_read::total_mapped_bytes;
 unsigned long long File_read::current_mapped_bytes;
 unsigned long long File_read::maximum_mapped_bytes;
+unsigned long long File_read::total_advised_bytes;
+
+// Class File_prefetch.
+
+// This class implements --prefetch-inputs.  It asks the kernel to
+// read ahead the input files named on the command line, staying at
+// most WINDOW files ahead of the files which the link has opened, so
+// that the tasks which read the files find them in the page cache
+// rather than waiting for them one file at a time.  When running
+// with threads the readahead is done on a separate thread; otherwise
+// it is done as each input file is opened.
+
+class File_prefetch
+{
+ public:
+  File_prefetch(unsigned int window)
+    : lock_(), condvar_(this->lock_), files_(), indexes_(), window_(window),
+      next_(0), opened_(0), open_count_(0), stopping_(false),
+      has_thread_(false), files_prefetched_(0), bytes_prefetched_(0),
+      issue_time_(0)
+  { }
+
+  // Add the input file INPUT_ARGUMENT to the list of files to read
+  // ahead.
+  void
+  add_file(const Input_file_argument* input_argument);
+
+  // Start reading ahead.
+  void
+  start();
+
+  // Stop reading ahead, and wait for the readahead thread to exit.
+  void
+  stop();
+
+  // Record that the link has opened the file NAME.
+  void
+  note_open(const std::string& name);
+
+  // Print statistics to stderr.
+  void
+  print_stats() const;
+
+ private:
+  // This class may not be copied.
+  File_prefetch(const File_prefetch&);
+  File_prefetch& operator=(const File_prefetch&);
+
+  // An input file to read ahead.
+  struct File
+  {
+    File(const std::string& a_name)
+      : name(a_name), is_opened(false)
+    { }
+
+    // The name that the link will use to open the file.
+    std::string name;
+    // Whether the link has opened the file.
+    bool is_opened;
+  };
+
+  // Return the current time in microseconds.
+  static uint64_t
+  microseconds()
+  {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return static_cast<uint64_t>(tv.tv_sec) * 1000000 + tv.tv_usec;
+  }
+
+  // Return whether the next file may be read ahead now.  This is
+  // called with the lock held.
+  bool
+  may_prefetch_next() const
+  {
+    return (this->next_ < this->files_.size()
+	    && this->next_ < this->opened_ + this->window_);
+  }
+
+  // Read ahead the file at INDEX in files_.  This is called without
+  // the lock held.
+  void
+  prefetch(size_t index);
+
+#ifdef ENABLE_THREADS
+  // A function to pass to pthread_create.
+  static void*
+  thread_body(void*);
+
+  // The body of the readahead thread.
+  void
+  run();
+
+  // The readahead thread.
+  pthread_t tid_;
+#endif
+
+  typedef Unordered_map<std::string, size_t> Indexes;
+
+  // Lock which protects the fields below.
+  Lock lock_;
+  // Condition variable used to wake up the readahead thread.
+  Condvar condvar_;
+  // The files to read ahead, in command line order.
+  std::vector<File> files_;
+  // Map from a file name to its index in files_.
+  Indexes indexes_;
+  // The number of files to read ahead of the link.
+  size_t window_;
+  // The index of the next file to read ahead.
+  size_t next_;
+  // The number of files in files_ which the link has reached.
+  size_t opened_;
+  // The number of files the link has opened.
+  size_t open_count_;
+  // Set when the readahead thread should exit.
+  bool stopping_;
+  // Whether there is a readahead thread.
+  bool has_thread_;
+  // The number of files read ahead.
+  unsigned int files_prefetched_;
+  // The number of bytes read ahead.
+  unsigned long long bytes_prefetched_;
+  // The time spent asking the kernel to read ahead, in microseconds.
+  // This does not include the reads themselves, which the kernel does
+  // in the background.
+  uint64_t issue_time_;
+};
+
+// The File_prefetch for --prefetch-inputs.  This is set before the
+// workqueue starts running, and does not change while it runs.  It
+// is deleted by File_read::delete_prefetch.
+static File_prefetch* file_prefetch = NULL;
+
+// Add an input file.  We look for files named by -l in the library
+// search path here, the way Input_file::find_file does; if we guess
+// wrong, we just read ahead the wrong file.
+
+void
+File_prefetch::add_file(const Input_file_argument* input_argument)
+{
+  if (IS_ABSOLUTE_PATH(input_argument->name())
+      || (!input_argument->is_lib()
+	  && !input_argument->is_searched_file()))
+    {
+      if (this->indexes_.find(input_argument->name()) == this->indexes_.end())
+	{
+	  this->indexes_[input_argument->name()] = this->files_.size();
+	  this->files_.push_back(File(input_argument->name()));
+	}
+      return;
+    }
+
+  std::vector<std::string> names;
+  if (input_argument->is_lib())
+    {
+      std::string prefix = "lib";
+      prefix += input_argument->name();
+      if (!parameters->options().is_static()
+	  && input_argument->options().Bdynamic())
+	names.push_back(prefix + ".so");
+      names.push_back(prefix + ".a");
+    }
+  else
+    names.push_back(input_argument->name());
+
+  const General_options::Dir_list& dirs =
+    parameters->options().library_path();
+  for (General_options::Dir_list::const_iterator d = dirs.begin();
+       d != dirs.end();
+       ++d)
+    {
+      for (std::vector<std::string>::const_iterator n = names.begin();
+	   n != names.end();
+	   ++n)
+	{
+	  std::string name = d->name() + '/' + *n;
+	  struct stat s;
+	  if (::stat(name.c_str(), &s) == 0)
+	    {
+	      if (this->indexes_.find(name) == this->indexes_.end())
+		{
+		  this->indexes_[name] = this->files_.size();
+		  this->files_.push_back(File(name));
+		}
+	      return;
+	    }
+	}
+    }
+}
+
+// Start reading ahead.
+
+void
+File_prefetch::start()
+{
+  gold_debug(DEBUG_FILES, "Reading ahead %u input files",
+	     static_cast<unsigned int>(this->files_.size()));
+
+#ifdef ENABLE_THREADS
+  if (parameters->options().threads())
+    {
+      this->has_thread_ = true;
+      int err = pthread_create(&this->tid_, NULL,
+			       &File_prefetch::thread_body,
+			       reinterpret_cast<void*>(this));
+      if (err != 0)
+	gold_fatal(_("%s failed: %s"), "pthread_create", strerror(err));
+      return;
+    }
+#endif
+
+  while (this->may_prefetch_next())
+    this->prefetch(this->next_++);
+}
+
+// Stop reading ahead.
+
+void
+File_prefetch::stop()
+{
+#ifdef ENABLE_THREADS
+  if (this->has_thread_)
+    {
+      {
+	Hold_lock hl(this->lock_);
+	this->stopping_ = true;
+	this->condvar_.signal();
+      }
+      int err = pthread_join(this->tid_, NULL);
+      if (err != 0)
+	gold_fatal(_("%s failed: %s"), "pthread_join", strerror(err));
+      this->has_thread_ = false;
+    }
+#endif
+}
+
+// Record that the link has opened NAME, and read ahead more files.
+// We count every file the link opens, whether or not we know about
+// it, so that a file we failed to find does not stall the readahead.
+
+void
+File_prefetch::note_open(const std::string& name)
+{
+  {
+    Hold_lock hl(this->lock_);
+    ++this->open_count_;
+    size_t opened = this->open_count_;
+    Indexes::const_iterator p = this->indexes_.find(name);
+    if (p != this->indexes_.end())
+      {
+	this->files_[p->second].is_opened = true;
+	if (p->second + 1 > opened)
+	  opened = p->second + 1;
+      }
+    if (opened <= this->opened_)
+      return;
+    this->opened_ = opened;
+    if (this->has_thread_)
+      {
+	this->condvar_.signal();
+	return;
+      }
+  }
+
+  // Without a readahead thread there is no other thread to race
+  // with.
+  while (this->may_prefetch_next())
+    this->prefetch(this->next_++);
+}
+
+// Read ahead a file.  We ask the kernel to start reading the whole
+// file into the page cache, and record how long it took to ask.
+
+void
+File_prefetch::prefetch(size_t index)
+{
+  std::string name;
+  {
+    Hold_lock hl(this->lock_);
+    if (this->files_[index].is_opened)
+      return;
+    name = this->files_[index].name;
+  }
+
+  uint64_t start = File_prefetch::microseconds();
+  off_t size = 0;
+  int o = ::open(name.c_str(), O_RDONLY);
+  if (o < 0)
+    return;
+  struct stat s;
+  if (::fstat(o, &s) == 0 && S_ISREG(s.st_mode))
+    {
+#ifdef HAVE_POSIX_FADVISE
+      if (::posix_fadvise(o, 0, s.st_size, POSIX_FADV_WILLNEED) == 0)
+	size = s.st_size;
+#endif
+    }
+  ::close(o);
+  uint64_t elapsed = File_prefetch::microseconds() - start;
+
+  if (size == 0)
+    return;
+
+  gold_debug(DEBUG_FILES, "Read ahead %s", name.c_str());
+
+  Hold_lock hl(this->lock_);
+  ++this->files_prefetched_;
+  this->bytes_prefetched_ += size;
+  this->issue_time_ += elapsed;
+}
+
+#ifdef ENABLE_THREADS
+
+// Passed to pthread_create.
+
+extern "C"
+void*
+File_prefetch::thread_body(void* arg)
+{
+  File_prefetch* prefetch = reinterpret_cast<File_prefetch*>(arg);
+  prefetch->run();
+  return NULL;
+}
+
+// Read ahead files as the link opens them, until there are no more
+// files or we are told to stop.
+
+void
+File_prefetch::run()
+{
+  for (;;)
+    {
+      size_t index;
+      {
+	Hold_lock hl(this->lock_);
+	while (!this->stopping_
+	       && this->next_ < this->files_.size()
+	       && !this->may_prefetch_next())
+	  this->condvar_.wait();
+	if (this->stopping_ || this->next_ >= this->files_.size())
+	  return;
+	index = this->next_++;
+      }
+      this->prefetch(index);
+    }
+}
+
+#endif // defined(ENABLE_THREADS)
+
+// Print statistics.
+
+void
+File_prefetch::print_stats() const
+{
+  fprintf(stderr, _("%s: input files prefetched: %u\n"),
+	  program_name, this->files_prefetched_);
+  fprintf(stderr, _("%s: input bytes prefetched: %llu\n"),
+	  program_name, this->bytes_prefetched_);
+  fprintf(stderr, _("%s: input prefetch issue time: %llu.%06llu\n"),
+	  program_name,
+	  static_cast<unsigned long long>(this->issue_time_ / 1000000),
+	  static_cast<unsigned long long>(this->issue_time_ % 1000000));
+}
 
 // Class File_read::View.
 
@@ -211,6 +580,8 @@ File_read::open(const Task* task, const std::string& name)
       gold_debug(DEBUG_FILES, "Attempt to open %s succeeded",
 		 this->name_.c_str());
       this->token_.add_writer(task);
+      if (file_prefetch != NULL)
+	file_prefetch->note_open(this->name_);
     }
 
   return this->descriptor_ >= 0;
@@ -505,6 +876,19 @@ File_read::make_view(off_t start, section_size_type size,
 	{
 	  ownership = View::DATA_MMAPPED;
 	  this->mapped_bytes_ += psize;
+#ifdef HAVE_MADVISE
+	  // With --prefetch-inputs, ask the kernel to read in large
+	  // views now, rather than one page fault at a time.
+	  if (file_prefetch != NULL
+	      && psize >= File_read::advise_view_size
+	      && ::madvise(p, psize, MADV_WILLNEED) == 0
+	      && parameters->options().stats())
+	    {
+	      file_counts_initialize_lock.initialize();
+	      Hold_optional_lock hl(file_counts_lock);
+	      File_read::total_advised_bytes += psize;
+	    }
+#endif
 	}
       else
 	{
@@ -856,6 +1240,71 @@ File_read::print_stats()
 	  program_name, File_read::total_mapped_bytes);
   fprintf(stderr, _("%s: maximum bytes mapped for read at one time: %llu\n"),
 	  program_name, File_read::maximum_mapped_bytes);
+  if (file_prefetch != NULL)
+    {
+      file_prefetch->print_stats();
+      fprintf(stderr, _("%s: input bytes prefetched when mapped: %llu\n"),
+	      program_name, File_read::total_advised_bytes);
+    }
+}
+
+// Start reading ahead the input files.
+
+void
+File_read::start_prefetch(const Input_arguments& inputs)
+{
+  gold_assert(file_prefetch == NULL);
+  File_prefetch* prefetch =
+    new File_prefetch(parameters->options().prefetch_inputs());
+
+  for (Input_arguments::const_iterator p = inputs.begin();
+       p != inputs.end();
+       ++p)
+    {
+      if (p->is_file())
+	prefetch->add_file(&p->file());
+      else if (p->is_group())
+	{
+	  for (Input_file_group::const_iterator q = p->group()->begin();
+	       q != p->group()->end();
+	       ++q)
+	    if (q->is_file())
+	      prefetch->add_file(&q->file());
+	}
+      else if (p->is_lib())
+	{
+	  for (Input_file_lib::const_iterator q = p->lib()->begin();
+	       q != p->lib()->end();
+	       ++q)
+	    if (q->is_file())
+	      prefetch->add_file(&q->file());
+	}
+    }
+
+  prefetch->start();
+  file_prefetch = prefetch;
+}
+
+// Stop reading ahead.  We keep the File_prefetch for print_stats.
+
+void
+File_read::stop_prefetch()
+{
+  if (file_prefetch != NULL)
+    file_prefetch->stop();
+}
+
+// Delete the File_prefetch, after print_stats.
+
+void
+File_read::delete_prefetch()
+{
+  if (file_prefetch != NULL)
+    {
+      file_prefetch->stop();
+      delete file_prefetch;
+      file_prefetch = NULL;
+    }
 }
 
 // Class File_view.
@@ -60,6 +60,7 @@ get_mtime(const char* filename, Timespec* mtime);
 
 class Position_dependent_options;
 class Input_file_argument;
+class Input_arguments;
 class Dirsearch;
 class File_view;
 
@@ -207,6 +208,20 @@ class File_read
   static void
   print_stats();
 
+  // Start reading ahead the input files named by INPUTS.  This is
+  // used for --prefetch-inputs.
+  static void
+  start_prefetch(const Input_arguments& inputs);
+
+  // Stop reading ahead input files.
+  static void
+  stop_prefetch();
+
+  // Free the memory used to read ahead input files.  This is called
+  // after stop_prefetch and print_stats.
+  static void
+  delete_prefetch();
+
   // Return the open file descriptor (for plugins).
   int
   descriptor()
@@ -247,6 +262,10 @@ class File_read
   // --stats.
   static unsigned long long maximum_mapped_bytes;
 
+  // Total bytes of mapped views for which we asked the kernel to
+  // read ahead, for --prefetch-inputs, if --stats.
+  static unsigned long long total_advised_bytes;
+
   // A view into the file.
   class View
   {
@@ -395,6 +414,10 @@ class File_read
   // The size of a file page for buffering data.
   static const off_t page_size = 8192;
 
+  // With --prefetch-inputs, the minimum size of a mapped view for
+  // which we ask the kernel to read ahead.
+  static const section_size_type advise_view_size = 128 * 1024;
+
   // Given a file offset, return the page offset.
   static off_t
   page_offset(off_t file_offset)
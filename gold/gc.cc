@@ -22,47 +22,263 @@
 
 
 #include "gold.h"
+
+#include <algorithm>
+
 #include "object.h"
 #include "gc.h"
 #include "symtab.h"
+#include "workqueue.h"
+#include "gold-threads.h"
 
 namespace gold
 {
 
+Garbage_collection::~Garbage_collection()
+{
+  delete this->mark_lock_;
+}
+
+// Turn the references recorded by add_reference into the CSR array,
+// and number the sections on the worklist.
+
+void
+Garbage_collection::build_reference_graph(std::vector<unsigned int>* roots)
+{
+  roots->reserve(this->worklist().size());
+  for (Worklist_type::const_iterator p = this->worklist().begin();
+       p != this->worklist().end();
+       ++p)
+    roots->push_back(this->section_number(p->first, p->second));
+  Worklist_type().swap(this->worklist());
+
+  unsigned int count = this->section_count_;
+  this->edge_offsets_.assign(count + 1, 0);
+  for (std::vector<std::pair<unsigned int, unsigned int> >::const_iterator p =
+	 this->edges_.begin();
+       p != this->edges_.end();
+       ++p)
+    ++this->edge_offsets_[p->first + 1];
+  for (unsigned int i = 0; i < count; ++i)
+    this->edge_offsets_[i + 1] += this->edge_offsets_[i];
+
+  // Fill in each row from the front, using the next row's start as
+  // the cursor, and then shift the starts back.
+  this->edge_targets_.resize(this->edges_.size());
+  for (std::vector<std::pair<unsigned int, unsigned int> >::const_iterator p =
+	 this->edges_.begin();
+       p != this->edges_.end();
+       ++p)
+    this->edge_targets_[this->edge_offsets_[p->first]++] = p->second;
+  for (unsigned int i = count; i > 0; --i)
+    this->edge_offsets_[i] = this->edge_offsets_[i - 1];
+  this->edge_offsets_[0] = 0;
+
+  std::vector<std::pair<unsigned int, unsigned int> >().swap(this->edges_);
+
+  this->marks_.assign((count + 31) / 32, 0);
+}
+
+// Free the CSR array once the sections have been marked.
+
+void
+Garbage_collection::release_reference_graph()
+{
+  std::vector<unsigned int>().swap(this->edge_offsets_);
+  std::vector<unsigned int>().swap(this->edge_targets_);
+  this->worklist_ready();
+}
+
+// Mark section N, returning true if it was not already marked.
+
+bool
+Garbage_collection::mark(unsigned int n)
+{
+  uint32_t* word = &this->marks_[n >> 5];
+  uint32_t bit = 1U << (n & 31);
+  if ((*word & bit) != 0)
+    return false;
+#ifdef __GCC_HAVE_SYNC_COMPARE_AND_SWAP_4
+  return (__sync_fetch_and_or(word, bit) & bit) == 0;
+#else
+  Hold_optional_lock hl(this->mark_lock_);
+  if ((*word & bit) != 0)
+    return false;
+  *word |= bit;
+  return true;
+#endif
+}
+
 // Garbage collection uses a worklist style algorithm to determine the 
 // transitive closure of all referenced sections.
 void 
 Garbage_collection::do_transitive_closure()
 {
-  while (!this->worklist().empty())
+  std::vector<unsigned int> stack;
+  this->build_reference_graph(&stack);
+  while (!stack.empty())
     {
-      // Add elements from the work list to the referenced list
-      // one by one.
-      Section_id entry = this->worklist().back();
-      this->worklist().pop_back();
-      if (!this->referenced_list().insert(entry).second)
+      // Mark the elements from the work list one by one.
+      unsigned int entry = stack.back();
+      stack.pop_back();
+      if (!this->mark(entry))
         continue;
-      Garbage_collection::Section_ref::iterator find_it = 
-                this->section_reloc_map().find(entry);
-      if (find_it == this->section_reloc_map().end()) 
-          continue;
-      const Garbage_collection::Sections_reachable &v = find_it->second;
-      // Scan the vector of references for each work_list entry. 
-      for (Garbage_collection::Sections_reachable::const_iterator it_v =
-               v.begin();
-           it_v != v.end();
-           ++it_v)
+      // Scan the references for each work_list entry.
+      for (unsigned int i = this->edge_offsets_[entry];
+	   i < this->edge_offsets_[entry + 1];
+	   ++i)
         {
+	  unsigned int target = this->edge_targets_[i];
           // Do not add already processed sections to the work_list. 
-          if (this->referenced_list().find(*it_v)
-              == this->referenced_list().end())
-            {
-              this->worklist().push_back(*it_v);
-            }
+          if (!this->is_marked(target))
+	    stack.push_back(target);
         }
     }
-  this->worklist_ready();
+  this->release_reference_graph();
 }
 
-} // End namespace gold.
+// A Gc_mark_task marks a set of sections and all the sections they
+// refer to.
+
+class Gc_mark_task : public Task
+{
+ public:
+  Gc_mark_task(Garbage_collection* gc, std::vector<unsigned int>* stack,
+	       Task_token* blocker)
+    : gc_(gc), stack_(), blocker_(blocker)
+  { this->stack_.swap(*stack); }
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  // Unblock BLOCKER_ when done.
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->blocker_); }
+
+  void
+  run(Workqueue* workqueue)
+  { this->gc_->mark_sections(workqueue, &this->stack_, this->blocker_); }
 
+  std::string
+  get_name() const
+  { return "Gc_mark_task"; }
+
+ private:
+  Garbage_collection* gc_;
+  std::vector<unsigned int> stack_;
+  Task_token* const blocker_;
+};
+
+// A task which has more than this many sections waiting to be
+// scanned gives half of them to a new task.
+static const size_t gc_mark_split_size = 2048;
+
+// Mark the sections on *STACK and all the sections they refer to.
+// This is run by several tasks at once.  Any thread which is idle
+// picks up the sections handed off by a busy task.
+
+void
+Garbage_collection::mark_sections(Workqueue* workqueue,
+				  std::vector<unsigned int>* stack,
+				  Task_token* blocker)
+{
+  while (!stack->empty())
+    {
+      unsigned int entry = stack->back();
+      stack->pop_back();
+      if (!this->mark(entry))
+	continue;
+      for (unsigned int i = this->edge_offsets_[entry];
+	   i < this->edge_offsets_[entry + 1];
+	   ++i)
+	{
+	  unsigned int target = this->edge_targets_[i];
+	  if (!this->is_marked(target))
+	    stack->push_back(target);
+	}
+
+      if (stack->size() > gc_mark_split_size)
+	{
+	  // Give the older half of the stack to a new task.
+	  size_t half = stack->size() / 2;
+	  std::vector<unsigned int> rest(stack->begin(),
+					 stack->begin() + half);
+	  stack->erase(stack->begin(), stack->begin() + half);
+	  workqueue->add_blocker(blocker);
+	  workqueue->queue(new Gc_mark_task(this, &rest, blocker));
+#ifdef __GCC_HAVE_SYNC_COMPARE_AND_SWAP_4
+	  __sync_fetch_and_add(&this->split_task_count_, 1);
+#else
+	  {
+	    Hold_optional_lock hl(this->mark_lock_);
+	    ++this->split_task_count_;
+	  }
+#endif
+	}
+    }
+}
+
+// Queue tasks to mark the sections which are kept.  NEXT_BLOCKER is
+// held by each task, and so is unblocked when they are all done.
+
+void
+Garbage_collection::queue_transitive_closure(Workqueue* workqueue,
+					     unsigned int task_count,
+					     Task_token* next_blocker)
+{
+#ifndef __GCC_HAVE_SYNC_COMPARE_AND_SWAP_4
+  if (this->mark_lock_ == NULL)
+    this->mark_lock_ = new Lock();
+#endif
+
+  std::vector<unsigned int> roots;
+  this->build_reference_graph(&roots);
+
+  if (task_count == 0)
+    task_count = 1;
+  size_t chunk_size = (roots.size() + task_count - 1) / task_count;
+  if (chunk_size < 64)
+    chunk_size = 64;
+
+  // Add all the blockers before queueing any of the tasks, since the
+  // tasks may start running right away.
+  size_t chunk_count = (roots.size() + chunk_size - 1) / chunk_size;
+  if (chunk_count > 0)
+    next_blocker->add_blockers(chunk_count);
+  this->mark_task_count_ = chunk_count;
+  for (size_t first = 0; first < roots.size(); first += chunk_size)
+    {
+      size_t last = std::min(first + chunk_size, roots.size());
+      std::vector<unsigned int> chunk(roots.begin() + first,
+				      roots.begin() + last);
+      workqueue->queue(new Gc_mark_task(this, &chunk, next_blocker));
+    }
+}
+
+// Called when all the Gc_mark_tasks are done.
+
+void
+Garbage_collection::finish_transitive_closure()
+{
+  this->release_reference_graph();
+}
+
+// Print statistics to stderr.
+
+void
+Garbage_collection::print_stats() const
+{
+  unsigned int marked = 0;
+  for (unsigned int i = 0; i < this->section_count_; ++i)
+    if (this->is_marked(i))
+      ++marked;
+  fprintf(stderr, _("%s: GC sections tracked: %u; marked: %u\n"),
+	  program_name, this->section_count_, marked);
+  if (this->mark_task_count_ > 0)
+    fprintf(stderr, _("%s: GC mark tasks: %u; split: %u\n"),
+	    program_name, this->mark_task_count_, this->split_task_count_);
+}
+
+} // End namespace gold.
@@ -44,13 +44,24 @@ struct Reloc_types;
 class Output_section;
 class General_options;
 class Layout;
+class Workqueue;
+class Task_token;
+class Lock;
+
+// The references between sections are recorded as pairs of section
+// numbers while the relocs are processed.  Each input section is given
+// a number by adding its index to a base number assigned to its
+// object.  Before the sections are marked, the references are turned
+// into a compressed sparse row (CSR) array: the sections referred to
+// by section N are EDGE_TARGETS_[EDGE_OFFSETS_[N]] up to
+// EDGE_TARGETS_[EDGE_OFFSETS_[N + 1]].  A section is kept if its bit
+// is set in MARKS_.
 
 class Garbage_collection
 {
  public:
 
   typedef Unordered_set<Section_id, Section_id_hash> Sections_reachable;
-  typedef std::map<Section_id, Sections_reachable> Section_ref;
   typedef std::vector<Section_id> Worklist_type;
   // This maps the name of the section which can be represented as a C
   // identifier (cident) to the list of sections that have that name.
@@ -58,18 +69,15 @@ class Garbage_collection
   typedef std::map<std::string, Sections_reachable> Cident_section_map;
 
   Garbage_collection()
-  : is_worklist_ready_(false)
+  : is_worklist_ready_(false), section_base_(), section_count_(0),
+    last_object_(NULL), last_base_(0), edges_(), edge_offsets_(),
+    edge_targets_(), marks_(), mark_lock_(NULL), mark_task_count_(0),
+    split_task_count_(0)
   { }
 
-  // Accessor methods for the private members.
-
-  Sections_reachable&
-  referenced_list()
-  { return referenced_list_; }
+  ~Garbage_collection();
 
-  Section_ref&
-  section_reloc_map()
-  { return this->section_reloc_map_; }
+  // Accessor methods for the private members.
 
   Worklist_type&
   worklist()
@@ -86,10 +94,35 @@ class Garbage_collection
   void
   do_transitive_closure();
 
+  // Does the same as do_transitive_closure, using tasks on WORKQUEUE.
+  // The work is split into about TASK_COUNT tasks to start with; a
+  // task which finds many sections to mark hands some of them to a
+  // new task.  NEXT_BLOCKER is unblocked when all the sections have
+  // been marked, after which finish_transitive_closure must be called.
+  void
+  queue_transitive_closure(Workqueue* workqueue, unsigned int task_count,
+			   Task_token* next_blocker);
+
+  // Finish a transitive closure done by queue_transitive_closure.
+  void
+  finish_transitive_closure();
+
+  // Print statistics to stderr, for --stats.
+  void
+  print_stats() const;
+
+  // Mark the sections in *STACK and all the sections they refer to.
+  // This is called by Gc_mark_task, which holds BLOCKER.
+  void
+  mark_sections(Workqueue* workqueue, std::vector<unsigned int>* stack,
+		Task_token* blocker);
+
   bool
-  is_section_garbage(Relobj* obj, unsigned int shndx)
-  { return (this->referenced_list().find(Section_id(obj, shndx))
-            == this->referenced_list().end()); }
+  is_section_garbage(Relobj* obj, unsigned int shndx) const
+  {
+    unsigned int n = this->find_section_number(obj, shndx);
+    return n == -1U || !this->is_marked(n);
+  }
 
   Cident_section_map*
   cident_sections()
@@ -106,19 +139,92 @@ class Garbage_collection
   add_reference(Relobj* src_object, unsigned int src_shndx,
 		Relobj* dst_object, unsigned int dst_shndx)
   {
-    Section_id src_id(src_object, src_shndx);
-    Section_id dst_id(dst_object, dst_shndx);
-    Sections_reachable& reachable = this->section_reloc_map_[src_id];
-    reachable.insert(dst_id);
+    std::pair<unsigned int, unsigned int>
+      edge(this->section_number(src_object, src_shndx),
+	   this->section_number(dst_object, dst_shndx));
+    // Most relocs refer to the same section as the previous reloc of
+    // the same section, so don't bother recording those twice.
+    if (this->edges_.empty() || this->edges_.back() != edge)
+      this->edges_.push_back(edge);
   }
 
  private:
+  typedef Unordered_map<const Relobj*, unsigned int> Section_base_map;
+
+  // Return the number of section SHNDX of OBJECT, assigning a base
+  // number to OBJECT if it does not have one yet.
+  unsigned int
+  section_number(Relobj* object, unsigned int shndx)
+  {
+    if (object != this->last_object_)
+      {
+	std::pair<Section_base_map::iterator, bool> ins =
+	  this->section_base_.insert(std::make_pair(object,
+						    this->section_count_));
+	if (ins.second)
+	  this->section_count_ += object->shnum();
+	this->last_object_ = object;
+	this->last_base_ = ins.first->second;
+      }
+    gold_assert(shndx < object->shnum());
+    return this->last_base_ + shndx;
+  }
+
+  // Return the number of section SHNDX of OBJECT, or -1U if no
+  // section of OBJECT is referred to.
+  unsigned int
+  find_section_number(const Relobj* object, unsigned int shndx) const
+  {
+    Section_base_map::const_iterator p = this->section_base_.find(object);
+    if (p == this->section_base_.end())
+      return -1U;
+    return p->second + shndx;
+  }
+
+  bool
+  is_marked(unsigned int n) const
+  {
+    return (n < this->section_count_
+	    && (this->marks_[n >> 5] & (1U << (n & 31))) != 0);
+  }
+
+  // Mark section N.  Return true if it was not already marked.  This
+  // may be called by several threads at once.
+  bool
+  mark(unsigned int n);
+
+  // Turn the references into the CSR array, and add the sections on
+  // the worklist to *ROOTS.
+  void
+  build_reference_graph(std::vector<unsigned int>* roots);
+
+  // Free the CSR array, and note that the marks are ready.
+  void
+  release_reference_graph();
 
   Worklist_type work_list_;
   bool is_worklist_ready_;
-  Section_ref section_reloc_map_;
-  Sections_reachable referenced_list_;
   Cident_section_map cident_sections_;
+  // The base section number of each object.
+  Section_base_map section_base_;
+  // The number of section numbers assigned.
+  unsigned int section_count_;
+  // The last object looked up by section_number.
+  Relobj* last_object_;
+  unsigned int last_base_;
+  // The references recorded by add_reference.
+  std::vector<std::pair<unsigned int, unsigned int> > edges_;
+  // The CSR array.
+  std::vector<unsigned int> edge_offsets_;
+  std::vector<unsigned int> edge_targets_;
+  // A bit for each section which is kept.
+  std::vector<uint32_t> marks_;
+  // Used to mark sections if we can not do it atomically.
+  Lock* mark_lock_;
+  // The number of Gc_mark_tasks queued by queue_transitive_closure,
+  // and the number queued by a task which split its work.
+  unsigned int mark_task_count_;
+  unsigned int split_task_count_;
 };
 
 // Data to pass between successive invocations of do_layout
@@ -358,16 +464,14 @@ gc_process_relocs(
                 symtab->gc()->cident_sections()->find(std::string(cident_section_name));
               if (ele == symtab->gc()->cident_sections()->end())
                 continue;
-	      Section_id src_id(src_obj, src_indx);
-              Garbage_collection::Sections_reachable&
-                v(symtab->gc()->section_reloc_map()[src_id]);
               Garbage_collection::Sections_reachable& cident_secn(ele->second);
               for (Garbage_collection::Sections_reachable::iterator it_v
                      = cident_secn.begin();
                    it_v != cident_secn.end();
                    ++it_v)
                 {
-                  v.insert(*it_v);
+                  symtab->gc()->add_reference(src_obj, src_indx,
+                                              it_v->first, it_v->second);
                 }
             }
         }
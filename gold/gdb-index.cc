@@ -22,12 +22,15 @@
 
 #include "gold.h"
 
+#include <algorithm>
+
 #include "gdb-index.h"
 #include "dwarf_reader.h"
 #include "dwarf.h"
 #include "object.h"
 #include "output.h"
 #include "demangle.h"
+#include "workqueue.h"
 
 namespace gold
 {
@@ -171,6 +174,232 @@ mapped_index_string_hash(const unsigned char* str)
   return r;
 }
 
+class Gdb_index_info_reader;
+
+// The index entries found in the .debug_info and .debug_types
+// sections of one input object.  The CU and TU indexes here are local
+// to the object; they are adjusted when the entries are merged into
+// the .gdb_index section.  Since each object has its own
+// Gdb_index_object, the objects may be scanned in parallel.
+
+class Gdb_index_object
+{
+ public:
+  typedef Gdb_index::Cu_vector Cu_vector;
+
+  // A symbol name, with the CUs in which it is found.
+  struct Symbol
+  {
+    Symbol(const char* n, unsigned int h)
+      : name(n), hashval(h), cu_vec()
+    { }
+    const char* name;
+    unsigned int hashval;
+    Cu_vector cu_vec;
+  };
+
+  Gdb_index_object(Relobj* object)
+    : object_(object), scans_(), comp_units_(), type_units_(), ranges_(),
+      names_(), symbols_(), cu_pubname_map_(), cu_pubtype_map_(),
+      pubnames_table_(NULL), pubtypes_table_(NULL), pubnames_mapped_(false),
+      stmt_list_offset_(-1), cu_count_(0), cu_nopubnames_count_(0),
+      tu_count_(0), tu_nopubnames_count_(0)
+  { }
+
+  ~Gdb_index_object()
+  {
+    delete this->pubnames_table_;
+    delete this->pubtypes_table_;
+  }
+
+  // Return the object.
+  Relobj*
+  object() const
+  { return this->object_; }
+
+  // Record a .debug_info or .debug_types section to scan later.
+  void
+  add_scan(bool is_type_unit, unsigned int shndx, unsigned int reloc_shndx,
+	   unsigned int reloc_type)
+  {
+    this->scans_.push_back(Scan(is_type_unit, shndx, reloc_shndx,
+				reloc_type));
+  }
+
+  // Scan the recorded sections.  The object must be locked.
+  void
+  scan_recorded_sections();
+
+  // Scan a .debug_info or .debug_types input section.
+  void
+  scan_debug_info(bool is_type_unit,
+		  const unsigned char* symbols,
+		  off_t symbols_size,
+		  unsigned int shndx,
+		  unsigned int reloc_shndx,
+		  unsigned int reloc_type);
+
+  // Add a compilation unit.
+  int
+  add_comp_unit(off_t cu_offset, off_t cu_length)
+  {
+    ++this->cu_count_;
+    this->comp_units_.push_back(Gdb_index::Comp_unit(cu_offset, cu_length));
+    return this->comp_units_.size() - 1;
+  }
+
+  // Add a type unit.
+  int
+  add_type_unit(off_t tu_offset, off_t type_offset, uint64_t signature)
+  {
+    ++this->tu_count_;
+    this->type_units_.push_back(Gdb_index::Type_unit(tu_offset, type_offset,
+						     signature));
+    return this->type_units_.size() - 1;
+  }
+
+  // Record that we had to parse the DIEs of a CU or TU, because it
+  // had no pubnames or pubtypes.
+  void
+  add_unit_without_pubnames(bool is_type_unit)
+  {
+    if (is_type_unit)
+      ++this->tu_nopubnames_count_;
+    else
+      ++this->cu_nopubnames_count_;
+  }
+
+  // Add an address range.
+  void
+  add_address_range_list(unsigned int cu_index, Dwarf_range_list* ranges)
+  {
+    this->ranges_.push_back(Gdb_index::Per_cu_range_list(this->object_,
+							 cu_index, ranges));
+  }
+
+  // Add a symbol.  FLAGS are the gdb_index version 7 flags to be stored in
+  // the high-byte of the cu_index field.
+  void
+  add_symbol(int cu_index, const char* sym_name, uint8_t flags);
+
+  // Return the offset into the pubnames table for the cu at the given
+  // offset.
+  off_t
+  find_pubname_offset(off_t cu_offset);
+
+  // Return the offset into the pubtypes table for the cu at the
+  // given offset.
+  off_t
+  find_pubtype_offset(off_t cu_offset);
+
+  // Return TRUE if we have already processed the pubnames and types
+  // set of the CUs and TUS associated with the statement list at
+  // OFFSET.
+  bool
+  pubnames_read(off_t offset) const
+  { return this->stmt_list_offset_ == offset; }
+
+  // Record that we have already read the pubnames associated with
+  // OFFSET.
+  void
+  set_pubnames_read(off_t offset)
+  { this->stmt_list_offset_ = offset; }
+
+  // Return a pointer to the given table.
+  Dwarf_pubnames_table*
+  pubnames_table()
+  { return this->pubnames_table_; }
+
+  Dwarf_pubnames_table*
+  pubtypes_table()
+  { return this->pubtypes_table_; }
+
+  // Accessors for merging the entries into the .gdb_index section.
+
+  const std::vector<Gdb_index::Comp_unit>&
+  comp_units() const
+  { return this->comp_units_; }
+
+  const std::vector<Gdb_index::Type_unit>&
+  type_units() const
+  { return this->type_units_; }
+
+  const std::vector<Gdb_index::Per_cu_range_list>&
+  ranges() const
+  { return this->ranges_; }
+
+  const std::vector<Symbol>&
+  symbols() const
+  { return this->symbols_; }
+
+  // Add the statistics for this object to the totals.
+  void
+  add_stats() const;
+
+ private:
+  // A .debug_info or .debug_types section waiting to be scanned.
+  struct Scan
+  {
+    Scan(bool type_unit, unsigned int section, unsigned int reloc_section,
+	 unsigned int rtype)
+      : is_type_unit(type_unit), shndx(section), reloc_shndx(reloc_section),
+	reloc_type(rtype)
+    { }
+    bool is_type_unit;
+    unsigned int shndx;
+    unsigned int reloc_shndx;
+    unsigned int reloc_type;
+  };
+
+  typedef Unordered_map<off_t, off_t> Pubname_offset_map;
+
+  // Create a map from dies to pubnames.
+  Dwarf_pubnames_table*
+  map_pubtable_to_dies(unsigned int attr,
+                       Gdb_index_info_reader* dwinfo,
+                       const unsigned char* symbols,
+                       off_t symbols_size);
+
+  // Wrapper for map_pubtable_to_dies
+  void
+  map_pubnames_and_types_to_dies(Gdb_index_info_reader* dwinfo,
+                                 const unsigned char* symbols,
+                                 off_t symbols_size);
+
+  // The object.
+  Relobj* object_;
+  // The sections to scan, when scanning in a task.
+  std::vector<Scan> scans_;
+  // The list of DWARF compilation units.
+  std::vector<Gdb_index::Comp_unit> comp_units_;
+  // The list of DWARF type units.
+  std::vector<Gdb_index::Type_unit> type_units_;
+  // The list of address ranges.
+  std::vector<Gdb_index::Per_cu_range_list> ranges_;
+  // The symbol names.  The key of a name in this pool, less one, is
+  // its index in SYMBOLS_.
+  Stringpool names_;
+  // The symbols, in the order in which they were first seen.
+  std::vector<Symbol> symbols_;
+  // Maps from a CU offset to its entry in the pubnames and pubtypes
+  // tables.
+  Pubname_offset_map cu_pubname_map_;
+  Pubname_offset_map cu_pubtype_map_;
+  // Tables to store the pubnames sections of the object.
+  Dwarf_pubnames_table* pubnames_table_;
+  Dwarf_pubnames_table* pubtypes_table_;
+  // Whether the pubnames and pubtypes tables have been read.
+  bool pubnames_mapped_;
+  // Stmt list offset of the CUs and TUs associated with the last
+  // read pubnames and pubtypes sections.
+  off_t stmt_list_offset_;
+  // Statistics.
+  unsigned int cu_count_;
+  unsigned int cu_nopubnames_count_;
+  unsigned int tu_count_;
+  unsigned int tu_nopubnames_count_;
+};
+
 // A specialization of Dwarf_info_reader, for building the .gdb_index.
 
 class Gdb_index_info_reader : public Dwarf_info_reader
@@ -183,7 +412,7 @@ class Gdb_index_info_reader : public Dwarf_info_reader
 			unsigned int shndx,
 			unsigned int reloc_shndx,
 			unsigned int reloc_type,
-			Gdb_index* gdb_index)
+			Gdb_index_object* gdb_index)
     : Dwarf_info_reader(is_type_unit, object, symbols, symbols_size, shndx,
 			reloc_shndx, reloc_type),
       gdb_index_(gdb_index), cu_index_(0), cu_language_(0)
@@ -192,6 +421,11 @@ class Gdb_index_info_reader : public Dwarf_info_reader
   ~Gdb_index_info_reader()
   { this->clear_declarations(); }
 
+  // Add to the usage statistics.
+  static void
+  add_stats(unsigned int cu_count, unsigned int cu_nopubnames_count,
+	    unsigned int tu_count, unsigned int tu_nopubnames_count);
+
   // Print usage statistics.
   static void
   print_stats();
@@ -285,8 +519,8 @@ class Gdb_index_info_reader : public Dwarf_info_reader
   void
   clear_declarations();
 
-  // The Gdb_index section.
-  Gdb_index* gdb_index_;
+  // The index entries for the object.
+  Gdb_index_object* gdb_index_;
   // The current CU index (negative for a TU).
   int cu_index_;
   // The language of the current CU or TU.
@@ -321,7 +555,6 @@ void
 Gdb_index_info_reader::visit_compilation_unit(off_t cu_offset, off_t cu_length,
 					      Dwarf_die* root_die)
 {
-  ++Gdb_index_info_reader::dwarf_cu_count;
   this->cu_index_ = this->gdb_index_->add_comp_unit(cu_offset, cu_length);
   this->visit_top_die(root_die);
 }
@@ -333,7 +566,6 @@ Gdb_index_info_reader::visit_type_unit(off_t tu_offset, off_t,
 				       off_t type_offset, uint64_t signature,
 				       Dwarf_die* root_die)
 {
-  ++Gdb_index_info_reader::dwarf_tu_count;
   // Use a negative index to flag this as a TU instead of a CU.
   this->cu_index_ = -1 - this->gdb_index_->add_type_unit(tu_offset, type_offset,
 							 signature);
@@ -380,10 +612,8 @@ Gdb_index_info_reader::visit_top_die(Dwarf_die* die)
 			     this->object()->name().c_str());
 		return;
 	      }
-	    if (die->tag() == elfcpp::DW_TAG_compile_unit)
-	      ++Gdb_index_info_reader::dwarf_cu_nopubnames_count;
-	    else
-	      ++Gdb_index_info_reader::dwarf_tu_nopubnames_count;
+	    this->gdb_index_->add_unit_without_pubnames(
+		die->tag() != elfcpp::DW_TAG_compile_unit);
 	    this->visit_children(die, NULL);
 	  }
 	break;
@@ -825,8 +1055,7 @@ Gdb_index_info_reader::record_cu_ranges(Dwarf_die* die)
     {
       Dwarf_range_list* ranges = this->read_range_list(shndx, ranges_offset);
       if (ranges != NULL)
-	this->gdb_index_->add_address_range_list(this->object(),
-						 this->cu_index_, ranges);
+	this->gdb_index_->add_address_range_list(this->cu_index_, ranges);
       return;
     }
 
@@ -851,8 +1080,7 @@ Gdb_index_info_reader::record_cu_ranges(Dwarf_die* die)
         {
 	  Dwarf_range_list* ranges = new Dwarf_range_list();
 	  ranges->add(shndx, low_pc, high_pc);
-	  this->gdb_index_->add_address_range_list(this->object(),
-						   this->cu_index_, ranges);
+	  this->gdb_index_->add_address_range_list(this->cu_index_, ranges);
         }
     }
 }
@@ -916,8 +1144,7 @@ Gdb_index_info_reader::read_pubnames_and_pubtypes(Dwarf_die* die)
           // have read. If it does, then no need to read the pubnames.
           // If it doesn't, then the caller will have to parse the
           // dies manually to find the names.
-          return this->gdb_index_->pubnames_read(this->object(),
-                                                 stmt_list_off);
+          return this->gdb_index_->pubnames_read(stmt_list_off);
         }
       else
         {
@@ -928,10 +1155,10 @@ Gdb_index_info_reader::read_pubnames_and_pubtypes(Dwarf_die* die)
 
   // We found the attribute, so we can check if the corresponding
   // pubnames have been read.
-  if (this->gdb_index_->pubnames_read(this->object(), stmt_list_off))
+  if (this->gdb_index_->pubnames_read(stmt_list_off))
     return true;
 
-  this->gdb_index_->set_pubnames_read(this->object(), stmt_list_off);
+  this->gdb_index_->set_pubnames_read(stmt_list_off);
 
   // We have an attribute, and the pubnames haven't been read, so read
   // them.
@@ -964,6 +1191,21 @@ Gdb_index_info_reader::clear_declarations()
   this->declarations_.clear();
 }
 
+// Add to the usage statistics.  This is called when merging the
+// entries of an object, so it need not be thread-safe.
+
+void
+Gdb_index_info_reader::add_stats(unsigned int cu_count,
+				 unsigned int cu_nopubnames_count,
+				 unsigned int tu_count,
+				 unsigned int tu_nopubnames_count)
+{
+  Gdb_index_info_reader::dwarf_cu_count += cu_count;
+  Gdb_index_info_reader::dwarf_cu_nopubnames_count += cu_nopubnames_count;
+  Gdb_index_info_reader::dwarf_tu_count += tu_count;
+  Gdb_index_info_reader::dwarf_tu_nopubnames_count += tu_nopubnames_count;
+}
+
 // Print usage statistics.
 void
 Gdb_index_info_reader::print_stats()
@@ -978,53 +1220,44 @@ Gdb_index_info_reader::print_stats()
           program_name, Gdb_index_info_reader::dwarf_tu_nopubnames_count);
 }
 
-// Class Gdb_index.
+// Class Gdb_index_object.
 
-// Construct the .gdb_index section.
+// Scan the sections recorded by add_scan.  We need the symbol table
+// to interpret the relocations, so we read it again here.
 
-Gdb_index::Gdb_index(Output_section* gdb_index_section)
-  : Output_section_data(4),
-    pubnames_table_(NULL),
-    pubtypes_table_(NULL),
-    gdb_index_section_(gdb_index_section),
-    comp_units_(),
-    type_units_(),
-    ranges_(),
-    cu_vector_list_(),
-    cu_vector_offsets_(NULL),
-    stringpool_(),
-    tu_offset_(0),
-    addr_offset_(0),
-    symtab_offset_(0),
-    cu_pool_offset_(0),
-    stringpool_offset_(0),
-    pubnames_object_(NULL),
-    stmt_list_offset_(-1)
+void
+Gdb_index_object::scan_recorded_sections()
 {
-  this->gdb_symtab_ = new Gdb_hashtab<Gdb_symbol>();
-}
+  Relobj* object = this->object_;
+  const unsigned char* symbols = NULL;
+  section_size_type symbols_size = 0;
+  for (unsigned int i = 1; i < object->shnum(); ++i)
+    {
+      if (object->section_type(i) == elfcpp::SHT_SYMTAB)
+	{
+	  symbols = object->section_contents(i, &symbols_size, false);
+	  break;
+	}
+    }
 
-Gdb_index::~Gdb_index()
-{
-  // Free the memory used by the symbol table.
-  delete this->gdb_symtab_;
-  // Free the memory used by the CU vectors.
-  for (unsigned int i = 0; i < this->cu_vector_list_.size(); ++i)
-    delete this->cu_vector_list_[i];
+  for (std::vector<Scan>::const_iterator p = this->scans_.begin();
+       p != this->scans_.end();
+       ++p)
+    this->scan_debug_info(p->is_type_unit, symbols, symbols_size, p->shndx,
+			  p->reloc_shndx, p->reloc_type);
+  this->scans_.clear();
 }
 
-
 // Scan the pubnames and pubtypes sections and build a map of the
 // various cus and tus they refer to, so we can process the entries
 // when we encounter the die for that cu or tu.
 // Return the just-read table so it can be cached.
 
 Dwarf_pubnames_table*
-Gdb_index::map_pubtable_to_dies(unsigned int attr,
-                                Gdb_index_info_reader* dwinfo,
-                                Relobj* object,
-                                const unsigned char* symbols,
-                                off_t symbols_size)
+Gdb_index_object::map_pubtable_to_dies(unsigned int attr,
+				       Gdb_index_info_reader* dwinfo,
+				       const unsigned char* symbols,
+				       off_t symbols_size)
 {
   uint64_t section_offset = 0;
   Dwarf_pubnames_table* table;
@@ -1042,7 +1275,7 @@ Gdb_index::map_pubtable_to_dies(unsigned int attr,
     }
 
   map->clear();
-  if (!table->read_section(object, symbols, symbols_size))
+  if (!table->read_section(this->object_, symbols, symbols_size))
     return NULL;
 
   while (table->read_header(section_offset))
@@ -1057,30 +1290,28 @@ Gdb_index::map_pubtable_to_dies(unsigned int attr,
 // Wrapper for map_pubtable_to_dies
 
 void
-Gdb_index::map_pubnames_and_types_to_dies(Gdb_index_info_reader* dwinfo,
-                                          Relobj* object,
-                                          const unsigned char* symbols,
-                                          off_t symbols_size)
+Gdb_index_object::map_pubnames_and_types_to_dies(
+    Gdb_index_info_reader* dwinfo,
+    const unsigned char* symbols,
+    off_t symbols_size)
 {
-  // This is a new object, so reset the relevant variables.
-  this->pubnames_object_ = object;
   this->stmt_list_offset_ = -1;
 
   delete this->pubnames_table_;
   this->pubnames_table_
       = this->map_pubtable_to_dies(elfcpp::DW_AT_GNU_pubnames, dwinfo,
-                                   object, symbols, symbols_size);
+                                   symbols, symbols_size);
   delete this->pubtypes_table_;
   this->pubtypes_table_
       = this->map_pubtable_to_dies(elfcpp::DW_AT_GNU_pubtypes, dwinfo,
-                                   object, symbols, symbols_size);
+                                   symbols, symbols_size);
 }
 
 // Given a cu_offset, find the associated section of the pubnames
 // table.
 
 off_t
-Gdb_index::find_pubname_offset(off_t cu_offset)
+Gdb_index_object::find_pubname_offset(off_t cu_offset)
 {
   Pubname_offset_map::iterator it = this->cu_pubname_map_.find(cu_offset);
   if (it != this->cu_pubname_map_.end())
@@ -1092,7 +1323,7 @@ Gdb_index::find_pubname_offset(off_t cu_offset)
 // table.
 
 off_t
-Gdb_index::find_pubtype_offset(off_t cu_offset)
+Gdb_index_object::find_pubtype_offset(off_t cu_offset)
 {
   Pubname_offset_map::iterator it = this->cu_pubtype_map_.find(cu_offset);
   if (it != this->cu_pubtype_map_.end())
@@ -1103,78 +1334,275 @@ Gdb_index::find_pubtype_offset(off_t cu_offset)
 // Scan a .debug_info or .debug_types input section.
 
 void
-Gdb_index::scan_debug_info(bool is_type_unit,
-			   Relobj* object,
-			   const unsigned char* symbols,
-			   off_t symbols_size,
-			   unsigned int shndx,
-			   unsigned int reloc_shndx,
-			   unsigned int reloc_type)
+Gdb_index_object::scan_debug_info(bool is_type_unit,
+				  const unsigned char* symbols,
+				  off_t symbols_size,
+				  unsigned int shndx,
+				  unsigned int reloc_shndx,
+				  unsigned int reloc_type)
 {
-  Gdb_index_info_reader dwinfo(is_type_unit, object,
+  Gdb_index_info_reader dwinfo(is_type_unit, this->object_,
 			       symbols, symbols_size,
 			       shndx, reloc_shndx,
 			       reloc_type, this);
-  if (object != this->pubnames_object_)
-    map_pubnames_and_types_to_dies(&dwinfo, object, symbols, symbols_size);
+  if (!this->pubnames_mapped_)
+    {
+      this->map_pubnames_and_types_to_dies(&dwinfo, symbols, symbols_size);
+      this->pubnames_mapped_ = true;
+    }
   dwinfo.parse();
 }
 
-// Add a symbol.
+// Add a symbol.  Each name is recorded once per object, so the
+// merge only has to look up each name in the .gdb_index symbol table
+// once for each object in which it appears.
 
 void
-Gdb_index::add_symbol(int cu_index, const char* sym_name, uint8_t flags)
+Gdb_index_object::add_symbol(int cu_index, const char* sym_name,
+			     uint8_t flags)
 {
-  unsigned int hash = mapped_index_string_hash(
-      reinterpret_cast<const unsigned char*>(sym_name));
-  Gdb_symbol* sym = new Gdb_symbol();
-  this->stringpool_.add(sym_name, true, &sym->name_key);
-  sym->hashval = hash;
-  sym->cu_vector_index = 0;
-
-  Gdb_symbol* found = this->gdb_symtab_->add(sym);
-  if (found == sym)
+  Stringpool::Key key;
+  const char* name = this->names_.add(sym_name, true, &key);
+  if (key > this->symbols_.size())
     {
-      // New symbol -- allocate a new CU index vector.
-      found->cu_vector_index = this->cu_vector_list_.size();
-      this->cu_vector_list_.push_back(new Cu_vector());
-    }
-  else
-    {
-      // Found an existing symbol -- append to the existing
-      // CU index vector.
-      delete sym;
+      // New symbol.
+      gold_assert(key == this->symbols_.size() + 1);
+      unsigned int hash = mapped_index_string_hash(
+	  reinterpret_cast<const unsigned char*>(name));
+      this->symbols_.push_back(Symbol(name, hash));
     }
 
   // Add the CU index to the vector list for this symbol,
   // if it's not already on the list.  We only need to
-  // check the last added entry.
-  Cu_vector* cu_vec = this->cu_vector_list_[found->cu_vector_index];
-  if (cu_vec->size() == 0
+  // check the last added entry here; the vectors are sorted
+  // and any other duplicates removed when the section size
+  // is set.
+  Cu_vector* cu_vec = &this->symbols_[key - 1].cu_vec;
+  if (cu_vec->empty()
       || cu_vec->back().first != cu_index
       || cu_vec->back().second != flags)
     cu_vec->push_back(std::make_pair(cu_index, flags));
 }
 
-// Return TRUE if we have already processed the pubnames associated
-// with the statement list at the given OFFSET.
+// Add the statistics for this object to the totals.
 
-bool
-Gdb_index::pubnames_read(const Relobj* object, off_t offset)
+void
+Gdb_index_object::add_stats() const
 {
-  bool ret = (this->pubnames_object_ == object
-	      && this->stmt_list_offset_ == offset);
-  return ret;
+  Gdb_index_info_reader::add_stats(this->cu_count_, this->cu_nopubnames_count_,
+				   this->tu_count_, this->tu_nopubnames_count_);
+}
+
+// A task to scan the .debug_info and .debug_types sections of one
+// object.
+
+class Gdb_index_scan_task : public Task
+{
+ public:
+  Gdb_index_scan_task(Gdb_index_object* gdb_object, Task_token* blocker)
+    : gdb_object_(gdb_object), blocker_(blocker)
+  { }
+
+  // We need to lock the object.
+  Task_token*
+  is_runnable()
+  {
+    Relobj* object = this->gdb_object_->object();
+    return object->is_locked() ? object->token() : NULL;
+  }
+
+  // Lock the object, and unblock BLOCKER_ when done.
+  void
+  locks(Task_locker* tl)
+  {
+    Task_token* token = this->gdb_object_->object()->token();
+    if (token != NULL)
+      tl->add(this, token);
+    tl->add(this, this->blocker_);
+  }
+
+  void
+  run(Workqueue*)
+  {
+    this->gdb_object_->scan_recorded_sections();
+    this->gdb_object_->object()->release();
+  }
+
+  std::string
+  get_name() const
+  {
+    return ("Gdb_index_scan_task "
+	    + this->gdb_object_->object()->name());
+  }
+
+ private:
+  Gdb_index_object* gdb_object_;
+  Task_token* const blocker_;
+};
+
+// Class Gdb_index.
+
+// Construct the .gdb_index section.
+
+Gdb_index::Gdb_index(Output_section* gdb_index_section)
+  : Output_section_data(4),
+    gdb_index_section_(gdb_index_section),
+    comp_units_(),
+    type_units_(),
+    ranges_(),
+    cu_vector_list_(),
+    cu_vector_offsets_(NULL),
+    stringpool_(),
+    tu_offset_(0),
+    addr_offset_(0),
+    symtab_offset_(0),
+    cu_pool_offset_(0),
+    stringpool_offset_(0),
+    objects_(),
+    scan_in_parallel_(parameters->options().threads())
+{
+  this->gdb_symtab_ = new Gdb_hashtab<Gdb_symbol>();
+}
+
+Gdb_index::~Gdb_index()
+{
+  // Free the memory used by the symbol table.
+  delete this->gdb_symtab_;
+  // Free the memory used by the CU vectors.
+  for (unsigned int i = 0; i < this->cu_vector_list_.size(); ++i)
+    delete this->cu_vector_list_[i];
+  for (unsigned int i = 0; i < this->objects_.size(); ++i)
+    delete this->objects_[i];
+}
+
+// Scan a .debug_info or .debug_types input section.  The sections of
+// an object are scanned one after the other, so we start a new
+// Gdb_index_object when the object changes.  When scanning serially,
+// that is also the time to merge the previous object, so that we do
+// not hold on to the entries of every object.
+
+void
+Gdb_index::scan_debug_info(bool is_type_unit,
+			   Relobj* object,
+			   const unsigned char* symbols,
+			   off_t symbols_size,
+			   unsigned int shndx,
+			   unsigned int reloc_shndx,
+			   unsigned int reloc_type)
+{
+  if (this->objects_.empty() || this->objects_.back()->object() != object)
+    {
+      if (!this->scan_in_parallel_)
+	this->merge_objects();
+      this->objects_.push_back(new Gdb_index_object(object));
+    }
+
+  Gdb_index_object* gdb_object = this->objects_.back();
+  if (this->scan_in_parallel_)
+    gdb_object->add_scan(is_type_unit, shndx, reloc_shndx, reloc_type);
+  else
+    gdb_object->scan_debug_info(is_type_unit, symbols, symbols_size, shndx,
+				reloc_shndx, reloc_type);
+}
+
+// Queue a task to scan each object.
+
+void
+Gdb_index::queue_scan_tasks(Workqueue* workqueue, Task_token* blocker)
+{
+  if (!this->scan_in_parallel_)
+    return;
+
+  for (std::vector<Gdb_index_object*>::const_iterator p =
+	 this->objects_.begin();
+       p != this->objects_.end();
+       ++p)
+    {
+      workqueue->add_blocker(blocker);
+      workqueue->queue(new Gdb_index_scan_task(*p, blocker));
+      ++Gdb_index::scan_task_count;
+    }
 }
 
-// Record that we have processed the pubnames associated with the
-// statement list for OBJECT at the given OFFSET.
+// Merge the entries of the scanned objects.  We always do this in
+// input order, so that the CU indexes, the layout of the symbol
+// table, and the order of the strings do not depend on how the
+// objects were scanned.
 
 void
-Gdb_index::set_pubnames_read(const Relobj* object, off_t offset)
+Gdb_index::merge_objects()
 {
-  this->pubnames_object_ = object;
-  this->stmt_list_offset_ = offset;
+  for (std::vector<Gdb_index_object*>::const_iterator p =
+	 this->objects_.begin();
+       p != this->objects_.end();
+       ++p)
+    {
+      const Gdb_index_object* gdb_object = *p;
+
+      // The CU and TU indexes of the object start after those of
+      // the objects already merged.  TU indexes are negative.
+      const int cu_base = this->comp_units_.size();
+      const int tu_base = this->type_units_.size();
+
+      this->comp_units_.insert(this->comp_units_.end(),
+			       gdb_object->comp_units().begin(),
+			       gdb_object->comp_units().end());
+      this->type_units_.insert(this->type_units_.end(),
+			       gdb_object->type_units().begin(),
+			       gdb_object->type_units().end());
+
+      const std::vector<Per_cu_range_list>& ranges(gdb_object->ranges());
+      for (std::vector<Per_cu_range_list>::const_iterator q = ranges.begin();
+	   q != ranges.end();
+	   ++q)
+	{
+	  int cu_index = q->cu_index;
+	  cu_index += cu_index >= 0 ? cu_base : -tu_base;
+	  this->ranges_.push_back(Per_cu_range_list(q->object, cu_index,
+						    q->ranges));
+	}
+
+      const std::vector<Gdb_index_object::Symbol>&
+	symbols(gdb_object->symbols());
+      for (std::vector<Gdb_index_object::Symbol>::const_iterator q =
+	     symbols.begin();
+	   q != symbols.end();
+	   ++q)
+	{
+	  Gdb_symbol* sym = new Gdb_symbol();
+	  this->stringpool_.add(q->name, true, &sym->name_key);
+	  sym->hashval = q->hashval;
+	  sym->cu_vector_index = 0;
+
+	  Gdb_symbol* found = this->gdb_symtab_->add(sym);
+	  if (found == sym)
+	    {
+	      // New symbol -- allocate a new CU index vector.
+	      found->cu_vector_index = this->cu_vector_list_.size();
+	      this->cu_vector_list_.push_back(new Cu_vector());
+	    }
+	  else
+	    {
+	      // Found an existing symbol -- append to the existing
+	      // CU index vector.
+	      delete sym;
+	    }
+
+	  Cu_vector* cu_vec = this->cu_vector_list_[found->cu_vector_index];
+	  for (Cu_vector::const_iterator r = q->cu_vec.begin();
+	       r != q->cu_vec.end();
+	       ++r)
+	    {
+	      int cu_index = r->first;
+	      cu_index += cu_index >= 0 ? cu_base : -tu_base;
+	      cu_vec->push_back(std::make_pair(cu_index, r->second));
+	    }
+	}
+
+      gdb_object->add_stats();
+      delete gdb_object;
+    }
+  this->objects_.clear();
 }
 
 // Set the size of the .gdb_index section.
@@ -1182,6 +1610,24 @@ Gdb_index::set_pubnames_read(const Relobj* object, off_t offset)
 void
 Gdb_index::set_final_data_size()
 {
+  // Merge any objects which we have not yet merged.
+  this->merge_objects();
+
+  // Translate negative indexes in the CU vectors, which refer to a
+  // TU, to a logical index into a concatenated CU/TU list.  Then sort
+  // each vector, and remove duplicate entries.
+  const int comp_units_count = this->comp_units_.size();
+  for (unsigned int i = 0; i < this->cu_vector_list_.size(); ++i)
+    {
+      Cu_vector* cu_vec = this->cu_vector_list_[i];
+      for (Cu_vector::iterator p = cu_vec->begin(); p != cu_vec->end(); ++p)
+	if (p->first < 0)
+	  p->first = comp_units_count + (-1 - p->first);
+      std::sort(cu_vec->begin(), cu_vec->end());
+      cu_vec->erase(std::unique(cu_vec->begin(), cu_vec->end()),
+		    cu_vec->end());
+    }
+
   // Finalize the string pool.
   this->stringpool_.set_string_offsets();
 
@@ -1332,8 +1778,6 @@ Gdb_index::do_write(Output_file* of)
 	{
 	  int cu_index = (*cu_vec)[j].first;
           uint8_t flags = (*cu_vec)[j].second;
-	  if (cu_index < 0)
-	    cu_index = comp_units_count + (-1 - cu_index);
           cu_index |= flags << 24;
 	  elfcpp::Swap<32, false>::writeval(pov, cu_index);
 	  pov += 4;
@@ -1348,12 +1792,19 @@ Gdb_index::do_write(Output_file* of)
   of->write_output_view(off, oview_size, oview);
 }
 
+unsigned int Gdb_index::scan_task_count = 0;
+
 // Print usage statistics.
 void
 Gdb_index::print_stats()
 {
   if (parameters->options().gdb_index())
-    Gdb_index_info_reader::print_stats();
+    {
+      Gdb_index_info_reader::print_stats();
+      if (Gdb_index::scan_task_count > 0)
+	fprintf(stderr, _("%s: gdb index scan tasks: %u\n"),
+		program_name, Gdb_index::scan_task_count);
+    }
 }
 
 } // End namespace gold.
@@ -45,6 +45,7 @@
 #include "gc.h"
 #include "icf.h"
 #include "incremental.h"
+#include "call-graph.h"
 #include "timer.h"
 
 namespace gold
@@ -134,6 +135,87 @@ Middle_runner::run(Workqueue* workqueue, const Task* task)
 		     this->layout_, workqueue, this->mapfile_);
 }
 
+// Return the number of threads to use for the middle set of tasks.
+
+static int
+middle_thread_count(const General_options& options,
+		    const Input_objects* input_objects)
+{
+  int thread_count = options.thread_count_middle();
+  if (thread_count == 0)
+    thread_count = std::max(2, input_objects->number_of_input_objects());
+  return thread_count;
+}
+
+// This class arranges to run the functions done in the middle of the
+// link after the sections to keep for garbage collection have been
+// marked in parallel.
+
+class Middle_icf_runner : public Task_function_runner
+{
+ public:
+  Middle_icf_runner(const General_options& options,
+		    const Input_objects* input_objects,
+		    Symbol_table* symtab,
+		    Layout* layout, Mapfile* mapfile)
+    : options_(options), input_objects_(input_objects), symtab_(symtab),
+      layout_(layout), mapfile_(mapfile)
+  { }
+
+  void
+  run(Workqueue*, const Task*);
+
+ private:
+  const General_options& options_;
+  const Input_objects* input_objects_;
+  Symbol_table* symtab_;
+  Layout* layout_;
+  Mapfile* mapfile_;
+};
+
+void
+Middle_icf_runner::run(Workqueue* workqueue, const Task* task)
+{
+  this->symtab_->gc()->finish_transitive_closure();
+  queue_middle_icf_tasks(this->options_, task, this->input_objects_,
+			 this->symtab_, this->layout_, workqueue,
+			 this->mapfile_);
+}
+
+// This class arranges to run the rest of the functions done in the
+// middle of the link, after identical code folding has been done in
+// parallel.
+
+class Middle_layout_runner : public Task_function_runner
+{
+ public:
+  Middle_layout_runner(const General_options& options,
+		       const Input_objects* input_objects,
+		       Symbol_table* symtab,
+		       Layout* layout, Mapfile* mapfile)
+    : options_(options), input_objects_(input_objects), symtab_(symtab),
+      layout_(layout), mapfile_(mapfile)
+  { }
+
+  void
+  run(Workqueue*, const Task*);
+
+ private:
+  const General_options& options_;
+  const Input_objects* input_objects_;
+  Symbol_table* symtab_;
+  Layout* layout_;
+  Mapfile* mapfile_;
+};
+
+void
+Middle_layout_runner::run(Workqueue* workqueue, const Task* task)
+{
+  queue_middle_layout_tasks(this->options_, task, this->input_objects_,
+			    this->symtab_, this->layout_, workqueue,
+			    this->mapfile_);
+}
+
 // This class arranges the tasks to process the relocs for garbage collection.
 
 class Gc_runner : public Task_function_runner
@@ -195,6 +277,18 @@ queue_initial_tasks(const General_options& options,
     thread_count = cmdline.number_of_input_files();
   workqueue->set_thread_count(thread_count);
 
+  // Split the symbol table into shards so that the symbols of
+  // different object files can be added at the same time.  We don't
+  // do this for cases which look at the symbol table in ways which
+  // depend on the order in which symbols are added across shards.
+  if (options.threads()
+      && options.symtab_shards() > 1
+      && !options.has_plugins()
+      && !options.any_wrap()
+      && !options.relocatable()
+      && !parameters->incremental())
+    symtab->set_shard_count(options.symtab_shards());
+
   // For incremental links, the base output file.
   Incremental_binary* ibase = NULL;
 
@@ -283,6 +377,15 @@ queue_initial_tasks(const General_options& options,
       && (options.gc_sections() || options.icf_enabled()))
     gold_error(_("cannot mix -r with --gc-sections or --icf"));
 
+  if (symtab->is_sharded())
+    {
+      Task_token* next_blocker = new Task_token(true);
+      next_blocker->add_blocker();
+      workqueue->queue(new Finish_symbols(symtab, this_blocker,
+					  next_blocker));
+      this_blocker = next_blocker;
+    }
+
   if (options.gc_sections() || options.icf_enabled())
     {
       workqueue->queue(new Task_function(new Gc_runner(options,
@@ -513,18 +616,95 @@ queue_middle_tasks(const General_options& options,
       // Symbols named with -u should not be considered garbage.
       symtab->gc_mark_undef_symbols(layout);
       gold_assert(symtab->gc() != NULL);
+      if (parameters->options().threads()
+	  && parameters->options().parallel_gc())
+	{
+	  // Mark the sections which are kept with a set of tasks, and
+	  // carry on when they are done.
+	  int thread_count = middle_thread_count(options, input_objects);
+	  workqueue->set_thread_count(thread_count);
+
+	  Task_token* next_blocker = new Task_token(true);
+	  symtab->gc()->queue_transitive_closure(workqueue, thread_count,
+						 next_blocker);
+	  workqueue->queue(new Task_function(new Middle_icf_runner(options,
+								   input_objects,
+								   symtab,
+								   layout,
+								   mapfile),
+					     next_blocker,
+					     "Task_function Middle_icf_runner"));
+	  return;
+	}
+
       // Do a transitive closure on all references to determine the worklist.
       symtab->gc()->do_transitive_closure();
     }
 
+  queue_middle_icf_tasks(options, task, input_objects, symtab, layout,
+			 workqueue, mapfile);
+}
+
+// Queue up the part of the middle set of tasks which follows garbage
+// collection: identical code folding, if any, and the rest of the
+// layout.
+
+void
+queue_middle_icf_tasks(const General_options& options,
+		       const Task* task,
+		       const Input_objects* input_objects,
+		       Symbol_table* symtab,
+		       Layout* layout,
+		       Workqueue* workqueue,
+		       Mapfile* mapfile)
+{
   // If identical code folding (--icf) is chosen it makes sense to do it
   // only after garbage collection (--gc-sections) as we do not want to
   // be folding sections that will be garbage.
   if (parameters->options().icf_enabled())
     {
+      if (parameters->options().threads()
+	  && parameters->options().parallel_icf())
+	{
+	  // Find the identical sections with a set of tasks, and
+	  // carry on with the layout when they are done.
+	  int thread_count = middle_thread_count(options, input_objects);
+	  workqueue->set_thread_count(thread_count);
+
+	  Task_token* next_blocker = new Task_token(true);
+	  next_blocker->add_blocker();
+	  symtab->icf()->queue_find_identical_sections(
+	      workqueue, input_objects, symtab,
+	      std::min(thread_count, 64), next_blocker);
+	  workqueue->queue(new Task_function(new Middle_layout_runner(options,
+								      input_objects,
+								      symtab,
+								      layout,
+								      mapfile),
+					     next_blocker,
+					     "Task_function Middle_layout_runner"));
+	  return;
+	}
+
       symtab->icf()->find_identical_sections(input_objects, symtab);
     }
 
+  queue_middle_layout_tasks(options, task, input_objects, symtab, layout,
+			    workqueue, mapfile);
+}
+
+// Queue up the rest of the middle set of tasks, after any garbage
+// collection and identical code folding have been done.
+
+void
+queue_middle_layout_tasks(const General_options& options,
+			  const Task* task,
+			  const Input_objects* input_objects,
+			  Symbol_table* symtab,
+			  Layout* layout,
+			  Workqueue* workqueue,
+			  Mapfile* mapfile)
+{
   // Call Object::layout for the second time to determine the
   // output_sections for all referenced input sections.  When
   // --gc-sections or --icf is turned on, or when certain input
@@ -569,6 +749,11 @@ queue_middle_tasks(const General_options& options,
 	(*p)->update_section_layout(layout->get_section_order_map());
     }
 
+  // If a call graph profile was given, order the sections which
+  // define the functions it names.
+  if (layout->call_graph_ordering() != NULL)
+    layout->call_graph_ordering()->apply(symtab, layout);
+
   if (parameters->options().gc_sections()
       || parameters->options().icf_enabled())
     {
@@ -597,9 +782,7 @@ queue_middle_tasks(const General_options& options,
       && layout->incremental_base() == NULL)
     parameters_force_valid_target();
 
-  int thread_count = options.thread_count_middle();
-  if (thread_count == 0)
-    thread_count = std::max(2, input_objects->number_of_input_objects());
+  int thread_count = middle_thread_count(options, input_objects);
   workqueue->set_thread_count(thread_count);
 
   // Now we have seen all the input files.
@@ -699,15 +882,36 @@ queue_middle_tasks(const General_options& options,
 
   Task_token* this_blocker = NULL;
 
+  // When using threads, prescan the relocations of all the objects in
+  // parallel, to find the ones which may need a GOT or PLT entry or a
+  // dynamic relocation.  The Scan_relocs tasks, which must run in
+  // order, then only look at those.  The prescan must see the symbol
+  // table before anything changes it, so PRESCAN_BLOCKER is unblocked
+  // when every object has been prescanned, and blocks everything
+  // after.
+  Task_token* prescan_blocker = NULL;
+  if (parameters->options().threads()
+      && !parameters->options().relocatable()
+      && !parameters->incremental())
+    {
+      prescan_blocker = new Task_token(true);
+      for (Input_objects::Relobj_iterator p = input_objects->relobj_begin();
+	   p != input_objects->relobj_end();
+	   ++p)
+	prescan_blocker->add_blocker();
+      this_blocker = prescan_blocker;
+    }
+
   // Allocate common symbols.  We use a blocker to run this before the
   // Scan_relocs tasks, because it writes to the symbol table just as
   // they do.
   if (parameters->options().define_common())
     {
-      this_blocker = new Task_token(true);
-      this_blocker->add_blocker();
+      Task_token* next_blocker = new Task_token(true);
+      next_blocker->add_blocker();
       workqueue->queue(new Allocate_commons_task(symtab, layout, mapfile,
-						 this_blocker));
+						 this_blocker, next_blocker));
+      this_blocker = next_blocker;
     }
 
   // If doing garbage collection, the relocations have already been read.
@@ -719,6 +923,10 @@ queue_middle_tasks(const General_options& options,
 	   p != input_objects->relobj_end();
 	   ++p)
 	{
+	  if (prescan_blocker != NULL)
+	    workqueue->queue(new Prescan_relocs(symtab, layout, *p,
+						(*p)->get_relocs_data(),
+						prescan_blocker));
 	  Task_token* next_blocker = new Task_token(true);
 	  next_blocker->add_blocker();
 	  workqueue->queue(new Scan_relocs(symtab, layout, *p,
@@ -747,7 +955,7 @@ queue_middle_tasks(const General_options& options,
 	  Task_token* next_blocker = new Task_token(true);
 	  next_blocker->add_blocker();
 	  workqueue->queue(new Read_relocs(symtab, layout, *p, this_blocker,
-					   next_blocker));
+					   next_blocker, prescan_blocker));
 	  this_blocker = next_blocker;
 	}
     }
@@ -771,6 +979,34 @@ queue_middle_tasks(const General_options& options,
 	}
     }
 
+  // Merge the strings in SHF_MERGE string sections while the
+  // relocations are read and scanned.  These tasks also unblock
+  // THIS_BLOCKER, since the merged strings are needed by layout.  We
+  // use one shard per thread, but there is no point in using many
+  // more shards than we have processors.
+  if (parameters->options().threads()
+      && parameters->options().parallel_string_merge())
+    {
+      const int max_merge_shards = 64;
+      unsigned int shard_count = std::min(thread_count, max_merge_shards);
+      layout->queue_merge_tasks(workqueue, shard_count, this_blocker);
+    }
+
+  // When using threads, the debug information for the .gdb_index
+  // section is scanned by a task for each object, while the
+  // relocations are read and scanned.  These tasks also unblock
+  // THIS_BLOCKER, so the scan is done before layout.
+  if (parameters->options().gdb_index())
+    layout->queue_gdb_index_tasks(workqueue, this_blocker);
+
+  // Read the line numbers of the candidate ODR violations with a task
+  // for each object which defines them, and then check them.  These
+  // tasks also unblock THIS_BLOCKER, and the violations are reported
+  // by layout.
+  if (parameters->options().detect_odr_violations())
+    symtab->queue_odr_tasks(workqueue, input_objects, thread_count,
+			    this_blocker);
+
   // When all those tasks are complete, we can start laying out the
   // output file.
   workqueue->queue(new Task_function(new Layout_task_runner(options,
@@ -870,6 +1106,18 @@ queue_final_tasks(const General_options& options,
     }
   else
     {
+      // Compress the sections which are written compressed before
+      // the section offsets are finalized, in parallel if we have
+      // threads.
+      if (layout->any_compressed_sections())
+	{
+	  Task_token* compress_blocker = new Task_token(true);
+	  compress_blocker->add_blocker();
+	  workqueue->queue(new Compress_sections_task(layout, final_blocker,
+						      compress_blocker));
+	  final_blocker = compress_blocker;
+	}
+
       Task_token* new_final_blocker = new Task_token(true);
       new_final_blocker->add_blocker();
       Task* t = new Write_after_input_sections_task(layout, of,
@@ -879,8 +1127,10 @@ queue_final_tasks(const General_options& options,
       final_blocker = new_final_blocker;
     }
 
-  // Create tasks for tree-style build ID computation, if necessary.
-  if (strcmp(options.build_id(), "tree") == 0)
+  // Create tasks for tree-style or fast build ID computation, if
+  // necessary.
+  if (strcmp(options.build_id(), "tree") == 0
+      || strcmp(options.build_id(), "fast") == 0)
     {
       // Queue a task to compute the build id.  This will be blocked by
       // FINAL_BLOCKER, and will in turn schedule the task to close
@@ -93,6 +93,21 @@
 // frequent and Algorithm I wins because of its ability to be stopped
 // arbitrarily.
 //
+// Parallel matching :
+// -----------------
+//
+// With --threads and --parallel-icf the checksumming is done by tasks.
+// In each iteration the sections are checksummed by a task for each
+// chunk of sections, and the sections with the same checksum are
+// grouped by a task for each shard of the checksums.  Unlike the serial
+// algorithm, an iteration only sees the groups formed by the previous
+// iterations, so that the result does not depend on the order in which
+// the tasks run; it may take more iterations to converge.  Since an
+// iteration is cheap when run in parallel, the iterations go on until
+// convergence unless --icf-iterations is given.  After convergence the
+// groups, and the first section of each group, are the same as with
+// the serial algorithm run to convergence.
+//
 // Caveat with using function pointers :
 // ------------------------------------
 //
@@ -134,11 +149,15 @@
 //
 // How to run  : --icf=[safe|all|none]
 // Optional parameters : --icf-iterations <num> --print-icf-sections
+//                       --parallel-icf
 //
 // Performance : Less than 20 % link-time overhead on industry strength
 // applications.  Up to 6 %  text size reductions.
 
 #include "gold.h"
+
+#include <algorithm>
+
 #include "object.h"
 #include "gc.h"
 #include "icf.h"
@@ -147,10 +166,74 @@
 #include "demangle.h"
 #include "elfcpp.h"
 #include "int_encoding.h"
+#include "parameters.h"
+#include "options.h"
+#include "workqueue.h"
 
 namespace gold
 {
 
+// Compute a 64-bit hash code of the LEN bytes at P.  This is
+// MurmurHash64A, which is faster than a CRC and, being 64 bits wide,
+// leaves far fewer collisions to be resolved by comparing contents.
+
+static uint64_t
+icf_hash(const unsigned char* p, size_t len)
+{
+  const uint64_t m = 0xc6a4a7935bd1e995ULL;
+  const int r = 47;
+  uint64_t h = 0x8445d61a4e774912ULL ^ (len * m);
+
+  const unsigned char* end = p + (len & ~static_cast<size_t>(7));
+  for (; p != end; p += 8)
+    {
+      uint64_t k;
+      memcpy(&k, p, 8);
+      k *= m;
+      k ^= k >> r;
+      k *= m;
+      h ^= k;
+      h *= m;
+    }
+
+  switch (len & 7)
+    {
+    case 7:
+      h ^= static_cast<uint64_t>(p[6]) << 48;
+      // Fall through.
+    case 6:
+      h ^= static_cast<uint64_t>(p[5]) << 40;
+      // Fall through.
+    case 5:
+      h ^= static_cast<uint64_t>(p[4]) << 32;
+      // Fall through.
+    case 4:
+      h ^= static_cast<uint64_t>(p[3]) << 24;
+      // Fall through.
+    case 3:
+      h ^= static_cast<uint64_t>(p[2]) << 16;
+      // Fall through.
+    case 2:
+      h ^= static_cast<uint64_t>(p[1]) << 8;
+      // Fall through.
+    case 1:
+      h ^= static_cast<uint64_t>(p[0]);
+      h *= m;
+    }
+
+  h ^= h >> r;
+  h *= m;
+  h ^= h >> r;
+  return h;
+}
+
+static inline uint64_t
+icf_hash(const std::string& s)
+{
+  return icf_hash(reinterpret_cast<const unsigned char*>(s.data()),
+                  s.length());
+}
+
 // This function determines if a section or a group of identical
 // sections has unique contents.  Such unique sections or groups can be
 // declared final and need not be processed any further.
@@ -168,8 +251,8 @@ preprocess_for_unique_sections(const std::vector<Section_id>& id_section,
                                std::vector<bool>* is_secn_or_group_unique,
                                std::vector<std::string>* section_contents)
 {
-  Unordered_map<uint32_t, unsigned int> uniq_map;
-  std::pair<Unordered_map<uint32_t, unsigned int>::iterator, bool>
+  Unordered_map<uint64_t, unsigned int> uniq_map;
+  std::pair<Unordered_map<uint64_t, unsigned int>::iterator, bool>
     uniq_map_insert;
 
   for (unsigned int i = 0; i < id_section.size(); i++)
@@ -177,7 +260,7 @@ preprocess_for_unique_sections(const std::vector<Section_id>& id_section,
       if ((*is_secn_or_group_unique)[i])
         continue;
 
-      uint32_t cksum;
+      uint64_t cksum;
       Section_id secn = id_section[i];
       section_size_type plen;
       if (section_contents == NULL)
@@ -191,15 +274,10 @@ preprocess_for_unique_sections(const std::vector<Section_id>& id_section,
           contents = secn.first->section_contents(secn.second,
                                                   &plen,
                                                   false);
-          cksum = xcrc32(contents, plen, 0xffffffff);
+          cksum = icf_hash(contents, plen);
         }
       else
-        {
-          const unsigned char* contents_array = reinterpret_cast
-            <const unsigned char*>((*section_contents)[i].c_str());
-          cksum = xcrc32(contents_array, (*section_contents)[i].length(),
-                         0xffffffff);
-        }
+        cksum = icf_hash((*section_contents)[i]);
       uniq_map_insert = uniq_map.insert(std::make_pair(cksum, i));
       if (uniq_map_insert.second)
         {
@@ -227,6 +305,11 @@ preprocess_for_unique_sections(const std::vector<Section_id>& id_section,
 // KEPT_SECTION_ID    : Vector which maps folded sections to kept sections.
 // SECTION_CONTENTS   : Store the section's text and relocs to non-ICF
 //                      sections.
+// MERGE_CONTENTS     : If not NULL, the contents of the merge sections
+//                      referred to by the section, which are then not
+//                      read from their objects.
+//
+// On the first iteration the caller must lock the object of SECN.
 
 static std::string
 get_section_contents(bool first_iteration,
@@ -235,14 +318,9 @@ get_section_contents(bool first_iteration,
                      unsigned int* num_tracked_relocs,
                      Symbol_table* symtab,
                      const std::vector<unsigned int>& kept_section_id,
-                     std::vector<std::string>* section_contents)
+                     std::vector<std::string>* section_contents,
+                     const Icf::Merge_section_contents* merge_contents)
 {
-  // Lock the object so we can read from it.  This is only called
-  // single-threaded from queue_middle_tasks, so it is OK to lock.
-  // Unfortunately we have no way to pass in a Task token.
-  const Task* dummy_task = reinterpret_cast<const Task*>(-1);
-  Task_lock_obj<Object> tl(dummy_task, secn.first);
-
   section_size_type plen;
   const unsigned char* contents = NULL;
   if (first_iteration)
@@ -444,11 +522,25 @@ get_section_contents(bool first_iteration,
 		    }
 		  offset = offset + reloc_addend_value;
 
-                  section_size_type secn_len;
-                  const unsigned char* str_contents =
-                  (it_v->first)->section_contents(it_v->second,
-                                                  &secn_len,
-                                                  false) + offset;
+                  const unsigned char* str_contents;
+                  if (merge_contents == NULL)
+                    {
+                      section_size_type secn_len;
+                      str_contents =
+                        (it_v->first)->section_contents(it_v->second,
+                                                        &secn_len,
+                                                        false) + offset;
+                    }
+                  else
+                    {
+                      Icf::Merge_section_contents::const_iterator pm =
+                        merge_contents->find(Section_id(it_v->first,
+                                                        it_v->second));
+                      gold_assert(pm != merge_contents->end());
+                      str_contents = (reinterpret_cast<const unsigned char*>(
+                                        pm->second.data())
+                                      + offset);
+                    }
                   if ((secn_flags & elfcpp::SHF_STRINGS) != 0)
                     {
                       // String merge section.
@@ -546,7 +638,7 @@ get_section_contents(bool first_iteration,
 // determine if larger groups of identical sections could be formed.  The
 // first section in each group is the kept section for that group.
 //
-// CRC32 is the checksumming algorithm and can have collisions.  That is,
+// The checksum is a 64-bit hash and can have collisions.  That is,
 // two sections with different contents can have the same checksum. Hence,
 // a multimap is used to maintain more than one group of checksum
 // identical sections.  A section is added to a group only after its
@@ -572,9 +664,9 @@ match_sections(unsigned int iteration_num,
                std::vector<bool>* is_secn_or_group_unique,
                std::vector<std::string>* section_contents)
 {
-  Unordered_multimap<uint32_t, unsigned int> section_cksum;
-  std::pair<Unordered_multimap<uint32_t, unsigned int>::iterator,
-            Unordered_multimap<uint32_t, unsigned int>::iterator> key_range;
+  Unordered_multimap<uint64_t, unsigned int> section_cksum;
+  std::pair<Unordered_multimap<uint64_t, unsigned int>::iterator,
+            Unordered_multimap<uint64_t, unsigned int>::iterator> key_range;
   bool converged = true;
 
   if (iteration_num == 1)
@@ -596,13 +688,19 @@ match_sections(unsigned int iteration_num,
 
       Section_id secn = id_section[i];
       std::string this_secn_contents;
-      uint32_t cksum;
+      uint64_t cksum;
       if (iteration_num == 1)
         {
+          // Lock the object so we can read from it.  This is only called
+          // single-threaded from queue_middle_tasks, so it is OK to lock.
+          // Unfortunately we have no way to pass in a Task token.
+          const Task* dummy_task = reinterpret_cast<const Task*>(-1);
+          Task_lock_obj<Object> tl(dummy_task, secn.first);
+
           unsigned int num_relocs = 0;
           this_secn_contents = get_section_contents(true, secn, i, &num_relocs,
                                                     symtab, (*kept_section_id),
-                                                    section_contents);
+                                                    section_contents, NULL);
           (*num_tracked_relocs)[i] = num_relocs;
         }
       else
@@ -620,13 +718,10 @@ match_sections(unsigned int iteration_num,
             }
           this_secn_contents = get_section_contents(false, secn, i, NULL,
                                                     symtab, (*kept_section_id),
-                                                    section_contents);
+                                                    section_contents, NULL);
         }
 
-      const unsigned char* this_secn_contents_array =
-            reinterpret_cast<const unsigned char*>(this_secn_contents.c_str());
-      cksum = xcrc32(this_secn_contents_array, this_secn_contents.length(),
-                     0xffffffff);
+      cksum = icf_hash(this_secn_contents);
       size_t count = section_cksum.count(cksum);
 
       if (count == 0)
@@ -638,7 +733,7 @@ match_sections(unsigned int iteration_num,
       else
         {
           key_range = section_cksum.equal_range(cksum);
-          Unordered_multimap<uint32_t, unsigned int>::iterator it;
+          Unordered_multimap<uint64_t, unsigned int>::iterator it;
           // Search all the groups with this cksum for a match.
           for (it = key_range.first; it != key_range.second; ++it)
             {
@@ -688,22 +783,16 @@ is_function_ctor_or_dtor(const std::string& section_name)
   return false;
 }
 
-// This is the main ICF function called in gold.cc.  This does the
-// initialization and calls match_sections repeatedly (twice by default)
-// which computes the crc checksums and detects identical functions.
+// Choose the sections which may be folded, and give each a unique
+// integer.  The sections of each object are numbered consecutively.
 
 void
-Icf::find_identical_sections(const Input_objects* input_objects,
-                             Symbol_table* symtab)
+Icf::select_candidate_sections(const Input_objects* input_objects,
+                               Symbol_table* symtab)
 {
   unsigned int section_num = 0;
-  std::vector<unsigned int> num_tracked_relocs;
-  std::vector<bool> is_secn_or_group_unique;
-  std::vector<std::string> section_contents;
   const Target& target = parameters->target();
 
-  // Decide which sections are possible candidates first.
-
   for (Input_objects::Relobj_iterator p = input_objects->relobj_begin();
        p != input_objects->relobj_end();
        ++p)
@@ -737,12 +826,59 @@ Icf::find_identical_sections(const Input_objects* input_objects,
           this->id_section_.push_back(Section_id(*p, i));
           this->section_id_[Section_id(*p, i)] = section_num;
           this->kept_section_id_.push_back(section_num);
-          num_tracked_relocs.push_back(0);
-          is_secn_or_group_unique.push_back(false);
-          section_contents.push_back("");
           section_num++;
         }
     }
+}
+
+// Unfold --keep-unique symbols.
+
+void
+Icf::unfold_keep_unique_sections(Symbol_table* symtab)
+{
+  for (options::String_set::const_iterator p =
+	 parameters->options().keep_unique_begin();
+       p != parameters->options().keep_unique_end();
+       ++p)
+    {
+      const char* name = p->c_str();
+      Symbol* sym = symtab->lookup(name);
+      if (sym == NULL)
+	{
+	  gold_warning(_("Could not find symbol %s to unfold\n"), name);
+	}
+      else if (sym->source() == Symbol::FROM_OBJECT 
+               && !sym->object()->is_dynamic())
+        {
+          Relobj* obj = static_cast<Relobj*>(sym->object());
+          bool is_ordinary;
+          unsigned int shndx = sym->shndx(&is_ordinary);
+          if (is_ordinary)
+            {
+	      this->unfold_section(obj, shndx);
+            }
+        }
+
+    }
+}
+
+// This is the main ICF function called in gold.cc.  This does the
+// initialization and calls match_sections repeatedly (twice by default)
+// which computes the checksums and detects identical functions.
+
+void
+Icf::find_identical_sections(const Input_objects* input_objects,
+                             Symbol_table* symtab)
+{
+  Timer::TimeStats start = Icf::current_time();
+
+  // Decide which sections are possible candidates first.
+  this->select_candidate_sections(input_objects, symtab);
+  this->add_stage_time(STAGE_SELECT, start);
+
+  std::vector<unsigned int> num_tracked_relocs(this->id_section_.size(), 0);
+  std::vector<bool> is_secn_or_group_unique(this->id_section_.size(), false);
+  std::vector<std::string> section_contents(this->id_section_.size());
 
   unsigned int num_iterations = 0;
 
@@ -755,12 +891,18 @@ Icf::find_identical_sections(const Input_objects* input_objects,
 
   while (!converged && (num_iterations < max_iterations))
     {
+      start = Icf::current_time();
       num_iterations++;
       converged = match_sections(num_iterations, symtab,
                                  &num_tracked_relocs, &this->kept_section_id_,
                                  this->id_section_, &is_secn_or_group_unique,
                                  &section_contents);
+      this->add_stage_time(num_iterations == 1
+                           ? STAGE_FINGERPRINT
+                           : STAGE_REFINE,
+                           start);
     }
+  this->iterations_ = num_iterations;
 
   if (parameters->options().print_icf_sections())
     {
@@ -772,33 +914,538 @@ Icf::find_identical_sections(const Input_objects* input_objects,
                   program_name, num_iterations);
     }
 
-  // Unfold --keep-unique symbols.
-  for (options::String_set::const_iterator p =
-	 parameters->options().keep_unique_begin();
-       p != parameters->options().keep_unique_end();
+  this->unfold_keep_unique_sections(symtab);
+
+  this->icf_ready();
+}
+
+// An Icf_fingerprint_task computes the contents and the hash codes of
+// one chunk of the sections in a round of a parallel match.
+
+class Icf_fingerprint_task : public Task
+{
+ public:
+  Icf_fingerprint_task(Icf* icf, unsigned int chunk, Relobj* object,
+                       Task_token* fingerprint_blocker)
+    : icf_(icf), chunk_(chunk), object_(object),
+      fingerprint_blocker_(fingerprint_blocker)
+  { }
+
+  // In the first round we read the section contents, so we must wait
+  // for the object.
+  Task_token*
+  is_runnable()
+  {
+    if (this->object_ != NULL && this->object_->is_locked())
+      return this->object_->token();
+    return NULL;
+  }
+
+  // Lock the object, if any, and unblock FINGERPRINT_BLOCKER_ when
+  // done.
+  void
+  locks(Task_locker* tl)
+  {
+    if (this->object_ != NULL)
+      {
+        Task_token* token = this->object_->token();
+        if (token != NULL)
+          tl->add(this, token);
+      }
+    tl->add(this, this->fingerprint_blocker_);
+  }
+
+  void
+  run(Workqueue*)
+  {
+    this->icf_->fingerprint_sections(this->chunk_);
+    if (this->object_ != NULL)
+      this->object_->release();
+  }
+
+  std::string
+  get_name() const
+  { return "Icf_fingerprint_task"; }
+
+ private:
+  Icf* icf_;
+  const unsigned int chunk_;
+  Relobj* object_;
+  Task_token* const fingerprint_blocker_;
+};
+
+// An Icf_match_task groups the identical sections in one shard of a
+// round of a parallel match.  It runs after all the sections of the
+// round have been fingerprinted.
+
+class Icf_match_task : public Task
+{
+ public:
+  Icf_match_task(Icf* icf, unsigned int shard,
+                 Task_token* fingerprint_blocker, Task_token* match_blocker)
+    : icf_(icf), shard_(shard), fingerprint_blocker_(fingerprint_blocker),
+      match_blocker_(match_blocker)
+  { }
+
+  // Wait until all the sections have been fingerprinted.
+  Task_token*
+  is_runnable()
+  {
+    if (this->fingerprint_blocker_->is_blocked())
+      return this->fingerprint_blocker_;
+    return NULL;
+  }
+
+  // Unblock MATCH_BLOCKER_ when done.
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->match_blocker_); }
+
+  void
+  run(Workqueue*)
+  { this->icf_->match_shard(this->shard_); }
+
+  std::string
+  get_name() const
+  { return "Icf_match_task"; }
+
+ private:
+  Icf* icf_;
+  const unsigned int shard_;
+  Task_token* const fingerprint_blocker_;
+  Task_token* const match_blocker_;
+};
+
+// An Icf_round_task finishes a round of a parallel match once all the
+// shards have been matched, and queues the next round if needed.
+
+class Icf_round_task : public Task
+{
+ public:
+  Icf_round_task(Icf* icf, Task_token* match_blocker,
+                 Task_token* next_blocker)
+    : icf_(icf), match_blocker_(match_blocker), next_blocker_(next_blocker)
+  { }
+
+  // Wait until all the shards have been matched.
+  Task_token*
+  is_runnable()
+  {
+    if (this->match_blocker_->is_blocked())
+      return this->match_blocker_;
+    return NULL;
+  }
+
+  // Unblock NEXT_BLOCKER_ when done.  If another round is queued, it
+  // adds a blocker of its own first.
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->next_blocker_); }
+
+  void
+  run(Workqueue* workqueue)
+  { this->icf_->finish_round(workqueue); }
+
+  std::string
+  get_name() const
+  { return "Icf_round_task"; }
+
+ private:
+  Icf* icf_;
+  Task_token* const match_blocker_;
+  Task_token* const next_blocker_;
+};
+
+// Read the contents of the SHF_MERGE sections referred to by the
+// candidate sections.  get_section_contents reads the strings these
+// sections hold, and in a parallel match it can not read them from
+// the object, which may be locked by another task.
+
+void
+Icf::read_merge_section_contents(Merge_section_contents* merge_contents)
+{
+  if (!parameters->target().can_icf_inline_merge_sections())
+    return;
+
+  for (unsigned int i = 0; i < this->id_section_.size(); ++i)
+    {
+      Reloc_info_list::const_iterator p =
+        this->reloc_info_list_.find(this->id_section_[i]);
+      if (p == this->reloc_info_list_.end())
+        continue;
+
+      const Sections_reachable_info& v = p->second.section_info;
+      for (Sections_reachable_info::const_iterator pv = v.begin();
+           pv != v.end();
+           ++pv)
+        {
+          if (pv->first == NULL
+              || (pv->first->section_flags(pv->second)
+                  & elfcpp::SHF_MERGE) == 0)
+            continue;
+
+          std::pair<Merge_section_contents::iterator, bool> ins =
+            merge_contents->insert(std::make_pair(*pv, std::string()));
+          if (!ins.second)
+            continue;
+
+          // This is only called single-threaded, before any of the
+          // fingerprint tasks are queued, so it is OK to lock.
+          const Task* dummy_task = reinterpret_cast<const Task*>(-1);
+          Task_lock_obj<Object> tl(dummy_task, pv->first);
+          section_size_type len;
+          const unsigned char* contents =
+            pv->first->section_contents(pv->second, &len, false);
+          ins.first->second.assign(reinterpret_cast<const char*>(contents),
+                                   len);
+        }
+    }
+}
+
+// Find the identical sections in parallel.  The sections are matched
+// in rounds, each of which is a group of tasks.  Each section to be
+// matched in a round is fingerprinted by a task which handles a chunk
+// of the sections, and then the sections are grouped by a task for
+// each shard of the hash codes.  The sections are visited in the same
+// order in each shard as in find_identical_sections, so the first
+// section of each group is always the lowest numbered one, whatever
+// the number of threads.  Unlike find_identical_sections we
+// go on until no more sections are folded, unless --icf-iterations
+// sets a limit.
+
+void
+Icf::queue_find_identical_sections(Workqueue* workqueue,
+                                   const Input_objects* input_objects,
+                                   Symbol_table* symtab,
+                                   unsigned int shard_count,
+                                   Task_token* next_blocker)
+{
+  Timer::TimeStats start = Icf::current_time();
+  this->select_candidate_sections(input_objects, symtab);
+  this->add_stage_time(STAGE_SELECT, start);
+
+  gold_assert(this->match_state_ == NULL && shard_count > 0);
+  Match_state* ms = new Match_state;
+  this->match_state_ = ms;
+
+  ms->round_start = Icf::current_time();
+  this->read_merge_section_contents(&ms->merge_contents);
+
+  unsigned int count = this->id_section_.size();
+  ms->symtab = symtab;
+  ms->next_blocker = next_blocker;
+  ms->shard_count = shard_count;
+  ms->max_iterations = parameters->options().icf_iterations();
+  ms->num_tracked_relocs.resize(count, 0);
+  ms->is_unique.resize(count, 0);
+  ms->section_contents.resize(count);
+  ms->full_contents.resize(count);
+  ms->hashes.resize(count, 0);
+  ms->shard_folded.resize(shard_count, 0);
+
+  // In the first round every section is matched, in one chunk for
+  // each object, since the fingerprint tasks must lock the objects.
+  ms->active.reserve(count);
+  for (unsigned int i = 0; i < count; ++i)
+    {
+      ms->active.push_back(i);
+      Relobj* object = this->id_section_[i].first;
+      if (ms->chunks.empty() || ms->chunks.back().object != object)
+        {
+          Match_chunk chunk;
+          chunk.first = i;
+          chunk.object = object;
+          ms->chunks.push_back(chunk);
+        }
+      ms->chunks.back().last = i + 1;
+    }
+
+  this->queue_match_round(workqueue);
+}
+
+// Queue the tasks for a round of a parallel match.  The chunks of the
+// round have been set up.
+
+void
+Icf::queue_match_round(Workqueue* workqueue)
+{
+  Match_state* ms = this->match_state_;
+  ++this->iterations_;
+  this->match_shards_ = ms->shard_count;
+  this->fingerprint_tasks_ += ms->chunks.size();
+
+  for (std::vector<Match_chunk>::iterator p = ms->chunks.begin();
+       p != ms->chunks.end();
        ++p)
+    p->shards.resize(ms->shard_count);
+  for (unsigned int i = 0; i < ms->shard_count; ++i)
+    ms->shard_folded[i] = 0;
+
+  ms->fingerprint_blocker = new Task_token(true);
+  ms->match_blocker = new Task_token(true);
+
+  // There are no chunks at all if there are no candidate sections.
+  if (!ms->chunks.empty())
+    ms->fingerprint_blocker->add_blockers(ms->chunks.size());
+  ms->match_blocker->add_blockers(ms->shard_count);
+
+  for (unsigned int i = 0; i < ms->shard_count; ++i)
+    workqueue->queue(new Icf_match_task(this, i, ms->fingerprint_blocker,
+                                        ms->match_blocker));
+  workqueue->queue(new Icf_round_task(this, ms->match_blocker,
+                                      ms->next_blocker));
+  for (unsigned int i = 0; i < ms->chunks.size(); ++i)
+    workqueue->queue(new Icf_fingerprint_task(this, i, ms->chunks[i].object,
+                                              ms->fingerprint_blocker));
+}
+
+// Compute the contents and the hash codes of the sections in CHUNK,
+// and sort them by shard.
+
+void
+Icf::fingerprint_sections(unsigned int chunk_index)
+{
+  Match_state* ms = this->match_state_;
+  Match_chunk& chunk(ms->chunks[chunk_index]);
+  bool first_round = this->iterations_ == 1;
+
+  for (unsigned int j = chunk.first; j < chunk.last; ++j)
     {
-      const char* name = p->c_str();
-      Symbol* sym = symtab->lookup(name);
-      if (sym == NULL)
-	{
-	  gold_warning(_("Could not find symbol %s to unfold\n"), name);
-	}
-      else if (sym->source() == Symbol::FROM_OBJECT 
-               && !sym->object()->is_dynamic())
+      unsigned int i = ms->active[j];
+      std::string contents =
+        get_section_contents(first_round, this->id_section_[i], i,
+                             first_round ? &ms->num_tracked_relocs[i] : NULL,
+                             ms->symtab, this->kept_section_id_,
+                             &ms->section_contents, &ms->merge_contents);
+      uint64_t h = icf_hash(contents);
+      ms->full_contents[i].swap(contents);
+      if (first_round)
+        ms->hashes[i] = icf_hash(ms->section_contents[i]);
+      chunk.shards[this->shard_of(h)].push_back(std::make_pair(h, i));
+    }
+}
+
+// Group the sections in SHARD.  Each section is folded into the first
+// section with the same contents.
+
+void
+Icf::match_shard(unsigned int shard)
+{
+  Match_state* ms = this->match_state_;
+  Unordered_multimap<uint64_t, unsigned int> leaders;
+
+  for (std::vector<Match_chunk>::const_iterator p = ms->chunks.begin();
+       p != ms->chunks.end();
+       ++p)
+    {
+      const std::vector<std::pair<uint64_t, unsigned int> >&
+        sections(p->shards[shard]);
+      for (std::vector<std::pair<uint64_t, unsigned int> >::const_iterator
+             ps = sections.begin();
+           ps != sections.end();
+           ++ps)
         {
-          Relobj* obj = static_cast<Relobj*>(sym->object());
-          bool is_ordinary;
-          unsigned int shndx = sym->shndx(&is_ordinary);
-          if (is_ordinary)
+          uint64_t h = ps->first;
+          unsigned int i = ps->second;
+          const std::string& contents(ms->full_contents[i]);
+
+          std::pair<Unordered_multimap<uint64_t, unsigned int>::iterator,
+                    Unordered_multimap<uint64_t, unsigned int>::iterator>
+            key_range = leaders.equal_range(h);
+          Unordered_multimap<uint64_t, unsigned int>::iterator it;
+          for (it = key_range.first; it != key_range.second; ++it)
+            if (ms->full_contents[it->second] == contents)
+              break;
+
+          if (it == key_range.second)
+            leaders.insert(std::make_pair(h, i));
+          else
             {
-	      this->unfold_section(obj, shndx);
+              this->kept_section_id_[i] = it->second;
+              ms->shard_folded[shard] = 1;
+            }
+        }
+    }
+}
+
+// Finish a round of a parallel match, and queue another one if any
+// sections were folded.
+
+bool
+Icf::finish_round(Workqueue* workqueue)
+{
+  Match_state* ms = this->match_state_;
+  unsigned int count = this->id_section_.size();
+  bool first_round = this->iterations_ == 1;
+
+  bool converged = true;
+  for (unsigned int i = 0; i < ms->shard_count; ++i)
+    if (ms->shard_folded[i])
+      converged = false;
+
+  // A section is only ever folded into a section with a lower number,
+  // so this makes every section point at the first section of its
+  // group.
+  for (unsigned int i = 0; i < count; ++i)
+    this->kept_section_id_[i] =
+      this->kept_section_id_[this->kept_section_id_[i]];
+
+  std::vector<std::string>().swap(ms->full_contents);
+
+  if (first_round)
+    {
+      // Sections with no relocs to foldable sections will not change,
+      // and neither will sections whose other contents are unlike
+      // those of any other section.
+      Unordered_map<uint64_t, unsigned int> hash_count;
+      for (unsigned int i = 0; i < count; ++i)
+        {
+          if (ms->num_tracked_relocs[i] == 0)
+            ms->is_unique[i] = 1;
+          else
+            ++hash_count[ms->hashes[i]];
+        }
+      for (unsigned int i = 0; i < count; ++i)
+        if (!ms->is_unique[i] && hash_count[ms->hashes[i]] == 1)
+          ms->is_unique[i] = 1;
+      Merge_section_contents().swap(ms->merge_contents);
+      std::vector<uint64_t>().swap(ms->hashes);
+    }
+
+  this->add_stage_time(first_round ? STAGE_FINGERPRINT : STAGE_REFINE,
+                       ms->round_start);
+
+  delete ms->fingerprint_blocker;
+  delete ms->match_blocker;
+  ms->fingerprint_blocker = NULL;
+  ms->match_blocker = NULL;
+
+  if (!converged
+      && (ms->max_iterations == 0 || this->iterations_ < ms->max_iterations))
+    {
+      // Only the first section of each group can change now.
+      ms->active.clear();
+      for (unsigned int i = 0; i < count; ++i)
+        if (!ms->is_unique[i] && this->kept_section_id_[i] == i)
+          ms->active.push_back(i);
+
+      if (ms->active.size() > 1)
+        {
+          ms->round_start = Icf::current_time();
+          ms->full_contents.resize(count);
+
+          unsigned int nchunks = ms->shard_count * 4;
+          unsigned int chunk_size = ((ms->active.size() + nchunks - 1)
+                                     / nchunks);
+          if (chunk_size < 64)
+            chunk_size = 64;
+          ms->chunks.clear();
+          for (unsigned int first = 0;
+               first < ms->active.size();
+               first += chunk_size)
+            {
+              Match_chunk chunk;
+              chunk.first = first;
+              chunk.last = std::min(first + chunk_size,
+                                    static_cast<unsigned int>(
+                                      ms->active.size()));
+              chunk.object = NULL;
+              ms->chunks.push_back(chunk);
             }
+
+          workqueue->add_blocker(ms->next_blocker);
+          this->queue_match_round(workqueue);
+          return true;
         }
 
+      // Nothing left to fold.
+      converged = true;
     }
 
+  if (parameters->options().print_icf_sections())
+    {
+      if (converged)
+        gold_info(_("%s: ICF Converged after %u iteration(s)"),
+                  program_name, this->iterations_);
+      else
+        gold_info(_("%s: ICF stopped after %u iteration(s)"),
+                  program_name, this->iterations_);
+    }
+
+  this->unfold_keep_unique_sections(ms->symtab);
+
+  delete ms;
+  this->match_state_ = NULL;
+
   this->icf_ready();
+  return false;
+}
+
+// Return the time used so far, if we are collecting statistics.
+
+Timer::TimeStats
+Icf::current_time()
+{
+  Timer* timer = parameters->timer();
+  if (timer != NULL)
+    return timer->get_elapsed_time();
+  Timer::TimeStats zero;
+  zero.user = zero.sys = zero.wall = 0;
+  return zero;
+}
+
+// Add the time used since START to STAGE.
+
+void
+Icf::add_stage_time(Stage stage, const Timer::TimeStats& start)
+{
+  Timer::TimeStats now = Icf::current_time();
+  this->stage_times_[stage].user += now.user - start.user;
+  this->stage_times_[stage].sys += now.sys - start.sys;
+  this->stage_times_[stage].wall += now.wall - start.wall;
+}
+
+// Print statistics to stderr.
+
+void
+Icf::print_stats() const
+{
+  unsigned int folded = 0;
+  for (unsigned int i = 0; i < this->kept_section_id_.size(); ++i)
+    if (this->kept_section_id_[i] != i)
+      ++folded;
+
+  fprintf(stderr, _("%s: ICF candidate sections: %zu\n"),
+          program_name, this->id_section_.size());
+  fprintf(stderr, _("%s: ICF iterations: %u\n"),
+          program_name, this->iterations_);
+  fprintf(stderr, _("%s: ICF folded sections: %u\n"),
+          program_name, folded);
+  if (this->match_shards_ > 0)
+    {
+      fprintf(stderr, _("%s: ICF match shards: %u\n"),
+              program_name, this->match_shards_);
+      fprintf(stderr, _("%s: ICF fingerprint tasks: %zu\n"),
+              program_name, this->fingerprint_tasks_);
+    }
+
+  static const char* const stage_names[STAGE_COUNT] =
+  {
+    "candidate selection",
+    "fingerprinting",
+    "refinement"
+  };
+  for (int i = 0; i < STAGE_COUNT; ++i)
+    {
+      const Timer::TimeStats& t(this->stage_times_[i]);
+      fprintf(stderr,
+              _("%s: ICF %s time: " \
+                "(user: %ld.%06ld sys: %ld.%06ld wall: %ld.%06ld)\n"),
+              program_name, stage_names[i],
+              t.user / 1000, (t.user % 1000) * 1000,
+              t.sys / 1000, (t.sys % 1000) * 1000,
+              t.wall / 1000, (t.wall % 1000) * 1000);
+    }
 }
 
 // Unfolds the section denoted by OBJ and SHNDX if folded.
@@ -23,11 +23,13 @@
 #ifndef GOLD_ICF_H
 #define GOLD_ICF_H
 
+#include <string>
 #include <vector>
 
 #include "elfcpp.h"
 #include "symtab.h"
 #include "object.h"
+#include "timer.h"
 
 namespace gold
 {
@@ -35,6 +37,9 @@ namespace gold
 class Object;
 class Input_objects;
 class Symbol_table;
+class Workqueue;
+class Task;
+class Task_token;
 
 class Icf
 {
@@ -64,12 +69,23 @@ class Icf
   typedef Unordered_map<Section_id, Reloc_info,
                         Section_id_hash> Reloc_info_list;
 
+  // The contents of the SHF_MERGE sections referred to by candidate
+  // sections, copied so that they may be read by any thread.
+  typedef Unordered_map<Section_id, std::string,
+                        Section_id_hash> Merge_section_contents;
+
   Icf()
   : id_section_(), section_id_(), kept_section_id_(),
     fptr_section_id_(),
     icf_ready_(false),
-    reloc_info_list_()
-  { }
+    reloc_info_list_(),
+    match_state_(NULL), iterations_(0), match_shards_(0),
+    fingerprint_tasks_(0)
+  {
+    for (int i = 0; i < STAGE_COUNT; ++i)
+      this->stage_times_[i].user = this->stage_times_[i].sys =
+        this->stage_times_[i].wall = 0;
+  }
 
   // Returns the kept folded identical section corresponding to
   // dup_obj and dup_shndx.
@@ -82,6 +98,39 @@ class Icf
   find_identical_sections(const Input_objects* input_objects,
                           Symbol_table* symtab);
 
+  // Does the same as find_identical_sections, using tasks on
+  // WORKQUEUE.  The contents of the sections are fingerprinted in
+  // parallel, and then the groups are refined in parallel, SHARD_COUNT
+  // ways, until no more sections are folded.  NEXT_BLOCKER is
+  // unblocked when the groups have been formed.
+  void
+  queue_find_identical_sections(Workqueue* workqueue,
+                                const Input_objects* input_objects,
+                                Symbol_table* symtab,
+                                unsigned int shard_count,
+                                Task_token* next_blocker);
+
+  // Compute the contents and the fingerprints of the sections in
+  // CHUNK of the current round of a parallel match.  This is called
+  // by Icf_fingerprint_task.
+  void
+  fingerprint_sections(unsigned int chunk);
+
+  // Group the identical sections in SHARD of the current round of a
+  // parallel match.  This is called by Icf_match_task.
+  void
+  match_shard(unsigned int shard);
+
+  // Finish the current round of a parallel match, and queue the next
+  // round if any sections were folded.  This is called by
+  // Icf_round_task.  Returns true if another round was queued.
+  bool
+  finish_round(Workqueue* workqueue);
+
+  // Print statistics about ICF to stderr.  This is used for --stats.
+  void
+  print_stats() const;
+
   // This is set when ICF has been run and the groups of
   // identical sections have been formed.
   void
@@ -143,6 +192,101 @@ class Icf
   { return this->section_id_; }
 
  private:
+  // The stages of ICF, for which we report the time with --stats.
+  enum Stage
+  {
+    // Choosing the candidate sections.
+    STAGE_SELECT,
+    // Computing the contents of each section, and the first grouping.
+    STAGE_FINGERPRINT,
+    // Refining the groups until they do not change.
+    STAGE_REFINE,
+    STAGE_COUNT
+  };
+
+  // A range of the sections being matched in a round of a parallel
+  // match.
+  struct Match_chunk
+  {
+    // The range of entries in Match_state::active.
+    unsigned int first;
+    unsigned int last;
+    // In the first round, the object which holds the sections, which
+    // the fingerprint task must lock.  NULL in later rounds.
+    Relobj* object;
+    // The hash codes and numbers of the sections in the chunk which
+    // hash to each shard, in order.
+    std::vector<std::vector<std::pair<uint64_t, unsigned int> > > shards;
+  };
+
+  // The state of a parallel match.
+  struct Match_state
+  {
+    Match_state()
+      : symtab(NULL), next_blocker(NULL), fingerprint_blocker(NULL),
+        match_blocker(NULL), shard_count(0), max_iterations(0),
+        active(), chunks(), num_tracked_relocs(), is_unique(),
+        section_contents(), full_contents(), hashes(), shard_folded(),
+        merge_contents(), round_start()
+    { }
+
+    Symbol_table* symtab;
+    // Unblocked when the match is complete.
+    Task_token* next_blocker;
+    // Unblocked when the fingerprint tasks of this round are done.
+    Task_token* fingerprint_blocker;
+    // Unblocked when the match tasks of this round are done.
+    Task_token* match_blocker;
+    unsigned int shard_count;
+    // The maximum number of rounds, or 0 to run until convergence.
+    unsigned int max_iterations;
+    // The sections being matched in this round, in order.
+    std::vector<unsigned int> active;
+    std::vector<Match_chunk> chunks;
+    // These are indexed by section number.  IS_UNIQUE is not a
+    // vector<bool> since it is updated by several threads.
+    std::vector<unsigned int> num_tracked_relocs;
+    std::vector<unsigned char> is_unique;
+    std::vector<std::string> section_contents;
+    std::vector<std::string> full_contents;
+    std::vector<uint64_t> hashes;
+    // Whether any section was folded, by shard.
+    std::vector<unsigned char> shard_folded;
+    Merge_section_contents merge_contents;
+    // When the current stage started.
+    Timer::TimeStats round_start;
+  };
+
+  // Choose the sections which may be folded.
+  void
+  select_candidate_sections(const Input_objects*, Symbol_table*);
+
+  // Unfold the sections named with --keep-unique.
+  void
+  unfold_keep_unique_sections(Symbol_table*);
+
+  // Read the contents of the SHF_MERGE sections referred to by the
+  // candidate sections into MERGE_CONTENTS.
+  void
+  read_merge_section_contents(Merge_section_contents* merge_contents);
+
+  // Queue the tasks for a round of a parallel match.
+  void
+  queue_match_round(Workqueue*);
+
+  // Return the shard for a section with hash code HASH.
+  unsigned int
+  shard_of(uint64_t hash) const
+  { return (hash ^ (hash >> 32)) % this->match_state_->shard_count; }
+
+  // Return the time used so far, if we are collecting statistics.
+  static Timer::TimeStats
+  current_time();
+
+  // Add the time used since START to stage STAGE.
+  void
+  add_stage_time(Stage stage, const Timer::TimeStats& start);
+
 
   // Maps integers to sections.
   std::vector<Section_id> id_section_;
@@ -160,6 +304,16 @@ class Icf
   bool icf_ready_;
   // This list is populated by gc_process_relocs in gc.h.
   Reloc_info_list reloc_info_list_;
+  // The state of a parallel match, while it is running.
+  Match_state* match_state_;
+  // The number of iterations which were run.
+  unsigned int iterations_;
+  // The number of shards and the total number of fingerprinting
+  // tasks used by a parallel match, for --stats.
+  unsigned int match_shards_;
+  size_t fingerprint_tasks_;
+  // The time spent in each stage, for --stats.
+  Timer::TimeStats stage_times_[STAGE_COUNT];
 };
 
 // This function returns true if this section corresponds to a function that
@@ -155,6 +155,17 @@ explain_no_incremental(const char* format, ...)
   va_end(args);
 }
 
+// Class Incremental_binary.
+
+// The number of replaced global symbols whose incremental relocations
+// were reapplied.
+unsigned int Incremental_binary::num_changed_symbols = 0;
+// The number of replaced global symbols whose value was unchanged, so
+// that their incremental relocations could be skipped.
+unsigned int Incremental_binary::num_unchanged_symbols = 0;
+// The number of incremental relocations reapplied.
+unsigned int Incremental_binary::num_relocs_applied = 0;
+
 // Report an error.
 
 void
@@ -171,6 +182,19 @@ Incremental_binary::error(const char* format, ...) const
   va_end(args);
 }
 
+// Print statistics about incremental relocation processing.
+
+void
+Incremental_binary::print_stats()
+{
+  fprintf(stderr, _("%s: replaced symbols with new values: %u\n"),
+	  program_name, Incremental_binary::num_changed_symbols);
+  fprintf(stderr, _("%s: replaced symbols with unchanged values: %u\n"),
+	  program_name, Incremental_binary::num_unchanged_symbols);
+  fprintf(stderr, _("%s: incremental relocations reapplied: %u\n"),
+	  program_name, Incremental_binary::num_relocs_applied);
+}
+
 // Return TRUE if a section of type SH_TYPE can be updated in place
 // during an incremental update.  We can update sections of type PROGBITS,
 // NOBITS, INIT_ARRAY, FINI_ARRAY, PREINIT_ARRAY, and NOTE.  All others
@@ -736,6 +760,7 @@ Sized_incremental_binary<size, big_endian>::do_apply_incremental_relocs(
 {
   typedef typename elfcpp::Elf_types<size>::Elf_Addr Address;
   typedef typename elfcpp::Elf_types<size>::Elf_Swxword Addend;
+  const int sym_size = elfcpp::Elf_sizes<size>::sym_size;
   Incremental_symtab_reader<big_endian> isymtab(this->symtab_reader());
   Incremental_relocs_reader<size, big_endian> irelocs(this->relocs_reader());
   unsigned int nglobals = isymtab.symbol_count();
@@ -753,6 +778,26 @@ Sized_incremental_binary<size, big_endian>::do_apply_incremental_relocs(
   Sized_target<size, big_endian>* target =
       parameters->sized_target<size, big_endian>();
 
+  // The main symbol table of the base file still holds the value each
+  // symbol had when its relocations were last applied.  As in
+  // do_process_got_plt, the incremental symbol table entries map onto
+  // the tail of the main symbol table.
+  View symtab_view(NULL);
+  unsigned int symtab_count;
+  elfcpp::Elf_strtab strtab(NULL, 0);
+  this->get_symtab_view(&symtab_view, &symtab_count, &strtab);
+  gold_assert(symtab_count >= nglobals);
+  unsigned int first_global = symtab_count - nglobals;
+
+  // The output section of the last relocation, and a view of it.
+  // Relocations for a symbol tend to be grouped by section, so this
+  // saves looking up the section and view for each one.
+  unsigned int last_shndx = 0;
+  Address address = 0;
+  off_t section_offset = 0;
+  size_t view_size = 0;
+  unsigned char* view = NULL;
+
   for (unsigned int i = 0; i < nglobals; i++)
     {
       const Symbol* gsym = this->global_symbol(i);
@@ -768,6 +813,34 @@ Sized_incremental_binary<size, big_endian>::do_apply_incremental_relocs(
 	  && gsym->object()->is_incremental())
 	continue;
 
+      // If the symbol was replaced but ended up with the same value it
+      // had in the base file, the relocations already in the file are
+      // still correct.  This is the common case when a changed file is
+      // laid out in the space it occupied before.  We leave TLS, IFUNC,
+      // and PLT symbols alone, since their relocations depend on more
+      // than the symbol value.
+      if (gsym->is_defined()
+	  && !gsym->is_from_dynobj()
+	  && !gsym->has_plt_offset()
+	  && gsym->type() != elfcpp::STT_TLS
+	  && gsym->type() != elfcpp::STT_GNU_IFUNC)
+	{
+	  elfcpp::Sym<size, big_endian> old_sym(
+	      symtab_view.data() + (first_global + i) * sym_size);
+	  if (old_sym.get_st_shndx() != elfcpp::SHN_UNDEF
+	      && (old_sym.get_st_value()
+		  == static_cast<const Sized_symbol<size>*>(gsym)->value()))
+	    {
+	      gold_debug(DEBUG_INCREMENTAL,
+			 "Value of global symbol %s [%d] is unchanged",
+			 gsym->name(), i);
+	      ++Incremental_binary::num_unchanged_symbols;
+	      continue;
+	    }
+	}
+
+      ++Incremental_binary::num_changed_symbols;
+
       gold_debug(DEBUG_INCREMENTAL,
 		 "Applying incremental relocations for global symbol %s [%d]",
 		 gsym->name(), i);
@@ -794,31 +867,36 @@ Sized_incremental_binary<size, big_endian>::do_apply_incremental_relocs(
 	      unsigned int r_shndx = irelocs.get_r_shndx(r_base);
 	      Address r_offset = irelocs.get_r_offset(r_base);
 	      Addend r_addend = irelocs.get_r_addend(r_base);
-	      Output_section* os = this->output_section(r_shndx);
-	      Address address = os->address();
-	      off_t section_offset = os->offset();
-	      size_t view_size = os->data_size();
-	      unsigned char* const view = of->get_output_view(section_offset,
-							      view_size);
+	      if (view == NULL || r_shndx != last_shndx)
+		{
+		  if (view != NULL)
+		    of->write_output_view(section_offset, view_size, view);
+		  Output_section* os = this->output_section(r_shndx);
+		  address = os->address();
+		  section_offset = os->offset();
+		  view_size = os->data_size();
+		  view = of->get_output_view(section_offset, view_size);
+		  last_shndx = r_shndx;
+		}
 
 	      gold_debug(DEBUG_INCREMENTAL,
 			 "  %08lx: %s + %d: type %d addend %ld",
 			 (long)(section_offset + r_offset),
-			 os->name(),
+			 this->output_section(r_shndx)->name(),
 			 (int)r_offset,
 			 r_type,
 			 (long)r_addend);
 
 	      target->apply_relocation(&relinfo, r_offset, r_type, r_addend,
 				       gsym, view, address, view_size);
-
-	      // FIXME: Do something more efficient if write_output_view
-	      // ever becomes more than a no-op.
-	      of->write_output_view(section_offset, view_size, view);
+	      ++Incremental_binary::num_relocs_applied;
 	    }
 	  offset = sym_info.next_offset();
 	}
     }
+
+  if (view != NULL)
+    of->write_output_view(section_offset, view_size, view);
 }
 
 // Get a view of the main symbol table and the symbol string table.
@@ -1360,6 +1360,10 @@ class Incremental_binary
   void
   error(const char* format, ...) const ATTRIBUTE_PRINTF_2;
 
+  // Print statistics about incremental relocation processing.
+  static void
+  print_stats();
+
   // Proxy class for a sized Incremental_input_entry_reader.
 
   class Input_reader
@@ -1577,6 +1581,16 @@ class Incremental_binary
   // Map from an input file index to a Script_info.
   std::vector<Script_info*> script_map_;
 
+  // Statistics:
+  // The number of replaced global symbols whose incremental relocations
+  // were reapplied.
+  static unsigned int num_changed_symbols;
+  // The number of replaced global symbols whose incremental relocations
+  // were skipped because the symbol value did not change.
+  static unsigned int num_unchanged_symbols;
+  // The number of incremental relocations reapplied.
+  static unsigned int num_relocs_applied;
+
  private:
   // Edited output file object.
   Output_file* output_;
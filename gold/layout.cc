@@ -52,6 +52,7 @@
 #include "descriptors.h"
 #include "plugin.h"
 #include "incremental.h"
+#include "call-graph.h"
 #include "layout.h"
 
 namespace gold
@@ -235,7 +236,100 @@ Free_list::print_stats()
 	  program_name, Free_list::num_allocate_visits);
 }
 
-// A Hash_task computes the MD5 checksum of an array of char.
+// Compute a fast 128-bit non-cryptographic hash of the LEN bytes at
+// DATA, and store it in the 16 bytes at DST.  This is used for
+// --build-id=fast.  The hash is MurmurHash3_x64_128 with a seed of 0,
+// by Austin Appleby, who placed it in the public domain.  We read and
+// write the data as little-endian, so that the result does not
+// depend on the host.
+
+static inline uint64_t
+fast_hash_rotl(uint64_t x, int r)
+{
+  return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t
+fast_hash_fmix(uint64_t k)
+{
+  k ^= k >> 33;
+  k *= 0xff51afd7ed558ccdULL;
+  k ^= k >> 33;
+  k *= 0xc4ceb9fe1a85ec53ULL;
+  k ^= k >> 33;
+  return k;
+}
+
+static void
+fast_hash_buffer(const unsigned char* data, size_t len, unsigned char* dst)
+{
+  const uint64_t c1 = 0x87c37b91114253d5ULL;
+  const uint64_t c2 = 0x4cf5ad432745937fULL;
+  uint64_t h1 = 0;
+  uint64_t h2 = 0;
+
+  const size_t nblocks = len / 16;
+  for (size_t i = 0; i < nblocks; ++i)
+    {
+      const unsigned char* p = data + i * 16;
+      uint64_t k1 = elfcpp::Swap_unaligned<64, false>::readval(p);
+      uint64_t k2 = elfcpp::Swap_unaligned<64, false>::readval(p + 8);
+
+      k1 *= c1;
+      k1 = fast_hash_rotl(k1, 31);
+      k1 *= c2;
+      h1 ^= k1;
+      h1 = fast_hash_rotl(h1, 27);
+      h1 += h2;
+      h1 = h1 * 5 + 0x52dce729;
+
+      k2 *= c2;
+      k2 = fast_hash_rotl(k2, 33);
+      k2 *= c1;
+      h2 ^= k2;
+      h2 = fast_hash_rotl(h2, 31);
+      h2 += h1;
+      h2 = h2 * 5 + 0x38495ab5;
+    }
+
+  const unsigned char* tail = data + nblocks * 16;
+  const size_t rest = len & 15;
+  uint64_t k1 = 0;
+  uint64_t k2 = 0;
+  for (size_t i = rest; i > 8; --i)
+    k2 ^= static_cast<uint64_t>(tail[i - 1]) << ((i - 9) * 8);
+  if (rest > 8)
+    {
+      k2 *= c2;
+      k2 = fast_hash_rotl(k2, 33);
+      k2 *= c1;
+      h2 ^= k2;
+    }
+  for (size_t i = std::min(rest, static_cast<size_t>(8)); i > 0; --i)
+    k1 ^= static_cast<uint64_t>(tail[i - 1]) << ((i - 1) * 8);
+  if (rest > 0)
+    {
+      k1 *= c1;
+      k1 = fast_hash_rotl(k1, 31);
+      k1 *= c2;
+      h1 ^= k1;
+    }
+
+  h1 ^= len;
+  h2 ^= len;
+  h1 += h2;
+  h2 += h1;
+  h1 = fast_hash_fmix(h1);
+  h2 = fast_hash_fmix(h2);
+  h1 += h2;
+  h2 += h1;
+
+  elfcpp::Swap_unaligned<64, false>::writeval(dst, h1);
+  elfcpp::Swap_unaligned<64, false>::writeval(dst + 8, h2);
+}
+
+// A Hash_task computes the MD5 checksum of an array of char, or the
+// fast hash for --build-id=fast.
 
 class Hash_task : public Task
 {
@@ -244,8 +338,9 @@ class Hash_task : public Task
 	    size_t offset,
 	    size_t size,
 	    unsigned char* dst,
+	    bool is_fast,
 	    Task_token* final_blocker)
-    : of_(of), offset_(offset), size_(size), dst_(dst),
+    : of_(of), offset_(offset), size_(size), dst_(dst), is_fast_(is_fast),
       final_blocker_(final_blocker)
   { }
 
@@ -254,7 +349,11 @@ class Hash_task : public Task
   {
     const unsigned char* iv =
 	this->of_->get_input_view(this->offset_, this->size_);
-    md5_buffer(reinterpret_cast<const char*>(iv), this->size_, this->dst_);
+    if (this->is_fast_)
+      fast_hash_buffer(iv, this->size_, this->dst_);
+    else
+      md5_buffer(reinterpret_cast<const char*>(iv), this->size_,
+		 this->dst_);
     this->of_->free_input_view(this->offset_, this->size_, iv);
   }
 
@@ -276,6 +375,7 @@ class Hash_task : public Task
   const size_t offset_;
   const size_t size_;
   unsigned char* const dst_;
+  const bool is_fast_;
   Task_token* const final_blocker_;
 };
 
@@ -363,9 +463,9 @@ Layout::Relaxation_debug_check::verify_sections(
 void
 Layout_task_runner::run(Workqueue* workqueue, const Task* task)
 {
-  // See if any of the input definitions violate the One Definition Rule.
-  // TODO: if this is too slow, do this as a task, rather than inline.
-  this->symtab_->detect_odr_violations(task, this->options_.output_file_name());
+  // Report any input definitions which violate the One Definition
+  // Rule.  They were checked by the tasks queued by queue_odr_tasks.
+  this->symtab_->detect_odr_violations(this->options_.output_file_name());
 
   Layout* layout = this->layout_;
   off_t file_size = layout->finalize(this->input_objects_,
@@ -447,6 +547,7 @@ Layout::Layout(int number_of_input_files, Script_options* script_options)
     build_id_note_(NULL),
     debug_abbrev_(NULL),
     debug_info_(NULL),
+    compressed_sections_(),
     group_signatures_(),
     output_file_size_(-1),
     have_added_input_section_(false),
@@ -455,6 +556,7 @@ Layout::Layout(int number_of_input_files, Script_options* script_options)
     input_with_gnu_stack_note_(false),
     input_without_gnu_stack_note_(false),
     has_static_tls_(false),
+    has_relr_dyn_(false),
     any_postprocessing_sections_(false),
     resized_signatures_(false),
     have_stabstr_section_(false),
@@ -469,6 +571,7 @@ Layout::Layout(int number_of_input_files, Script_options* script_options)
     section_segment_map_(),
     input_section_position_(),
     input_section_glob_(),
+    call_graph_ordering_(NULL),
     incremental_base_(NULL),
     free_list_()
 {
@@ -1052,6 +1155,17 @@ Layout::choose_output_section(const Relobj* relobj, const char* name,
       name = parameters->target().output_section_name(relobj, name, &len);
       if (name == NULL)
 	name = Layout::output_section_name(relobj, orig_name, &len);
+
+      // With --hot-text-align, the hot text sections go in their own
+      // output section so that align_hot_text can align it.
+      if (parameters->options().hot_text_align() != 0
+	  && !parameters->incremental()
+	  && (strcmp(orig_name, ".text.hot") == 0
+	      || is_prefix_of(".text.hot.", orig_name)))
+	{
+	  name = ".text.hot";
+	  len = strlen(name);
+	}
     }
 
   Stringpool::Key name_key;
@@ -1103,6 +1217,34 @@ Layout::init_fixed_output_section(const char* name,
   return os;
 }
 
+// For --hot-text-align, align the .text.hot output section to the
+// requested size in memory and in the file, and pad it to a multiple
+// of that size, so that the hot code fills whole huge pages.  Aligning
+// the section also aligns its segment, and set_segment_offsets keeps
+// file offsets congruent to addresses modulo the segment alignment.
+// If no input section was marked hot, we align all of .text instead.
+
+void
+Layout::align_hot_text()
+{
+  uint64_t align = parameters->options().hot_text_align();
+  if (align == 0
+      || parameters->options().relocatable()
+      || parameters->incremental()
+      || this->script_options_->saw_sections_clause())
+    return;
+
+  Output_section* os = this->find_output_section(".text.hot");
+  if (os == NULL)
+    os = this->find_output_section(".text");
+  if (os == NULL || (os->flags() & elfcpp::SHF_EXECINSTR) == 0)
+    return;
+
+  if (os->addralign() < align)
+    os->set_addralign(align);
+  os->set_pad_to_addralign();
+}
+
 // Return the index by which an input section should be ordered.  This
 // is used to sort some .text sections, for compatibility with GNU ld.
 
@@ -1218,12 +1360,15 @@ Layout::layout(Sized_relobj_file<size, big_endian>* object, unsigned int shndx,
     os->set_must_sort_attached_input_sections();
 
   // By default the GNU linker sorts some special text sections ahead
-  // of others.  We are compatible.
+  // of others.  We are compatible.  There is nothing to sort if the
+  // hot text sections have their own output section.
   if (parameters->options().text_reorder()
       && !this->script_options_->saw_sections_clause()
       && !this->is_section_ordering_specified()
       && !parameters->options().relocatable()
-      && Layout::special_ordering_of_input_section(name) >= 0)
+      && Layout::special_ordering_of_input_section(name) >= 0
+      && !(parameters->options().hot_text_align() != 0
+	   && strcmp(os->name(), ".text.hot") == 0))
     os->set_must_sort_attached_input_sections();
 
   // If this is a .ctors or .ctors.* section being mapped to a
@@ -1402,7 +1547,7 @@ Layout::layout_eh_frame(Sized_relobj_file<size, big_endian>* object,
 			unsigned int shndx,
 			const elfcpp::Shdr<size, big_endian>& shdr,
 			unsigned int reloc_shndx, unsigned int reloc_type,
-			off_t* off)
+			Eh_frame_input* input, off_t* off)
 {
   gold_assert(shdr.get_sh_type() == elfcpp::SHT_PROGBITS
 	      || shdr.get_sh_type() == elfcpp::SHT_X86_64_UNWIND);
@@ -1427,7 +1572,8 @@ Layout::layout_eh_frame(Sized_relobj_file<size, big_endian>* object,
 							     symbol_names_size,
 							     shndx,
 							     reloc_shndx,
-							     reloc_type);
+							     reloc_type,
+							     input);
     }
 
   if (disp == Eh_frame::EH_OPTIMIZABLE_SECTION)
@@ -1640,8 +1786,13 @@ Layout::make_output_section(const char* name, elfcpp::Elf_Word type,
   if ((flags & elfcpp::SHF_ALLOC) == 0
       && strcmp(parameters->options().compress_debug_sections(), "none") != 0
       && is_compressible_debug_section(name))
-    os = new Output_compressed_section(&parameters->options(), name, type,
-				       flags);
+    {
+      Output_compressed_section* ocs =
+	new Output_compressed_section(&parameters->options(), name, type,
+				      flags);
+      this->compressed_sections_.push_back(ocs);
+      os = ocs;
+    }
   else if ((flags & elfcpp::SHF_ALLOC) == 0
 	   && parameters->options().strip_debug_non_line()
 	   && strcmp(".debug_abbrev", name) == 0)
@@ -2643,6 +2794,19 @@ Layout::read_layout_from_file()
     }
 }
 
+// Read the call graph profile from the file specified with option
+// --call-graph-ordering-file.  The sections are ordered from it once
+// they have all been laid out.
+
+void
+Layout::read_call_graph_ordering_file()
+{
+  this->call_graph_ordering_ = new Call_graph_ordering();
+  this->call_graph_ordering_->read(
+      parameters->options().call_graph_ordering_file());
+  this->set_section_ordering_specified();
+}
+
 // Finalize the layout.  When this is called, we have created all the
 // output sections and all the output segments which are based on
 // input sections.  We have several things to do, and we have to do
@@ -2756,6 +2920,8 @@ Layout::finalize(const Input_objects* input_objects, Symbol_table* symtab,
   unsigned int shndx;
   int pass = 0;
 
+  this->align_hot_text();
+
   // Take a snapshot of the section layout as needed.
   if (target->may_relax())
     this->prepare_for_relaxation();
@@ -3051,6 +3217,8 @@ Layout::create_build_id()
     descsz = 128 / 8;
   else if ((strcmp(style, "sha1") == 0) || (strcmp(style, "tree") == 0))
     descsz = 160 / 8;
+  else if (strcmp(style, "fast") == 0)
+    descsz = 128 / 8;
   else if (strcmp(style, "uuid") == 0)
     {
       const size_t uuidsz = 128 / 8;
@@ -4230,6 +4398,11 @@ Layout::create_dynamic_symtab(const Input_objects* input_objects,
   unsigned int local_symcount = index;
   *plocal_dynamic_count = local_symcount;
 
+  // The versions are finalized along with the dynamic symbols, so
+  // this is our last chance to add a version reference.
+  if (this->has_relr_dyn_)
+    pversions->add_glibc_abi_dt_relr(symtab, &this->dynpool_);
+
   index = symtab->set_dynsym_indexes(index, pdynamic_symbols,
 				     &this->dynpool_, pversions);
 
@@ -4719,6 +4892,22 @@ Layout::add_target_dynamic_tags(bool use_rel, const Output_data* plt_got,
     }
 }
 
+// Add the DT_RELR, DT_RELRSZ and DT_RELRENT tags for RELR_DYN, a
+// SHT_RELR section.
+
+void
+Layout::add_relr_dynamic_tags(const Output_data* relr_dyn)
+{
+  Output_data_dynamic* odyn = this->dynamic_data_;
+  if (odyn == NULL || relr_dyn->output_section() == NULL)
+    return;
+
+  odyn->add_section_address(elfcpp::DT_RELR, relr_dyn->output_section());
+  odyn->add_section_size(elfcpp::DT_RELRSZ, relr_dyn->output_section());
+  odyn->add_constant(elfcpp::DT_RELRENT, parameters->target().get_size() / 8);
+  this->has_relr_dyn_ = true;
+}
+
 // Finish the .dynamic section and PT_DYNAMIC segment.
 
 void
@@ -5384,9 +5573,22 @@ Layout::write_sections_after_input_sections(Output_file* of)
   this->section_headers_->write(of);
 }
 
-// If a tree-style build ID was requested, the parallel part of that computation
-// is already done, and the final hash-of-hashes is computed here.  For other
-// types of build IDs, all the work is done here.
+// Queue tasks to compress the sections which are written compressed.
+
+void
+Layout::queue_compression_tasks(Workqueue* workqueue, Task_token* blocker)
+{
+  for (std::vector<Output_compressed_section*>::const_iterator p =
+	 this->compressed_sections_.begin();
+       p != this->compressed_sections_.end();
+       ++p)
+    (*p)->queue_compression_tasks(workqueue, blocker);
+}
+
+// If a tree-style or fast build ID was requested, the parallel part of
+// that computation is already done, and the final hash-of-hashes is
+// computed here.  For other types of build IDs, all the work is done
+// here.
 
 void
 Layout::write_build_id(Output_file* of, unsigned char* array_of_hashes,
@@ -5398,29 +5600,72 @@ Layout::write_build_id(Output_file* of, unsigned char* array_of_hashes,
   unsigned char* ov = of->get_output_view(this->build_id_note_->offset(),
 					  this->build_id_note_->data_size());
 
-  if (array_of_hashes == NULL)
+  const char* style = parameters->options().build_id();
+  const bool is_fast = strcmp(style, "fast") == 0;
+
+  if (array_of_hashes == NULL && is_fast)
+    {
+      // The output file is empty, so there was nothing to hash in
+      // parallel.
+      fast_hash_buffer(NULL, 0, ov);
+    }
+  else if (array_of_hashes == NULL)
     {
       const size_t output_file_size = this->output_file_size();
-      const unsigned char* iv = of->get_input_view(0, output_file_size);
-      const char* style = parameters->options().build_id();
 
       // If we get here with style == "tree" then the output must be
       // too small for chunking, and we use SHA-1 in that case.
+      bool is_sha1;
       if ((strcmp(style, "sha1") == 0) || (strcmp(style, "tree") == 0))
-	sha1_buffer(reinterpret_cast<const char*>(iv), output_file_size, ov);
+	is_sha1 = true;
       else if (strcmp(style, "md5") == 0)
-	md5_buffer(reinterpret_cast<const char*>(iv), output_file_size, ov);
+	is_sha1 = false;
       else
 	gold_unreachable();
 
-      of->free_input_view(0, output_file_size, iv);
+      // If the output file is not mapped, read it back a piece at a
+      // time so that we stay within the memory limit.
+      size_t chunk_size = output_file_size;
+      if (of->is_streaming())
+	{
+	  uint64_t limit = parameters->options().output_memory_limit();
+	  if (limit < 4096)
+	    limit = 4096;
+	  if (limit < chunk_size)
+	    chunk_size = limit;
+	}
+
+      struct sha1_ctx sha1_ctx;
+      struct md5_ctx md5_ctx;
+      if (is_sha1)
+	sha1_init_ctx(&sha1_ctx);
+      else
+	md5_init_ctx(&md5_ctx);
+      for (size_t off = 0; off < output_file_size; off += chunk_size)
+	{
+	  size_t len = std::min(chunk_size, output_file_size - off);
+	  const unsigned char* iv = of->get_input_view(off, len);
+	  if (is_sha1)
+	    sha1_process_bytes(iv, len, &sha1_ctx);
+	  else
+	    md5_process_bytes(iv, len, &md5_ctx);
+	  of->free_input_view(off, len, iv);
+	}
+      if (is_sha1)
+	sha1_finish_ctx(&sha1_ctx, ov);
+      else
+	md5_finish_ctx(&md5_ctx, ov);
     }
   else
     {
       // Non-overlapping substrings of the output file have been hashed.
-      // Compute SHA-1 hash of the hashes.
-      sha1_buffer(reinterpret_cast<const char*>(array_of_hashes),
-		  size_of_hashes, ov);
+      // Compute the hash of the hashes, using SHA-1 except for
+      // --build-id=fast.
+      if (is_fast)
+	fast_hash_buffer(array_of_hashes, size_of_hashes, ov);
+      else
+	sha1_buffer(reinterpret_cast<const char*>(array_of_hashes),
+		    size_of_hashes, ov);
       delete[] array_of_hashes;
     }
 
@@ -5502,12 +5747,39 @@ Layout::print_stats() const
   this->sympool_.print_stats("output symbol name pool");
   this->dynpool_.print_stats("dynamic name pool");
 
+  if (this->call_graph_ordering_ != NULL)
+    this->call_graph_ordering_->print_stats();
+
+  Output_compressed_section::print_stats();
+
   for (Section_list::const_iterator p = this->section_list_.begin();
        p != this->section_list_.end();
        ++p)
     (*p)->print_merge_stats();
 }
 
+// Queue tasks to merge SHF_MERGE sections in parallel.
+
+void
+Layout::queue_merge_tasks(Workqueue* workqueue, unsigned int shard_count,
+			  Task_token* merge_blocker)
+{
+  for (Section_list::const_iterator p = this->section_list_.begin();
+       p != this->section_list_.end();
+       ++p)
+    (*p)->queue_merge_tasks(workqueue, shard_count, merge_blocker);
+}
+
+// Queue tasks to scan the debug information for the .gdb_index
+// section.
+
+void
+Layout::queue_gdb_index_tasks(Workqueue* workqueue, Task_token* blocker)
+{
+  if (this->gdb_index_data_ != NULL)
+    this->gdb_index_data_->queue_scan_tasks(workqueue, blocker);
+}
+
 // Write_sections_task methods.
 
 // We can always run this task.
@@ -5620,10 +5892,40 @@ Write_after_input_sections_task::run(Workqueue*)
   this->layout_->write_sections_after_input_sections(this->of_);
 }
 
+// Compress_sections_task methods.
+
+// We can only run this task after the input sections have completed.
+
+Task_token*
+Compress_sections_task::is_runnable()
+{
+  if (this->input_sections_blocker_->is_blocked())
+    return this->input_sections_blocker_;
+  return NULL;
+}
+
+// We hold NEXT_BLOCKER until we have queued the chunk tasks.
+
+void
+Compress_sections_task::locks(Task_locker* tl)
+{
+  tl->add(this, this->next_blocker_);
+}
+
+// Run the task.
+
+void
+Compress_sections_task::run(Workqueue* workqueue)
+{
+  this->layout_->queue_compression_tasks(workqueue, this->next_blocker_);
+}
+
 // Build IDs can be computed as a "flat" sha1 or md5 of a string of bytes,
 // or as a "tree" where each chunk of the string is hashed and then those
 // hashes are put into a (much smaller) string which is hashed with sha1.
-// We compute a checksum over the entire file because that is simplest.
+// A "fast" build ID is always computed as a tree, using the fast hash
+// for both the chunks and the hashes.  We compute a checksum over the
+// entire file because that is simplest.
 
 void
 Build_id_task_runner::run(Workqueue* workqueue, const Task*)
@@ -5636,27 +5938,34 @@ Build_id_task_runner::run(Workqueue* workqueue, const Task*)
   unsigned char* array_of_hashes = NULL;
   size_t size_of_hashes = 0;
 
-  if (strcmp(this->options_->build_id(), "tree") == 0
-      && this->options_->build_id_chunk_size_for_treehash() > 0
-      && filesize > 0
-      && (filesize >= this->options_->build_id_min_file_size_for_treehash()))
+  const bool is_fast = strcmp(this->options_->build_id(), "fast") == 0;
+  size_t chunk_size = this->options_->build_id_chunk_size_for_treehash();
+  if (is_fast && chunk_size == 0)
+    chunk_size = filesize;
+
+  if ((is_fast && filesize > 0)
+      || (strcmp(this->options_->build_id(), "tree") == 0
+	  && chunk_size > 0
+	  && filesize > 0
+	  && (filesize
+	      >= this->options_->build_id_min_file_size_for_treehash())))
     {
-      static const size_t MD5_OUTPUT_SIZE_IN_BYTES = 16;
-      const size_t chunk_size =
-	  this->options_->build_id_chunk_size_for_treehash();
+      // MD5 and the fast hash both produce 16 bytes.
+      static const size_t HASH_OUTPUT_SIZE_IN_BYTES = 16;
       const size_t num_hashes = ((filesize - 1) / chunk_size) + 1;
       post_hash_tasks_blocker->add_blockers(num_hashes);
-      size_of_hashes = num_hashes * MD5_OUTPUT_SIZE_IN_BYTES;
+      size_of_hashes = num_hashes * HASH_OUTPUT_SIZE_IN_BYTES;
       array_of_hashes = new unsigned char[size_of_hashes];
       unsigned char *dst = array_of_hashes;
       for (size_t i = 0, src_offset = 0; i < num_hashes;
-	   i++, dst += MD5_OUTPUT_SIZE_IN_BYTES, src_offset += chunk_size)
+	   i++, dst += HASH_OUTPUT_SIZE_IN_BYTES, src_offset += chunk_size)
 	{
 	  size_t size = std::min(chunk_size, filesize - src_offset);
 	  workqueue->queue(new Hash_task(of,
 					 src_offset,
 					 size,
 					 dst,
+					 is_fast,
 					 post_hash_tasks_blocker));
 	}
     }
@@ -5870,6 +6179,7 @@ Layout::layout_eh_frame<32, false>(Sized_relobj_file<32, false>* object,
 				   const elfcpp::Shdr<32, false>& shdr,
 				   unsigned int reloc_shndx,
 				   unsigned int reloc_type,
+				   Eh_frame_input* input,
 				   off_t* off);
 #endif
 
@@ -5885,6 +6195,7 @@ Layout::layout_eh_frame<32, true>(Sized_relobj_file<32, true>* object,
 				  const elfcpp::Shdr<32, true>& shdr,
 				  unsigned int reloc_shndx,
 				  unsigned int reloc_type,
+				  Eh_frame_input* input,
 				  off_t* off);
 #endif
 
@@ -5900,6 +6211,7 @@ Layout::layout_eh_frame<64, false>(Sized_relobj_file<64, false>* object,
 				   const elfcpp::Shdr<64, false>& shdr,
 				   unsigned int reloc_shndx,
 				   unsigned int reloc_type,
+				   Eh_frame_input* input,
 				   off_t* off);
 #endif
 
@@ -5915,6 +6227,7 @@ Layout::layout_eh_frame<64, true>(Sized_relobj_file<64, true>* object,
 				  const elfcpp::Shdr<64, true>& shdr,
 				  unsigned int reloc_shndx,
 				  unsigned int reloc_type,
+				  Eh_frame_input* input,
 				  off_t* off);
 #endif
 
@@ -57,8 +57,11 @@ class Output_data_dynamic;
 class Output_symtab_xindex;
 class Output_reduced_debug_abbrev_section;
 class Output_reduced_debug_info_section;
+class Output_compressed_section;
 class Eh_frame;
+class Eh_frame_input;
 class Gdb_index;
+class Call_graph_ordering;
 class Target;
 struct Timespec;
 
@@ -594,6 +597,16 @@ class Layout
   void
   read_layout_from_file();
 
+  // Read the call graph profile from the file specified with linker
+  // option --call-graph-ordering-file.
+  void
+  read_call_graph_ordering_file();
+
+  // Return the call graph profile, or NULL if there is none.
+  Call_graph_ordering*
+  call_graph_ordering() const
+  { return this->call_graph_ordering_; }
+
   // Layout an input reloc section when doing a relocatable link.  The
   // section is RELOC_SHNDX in OBJECT, with data in SHDR.
   // DATA_SECTION is the reloc section to which it refers.  RR is the
@@ -625,8 +638,10 @@ class Layout
   // .eh_frame section in OBJECT.  SHDR is the section header.
   // RELOC_SHNDX is the index of a relocation section which applies to
   // this section, or 0 if none, or -1U if more than one.  RELOC_TYPE
-  // is the type of the relocation section if there is one.  This
-  // returns the output section, and sets *OFFSET to the offset.
+  // is the type of the relocation section if there is one.  INPUT is
+  // the section as already parsed by
+  // Eh_frame::read_ehframe_input_section, or NULL.  This returns the
+  // output section, and sets *OFFSET to the offset.
   template<int size, bool big_endian>
   Output_section*
   layout_eh_frame(Sized_relobj_file<size, big_endian>* object,
@@ -637,7 +652,7 @@ class Layout
 		  unsigned int shndx,
 		  const elfcpp::Shdr<size, big_endian>& shdr,
 		  unsigned int reloc_shndx, unsigned int reloc_type,
-		  off_t* offset);
+		  Eh_frame_input* input, off_t* offset);
 
   // After processing all input files, we call this to make sure that
   // the optimized .eh_frame sections have been added to the output
@@ -800,6 +815,16 @@ class Layout
   any_postprocessing_sections() const
   { return this->any_postprocessing_sections_; }
 
+  // Return whether any sections are written compressed.
+  bool
+  any_compressed_sections() const
+  { return !this->compressed_sections_.empty(); }
+
+  // Queue tasks to compress the sections which are written
+  // compressed.  Each task unblocks BLOCKER when it is done.
+  void
+  queue_compression_tasks(Workqueue*, Task_token* blocker);
+
   // Return the size of the output file.
   off_t
   output_file_size() const
@@ -901,6 +926,11 @@ class Layout
 			  const Output_data_reloc_generic* dyn_rel,
 			  bool add_debug, bool dynrel_includes_plt);
 
+  // For the target-specific code to add the dynamic tags for a
+  // SHT_RELR section of packed relative relocations.
+  void
+  add_relr_dynamic_tags(const Output_data* relr_dyn);
+
   // Compute and write out the build ID if needed.
   void
   write_build_id(Output_file*, unsigned char*, size_t) const;
@@ -917,6 +947,19 @@ class Layout
   void
   print_stats() const;
 
+  // Queue tasks to merge the contents of SHF_MERGE sections in
+  // parallel, using SHARD_COUNT shards per section.  The tasks
+  // unblock MERGE_BLOCKER when they are done.
+  void
+  queue_merge_tasks(Workqueue*, unsigned int shard_count,
+		    Task_token* merge_blocker);
+
+  // Queue tasks to scan the debug information of the input objects
+  // for the .gdb_index section in parallel.  The tasks unblock
+  // BLOCKER when they are done.
+  void
+  queue_gdb_index_tasks(Workqueue*, Task_token* blocker);
+
   // A list of segments.
 
   typedef std::vector<Output_segment*> Segment_list;
@@ -1226,6 +1269,10 @@ class Layout
   void
   clean_up_after_relaxation();
 
+  // Align and pad the hot text for --hot-text-align.
+  void
+  align_hot_text();
+
   // Doing preparation work for relaxation.  This is factored out to make
   // Layout::finalized a bit smaller and easier to read.
   void
@@ -1381,6 +1428,8 @@ class Layout
   Output_reduced_debug_abbrev_section* debug_abbrev_;
   // The output section containing the dwarf debug info tree
   Output_reduced_debug_info_section* debug_info_;
+  // The output sections which are written compressed.
+  std::vector<Output_compressed_section*> compressed_sections_;
   // A list of group sections and their signatures.
   Group_signatures group_signatures_;
   // The size of the output file.
@@ -1400,6 +1449,8 @@ class Layout
   bool input_without_gnu_stack_note_;
   // Whether we have seen an object file that uses the static TLS model.
   bool has_static_tls_;
+  // Whether we have added DT_RELR to the dynamic section.
+  bool has_relr_dyn_;
   // Whether any sections require postprocessing.
   bool any_postprocessing_sections_;
   // Whether we have resized the signatures_ hash table.
@@ -1435,6 +1486,8 @@ class Layout
   Unordered_map<std::string, unsigned int> input_section_position_;
   // Vector of glob only patterns in the section_ordering file.
   std::vector<std::string> input_section_glob_;
+  // The call graph profile from --call-graph-ordering-file, or NULL.
+  Call_graph_ordering* call_graph_ordering_;
   // For incremental links, the base file to be modified.
   Incremental_binary* incremental_base_;
   // For incremental links, a list of free space within the file.
@@ -1593,6 +1646,41 @@ class Write_after_input_sections_task : public Task
   Task_token* final_blocker_;
 };
 
+// This task compresses the sections which are written compressed, by
+// queueing a task for each chunk of each section.  It can only run
+// after all the input sections have been written, and the chunk tasks
+// unblock NEXT_BLOCKER when they are done.
+
+class Compress_sections_task : public Task
+{
+ public:
+  Compress_sections_task(Layout* layout, Task_token* input_sections_blocker,
+			 Task_token* next_blocker)
+    : layout_(layout), input_sections_blocker_(input_sections_blocker),
+      next_blocker_(next_blocker)
+  { }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable();
+
+  void
+  locks(Task_locker*);
+
+  void
+  run(Workqueue*);
+
+  std::string
+  get_name() const
+  { return "Compress_sections_task"; }
+
+ private:
+  Layout* layout_;
+  Task_token* input_sections_blocker_;
+  Task_token* next_blocker_;
+};
+
 // This task function handles computation of the build id.
 // When using --build-id=tree, it schedules the tasks that
 // compute the hashes for each chunk of the file. This task
@@ -200,6 +200,11 @@ main(int argc, char** argv)
   if (parameters->options().relocatable())
     command_line.script_options().version_script_info()->clear();
 
+  // Start reading ahead the input files, now that we know what they
+  // are.
+  if (command_line.options().prefetch_inputs() > 0)
+    File_read::start_prefetch(command_line.inputs());
+
   // The work queue.
   Workqueue workqueue(command_line.options());
 
@@ -235,6 +240,9 @@ main(int argc, char** argv)
   if (parameters->options().section_ordering_file())
     layout.read_layout_from_file();
 
+  if (parameters->options().call_graph_ordering_file())
+    layout.read_call_graph_ordering_file();
+
   // Load plugin libraries.
   if (command_line.options().has_plugins())
     command_line.options().plugins()->load_plugins(&layout);
@@ -251,6 +259,11 @@ main(int argc, char** argv)
   // Run the main task processing loop.
   workqueue.process(0);
 
+  File_read::stop_prefetch();
+
+  if (command_line.options().task_timeline() != NULL)
+    workqueue.write_timeline(command_line.options().task_timeline());
+
   if (command_line.options().print_output_format())
     print_output_format();
 
@@ -298,14 +311,20 @@ main(int argc, char** argv)
       File_read::print_stats();
       Archive::print_stats();
       Lib_group::print_stats();
+      Relobj::print_prescan_stats();
       fprintf(stderr, _("%s: output file size: %lld bytes\n"),
 	      program_name, static_cast<long long>(layout.output_file_size()));
       symtab.print_stats();
       layout.print_stats();
       Gdb_index::print_stats();
       Free_list::print_stats();
+      if (parameters->incremental_update())
+	Incremental_binary::print_stats();
+      Output_file::print_stats();
     }
 
+  File_read::delete_prefetch();
+
   // Issue defined symbol report.
   if (command_line.options().user_set_print_symbol_counts())
     input_objects.print_symbol_counts(&symtab);
@@ -25,6 +25,9 @@
 #include <cstdlib>
 #include <algorithm>
 
+#include "parameters.h"
+#include "options.h"
+#include "workqueue.h"
 #include "merge.h"
 #include "compressed_output.h"
 
@@ -431,6 +434,114 @@ Output_merge_data::do_print_merge_stats(const char* section_name)
 
 // Class Output_merge_string.
 
+// A Merge_strings_hash_task computes the hash codes of the strings in
+// one chunk of the input sections of a merged string section.
+
+template<typename Char_type>
+class Merge_strings_hash_task : public Task
+{
+ public:
+  Merge_strings_hash_task(Output_merge_string<Char_type>* pomb,
+			  unsigned int chunk, Task_token* hash_blocker)
+    : pomb_(pomb), chunk_(chunk), hash_blocker_(hash_blocker)
+  { }
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  // Unblock HASH_BLOCKER_ when done.
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->hash_blocker_); }
+
+  void
+  run(Workqueue*)
+  { this->pomb_->hash_strings(this->chunk_); }
+
+  std::string
+  get_name() const
+  { return "Merge_strings_hash_task"; }
+
+ private:
+  Output_merge_string<Char_type>* pomb_;
+  const unsigned int chunk_;
+  Task_token* const hash_blocker_;
+};
+
+// A Merge_strings_shard_task merges the strings in one shard of a
+// merged string section.  It runs after all the strings of the
+// section have been hashed.
+
+template<typename Char_type>
+class Merge_strings_shard_task : public Task
+{
+ public:
+  Merge_strings_shard_task(Output_merge_string<Char_type>* pomb,
+			   unsigned int shard, Task_token* hash_blocker,
+			   Task_token* merge_blocker)
+    : pomb_(pomb), shard_(shard), hash_blocker_(hash_blocker),
+      merge_blocker_(merge_blocker)
+  { }
+
+  // Wait until all the strings have been hashed.
+  Task_token*
+  is_runnable()
+  {
+    if (this->hash_blocker_->is_blocked())
+      return this->hash_blocker_;
+    return NULL;
+  }
+
+  // Unblock MERGE_BLOCKER_ when done.
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->merge_blocker_); }
+
+  void
+  run(Workqueue*)
+  { this->pomb_->merge_shard(this->shard_); }
+
+  std::string
+  get_name() const
+  { return "Merge_strings_shard_task"; }
+
+ private:
+  Output_merge_string<Char_type>* pomb_;
+  const unsigned int shard_;
+  Task_token* const hash_blocker_;
+  Task_token* const merge_blocker_;
+};
+
+template<typename Char_type>
+Output_merge_string<Char_type>::Output_merge_string(uint64_t addralign)
+  : Output_merge_base(sizeof(Char_type), addralign), stringpool_(addralign),
+    merged_strings_lists_(), input_count_(0), input_size_(0),
+    merge_in_parallel_(parameters->options().threads()
+		       && parameters->options().parallel_string_merge()),
+    merge_chunks_(), shards_(), hash_blocker_(NULL), merged_count_(0),
+    merge_chunk_count_(0), merge_shard_count_(0),
+    merged_data_(NULL), merged_data_size_(0)
+{
+  this->stringpool_.set_no_zero_null();
+}
+
+template<typename Char_type>
+Output_merge_string<Char_type>::~Output_merge_string()
+{
+  for (typename Merged_strings_lists::iterator p =
+	 this->merged_strings_lists_.begin();
+       p != this->merged_strings_lists_.end();
+       ++p)
+    delete *p;
+  for (typename std::vector<Merge_shard*>::iterator p = this->shards_.begin();
+       p != this->shards_.end();
+       ++p)
+    delete *p;
+  delete this->hash_blocker_;
+  delete[] this->merged_data_;
+}
+
 // Add an input section to a merged string section.
 
 template<typename Char_type>
@@ -507,8 +618,11 @@ Output_merge_string<Char_type>::do_add_input_section(Relobj* object,
 	      != init_align_modulo))
 	  has_misaligned_strings = true;
 
-      Stringpool::Key key;
-      this->stringpool_.add_with_length(p, len, true, &key);
+      // When merging in parallel, the key is filled in by
+      // merge_shard.
+      Stringpool::Key key = 0;
+      if (!this->merge_in_parallel_)
+	this->stringpool_.add_with_length(p, len, true, &key);
 
       merged_strings.push_back(Merged_string(i, key));
       p += len + 1;
@@ -532,12 +646,355 @@ Output_merge_string<Char_type>::do_add_input_section(Relobj* object,
   if (this->keeps_input_sections())
     record_input_section(object, shndx);
 
-  if (is_new)
+  // When merging in parallel, we hold on to the contents until the
+  // strings are merged.
+  if (this->merge_in_parallel_)
+    {
+      gold_assert(this->shards_.empty());
+      if (is_new)
+	merged_strings_list->contents = const_cast<unsigned char*>(pdata);
+      else
+	{
+	  merged_strings_list->contents = new unsigned char[sec_len];
+	  memcpy(merged_strings_list->contents, pdata, sec_len);
+	}
+    }
+  else if (is_new)
     delete[] pdata;
 
   return true;
 }
 
+// Split the input sections into chunks of roughly equal size, one
+// for each hashing task, and create SHARD_COUNT shards.
+
+template<typename Char_type>
+void
+Output_merge_string<Char_type>::setup_shards(unsigned int shard_count)
+{
+  gold_assert(this->merge_in_parallel_ && this->shards_.empty());
+  gold_assert(shard_count > 0);
+
+  // Use a few chunks per shard, so that a single large input section
+  // does not leave the other threads idle for long.
+  const size_t min_chunk_size = 64 * 1024;
+  size_t chunk_size = this->input_size_ / (shard_count * 4);
+  if (chunk_size < min_chunk_size)
+    chunk_size = min_chunk_size;
+
+  const unsigned int list_count = this->merged_strings_lists_.size();
+  unsigned int first = 0;
+  size_t size = 0;
+  for (unsigned int i = 0; i < list_count; ++i)
+    {
+      const Merged_strings& ms(this->merged_strings_lists_[i]->merged_strings);
+      size += ms.back().offset;
+      if (size >= chunk_size || i + 1 == list_count)
+	{
+	  this->merge_chunks_.push_back(Merge_chunk(first, i + 1));
+	  this->merge_chunks_.back().shards.resize(shard_count);
+	  first = i + 1;
+	  size = 0;
+	}
+    }
+
+  this->shards_.reserve(shard_count);
+  for (unsigned int i = 0; i < shard_count; ++i)
+    this->shards_.push_back(new Merge_shard());
+
+  this->merge_chunk_count_ = this->merge_chunks_.size();
+  this->merge_shard_count_ = shard_count;
+}
+
+// Queue the tasks to merge the strings in parallel: one task per
+// chunk to compute the hash codes, followed by one task per shard to
+// merge the strings.  Only the shard tasks unblock MERGE_BLOCKER.
+
+template<typename Char_type>
+void
+Output_merge_string<Char_type>::do_queue_merge_tasks(
+    Workqueue* workqueue,
+    unsigned int shard_count,
+    Task_token* merge_blocker)
+{
+  if (!this->merge_in_parallel_ || this->merged_strings_lists_.empty())
+    return;
+
+  this->setup_shards(shard_count);
+
+  const unsigned int chunk_count = this->merge_chunks_.size();
+  this->hash_blocker_ = new Task_token(true);
+  this->hash_blocker_->add_blockers(chunk_count);
+
+  for (unsigned int i = 0; i < shard_count; ++i)
+    {
+      workqueue->add_blocker(merge_blocker);
+      workqueue->queue(new Merge_strings_shard_task<Char_type>(
+			   this, i, this->hash_blocker_, merge_blocker));
+    }
+
+  for (unsigned int i = 0; i < chunk_count; ++i)
+    workqueue->queue(new Merge_strings_hash_task<Char_type>(
+			 this, i, this->hash_blocker_));
+}
+
+// Compute the hash codes of the strings in chunk CHUNK, and record
+// each string in the list for its shard.
+
+template<typename Char_type>
+void
+Output_merge_string<Char_type>::hash_strings(unsigned int chunk)
+{
+  Merge_chunk& mc(this->merge_chunks_[chunk]);
+  for (unsigned int i = mc.first; i < mc.last; ++i)
+    {
+      Merged_strings_list* msl = this->merged_strings_lists_[i];
+      const Char_type* contents =
+	reinterpret_cast<const Char_type*>(msl->contents);
+      Merged_strings& merged_strings(msl->merged_strings);
+
+      // The last entry only records the end of the section.
+      const unsigned int count = merged_strings.size() - 1;
+      for (unsigned int j = 0; j < count; ++j)
+	{
+	  Merged_string& ms(merged_strings[j]);
+	  size_t len = ((merged_strings[j + 1].offset - ms.offset)
+			/ sizeof(Char_type)) - 1;
+	  size_t hash_code = string_hash<Char_type>(contents
+						    + (ms.offset
+						       / sizeof(Char_type)),
+						    len);
+	  ms.stringpool_key = hash_code;
+	  mc.shards[this->shard_of(hash_code)].push_back(Merged_string_ref(i,
+									  j));
+	}
+    }
+}
+
+// Merge the strings in shard SHARD.  We walk the chunks in order, so
+// the unique strings in the shard are recorded in the order in which
+// they appear in the input.
+
+template<typename Char_type>
+void
+Output_merge_string<Char_type>::merge_shard(unsigned int shard)
+{
+  Merge_shard* psh = this->shards_[shard];
+  for (typename Merge_chunks::iterator pc = this->merge_chunks_.begin();
+       pc != this->merge_chunks_.end();
+       ++pc)
+    {
+      Merged_string_refs& refs(pc->shards[shard]);
+      for (typename Merged_string_refs::const_iterator p = refs.begin();
+	   p != refs.end();
+	   ++p)
+	{
+	  Merged_strings_list* msl = this->merged_strings_lists_[p->list];
+	  Merged_string& ms(msl->merged_strings[p->index]);
+	  section_offset_type next_offset =
+	    msl->merged_strings[p->index + 1].offset;
+	  size_t len = ((next_offset - ms.offset) / sizeof(Char_type)) - 1;
+	  const Char_type* str =
+	    (reinterpret_cast<const Char_type*>(msl->contents)
+	     + ms.offset / sizeof(Char_type));
+
+	  Shard_string ss(str, len, ms.stringpool_key);
+	  std::pair<typename Shard_string_map::iterator, bool> ins =
+	    psh->string_map.insert(std::make_pair(ss, psh->strings.size()));
+	  if (ins.second)
+	    psh->strings.push_back(ss);
+	  ms.stringpool_key = this->shard_key(shard, ins.first->second);
+	}
+
+      // We no longer need this list.
+      Merged_string_refs().swap(refs);
+    }
+
+  // The hash table is no longer needed either.
+  Shard_string_map().swap(psh->string_map);
+}
+
+// Comparison routine used when sorting the unique strings with -O2.
+// See Stringpool_template::Stringpool_sort_comparison.
+
+template<typename Char_type>
+bool
+Output_merge_string<Char_type>::Shard_string_sort_comparison::operator()(
+    const Shard_index& si1,
+    const Shard_index& si2) const
+{
+  const Shard_string& ss1(this->shards_[si1.first]->strings[si1.second]);
+  const Shard_string& ss2(this->shards_[si2.first]->strings[si2.second]);
+  const size_t minlen = ss1.length < ss2.length ? ss1.length : ss2.length;
+  const Char_type* p1 = ss1.string + ss1.length - 1;
+  const Char_type* p2 = ss2.string + ss2.length - 1;
+  for (size_t i = minlen; i > 0; --i, --p1, --p2)
+    {
+      if (*p1 != *p2)
+	return *p1 > *p2;
+    }
+  return ss1.length > ss2.length;
+}
+
+// Finalize the mappings from the input sections to the output
+// section when merging in parallel, and build the contents of the
+// output section.  The offsets are assigned exactly as
+// Stringpool_template::set_string_offsets would assign them, so the
+// output does not depend on the number of shards.
+
+template<typename Char_type>
+section_size_type
+Output_merge_string<Char_type>::finalize_sharded_merged_data()
+{
+  // The section may be finalized more than once.
+  if (this->merged_data_ != NULL)
+    return this->merged_data_size_;
+
+  // If no tasks were queued, do the work here.
+  if (this->shards_.empty())
+    {
+      this->setup_shards(1);
+      for (unsigned int i = 0; i < this->merge_chunks_.size(); ++i)
+	this->hash_strings(i);
+      this->merge_shard(0);
+    }
+
+  delete this->hash_blocker_;
+  this->hash_blocker_ = NULL;
+
+  const size_t charsize = sizeof(Char_type);
+  const unsigned int shard_count = this->shards_.size();
+  const uint64_t addralign = this->addralign();
+
+  this->merged_count_ = 0;
+  for (unsigned int i = 0; i < shard_count; ++i)
+    {
+      Merge_shard* psh = this->shards_[i];
+      psh->offsets.resize(psh->strings.size(), -1);
+      this->merged_count_ += psh->strings.size();
+    }
+
+  // This is the same test as in the Stringpool_template constructor.
+  const bool optimize = (parameters->options().optimize() >= 2
+			 && addralign <= charsize);
+
+  section_offset_type offset = 0;
+  if (optimize)
+    {
+      std::vector<Shard_index> v;
+      v.reserve(this->merged_count_);
+      for (unsigned int i = 0; i < shard_count; ++i)
+	for (unsigned int j = 0; j < this->shards_[i]->strings.size(); ++j)
+	  v.push_back(Shard_index(i, j));
+
+      std::sort(v.begin(), v.end(),
+		Shard_string_sort_comparison(this->shards_));
+
+      section_offset_type last_offset = -1;
+      const Shard_string* last = NULL;
+      for (typename std::vector<Shard_index>::const_iterator p = v.begin();
+	   p != v.end();
+	   ++p)
+	{
+	  Merge_shard* psh = this->shards_[p->first];
+	  const Shard_string* curr = &psh->strings[p->second];
+	  section_offset_type this_offset;
+	  if (last != NULL
+	      && curr->length <= last->length
+	      && memcmp(curr->string,
+			last->string + last->length - curr->length,
+			curr->length * charsize) == 0)
+	    this_offset = last_offset + (last->length - curr->length) * charsize;
+	  else
+	    {
+	      this_offset = align_address(offset, addralign);
+	      offset = this_offset + (curr->length + 1) * charsize;
+	    }
+	  psh->offsets[p->second] = this_offset;
+	  last = curr;
+	  last_offset = this_offset;
+	}
+    }
+
+  for (typename Merged_strings_lists::const_iterator l =
+	 this->merged_strings_lists_.begin();
+       l != this->merged_strings_lists_.end();
+       ++l)
+    {
+      section_offset_type last_input_offset = 0;
+      section_offset_type last_output_offset = 0;
+      Relobj *object = (*l)->object;
+      Object_merge_map* merge_map = object->get_or_create_merge_map();
+      Object_merge_map::Input_merge_map* input_merge_map =
+        merge_map->get_or_make_input_merge_map(this, (*l)->shndx);
+
+      for (typename Merged_strings::const_iterator p =
+	     (*l)->merged_strings.begin();
+	   p != (*l)->merged_strings.end();
+	   ++p)
+	{
+	  section_size_type length = p->offset - last_input_offset;
+	  if (length > 0)
+	    input_merge_map->add_mapping(last_input_offset, length,
+                                         last_output_offset);
+	  last_input_offset = p->offset;
+	  if (p->stringpool_key != 0)
+	    {
+	      unsigned int shard = (p->stringpool_key - 1) % shard_count;
+	      unsigned int index = (p->stringpool_key - 1) / shard_count;
+	      Merge_shard* psh = this->shards_[shard];
+	      section_offset_type* poffset = &psh->offsets[index];
+	      if (*poffset == -1)
+		{
+		  // The first time we see a string without -O2, assign
+		  // it the next offset, as Stringpool::new_key_offset
+		  // does.
+		  gold_assert(!optimize);
+		  size_t len = psh->strings[index].length;
+		  *poffset = offset;
+		  if (len != 0)
+		    *poffset = align_address(offset, addralign);
+		  offset = *poffset + (len + 1) * charsize;
+		}
+	      last_output_offset = *poffset;
+	    }
+	}
+    }
+
+  // Copy the strings into the section contents.  The strings in the
+  // shards point into the input section contents, so we must do this
+  // before freeing them.
+  this->merged_data_size_ = offset;
+  this->merged_data_ = new unsigned char[offset];
+  memset(this->merged_data_, 0, offset);
+  for (unsigned int i = 0; i < shard_count; ++i)
+    {
+      Merge_shard* psh = this->shards_[i];
+      for (unsigned int j = 0; j < psh->strings.size(); ++j)
+	{
+	  const Shard_string& ss(psh->strings[j]);
+	  section_offset_type off = psh->offsets[j];
+	  gold_assert(off >= 0
+		      && (static_cast<section_size_type>(off)
+			  + (ss.length + 1) * charsize
+			  <= this->merged_data_size_));
+	  memcpy(this->merged_data_ + off, ss.string, ss.length * charsize);
+	}
+      delete psh;
+    }
+  this->shards_.clear();
+  Merge_chunks().swap(this->merge_chunks_);
+
+  for (typename Merged_strings_lists::const_iterator l =
+	 this->merged_strings_lists_.begin();
+       l != this->merged_strings_lists_.end();
+       ++l)
+    delete *l;
+  this->merged_strings_lists_.clear();
+
+  return this->merged_data_size_;
+}
+
 // Finalize the mappings from the input sections to the output
 // section, and return the final data size.
 
@@ -545,6 +1002,9 @@ template<typename Char_type>
 section_size_type
 Output_merge_string<Char_type>::finalize_merged_data()
 {
+  if (this->merge_in_parallel_)
+    return this->finalize_sharded_merged_data();
+
   this->stringpool_.set_string_offsets();
 
   for (typename Merged_strings_lists::const_iterator l =
@@ -598,7 +1058,10 @@ template<typename Char_type>
 void
 Output_merge_string<Char_type>::do_write(Output_file* of)
 {
-  this->stringpool_.write(of, this->offset());
+  if (this->merge_in_parallel_)
+    of->write(this->offset(), this->merged_data_, this->merged_data_size_);
+  else
+    this->stringpool_.write(of, this->offset());
 }
 
 // Write a merged string section to a buffer.
@@ -607,7 +1070,10 @@ template<typename Char_type>
 void
 Output_merge_string<Char_type>::do_write_to_buffer(unsigned char* buffer)
 {
-  this->stringpool_.write_to_buffer(buffer, this->data_size());
+  if (this->merge_in_parallel_)
+    memcpy(buffer, this->merged_data_, this->merged_data_size_);
+  else
+    this->stringpool_.write_to_buffer(buffer, this->data_size());
 }
 
 // Return the name of the types of string to use with
@@ -654,7 +1120,17 @@ Output_merge_string<Char_type>::do_print_merge_stats(const char* section_name)
 	  program_name, buf, this->input_size_);
   fprintf(stderr, _("%s: %s input strings: %zu\n"),
 	  program_name, buf, this->input_count_);
-  this->stringpool_.print_stats(buf);
+  if (this->merge_in_parallel_)
+    {
+      fprintf(stderr, _("%s: %s merge chunks: %zu\n"),
+	      program_name, buf, this->merge_chunk_count_);
+      fprintf(stderr, _("%s: %s merge shards: %zu\n"),
+	      program_name, buf, this->merge_shard_count_);
+      fprintf(stderr, _("%s: %s unique strings: %zu\n"),
+	      program_name, buf, this->merged_count_);
+    }
+  else
+    this->stringpool_.print_stats(buf);
 }
 
 // Instantiate the templates we need.
@@ -33,6 +33,9 @@
 namespace gold
 {
 
+class Workqueue;
+class Task_token;
+
 // For each object with merge sections, we store an Object_merge_map.
 // This is used to map locations in input sections to a merged output
 // section.  The output section itself is not recorded here--it can be
@@ -201,6 +204,15 @@ class Output_merge_base : public Output_section_data
   set_keeps_input_sections()
   { this->do_set_keeps_input_sections(); }
 
+  // Queue tasks to merge the input sections in parallel, using
+  // SHARD_COUNT shards.  Each queued task that has to finish before
+  // the section is finalized unblocks MERGE_BLOCKER when it is done.
+  // This does nothing for sections which are merged serially.
+  void
+  queue_merge_tasks(Workqueue* workqueue, unsigned int shard_count,
+		    Task_token* merge_blocker)
+  { this->do_queue_merge_tasks(workqueue, shard_count, merge_blocker); }
+
   // Return the object of the first merged input section.  This used
   // for script processing.  This is NULL if merge section is empty.
   Relobj*
@@ -253,6 +265,11 @@ class Output_merge_base : public Output_section_data
   do_set_keeps_input_sections()
   { this->keeps_input_sections_ = true; }
 
+  // This may be overridden by the child class.
+  virtual void
+  do_queue_merge_tasks(Workqueue*, unsigned int, Task_token*)
+  { }
+
   // Record the merged input section for script processing.
   void
   record_input_section(Relobj* relobj, unsigned int shndx);
@@ -400,18 +417,32 @@ template<typename Char_type>
 class Output_merge_string : public Output_merge_base
 {
  public:
-  Output_merge_string(uint64_t addralign)
-    : Output_merge_base(sizeof(Char_type), addralign), stringpool_(addralign),
-      merged_strings_lists_(), input_count_(0), input_size_(0)
-  {
-    this->stringpool_.set_no_zero_null();
-  }
+  Output_merge_string(uint64_t addralign);
+
+  ~Output_merge_string();
+
+  // Compute the hash codes of the strings in chunk CHUNK of the input
+  // sections, and sort them by shard.  This is called by a
+  // Merge_strings_hash_task when merging in parallel.
+  void
+  hash_strings(unsigned int chunk);
+
+  // Merge the strings which belong to shard SHARD.  This is called by
+  // a Merge_strings_shard_task when merging in parallel, after all the
+  // strings have been hashed.
+  void
+  merge_shard(unsigned int shard);
 
  protected:
   // Add an input section.
   bool
   do_add_input_section(Relobj* object, unsigned int shndx);
 
+  // Queue the tasks which merge the strings in parallel.
+  void
+  do_queue_merge_tasks(Workqueue*, unsigned int shard_count,
+		       Task_token* merge_blocker);
+
   // Do all the final processing after the input sections are read in.
   // Returns the final data size.
   section_size_type
@@ -472,7 +503,9 @@ class Output_merge_string : public Output_merge_base
   {
     // The offset in the input section.
     section_offset_type offset;
-    // The key in the Stringpool.
+    // The key in the Stringpool.  When merging in parallel, this is
+    // first the hash code of the string, and then the key returned by
+    // shard_key.
     Stringpool::Key stringpool_key;
 
     Merged_string(section_offset_type offseta, Stringpool::Key stringpool_keya)
@@ -490,14 +523,148 @@ class Output_merge_string : public Output_merge_base
     unsigned int shndx;
     // The list of merged strings.
     Merged_strings merged_strings;
+    // When merging in parallel, a copy of the section contents, since
+    // the strings are not added to the Stringpool until later.
+    // Otherwise NULL.
+    unsigned char* contents;
 
     Merged_strings_list(Relobj* objecta, unsigned int shndxa)
-      : object(objecta), shndx(shndxa), merged_strings()
+      : object(objecta), shndx(shndxa), merged_strings(), contents(NULL)
     { }
+
+    ~Merged_strings_list()
+    { delete[] this->contents; }
   };
 
   typedef std::vector<Merged_strings_list*> Merged_strings_lists;
 
+  // The rest of the declarations are used when merging the strings
+  // in parallel.  The strings are distributed by hash code over a
+  // number of shards.  Each shard has its own hash table, so the
+  // shards may be merged concurrently.  The offsets in the output
+  // section are then assigned in a single pass over the input
+  // sections, which produces the same output as the serial
+  // Stringpool.
+
+  // A reference to a string in merged_strings_lists_.
+  struct Merged_string_ref
+  {
+    // The index in merged_strings_lists_.
+    unsigned int list;
+    // The index in the merged_strings of that list.
+    unsigned int index;
+
+    Merged_string_ref(unsigned int lista, unsigned int indexa)
+      : list(lista), index(indexa)
+    { }
+  };
+
+  typedef std::vector<Merged_string_ref> Merged_string_refs;
+
+  // A range of merged_strings_lists_ which is hashed by a single
+  // task.  The strings are sorted by shard, in input order.
+  struct Merge_chunk
+  {
+    // The first entry in merged_strings_lists_.
+    unsigned int first;
+    // One past the last entry in merged_strings_lists_.
+    unsigned int last;
+    // The strings in the chunk, indexed by shard.
+    std::vector<Merged_string_refs> shards;
+
+    Merge_chunk(unsigned int firsta, unsigned int lasta)
+      : first(firsta), last(lasta), shards()
+    { }
+  };
+
+  typedef std::vector<Merge_chunk> Merge_chunks;
+
+  // A unique string in a shard.
+  struct Shard_string
+  {
+    const Char_type* string;
+    // Length is in characters, not bytes.
+    size_t length;
+    size_t hash_code;
+
+    Shard_string(const Char_type* stringa, size_t lengtha, size_t hash_codea)
+      : string(stringa), length(lengtha), hash_code(hash_codea)
+    { }
+  };
+
+  struct Shard_string_hash
+  {
+    size_t
+    operator()(const Shard_string& ss) const
+    { return ss.hash_code; }
+  };
+
+  struct Shard_string_eq
+  {
+    bool
+    operator()(const Shard_string& ss1, const Shard_string& ss2) const
+    {
+      return (ss1.hash_code == ss2.hash_code
+	      && ss1.length == ss2.length
+	      && memcmp(ss1.string, ss2.string,
+			ss1.length * sizeof(Char_type)) == 0);
+    }
+  };
+
+  // Map from a string to its index in Merge_shard::strings.
+  typedef Unordered_map<Shard_string, unsigned int, Shard_string_hash,
+			Shard_string_eq> Shard_string_map;
+
+  struct Merge_shard
+  {
+    // The hash table of strings in this shard.
+    Shard_string_map string_map;
+    // The unique strings, in the order in which they were first seen.
+    std::vector<Shard_string> strings;
+    // The output offset of each entry in STRINGS.
+    std::vector<section_offset_type> offsets;
+  };
+
+  // Identifies a unique string by shard and index, for sorting.
+  typedef std::pair<unsigned int, unsigned int> Shard_index;
+
+  // Comparison routine used when sorting the unique strings with -O2.
+  // This orders the strings like Stringpool::set_string_offsets.
+  class Shard_string_sort_comparison
+  {
+   public:
+    Shard_string_sort_comparison(const std::vector<Merge_shard*>& shards)
+      : shards_(shards)
+    { }
+
+    bool
+    operator()(const Shard_index&, const Shard_index&) const;
+
+   private:
+    const std::vector<Merge_shard*>& shards_;
+  };
+
+  // Return the shard to use for a string with hash code HASH_CODE.
+  unsigned int
+  shard_of(size_t hash_code) const
+  { return (hash_code ^ (hash_code >> 16)) % this->shards_.size(); }
+
+  // Return the key to store for index INDEX in shard SHARD.
+  Stringpool::Key
+  shard_key(unsigned int shard, unsigned int index) const
+  {
+    return (static_cast<Stringpool::Key>(index) * this->shards_.size()
+	    + shard + 1);
+  }
+
+  // Split the input sections into chunks and create the shards.
+  void
+  setup_shards(unsigned int shard_count);
+
+  // Finalize the merged data when merging in parallel.
+  section_size_type
+  finalize_sharded_merged_data();
+
   // As we see the strings, we add them to a Stringpool.
   Stringpool_template<Char_type> stringpool_;
   // Map from a location in an input object to an entry in the
@@ -507,6 +674,26 @@ class Output_merge_string : public Output_merge_base
   size_t input_count_;
   // The total size of input sections.
   size_t input_size_;
+  // Whether the strings are merged in parallel rather than added to
+  // STRINGPOOL_ as the input sections are seen.
+  bool merge_in_parallel_;
+  // The chunks of input sections, when merging in parallel.
+  Merge_chunks merge_chunks_;
+  // The shards, when merging in parallel.
+  std::vector<Merge_shard*> shards_;
+  // Blocker which is released when all the strings have been hashed.
+  Task_token* hash_blocker_;
+  // The number of unique strings, when merging in parallel.
+  size_t merged_count_;
+  // The number of chunks and shards used to merge in parallel, for
+  // --stats.
+  size_t merge_chunk_count_;
+  size_t merge_shard_count_;
+  // The contents of the section, when merging in parallel.  This is
+  // set by finalize_merged_data.
+  unsigned char* merged_data_;
+  // The size of MERGED_DATA_.
+  section_size_type merged_data_size_;
 };
 
 } // End namespace gold.
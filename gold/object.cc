@@ -42,6 +42,7 @@
 #include "compressed_output.h"
 #include "incremental.h"
 #include "merge.h"
+#include "ehframe.h"
 
 namespace gold
 {
@@ -476,6 +477,7 @@ Sized_relobj_file<size, big_endian>::Sized_relobj_file(
     kept_comdat_sections_(),
     has_eh_frame_(false),
     discarded_eh_frame_shndx_(-1U),
+    eh_frame_input_(NULL),
     is_deferred_layout_(false),
     deferred_layout_(),
     deferred_layout_relocs_()
@@ -486,6 +488,7 @@ Sized_relobj_file<size, big_endian>::Sized_relobj_file(
 template<int size, bool big_endian>
 Sized_relobj_file<size, big_endian>::~Sized_relobj_file()
 {
+  delete this->eh_frame_input_;
 }
 
 // Set up an object file based on the file header.  This sets up the
@@ -900,6 +903,75 @@ Sized_relobj_file<size, big_endian>::base_read_symbols(Read_symbols_data* sd)
   sd->symbol_names = fvstrtab;
   sd->symbol_names_size =
     convert_to_section_size_type(strtabshdr.get_sh_size());
+
+  this->read_eh_frame_section(sd);
+}
+
+// Parse the .eh_frame section, if there is one that we will lay out.
+// Reading the symbols of different objects happens in parallel, so
+// doing the work here, rather than when we lay out the section,
+// leaves only the merging of the CIEs to the serial layout pass.
+
+template<int size, bool big_endian>
+void
+Sized_relobj_file<size, big_endian>::read_eh_frame_section(
+    Read_symbols_data* sd)
+{
+  if (!this->has_eh_frame_
+      || this->eh_frame_input_ != NULL
+      || parameters->options().relocatable()
+      || parameters->incremental())
+    return;
+
+  const unsigned int shnum = this->shnum();
+  const unsigned char* const pshdrs = sd->section_headers->data();
+  const char* names =
+    reinterpret_cast<const char*>(sd->section_names->data());
+
+  // Find the first .eh_frame section, as do_layout does.
+  unsigned int shndx = 0;
+  const unsigned char* p = pshdrs + This::shdr_size;
+  for (unsigned int i = 1; i < shnum; ++i, p += This::shdr_size)
+    {
+      typename This::Shdr shdr(p);
+      if (shdr.get_sh_name() < sd->section_names_size
+	  && strcmp(names + shdr.get_sh_name(), ".eh_frame") == 0
+	  && this->check_eh_frame_flags(&shdr))
+	{
+	  shndx = i;
+	  break;
+	}
+    }
+  if (shndx == 0)
+    return;
+
+  // Find the relocation section, as do_layout does.
+  unsigned int reloc_shndx = 0;
+  unsigned int reloc_type = elfcpp::SHT_NULL;
+  p = pshdrs + This::shdr_size;
+  for (unsigned int i = 1; i < shnum; ++i, p += This::shdr_size)
+    {
+      typename This::Shdr shdr(p);
+      unsigned int sh_type = shdr.get_sh_type();
+      if ((sh_type == elfcpp::SHT_REL || sh_type == elfcpp::SHT_RELA)
+	  && this->adjust_shndx(shdr.get_sh_info()) == shndx)
+	{
+	  if (reloc_shndx != 0)
+	    reloc_shndx = -1U;
+	  else
+	    {
+	      reloc_shndx = i;
+	      reloc_type = sh_type;
+	    }
+	}
+    }
+
+  this->eh_frame_input_ =
+    Eh_frame::read_ehframe_input_section(this, sd->symbols->data(),
+					 sd->symbols_size,
+					 sd->symbol_names->data(),
+					 sd->symbol_names_size,
+					 shndx, reloc_shndx, reloc_type);
 }
 
 // Return the section index of symbol SYM.  Set *VALUE to its value in
@@ -1282,7 +1354,10 @@ Sized_relobj_file<size, big_endian>::layout_eh_frame_section(
 					       shdr,
 					       reloc_shndx,
 					       reloc_type,
+					       this->eh_frame_input_,
 					       &offset);
+  delete this->eh_frame_input_;
+  this->eh_frame_input_ = NULL;
   this->output_sections()[shndx] = os;
   if (os == NULL || offset == -1)
     {
@@ -1794,6 +1869,15 @@ Sized_relobj_file<size, big_endian>::do_layout(Symbol_table* symtab,
 				    reloc_type[i]);
     }
 
+  // If the .eh_frame section that read_eh_frame_section parsed was
+  // not laid out, because it was excluded or discarded, we no longer
+  // need the parse.
+  if (!is_pass_one && !this->is_deferred_layout())
+    {
+      delete this->eh_frame_input_;
+      this->eh_frame_input_ = NULL;
+    }
+
   // When doing a relocatable link handle the reloc sections at the
   // end.  Garbage collection  and Identical Code Folding is not
   // turned on for relocatable code.
@@ -48,6 +48,7 @@ class Pluginobj;
 class Dynobj;
 class Object_merge_map;
 class Relocatable_relocs;
+class Eh_frame_input;
 struct Symbols_data;
 
 template<typename Stringpool_char>
@@ -112,11 +113,14 @@ struct Symbol_location_info
 struct Section_relocs
 {
   Section_relocs()
-    : contents(NULL)
+    : contents(NULL), staged_relocs(NULL)
   { }
 
   ~Section_relocs()
-  { delete this->contents; }
+  {
+    delete this->contents;
+    delete this->staged_relocs;
+  }
 
   // Index of reloc section.
   unsigned int reloc_shndx;
@@ -134,6 +138,9 @@ struct Section_relocs
   bool needs_special_offset_handling;
   // Whether the data section is allocated (has the SHF_ALLOC flag set).
   bool is_data_section_allocated;
+  // If the relocs were prescanned, a copy of the relocs which still
+  // need to be scanned, in order; otherwise NULL.
+  std::vector<unsigned char>* staged_relocs;
 };
 
 // Relocations in an object file.  This is read in read_relocs and
@@ -1077,6 +1084,17 @@ class Relobj : public Object
   gc_process_relocs(Symbol_table* symtab, Layout* layout, Read_relocs_data* rd)
   { return this->do_gc_process_relocs(symtab, layout, rd); }
 
+  // Prescan the relocs, to find the ones which scan_relocs needs to
+  // look at.  This does not change anything outside RD, so it may be
+  // run for several objects in parallel.
+  void
+  prescan_relocs(Symbol_table* symtab, Layout* layout, Read_relocs_data* rd)
+  { return this->do_prescan_relocs(symtab, layout, rd); }
+
+  // Print statistics about prescanned relocs to stderr.
+  static void
+  print_prescan_stats();
+
   // Scan the relocs and adjust the symbol table.
   void
   scan_relocs(Symbol_table* symtab, Layout* layout, Read_relocs_data* rd)
@@ -1294,6 +1312,12 @@ class Relobj : public Object
   virtual void
   do_gc_process_relocs(Symbol_table*, Layout*, Read_relocs_data*) = 0;
 
+  // Prescan the relocs--may be implemented by child class.  By
+  // default all the relocs are scanned.
+  virtual void
+  do_prescan_relocs(Symbol_table*, Layout*, Read_relocs_data*)
+  { }
+
   // Scan the relocs--implemented by child class.
   virtual void
   do_scan_relocs(Symbol_table*, Layout*, Read_relocs_data*) = 0;
@@ -2303,6 +2327,10 @@ class Sized_relobj_file : public Sized_relobj<size, big_endian>
   void
   do_gc_process_relocs(Symbol_table*, Layout*, Read_relocs_data*);
 
+  // Prescan the relocs to find the ones which need to be scanned.
+  void
+  do_prescan_relocs(Symbol_table*, Layout*, Read_relocs_data*);
+
   // Scan the relocs and adjust the symbol table.
   void
   do_scan_relocs(Symbol_table*, Layout*, Read_relocs_data*);
@@ -2506,6 +2534,10 @@ class Sized_relobj_file : public Sized_relobj<size, big_endian>
   find_eh_frame(const unsigned char* pshdrs, const char* names,
 		section_size_type names_size) const;
 
+  // Parse the .eh_frame section while reading the symbols.
+  void
+  read_eh_frame_section(Read_symbols_data*);
+
   // Whether to include a section group in the link.
   bool
   include_section_group(Symbol_table*, Layout*, unsigned int, const char*,
@@ -2728,6 +2760,9 @@ class Sized_relobj_file : public Sized_relobj<size, big_endian>
   // If this object has a GNU style .eh_frame section that is discarded in
   // output, record the index here.  Otherwise it is -1U.
   unsigned int discarded_eh_frame_shndx_;
+  // The .eh_frame section as parsed by read_eh_frame_section, until
+  // we lay it out.  This may be NULL.
+  Eh_frame_input* eh_frame_input_;
   // True if the layout of this object was deferred, waiting for plugin
   // replacement files.
   bool is_deferred_layout_;
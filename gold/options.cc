@@ -1235,6 +1235,11 @@ General_options::finalize()
   if (this->pie() && this->relocatable())
     gold_fatal(_("-pie and -r are incompatible"));
 
+  if (this->call_graph_ordering_file() != NULL
+      && this->section_ordering_file() != NULL)
+    gold_fatal(_("--call-graph-ordering-file and --section-ordering-file "
+		 "are incompatible"));
+
   if (!this->shared())
     {
       if (this->filter() != NULL)
@@ -1261,6 +1266,13 @@ General_options::finalize()
 		 "[0.0, 1.0)"),
 	       this->hash_bucket_empty_fraction());
 
+#ifndef HAVE_ZSTD
+  if (strcmp(this->compress_debug_sections(), "zstd") == 0)
+    gold_fatal(_("--compress-debug-sections=zstd: "
+		 "%s was compiled without zstd support"),
+	       program_name);
+#endif
+
   if (this->implicit_incremental_ && this->incremental_mode_ == INCREMENTAL_OFF)
     gold_fatal(_("Options --incremental-changed, --incremental-unchanged, "
 		 "--incremental-unknown require the use of --incremental"));
@@ -1298,6 +1310,10 @@ General_options::finalize()
 	}
     }
 
+  if ((this->hot_text_align() & (this->hot_text_align() - 1)) != 0)
+    gold_fatal(_("--hot-text-align value %#llx is not a power of 2"),
+	       static_cast<unsigned long long>(this->hot_text_align()));
+
   // --rosegment-gap implies --rosegment.
   if (this->user_set_rosegment_gap())
     this->set_rosegment(true);
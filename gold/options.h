@@ -684,21 +684,30 @@ class General_options
 
   DEFINE_uint64(build_id_chunk_size_for_treehash,
 		options::TWO_DASHES, '\0', 2 << 20,
-		N_("Chunk size for '--build-id=tree'"), N_("SIZE"));
+		N_("Chunk size for '--build-id=tree' and '--build-id=fast'"),
+		N_("SIZE"));
 
   DEFINE_uint64(build_id_min_file_size_for_treehash, options::TWO_DASHES,
 		'\0', 40 << 20,
 		N_("Minimum output file size for '--build-id=tree' to work"
 		   " differently than '--build-id=sha1'"), N_("SIZE"));
 
+  DEFINE_string(call_graph_ordering_file, options::TWO_DASHES, '\0', NULL,
+		N_("Layout functions using the call graph profile in FILENAME"),
+		N_("FILENAME"));
+
   DEFINE_bool(check_sections, options::TWO_DASHES, '\0', true,
 	      N_("Check segment addresses for overlaps (default)"),
 	      N_("Do not check segment addresses for overlaps"));
 
+  DEFINE_bool(compact_symbols, options::TWO_DASHES, '\0', false,
+	      N_("Store the symbol table compactly to use less memory"),
+	      N_("Store the symbol table normally (default)"));
+
   DEFINE_enum(compress_debug_sections, options::TWO_DASHES, '\0', "none",
 	      N_("Compress .debug_* sections in the output file"),
-	      ("[none,zlib]"),
-	      {"none", "zlib"});
+	      ("[none,zlib,zstd]"),
+	      {"none", "zlib", "zstd"});
 
   DEFINE_bool(copy_dt_needed_entries, options::TWO_DASHES, '\0', false,
 	      N_("Not supported"),
@@ -851,6 +860,17 @@ class General_options
 	      N_("Dynamic hash style"), N_("[sysv,gnu,both]"),
 	      {"sysv", "gnu", "both"});
 
+  DEFINE_bool(hash_optimize, options::TWO_DASHES, '\0', false,
+	      N_("Size dynamic hash tables and the GNU hash bloom filter "
+		 "by measuring collisions and false positives"),
+	      N_("Size dynamic hash tables using fixed heuristics (default)"));
+
+  DEFINE_uint64(hot_text_align, options::TWO_DASHES, '\0', 0,
+		N_("Put .text.hot sections in their own output section, "
+		   "aligned and padded to SIZE in memory and in the file, "
+		   "so that they can be mapped with huge pages"),
+		N_("SIZE"));
+
   DEFINE_string(dynamic_linker, options::TWO_DASHES, 'I', NULL,
 		N_("Set dynamic linker path"), N_("PROGRAM"));
 
@@ -894,6 +914,10 @@ class General_options
   DEFINE_string(init, options::ONE_DASH, '\0', "_init",
 		N_("Call SYMBOL at load-time"), N_("SYMBOL"));
 
+  DEFINE_string(input_cache, options::TWO_DASHES, '\0', NULL,
+		N_("Cache archive symbol tables in DIR across links"),
+		N_("DIR"));
+
   DEFINE_special(just_symbols, options::TWO_DASHES, '\0',
 		 N_("Read only symbol values from FILE"), N_("FILE"));
 
@@ -965,6 +989,11 @@ class General_options
   DEFINE_string(output, options::TWO_DASHES, 'o', "a.out",
 		N_("Set output file name"), N_("FILE"));
 
+  DEFINE_uint64(output_memory_limit, options::TWO_DASHES, '\0', 0,
+		N_("Write the output file with pwrite rather than mapping "
+		   "it, buffering at most SIZE bytes at a time"),
+		N_("SIZE"));
+
   DEFINE_uint(optimize, options::EXACTLY_ONE_DASH, 'O', 0,
 	      N_("Optimize output file size"), N_("LEVEL"));
 
@@ -974,6 +1003,11 @@ class General_options
   DEFINE_bool(p, options::ONE_DASH, '\0', false,
 	      N_("(ARM only) Ignore for backward compatibility"), NULL);
 
+  DEFINE_bool(parallel_string_merge, options::TWO_DASHES, '\0', false,
+	      N_("Merge SHF_MERGE string sections in parallel "
+		 "when multi-threaded"),
+	      N_("Merge SHF_MERGE string sections serially (default)"));
+
   DEFINE_bool(pie, options::ONE_DASH, '\0', false,
 	      N_("Create a position independent executable"),
 	      N_("Do not create a position independent executable"));
@@ -1009,6 +1043,10 @@ class General_options
 		 " (default)."),
 	      N_("Use fallocate or ftruncate to reserve space."));
 
+  DEFINE_uint(prefetch_inputs, options::TWO_DASHES, '\0', 0,
+	      N_("Read ahead up to COUNT input files before they are opened"),
+	      N_("COUNT"));
+
   DEFINE_bool(preread_archive_symbols, options::TWO_DASHES, '\0', false,
 	      N_("Preread archive symbols when multi-threaded"), NULL);
 
@@ -1116,7 +1154,12 @@ class General_options
 	      {"none", "all", "safe"});
 
   DEFINE_uint(icf_iterations, options::TWO_DASHES , '\0', 0,
-	      N_("Number of iterations of ICF (default 2)"), N_("COUNT"));
+	      N_("Number of iterations of ICF (default 2, or until no more "
+		 "sections are folded with --parallel-icf)"), N_("COUNT"));
+
+  DEFINE_bool(parallel_icf, options::TWO_DASHES, '\0', false,
+	      N_("Find identical sections in parallel when using threads"),
+	      N_("Find identical sections serially (default)"));
 
   DEFINE_bool(print_icf_sections, options::TWO_DASHES, '\0', false,
 	      N_("List folded identical sections on stderr"),
@@ -1129,6 +1172,11 @@ class General_options
 	      N_("Remove unused sections"),
 	      N_("Don't remove unused sections (default)"));
 
+  DEFINE_bool(parallel_gc, options::TWO_DASHES, '\0', false,
+	      N_("Mark the sections kept by --gc-sections in parallel "
+		 "when using threads"),
+	      N_("Mark the sections kept by --gc-sections serially (default)"));
+
   DEFINE_bool(print_gc_sections, options::TWO_DASHES, '\0', false,
 	      N_("List removed unused sections on stderr"),
 	      N_("Do not list removed unused sections"));
@@ -1136,9 +1184,19 @@ class General_options
   DEFINE_bool(stats, options::TWO_DASHES, '\0', false,
 	      N_("Print resource usage statistics"), NULL);
 
+  DEFINE_uint(symtab_shards, options::TWO_DASHES, '\0', 0,
+	      N_("Split the symbol table into COUNT shards and add the "
+		 "symbols of object files in parallel when multi-threaded"),
+	      N_("COUNT"));
+
   DEFINE_string(sysroot, options::TWO_DASHES, '\0', "",
 		N_("Set target system root directory"), N_("DIR"));
 
+  DEFINE_string(task_timeline, options::TWO_DASHES, '\0', NULL,
+		N_("Write a timeline of the tasks run by the linker to FILE, "
+		   "in Chrome trace event format"),
+		N_("FILE"));
+
   DEFINE_bool(trace, options::TWO_DASHES, 't', false,
 	      N_("Print the name of each input file"), NULL);
 
@@ -1323,6 +1381,10 @@ class General_options
   DEFINE_bool(origin, options::DASH_Z, '\0', false,
 	      N_("Mark DSO to indicate that needs immediate $ORIGIN "
 		 "processing at runtime"), NULL);
+  DEFINE_bool(pack_relative_relocs, options::DASH_Z, '\0', false,
+	      N_("Pack relative relocations in a .relr.dyn section "
+		 "(x86-64 only)"),
+	      N_("Do not pack relative relocations (default)"));
   DEFINE_bool(relro, options::DASH_Z, '\0', false,
 	      N_("Where possible mark variables read-only after relocation"),
 	      N_("Don't mark variables read-only after relocation"));
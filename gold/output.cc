@@ -22,6 +22,7 @@
 
 #include "gold.h"
 
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <cerrno>
@@ -34,6 +35,10 @@
 #include <sys/mman.h>
 #endif
 
+#ifdef ENABLE_THREADS
+#include <pthread.h>
+#endif
+
 #include "libiberty.h"
 
 #include "dwarf.h"
@@ -43,6 +48,7 @@
 #include "reloc.h"
 #include "merge.h"
 #include "descriptors.h"
+#include "gold-threads.h"
 #include "layout.h"
 #include "output.h"
 
@@ -1297,6 +1303,190 @@ Output_relocatable_relocs<sh_type, size, big_endian>::set_final_data_size()
 		      * Reloc_types<sh_type, size, big_endian>::reloc_size);
 }
 
+// Class Output_data_relr.
+
+// Set the entry size of the output section.
+
+template<int size, bool big_endian>
+void
+Output_data_relr<size, big_endian>::do_adjust_output_section(
+    Output_section* os)
+{
+  os->set_entsize(size / 8);
+}
+
+// Add the word at OFFSET in section SHNDX of RELOBJ, which goes in
+// the output section OS.
+
+template<int size, bool big_endian>
+void
+Output_data_relr<size, big_endian>::add_input_section(Output_section* os,
+						      Relobj* relobj,
+						      unsigned int shndx,
+						      Address offset)
+{
+  os->add_dynamic_reloc();
+  this->add(NULL, relobj, shndx, offset);
+}
+
+// Add the word at OFFSET in OD.
+
+template<int size, bool big_endian>
+void
+Output_data_relr<size, big_endian>::add_output_data(Output_data* od,
+						    Address offset)
+{
+  gold_assert(od->addralign() >= size / 8);
+  od->add_dynamic_reloc();
+  this->add(od, NULL, 0, offset);
+}
+
+// Add the word at OFFSET in OD or in section SHNDX of RELOBJ.
+
+template<int size, bool big_endian>
+void
+Output_data_relr<size, big_endian>::add(Output_data* od, Relobj* relobj,
+					unsigned int shndx, Address offset)
+{
+  gold_assert(offset % (size / 8) == 0);
+
+  // Relocations for one section tend to come together, so check the
+  // group we used last time first.
+  if (this->last_group_ != -1U)
+    {
+      Relr_group& last(this->groups_[this->last_group_]);
+      if (last.od == od && last.relobj == relobj && last.shndx == shndx)
+	{
+	  last.offsets.push_back(offset);
+	  return;
+	}
+    }
+
+  const void* key = od != NULL ? static_cast<const void*>(od) : relobj;
+  std::pair<typename Relr_group_map::iterator, bool> ins =
+    this->group_map_.insert(std::make_pair(std::make_pair(key, shndx),
+					   this->groups_.size()));
+  if (ins.second)
+    this->groups_.push_back(Relr_group(od, relobj, shndx));
+  this->last_group_ = ins.first->second;
+  this->groups_[this->last_group_].offsets.push_back(offset);
+}
+
+// Encode the words at the sorted OFFSETS from BASE.  An address entry
+// is followed by bitmap entries, each of which covers the SIZE - 1
+// words after the words covered by the previous entry.  The low bit
+// of a bitmap entry is set.
+
+template<int size, bool big_endian>
+size_t
+Output_data_relr<size, big_endian>::encode(Address base,
+					   const Address* offsets,
+					   size_t noffsets,
+					   unsigned char* pov)
+{
+  const int word_size = size / 8;
+  const Address nbits = size - 1;
+  size_t count = 0;
+  size_t i = 0;
+  while (i < noffsets)
+    {
+      if (pov != NULL)
+	elfcpp::Swap<size, big_endian>::writeval(pov + count * word_size,
+						 base + offsets[i]);
+      ++count;
+      Address where = offsets[i] + word_size;
+      ++i;
+
+      while (i < noffsets)
+	{
+	  Address bitmap = 0;
+	  while (i < noffsets)
+	    {
+	      Address delta = (offsets[i] - where) / word_size;
+	      if (delta >= nbits)
+		break;
+	      bitmap |= static_cast<Address>(1) << delta;
+	      ++i;
+	    }
+	  if (bitmap == 0)
+	    break;
+	  if (pov != NULL)
+	    elfcpp::Swap<size, big_endian>::writeval(pov + count * word_size,
+						     (bitmap << 1) | 1);
+	  ++count;
+	  where += nbits * word_size;
+	}
+    }
+  return count;
+}
+
+// Sort the offsets in each group and work out how many entries we
+// need.  Since every group starts at a word aligned address, this
+// does not depend on where the groups go.
+
+template<int size, bool big_endian>
+void
+Output_data_relr<size, big_endian>::set_final_data_size()
+{
+  size_t count = 0;
+  for (typename Relr_groups::iterator p = this->groups_.begin();
+       p != this->groups_.end();
+       ++p)
+    {
+      std::vector<Address>& offsets(p->offsets);
+      std::sort(offsets.begin(), offsets.end());
+      offsets.erase(std::unique(offsets.begin(), offsets.end()),
+		    offsets.end());
+      count += encode(0, &offsets[0], offsets.size(), NULL);
+    }
+  this->set_data_size(count * (size / 8));
+}
+
+// Write out the packed relocations.
+
+template<int size, bool big_endian>
+void
+Output_data_relr<size, big_endian>::do_write(Output_file* of)
+{
+  const off_t off = this->offset();
+  const off_t oview_size = this->data_size();
+  unsigned char* const oview = of->get_output_view(off, oview_size);
+
+  unsigned char* pov = oview;
+  for (typename Relr_groups::const_iterator p = this->groups_.begin();
+       p != this->groups_.end();
+       ++p)
+    {
+      Address base;
+      if (p->od != NULL)
+	base = p->od->address();
+      else
+	{
+	  Output_section* os = p->relobj->output_section(p->shndx);
+	  gold_assert(os != NULL);
+	  if (!p->relobj->is_output_section_offset_invalid(p->shndx))
+	    base = (os->address()
+		    + p->relobj->output_section_offset(p->shndx));
+	  else
+	    base = os->output_address(p->relobj, p->shndx, 0);
+	}
+      gold_assert(base % (size / 8) == 0);
+
+      const std::vector<Address>& offsets(p->offsets);
+      size_t count = encode(base, &offsets[0], offsets.size(), pov);
+      pov += count * (size / 8);
+    }
+
+  gold_assert(pov - oview == oview_size);
+
+  of->write_output_view(off, oview_size, oview);
+
+  // We no longer need the offsets.
+  this->groups_.clear();
+  this->group_map_.clear();
+  this->last_group_ = -1U;
+}
+
 // class Output_data_group.
 
 template<int size, bool big_endian>
@@ -2297,6 +2487,7 @@ Output_section::Output_section(const char* name, elfcpp::Elf_Word type,
     always_keeps_input_sections_(false),
     has_fixed_layout_(false),
     is_patch_space_allowed_(false),
+    pad_to_addralign_(false),
     is_unique_segment_(false),
     tls_offset_(0),
     extra_segment_flags_(0),
@@ -3119,6 +3310,11 @@ Output_section::set_final_data_size()
       data_size = new_size;
     }
 
+  // With --hot-text-align, the section takes up whole aligned blocks
+  // so that nothing else shares its huge pages.
+  if (this->pad_to_addralign_)
+    data_size = align_address(data_size, this->addralign());
+
   this->set_data_size(data_size);
 }
 
@@ -3977,6 +4173,21 @@ Output_section::print_merge_stats()
     p->print_merge_stats(this->name_);
 }
 
+// Queue tasks to merge the contents of SHF_MERGE sections.
+
+void
+Output_section::queue_merge_tasks(Workqueue* workqueue,
+				  unsigned int shard_count,
+				  Task_token* merge_blocker)
+{
+  for (Input_section_list::iterator p = this->input_sections_.begin();
+       p != this->input_sections_.end();
+       ++p)
+    if (p->is_merge_section())
+      p->output_merge_base()->queue_merge_tasks(workqueue, shard_count,
+						merge_blocker);
+}
+
 // Set a fixed layout for the section.  Used for incremental update links.
 
 void
@@ -4852,6 +5063,334 @@ Output_segment::print_section_list_to_mapfile(Mapfile* mapfile,
     (*p)->print_to_mapfile(mapfile);
 }
 
+// Class Output_file_stream.
+
+// This holds the state used when the output file is written with
+// pwrite rather than mapped, as requested by --output-memory-limit.
+// Each view is a separately allocated buffer.  A buffer is zero
+// filled if nothing has been written to that part of the file yet,
+// and otherwise read back from the file.  We keep the total size of
+// the outstanding buffers under the limit by making a thread wait
+// before allocating a new buffer.  A thread which already holds a
+// buffer never waits, since it may be holding memory that some other
+// waiting thread needs; this means that the limit can be exceeded by
+// a single task which needs several views at once.
+
+// An input/output view may overlap views held by other threads: when
+// relocating data which was written as an Output_section_data, such
+// as merged constants, each object gets a view of the whole output
+// section.  For such a view we keep a copy of the original contents,
+// and only write back the bytes which the caller changed.
+
+class Output_file_stream
+{
+ public:
+  Output_file_stream(uint64_t memory_limit)
+    : memory_limit_(memory_limit), lock_(), condvar_(lock_), views_(),
+      written_pages_(), in_flight_(0), holders_()
+  { }
+
+  // Allocate a buffer of SIZE bytes for a view at START, reading the
+  // current contents from the file descriptor O.  If IS_INPUT_OUTPUT
+  // is true, only the bytes which change will be written back.
+  unsigned char*
+  get_view(const char* name, int o, off_t start, size_t size,
+	   bool is_input_output);
+
+  // Release the buffer VIEW.  If WRITE is true, first write it to O.
+  void
+  release_view(const char* name, int o, const unsigned char* view,
+	       bool write);
+
+  // Record that LEN bytes at OFFSET have been written to the file.
+  void
+  mark_written(off_t offset, size_t len);
+
+  // Return the number of outstanding views.
+  size_t
+  view_count()
+  {
+    Hold_lock hl(this->lock_);
+    return this->views_.size();
+  }
+
+  // The largest number of bytes buffered at any one time, over all
+  // output files.
+  static uint64_t peak_in_flight;
+  // The number of views buffered, and the number of times a thread
+  // waited for another to release its buffer, over all output files.
+  static uint64_t total_views;
+  static uint64_t total_waits;
+
+ private:
+  Output_file_stream(const Output_file_stream&);
+  Output_file_stream& operator=(const Output_file_stream&);
+
+  // The size of a page in the written page bitmap.
+  static const int page_shift = 12;
+
+  // Where an outstanding view lives in the file.
+  struct View
+  {
+    off_t offset;
+    size_t size;
+    // For an input/output view, the original contents; otherwise NULL.
+    unsigned char* original;
+  };
+
+  typedef Unordered_map<const unsigned char*, View> View_map;
+
+  // Return whether anything in the range has been written.  The lock
+  // must be held.
+  bool
+  is_written(off_t offset, size_t len) const;
+
+  // Adjust the number of views held by the calling thread by DELTA,
+  // and return the number held before the adjustment.  The lock must
+  // be held.
+  int
+  adjust_holder(int delta);
+
+  // The most bytes to buffer at once.
+  uint64_t memory_limit_;
+  // Protects the fields below.
+  Lock lock_;
+  // Signalled when a buffer is released.
+  Condvar condvar_;
+  // The outstanding views.
+  View_map views_;
+  // One bit for each page of the file which has been written.
+  std::vector<bool> written_pages_;
+  // The number of bytes currently buffered.
+  uint64_t in_flight_;
+#ifdef ENABLE_THREADS
+  // The number of views held by each thread which holds any.
+  std::vector<std::pair<pthread_t, int> > holders_;
+#else
+  // The number of views held.
+  std::vector<std::pair<int, int> > holders_;
+#endif
+};
+
+uint64_t Output_file_stream::peak_in_flight;
+uint64_t Output_file_stream::total_views;
+uint64_t Output_file_stream::total_waits;
+
+// Write LEN bytes from DATA to O at OFFSET.
+
+static void
+pwrite_all(const char* name, int o, off_t offset, const unsigned char* data,
+	   size_t len)
+{
+  while (len > 0)
+    {
+      ssize_t bytes = ::pwrite(o, data, len, offset);
+      if (bytes < 0)
+	{
+	  if (errno == EINTR)
+	    continue;
+	  gold_fatal(_("%s: pwrite failed: %s"), name, strerror(errno));
+	}
+      if (bytes == 0)
+	gold_fatal(_("%s: pwrite: unexpected 0 return-value"), name);
+      data += bytes;
+      len -= bytes;
+      offset += bytes;
+    }
+}
+
+// Read LEN bytes from O at OFFSET into DATA.  Anything past the end
+// of the file reads as zero.
+
+static void
+pread_all(const char* name, int o, off_t offset, unsigned char* data,
+	  size_t len)
+{
+  while (len > 0)
+    {
+      ssize_t bytes = ::pread(o, data, len, offset);
+      if (bytes < 0)
+	{
+	  if (errno == EINTR)
+	    continue;
+	  gold_fatal(_("%s: pread failed: %s"), name, strerror(errno));
+	}
+      if (bytes == 0)
+	{
+	  memset(data, 0, len);
+	  break;
+	}
+      data += bytes;
+      len -= bytes;
+      offset += bytes;
+    }
+}
+
+bool
+Output_file_stream::is_written(off_t offset, size_t len) const
+{
+  if (len == 0)
+    return false;
+  size_t first = offset >> page_shift;
+  size_t last = (offset + len - 1) >> page_shift;
+  for (size_t i = first; i <= last && i < this->written_pages_.size(); ++i)
+    if (this->written_pages_[i])
+      return true;
+  return false;
+}
+
+void
+Output_file_stream::mark_written(off_t offset, size_t len)
+{
+  if (len == 0)
+    return;
+  size_t first = offset >> page_shift;
+  size_t last = (offset + len - 1) >> page_shift;
+  Hold_lock hl(this->lock_);
+  if (last >= this->written_pages_.size())
+    this->written_pages_.resize(last + 1, false);
+  for (size_t i = first; i <= last; ++i)
+    this->written_pages_[i] = true;
+}
+
+int
+Output_file_stream::adjust_holder(int delta)
+{
+#ifdef ENABLE_THREADS
+  pthread_t self = pthread_self();
+#else
+  int self = 0;
+#endif
+  for (size_t i = 0; i < this->holders_.size(); ++i)
+    {
+#ifdef ENABLE_THREADS
+      if (!pthread_equal(this->holders_[i].first, self))
+	continue;
+#else
+      if (this->holders_[i].first != self)
+	continue;
+#endif
+      int old = this->holders_[i].second;
+      if (old + delta == 0)
+	{
+	  this->holders_[i] = this->holders_.back();
+	  this->holders_.pop_back();
+	}
+      else
+	this->holders_[i].second = old + delta;
+      return old;
+    }
+  gold_assert(delta > 0);
+  this->holders_.push_back(std::make_pair(self, delta));
+  return 0;
+}
+
+unsigned char*
+Output_file_stream::get_view(const char* name, int o, off_t start,
+			     size_t size, bool is_input_output)
+{
+  // An input/output view needs twice the memory.
+  size_t bytes = is_input_output ? 2 * size : size;
+
+  bool read;
+  {
+    Hold_lock hl(this->lock_);
+
+    // Wait for room if this thread holds nothing.  If nothing at all
+    // is buffered we go ahead, however large the view.
+    if (this->adjust_holder(1) == 0)
+      while (this->in_flight_ > 0
+	     && this->in_flight_ + bytes > this->memory_limit_)
+	{
+	  ++total_waits;
+	  this->condvar_.wait();
+	}
+
+    ++total_views;
+    this->in_flight_ += bytes;
+    if (this->in_flight_ > peak_in_flight)
+      peak_in_flight = this->in_flight_;
+    read = this->is_written(start, size);
+  }
+
+  unsigned char* view = static_cast<unsigned char*>(malloc(size == 0
+							   ? 1
+							   : size));
+  if (view == NULL)
+    gold_nomem();
+  if (read)
+    pread_all(name, o, start, view, size);
+  else
+    memset(view, 0, size);
+
+  View v;
+  v.offset = start;
+  v.size = size;
+  v.original = NULL;
+  if (is_input_output)
+    {
+      v.original = static_cast<unsigned char*>(malloc(size == 0 ? 1 : size));
+      if (v.original == NULL)
+	gold_nomem();
+      memcpy(v.original, view, size);
+    }
+
+  Hold_lock hl(this->lock_);
+  this->views_[view] = v;
+  return view;
+}
+
+void
+Output_file_stream::release_view(const char* name, int o,
+				 const unsigned char* view, bool write)
+{
+  View v;
+  {
+    Hold_lock hl(this->lock_);
+    View_map::iterator p = this->views_.find(view);
+    gold_assert(p != this->views_.end());
+    v = p->second;
+    this->views_.erase(p);
+  }
+
+  if (write && v.original == NULL)
+    {
+      pwrite_all(name, o, v.offset, view, v.size);
+      this->mark_written(v.offset, v.size);
+    }
+  else if (write)
+    {
+      // Write back each run of changed bytes, leaving the rest alone
+      // in case another view has written to them in the meantime.
+      size_t i = 0;
+      while (i < v.size)
+	{
+	  if (view[i] == v.original[i])
+	    {
+	      ++i;
+	      continue;
+	    }
+	  size_t start = i;
+	  while (i < v.size && view[i] != v.original[i])
+	    ++i;
+	  pwrite_all(name, o, v.offset + start, view + start, i - start);
+	  this->mark_written(v.offset + start, i - start);
+	}
+    }
+  free(const_cast<unsigned char*>(view));
+  size_t bytes = v.size;
+  if (v.original != NULL)
+    {
+      free(v.original);
+      bytes *= 2;
+    }
+
+  Hold_lock hl(this->lock_);
+  this->adjust_holder(-1);
+  this->in_flight_ -= bytes;
+  this->condvar_.broadcast();
+}
+
 // Output_file methods.
 
 Output_file::Output_file(const char* name)
@@ -4861,7 +5400,8 @@ Output_file::Output_file(const char* name)
     base_(NULL),
     map_is_anonymous_(false),
     map_is_allocated_(false),
-    is_temporary_(false)
+    is_temporary_(false),
+    stream_(NULL)
 {
 }
 
@@ -5019,6 +5559,17 @@ Output_file::open(off_t file_size)
 void
 Output_file::resize(off_t file_size)
 {
+  if (this->stream_ != NULL)
+    {
+      int err = (file_size > this->file_size_
+		 ? gold_fallocate(this->o_, 0, file_size)
+		 : ::ftruncate(this->o_, file_size) < 0 ? errno : 0);
+      if (err != 0)
+	gold_fatal(_("%s: %s"), this->name_, strerror(err));
+      this->file_size_ = file_size;
+      return;
+    }
+
   // If the mmap is mapping an anonymous memory buffer, this is easy:
   // just mremap to the new size.  If it's mapping to a file, we want
   // to unmap to flush to the file, then remap after growing the file.
@@ -5124,11 +5675,85 @@ Output_file::map_no_anonymous(bool writable)
   return true;
 }
 
+// Set up to write the file with pwrite, buffering at most
+// MEMORY_LIMIT bytes at a time.  This is only done for a regular
+// file; we also don't do it for an incremental link, which expects to
+// be able to update the mapped file in place.  Return whether we are
+// streaming.
+
+bool
+Output_file::map_streaming(uint64_t memory_limit)
+{
+  struct stat statbuf;
+  if (memory_limit == 0
+      || parameters->incremental()
+      || this->is_temporary_
+      || this->o_ == STDOUT_FILENO
+      || this->o_ == STDERR_FILENO
+      || ::fstat(this->o_, &statbuf) != 0
+      || !S_ISREG(statbuf.st_mode))
+    return false;
+
+  // As in map_no_anonymous, make sure that we have the disk space.
+  int err = gold_fallocate(this->o_, 0, this->file_size_);
+  if (err != 0)
+    gold_fatal(_("%s: %s"), this->name_, strerror(err));
+
+  this->stream_ = new Output_file_stream(memory_limit);
+  return true;
+}
+
+void
+Output_file::stream_write(off_t offset, const void* data, size_t len)
+{
+  pwrite_all(this->name_, this->o_, offset,
+	     static_cast<const unsigned char*>(data), len);
+  this->stream_->mark_written(offset, len);
+}
+
+unsigned char*
+Output_file::get_stream_view(off_t start, size_t size, bool is_input_output)
+{
+  return this->stream_->get_view(this->name_, this->o_, start, size,
+				 is_input_output);
+}
+
+void
+Output_file::write_stream_view(const unsigned char* view)
+{
+  this->stream_->release_view(this->name_, this->o_, view, true);
+}
+
+void
+Output_file::free_stream_view(const unsigned char* view)
+{
+  this->stream_->release_view(this->name_, this->o_, view, false);
+}
+
+// Print statistics about streaming output.
+
+void
+Output_file::print_stats()
+{
+  if (Output_file_stream::peak_in_flight == 0)
+    return;
+  fprintf(stderr, _("%s: output file peak buffered bytes: %llu\n"),
+	  program_name,
+	  static_cast<unsigned long long>(Output_file_stream::peak_in_flight));
+  fprintf(stderr, _("%s: output file buffered views: %llu; waits: %llu\n"),
+	  program_name,
+	  static_cast<unsigned long long>(Output_file_stream::total_views),
+	  static_cast<unsigned long long>(Output_file_stream::total_waits));
+}
+
 // Map the file into memory.
 
 void
 Output_file::map()
 {
+  if (this->map_streaming(parameters->options().output_memory_limit()))
+    return;
+
   if (parameters->options().mmap_output_file()
       && this->map_no_anonymous(true))
     return;
@@ -5169,6 +5794,18 @@ Output_file::unmap()
 void
 Output_file::close()
 {
+  if (this->stream_ != NULL)
+    {
+      // Everything has already been written.
+      gold_assert(this->stream_->view_count() == 0);
+      delete this->stream_;
+      this->stream_ = NULL;
+      if (::close(this->o_) < 0)
+	gold_error(_("%s: close: %s"), this->name_, strerror(errno));
+      this->o_ = -1;
+      return;
+    }
+
   // If the map isn't file-backed, we need to write it now.
   if (this->map_is_anonymous_ && !this->is_temporary_)
     {
@@ -5415,6 +6052,26 @@ template
 class Output_data_reloc<elfcpp::SHT_RELA, true, 64, true>;
 #endif
 
+#ifdef HAVE_TARGET_32_LITTLE
+template
+class Output_data_relr<32, false>;
+#endif
+
+#ifdef HAVE_TARGET_32_BIG
+template
+class Output_data_relr<32, true>;
+#endif
+
+#ifdef HAVE_TARGET_64_LITTLE
+template
+class Output_data_relr<64, false>;
+#endif
+
+#ifdef HAVE_TARGET_64_BIG
+template
+class Output_data_relr<64, true>;
+#endif
+
 #ifdef HAVE_TARGET_32_LITTLE
 template
 class Output_relocatable_relocs<elfcpp::SHT_REL, 32, false>;
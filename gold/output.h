@@ -38,6 +38,7 @@ class General_options;
 class Object;
 class Symbol;
 class Output_file;
+class Output_file_stream;
 class Output_merge_base;
 class Output_section;
 class Relocatable_relocs;
@@ -2185,6 +2186,109 @@ class Output_data_reloc<elfcpp::SHT_RELA, dynamic, size, big_endian>
   }
 };
 
+// Output_data_relr holds the relative relocations packed into a
+// SHT_RELR section for -z pack-relative-relocs.  Each relocation is
+// just the address of a word which the dynamic linker must adjust by
+// the load address; the word itself holds the link-time value.  The
+// addresses are written as an address entry followed by bitmap
+// entries for the words after it.
+//
+// We group the words by the input section or Output_data holding
+// them, and only pack words whose group is aligned to the word size.
+// That way we know how big the section will be before we know where
+// the groups will end up.
+
+template<int size, bool big_endian>
+class Output_data_relr : public Output_section_data
+{
+ public:
+  typedef typename elfcpp::Elf_types<size>::Elf_Addr Address;
+
+  Output_data_relr()
+    : Output_section_data(Output_data::default_alignment_for_size(size)),
+      groups_(), group_map_(), last_group_(-1U)
+  { }
+
+  // Return whether the word at OFFSET in section SHNDX of RELOBJ may
+  // be added to this section.
+  static bool
+  can_pack(Relobj* relobj, unsigned int shndx, Address offset)
+  {
+    return (offset % (size / 8) == 0
+	    && relobj->section_addralign(shndx) >= size / 8
+	    && !relobj->is_output_section_offset_invalid(shndx));
+  }
+
+  // Add the word at OFFSET in section SHNDX of RELOBJ, which goes in
+  // the output section OS.
+  void
+  add_input_section(Output_section* os, Relobj* relobj, unsigned int shndx,
+		    Address offset);
+
+  // Add the word at OFFSET in OD, which must be aligned to the word
+  // size.
+  void
+  add_output_data(Output_data* od, Address offset);
+
+  // Encode the addresses of the NOFFSETS sorted word offsets at
+  // OFFSETS from BASE into POV, which may be NULL.  Return the number
+  // of entries.
+  static size_t
+  encode(Address base, const Address* offsets, size_t noffsets,
+	 unsigned char* pov);
+
+ protected:
+  // Set the final data size.
+  void
+  set_final_data_size();
+
+  // Write out the data.
+  void
+  do_write(Output_file*);
+
+  // Set the entry size.
+  void
+  do_adjust_output_section(Output_section* os);
+
+  // Write to a map file.
+  void
+  do_print_to_mapfile(Mapfile* mapfile) const
+  { mapfile->print_output_data(this, _("** dynamic relocs")); }
+
+ private:
+  // The words in one input section or Output_data.
+  struct Relr_group
+  {
+    Relr_group(Output_data* od_arg, Relobj* relobj_arg,
+	       unsigned int shndx_arg)
+      : od(od_arg), relobj(relobj_arg), shndx(shndx_arg), offsets()
+    { }
+
+    // The Output_data holding the words, or NULL for an input section.
+    Output_data* od;
+    // The object and section index of the input section.
+    Relobj* relobj;
+    unsigned int shndx;
+    // The offsets of the words.
+    std::vector<Address> offsets;
+  };
+
+  typedef std::vector<Relr_group> Relr_groups;
+  typedef std::map<std::pair<const void*, unsigned int>, unsigned int>
+    Relr_group_map;
+
+  // Add a word to the group for OD or for RELOBJ and SHNDX.
+  void
+  add(Output_data* od, Relobj* relobj, unsigned int shndx, Address offset);
+
+  // The groups, in the order we first saw them.
+  Relr_groups groups_;
+  // Map from an Output_data or Relobj and section index to a group.
+  Relr_group_map group_map_;
+  // The index of the group we added to last.
+  unsigned int last_group_;
+};
+
 // Output_relocatable_relocs represents a relocation section in a
 // relocatable link.  The actual data is written out in the target
 // hook relocate_relocs.  This just saves space for it.
@@ -3100,6 +3204,12 @@ class Output_section : public Output_data
   void
   update_flags_for_input_section(elfcpp::Elf_Xword flags);
 
+  // Add FLAGS to the section flags.  This is used to set
+  // SHF_COMPRESSED when the contents are compressed.
+  void
+  add_flags(elfcpp::Elf_Xword flags)
+  { this->flags_ |= flags; }
+
   // Return the entsize field.
   uint64_t
   entsize() const
@@ -3881,6 +3991,12 @@ class Output_section : public Output_data
   void
   print_merge_stats();
 
+  // Queue tasks to merge the contents of any SHF_MERGE sections in
+  // parallel.  See Output_merge_base::queue_merge_tasks.
+  void
+  queue_merge_tasks(Workqueue*, unsigned int shard_count,
+		    Task_token* merge_blocker);
+
   // Set a fixed layout for the section.  Used for incremental update links.
   void
   set_fixed_layout(uint64_t sh_addr, off_t sh_offset, off_t sh_size,
@@ -3897,6 +4013,12 @@ class Output_section : public Output_data
   set_is_patch_space_allowed()
   { this->is_patch_space_allowed_ = true; }
 
+  // Set flag to pad the size of this section to a multiple of its
+  // alignment.  Used for --hot-text-align.
+  void
+  set_pad_to_addralign()
+  { this->pad_to_addralign_ = true; }
+
   // Set a fill method to use for free space left in the output section
   // during incremental links.
   void
@@ -4392,6 +4514,8 @@ class Output_section : public Output_data
   bool has_fixed_layout_ : 1;
   // True if we can add patch space to this section.
   bool is_patch_space_allowed_ : 1;
+  // True if we pad the section to a multiple of its alignment.
+  bool pad_to_addralign_ : 1;
   // True if this output section goes into a unique segment.
   bool is_unique_segment_ : 1;
   // For SHT_TLS sections, the offset of this section relative to the base
@@ -4755,13 +4879,34 @@ class Output_file
   filename()
   { return this->name_; }
 
-  // We currently always use mmap which makes the view handling quite
-  // simple.  In the future we may support other approaches.
+  // Return whether the file is being written with pwrite through
+  // separately allocated buffers rather than mapped.  See
+  // --output-memory-limit.
+  bool
+  is_streaming() const
+  { return this->stream_ != NULL; }
+
+  // Print statistics about the streaming output mode.
+  static void
+  print_stats();
+
+  // Normally the file is mapped, which makes the view handling quite
+  // simple.  When streaming, each view is a buffer of its own which
+  // is read from the file if necessary and written back with pwrite
+  // when the caller is done with it.  In that case output views which
+  // are outstanding at the same time must not overlap; an
+  // input/output view may overlap other views, as only the bytes the
+  // caller changes are written back.
 
   // Write data to the output file.
   void
   write(off_t offset, const void* data, size_t len)
-  { memcpy(this->base_ + offset, data, len); }
+  {
+    if (this->stream_ != NULL)
+      this->stream_write(offset, data, len);
+    else
+      memcpy(this->base_ + offset, data, len);
+  }
 
   // Get a buffer to use to write to the file, given the offset into
   // the file and the size.
@@ -4770,25 +4915,41 @@ class Output_file
   {
     gold_assert(start >= 0
 		&& start + static_cast<off_t>(size) <= this->file_size_);
+    if (this->stream_ != NULL)
+      return this->get_stream_view(start, size, false);
     return this->base_ + start;
   }
 
   // VIEW must have been returned by get_output_view.  Write the
   // buffer to the file, passing in the offset and the size.
   void
-  write_output_view(off_t, size_t, unsigned char*)
-  { }
+  write_output_view(off_t, size_t, unsigned char* view)
+  {
+    if (this->stream_ != NULL)
+      this->write_stream_view(view);
+  }
 
   // Get a read/write buffer.  This is used when we want to write part
   // of the file, read it in, and write it again.
   unsigned char*
   get_input_output_view(off_t start, size_t size)
-  { return this->get_output_view(start, size); }
+  {
+    if (this->stream_ != NULL)
+      {
+	gold_assert(start >= 0
+		    && start + static_cast<off_t>(size) <= this->file_size_);
+	return this->get_stream_view(start, size, true);
+      }
+    return this->get_output_view(start, size);
+  }
 
   // Write a read/write buffer back to the file.
   void
-  write_input_output_view(off_t, size_t, unsigned char*)
-  { }
+  write_input_output_view(off_t, size_t, unsigned char* view)
+  {
+    if (this->stream_ != NULL)
+      this->write_stream_view(view);
+  }
 
   // Get a read buffer.  This is used when we just want to read part
   // of the file back it in.
@@ -4798,8 +4959,11 @@ class Output_file
 
   // Release a read bfufer.
   void
-  free_input_view(off_t, size_t, const unsigned char*)
-  { }
+  free_input_view(off_t, size_t, const unsigned char* view)
+  {
+    if (this->stream_ != NULL)
+      this->free_stream_view(view);
+  }
 
  private:
   // Map the file into memory or, if that fails, allocate anonymous
@@ -4819,6 +4983,24 @@ class Output_file
   void
   unmap();
 
+  // Set up to write the file with pwrite rather than mapping it.
+  // Return false if that is not possible.
+  bool
+  map_streaming(uint64_t memory_limit);
+
+  // Streaming versions of the view functions.
+  void
+  stream_write(off_t offset, const void* data, size_t len);
+
+  unsigned char*
+  get_stream_view(off_t start, size_t size, bool is_input_output);
+
+  void
+  write_stream_view(const unsigned char* view);
+
+  void
+  free_stream_view(const unsigned char* view);
+
   // File name.
   const char* name_;
   // File descriptor.
@@ -4833,6 +5015,9 @@ class Output_file
   bool map_is_allocated_;
   // True if this is a temporary file which should not be output.
   bool is_temporary_;
+  // Buffer state when the file is written with pwrite, or NULL if it
+  // is mapped.
+  Output_file_stream* stream_;
 };
 
 } // End namespace gold.
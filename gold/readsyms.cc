@@ -567,7 +567,11 @@ Add_symbols::~Add_symbols()
 }
 
 // We are blocked by this_blocker_.  We block next_blocker_.  We also
-// lock the file.
+// lock the file.  When the symbol table is sharded, the symbols of a
+// relocatable object are added to the shards by separate tasks, and
+// any other kind of object must wait for those tasks to complete.
+// The objects of an incremental update have no Input_file, so we
+// check is_incremental before just_symbols, which looks at it.
 
 Task_token*
 Add_symbols::is_runnable()
@@ -576,6 +580,15 @@ Add_symbols::is_runnable()
     return this->this_blocker_;
   if (this->object_->is_locked())
     return this->object_->token();
+  if (this->object_->is_dynamic()
+      || this->object_->pluginobj() != NULL
+      || this->object_->is_incremental()
+      || this->object_->just_symbols())
+    {
+      Task_token* shard_blocker = this->symtab_->shard_tasks_blocker();
+      if (shard_blocker != NULL)
+	return shard_blocker;
+    }
   return NULL;
 }
 
@@ -591,7 +604,7 @@ Add_symbols::locks(Task_locker* tl)
 // Add the symbols in the object to the symbol table.
 
 void
-Add_symbols::run(Workqueue*)
+Add_symbols::run(Workqueue* workqueue)
 {
   Pluginobj* pluginobj = this->object_->pluginobj();
   if (pluginobj != NULL)
@@ -632,7 +645,11 @@ Add_symbols::run(Workqueue*)
 					    this->library_, script_info);
 	}
       this->object_->layout(this->symtab_, this->layout_, this->sd_);
+      if (this->symtab_->is_sharded())
+	this->symtab_->set_shard_workqueue(workqueue);
       this->object_->add_symbols(this->symtab_, this->sd_, this->layout_);
+      if (this->symtab_->is_sharded())
+	this->symtab_->set_shard_workqueue(NULL);
       this->object_->discard_decompressed_sections();
       delete this->sd_;
       this->sd_ = NULL;
@@ -786,13 +803,17 @@ Start_group::~Start_group()
   // file in the group.
 }
 
-// We need to wait for THIS_BLOCKER_ and unblock NEXT_BLOCKER_.
+// We need to wait for THIS_BLOCKER_ and unblock NEXT_BLOCKER_.  We
+// also wait for any symbols being added to a sharded symbol table.
 
 Task_token*
 Start_group::is_runnable()
 {
   if (this->this_blocker_ != NULL && this->this_blocker_->is_blocked())
     return this->this_blocker_;
+  Task_token* shard_blocker = this->symtab_->shard_tasks_blocker();
+  if (shard_blocker != NULL)
+    return shard_blocker;
   return NULL;
 }
 
@@ -820,13 +841,17 @@ Finish_group::~Finish_group()
   // input file following the group.
 }
 
-// We need to wait for THIS_BLOCKER_ and unblock NEXT_BLOCKER_.
+// We need to wait for THIS_BLOCKER_ and unblock NEXT_BLOCKER_.  We
+// also wait for any symbols being added to a sharded symbol table.
 
 Task_token*
 Finish_group::is_runnable()
 {
   if (this->this_blocker_ != NULL && this->this_blocker_->is_blocked())
     return this->this_blocker_;
+  Task_token* shard_blocker = this->symtab_->shard_tasks_blocker();
+  if (shard_blocker != NULL)
+    return shard_blocker;
   return NULL;
 }
 
@@ -876,6 +901,35 @@ Finish_group::run(Workqueue*)
     delete this->input_group_;
 }
 
+// Class Finish_symbols.
+
+Finish_symbols::~Finish_symbols()
+{
+  if (this->this_blocker_ != NULL)
+    delete this->this_blocker_;
+  // next_blocker_ is deleted by the task which follows.
+}
+
+// We need to wait for THIS_BLOCKER_ and for the tasks adding symbols
+// to the shards of the symbol table.  We unblock NEXT_BLOCKER_.
+
+Task_token*
+Finish_symbols::is_runnable()
+{
+  if (this->this_blocker_ != NULL && this->this_blocker_->is_blocked())
+    return this->this_blocker_;
+  Task_token* shard_blocker = this->symtab_->shard_tasks_blocker();
+  if (shard_blocker != NULL)
+    return shard_blocker;
+  return NULL;
+}
+
+void
+Finish_symbols::locks(Task_locker* tl)
+{
+  tl->add(this, this->next_blocker_);
+}
+
 // Class Read_script
 
 Read_script::~Read_script()
@@ -437,6 +437,44 @@ class Finish_group : public Task
   Task_token* next_blocker_;
 };
 
+// This class waits until all the symbols of the input files have been
+// added to a sharded symbol table.  It is queued after the last input
+// file, and it unblocks the tasks which run once the symbol table is
+// complete.
+
+class Finish_symbols : public Task
+{
+ public:
+  Finish_symbols(Symbol_table* symtab, Task_token* this_blocker,
+		 Task_token* next_blocker)
+    : symtab_(symtab), this_blocker_(this_blocker),
+      next_blocker_(next_blocker)
+  { }
+
+  ~Finish_symbols();
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable();
+
+  void
+  locks(Task_locker*);
+
+  void
+  run(Workqueue*)
+  { }
+
+  std::string
+  get_name() const
+  { return "Finish_symbols"; }
+
+ private:
+  Symbol_table* symtab_;
+  Task_token* this_blocker_;
+  Task_token* next_blocker_;
+};
+
 // This class is used to read a file which was not recognized as an
 // object or archive.  It tries to read it as a linker script, using
 // the tokens to serialize with the calls to Add_symbols.
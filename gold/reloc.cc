@@ -51,7 +51,7 @@ Read_relocs::is_runnable()
   return this->object_->is_locked() ? this->object_->token() : NULL;
 }
 
-// Lock the file.
+// Lock the file, and unblock PRESCAN_BLOCKER_ when done.
 
 void
 Read_relocs::locks(Task_locker* tl)
@@ -59,6 +59,8 @@ Read_relocs::locks(Task_locker* tl)
   Task_token* token = this->object_->token();
   if (token != NULL)
     tl->add(this, token);
+  if (this->prescan_blocker_ != NULL)
+    tl->add(this, this->prescan_blocker_);
 }
 
 // Read the relocations and then start a Scan_relocs_task.
@@ -69,6 +71,8 @@ Read_relocs::run(Workqueue* workqueue)
   Read_relocs_data* rd = new Read_relocs_data;
   this->object_->read_relocs(rd);
   this->object_->set_relocs_data(rd);
+  if (this->prescan_blocker_ != NULL)
+    this->object_->prescan_relocs(this->symtab_, this->layout_, rd);
   this->object_->release();
 
   // If garbage collection or identical comdat folding is desired, we  
@@ -145,6 +149,45 @@ Gc_process_relocs::get_name() const
   return "Gc_process_relocs " + this->object_->name();
 }
 
+// Prescan_relocs methods.
+
+// These tasks prescan relocations which were read earlier, for
+// garbage collection or identical code folding; otherwise
+// Read_relocs prescans them as it reads them.  These tasks run in
+// parallel, and unblock BLOCKER_ when done.
+
+Task_token*
+Prescan_relocs::is_runnable()
+{
+  if (this->object_->is_locked())
+    return this->object_->token();
+  return NULL;
+}
+
+void
+Prescan_relocs::locks(Task_locker* tl)
+{
+  Task_token* token = this->object_->token();
+  if (token != NULL)
+    tl->add(this, token);
+  tl->add(this, this->blocker_);
+}
+
+void
+Prescan_relocs::run(Workqueue*)
+{
+  this->object_->prescan_relocs(this->symtab_, this->layout_, this->rd_);
+  this->object_->release();
+}
+
+// Return a debugging name for the task.
+
+std::string
+Prescan_relocs::get_name() const
+{
+  return "Prescan_relocs " + this->object_->name();
+}
+
 // Scan_relocs methods.
 
 Scan_relocs::~Scan_relocs()
@@ -418,6 +461,92 @@ Sized_relobj_file<size, big_endian>::do_gc_process_relocs(Symbol_table* symtab,
 }
 
 
+// The number of relocs looked at by do_prescan_relocs and the number
+// staged for scan_relocs, for --stats.  Objects are prescanned in
+// parallel, so these are protected by a lock.
+
+static Lock* prescan_counts_lock = NULL;
+static Initialize_lock prescan_counts_initialize_lock(&prescan_counts_lock);
+static unsigned long long prescanned_reloc_count;
+static unsigned long long staged_reloc_count;
+
+// Print statistics about prescanned relocs to stderr.
+
+void
+Relobj::print_prescan_stats()
+{
+  if (prescanned_reloc_count == 0)
+    return;
+  fprintf(stderr, _("%s: relocs prescanned: %llu; staged: %llu\n"),
+	  program_name, prescanned_reloc_count, staged_reloc_count);
+}
+
+// Prescan the relocs.  For each section which would be passed to
+// the target's scan_relocs, ask the target to copy the relocs which
+// scan_relocs needs to look at.  Since this does not change the
+// symbol table or the output sections, it may run for all the objects
+// in parallel, leaving only the staged relocs for the Scan_relocs
+// tasks, which must run in order.
+
+template<int size, bool big_endian>
+void
+Sized_relobj_file<size, big_endian>::do_prescan_relocs(Symbol_table* symtab,
+						       Layout* layout,
+						       Read_relocs_data* rd)
+{
+  gold_assert(!parameters->options().relocatable());
+
+  Sized_target<size, big_endian>* target =
+    parameters->sized_target<size, big_endian>();
+
+  const unsigned char* local_symbols;
+  if (rd->local_symbols == NULL)
+    local_symbols = NULL;
+  else
+    local_symbols = rd->local_symbols->data();
+
+  unsigned long long prescanned = 0;
+  unsigned long long staged_count = 0;
+  for (Read_relocs_data::Relocs_list::iterator p = rd->relocs.begin();
+       p != rd->relocs.end();
+       ++p)
+    {
+      // These are the sections skipped by do_scan_relocs.
+      if ((parameters->options().gc_sections()
+	   || parameters->options().icf_enabled())
+	  && p->output_section == NULL)
+	continue;
+      if (!p->is_data_section_allocated)
+	continue;
+
+      std::vector<unsigned char>* staged = new std::vector<unsigned char>();
+      if (target->prescan_relocs(symtab, layout, this, p->data_shndx,
+				 p->sh_type, p->contents->data(),
+				 p->reloc_count, p->output_section,
+				 p->needs_special_offset_handling,
+				 this->local_symbol_count_, local_symbols,
+				 staged))
+	{
+	  p->staged_relocs = staged;
+	  prescanned += p->reloc_count;
+	  staged_count += (staged->size()
+			   / (p->sh_type == elfcpp::SHT_REL
+			      ? elfcpp::Elf_sizes<size>::rel_size
+			      : elfcpp::Elf_sizes<size>::rela_size));
+	}
+      else
+	delete staged;
+    }
+
+  if (parameters->options().stats() && prescanned > 0)
+    {
+      prescan_counts_initialize_lock.initialize();
+      Hold_optional_lock hl(prescan_counts_lock);
+      prescanned_reloc_count += prescanned;
+      staged_reloc_count += staged_count;
+    }
+}
+
 // Scan the relocs and adjust the symbol table.  This looks for
 // relocations which require GOT/PLT/COPY relocations.
 
@@ -459,12 +588,28 @@ Sized_relobj_file<size, big_endian>::do_scan_relocs(Symbol_table* symtab,
 	  // only scan allocated sections.  We may see a non-allocated
 	  // section here if we are emitting relocs.
 	  if (p->is_data_section_allocated)
-	    target->scan_relocs(symtab, layout, this, p->data_shndx,
-				p->sh_type, p->contents->data(),
-				p->reloc_count, p->output_section,
-				p->needs_special_offset_handling,
-				this->local_symbol_count_,
-				local_symbols);
+	    {
+	      const unsigned char* prelocs = p->contents->data();
+	      size_t reloc_count = p->reloc_count;
+	      if (p->staged_relocs != NULL)
+		{
+		  // Only scan the relocs staged by do_prescan_relocs.
+		  prelocs = (p->staged_relocs->empty()
+			     ? NULL
+			     : &p->staged_relocs->front());
+		  reloc_count = (p->staged_relocs->size()
+				 / (p->sh_type == elfcpp::SHT_REL
+				    ? elfcpp::Elf_sizes<size>::rel_size
+				    : elfcpp::Elf_sizes<size>::rela_size));
+		}
+	      if (reloc_count > 0)
+		target->scan_relocs(symtab, layout, this, p->data_shndx,
+				    p->sh_type, prelocs, reloc_count,
+				    p->output_section,
+				    p->needs_special_offset_handling,
+				    this->local_symbol_count_,
+				    local_symbols);
+	    }
 	  if (parameters->options().emit_relocs())
 	    this->emit_relocs_scan(symtab, layout, local_symbols, p);
 	  if (layout->incremental_inputs() != NULL)
@@ -488,6 +633,8 @@ Sized_relobj_file<size, big_endian>::do_scan_relocs(Symbol_table* symtab,
 
       delete p->contents;
       p->contents = NULL;
+      delete p->staged_relocs;
+      p->staged_relocs = NULL;
     }
 
   // For incremental links, finalize the allocation of relocations.
@@ -1664,6 +1811,38 @@ Sized_relobj_file<64, true>::do_gc_process_relocs(Symbol_table* symtab,
 						  Read_relocs_data* rd);
 #endif
 
+#ifdef HAVE_TARGET_32_LITTLE
+template
+void
+Sized_relobj_file<32, false>::do_prescan_relocs(Symbol_table* symtab,
+						Layout* layout,
+						Read_relocs_data* rd);
+#endif
+
+#ifdef HAVE_TARGET_32_BIG
+template
+void
+Sized_relobj_file<32, true>::do_prescan_relocs(Symbol_table* symtab,
+					       Layout* layout,
+					       Read_relocs_data* rd);
+#endif
+
+#ifdef HAVE_TARGET_64_LITTLE
+template
+void
+Sized_relobj_file<64, false>::do_prescan_relocs(Symbol_table* symtab,
+						Layout* layout,
+						Read_relocs_data* rd);
+#endif
+
+#ifdef HAVE_TARGET_64_BIG
+template
+void
+Sized_relobj_file<64, true>::do_prescan_relocs(Symbol_table* symtab,
+					       Layout* layout,
+					       Read_relocs_data* rd);
+#endif
+
 #ifdef HAVE_TARGET_32_LITTLE
 template
 void
@@ -64,11 +64,14 @@ class Read_relocs : public Task
  public:
   //   THIS_BLOCKER and NEXT_BLOCKER are passed along to a Scan_relocs
   // or Gc_process_relocs task, so that they run in a deterministic
-  // order.
+  // order.  If PRESCAN_BLOCKER is not NULL, we also prescan the
+  // relocations, and unblock PRESCAN_BLOCKER when done.
   Read_relocs(Symbol_table* symtab, Layout* layout, Relobj* object,
-	      Task_token* this_blocker, Task_token* next_blocker)
+	      Task_token* this_blocker, Task_token* next_blocker,
+	      Task_token* prescan_blocker = NULL)
     : symtab_(symtab), layout_(layout), object_(object),
-      this_blocker_(this_blocker), next_blocker_(next_blocker)
+      this_blocker_(this_blocker), next_blocker_(next_blocker),
+      prescan_blocker_(prescan_blocker)
   { }
 
   // The standard Task methods.
@@ -91,6 +94,7 @@ class Read_relocs : public Task
   Relobj* object_;
   Task_token* this_blocker_;
   Task_token* next_blocker_;
+  Task_token* prescan_blocker_;
 };
 
 // Process the relocs to figure out which sections are garbage.
@@ -134,6 +138,41 @@ class Gc_process_relocs : public Task
   Task_token* next_blocker_;
 };
 
+// Prescan the relocations for an object, to find the ones which
+// Scan_relocs needs to look at.  These tasks may run in parallel.
+
+class Prescan_relocs : public Task
+{
+ public:
+  // BLOCKER is unblocked when we are done.
+  Prescan_relocs(Symbol_table* symtab, Layout* layout, Relobj* object,
+		 Read_relocs_data* rd, Task_token* blocker)
+    : symtab_(symtab), layout_(layout), object_(object), rd_(rd),
+      blocker_(blocker)
+  { }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable();
+
+  void
+  locks(Task_locker*);
+
+  void
+  run(Workqueue*);
+
+  std::string
+  get_name() const;
+
+ private:
+  Symbol_table* symtab_;
+  Layout* layout_;
+  Relobj* object_;
+  Read_relocs_data* rd_;
+  Task_token* blocker_;
+};
+
 // Scan the relocations for an object to see if they require any
 // GOT/PLT/COPY relocations.
 
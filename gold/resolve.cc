@@ -367,8 +367,9 @@ Symbol_table::resolve(Sized_symbol<size>* to,
           = { object, orig_st_shndx, static_cast<off_t>(sym.get_st_value()) };
       Symbol_location toloc = { to->object(), to->shndx(&to_is_ordinary),
 				static_cast<off_t>(to->value()) };
-      this->candidate_odr_violations_[to->name()].insert(fromloc);
-      this->candidate_odr_violations_[to->name()].insert(toloc);
+      Odr_map& candidates(this->shard(to)->candidate_odr_violations);
+      candidates[to->name()].insert(fromloc);
+      candidates[to->name()].insert(toloc);
     }
 
   // Plugins don't provide a symbol type, so adopt the existing type
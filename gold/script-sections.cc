@@ -540,6 +540,8 @@ Orphan_section_placement::last_place() const
   return this->places_[PLACE_LAST].location;
 }
 
+class Input_section_match_index;
+
 // An element in a SECTIONS clause.
 
 class Sections_element
@@ -577,13 +579,12 @@ class Sections_element
   finalize_symbols(Symbol_table*, const Layout*, uint64_t*)
   { }
 
-  // Return the output section name to use for an input file name and
-  // section name.  This only real implementation is in
-  // Output_section_definition.
-  virtual const char*
-  output_section_name(const char*, const char*, Output_section***,
-		      Script_sections::Section_type*, bool*)
-  { return NULL; }
+  // Add the input section specifications to the index used to find
+  // the output section for an input section.  The only real
+  // implementation is in Output_section_definition.
+  virtual void
+  add_match_rules(Input_section_match_index*)
+  { }
 
   // Initialize OSP with an output section.
   virtual void
@@ -797,11 +798,12 @@ class Output_section_element
   finalize_symbols(Symbol_table*, const Layout*, uint64_t*, Output_section**)
   { }
 
-  // Return whether this element matches FILE_NAME and SECTION_NAME.
-  // The only real implementation is in Output_section_element_input.
-  virtual bool
-  match_name(const char*, const char*, bool *) const
-  { return false; }
+  // Add the input section specifications to INDEX.  The only real
+  // implementation is in Output_section_element_input.
+  virtual void
+  add_match_rules(Input_section_match_index*, Output_section_definition*)
+    const
+  { }
 
   // Set section addresses.  This includes applying assignments if the
   // expression is an absolute value.
@@ -1238,10 +1240,28 @@ class Output_section_element_input : public Output_section_element
     *dot_section = this->final_dot_section_;
   }
 
-  // See whether we match FILE_NAME and SECTION_NAME as an input section.
-  // If we do then also indicate whether the section should be KEPT.
+  // Add our input section patterns to INDEX.  OSDEF is the output
+  // section which holds this element.
+  void
+  add_match_rules(Input_section_match_index* index,
+		  Output_section_definition* osdef) const;
+
+  // See if we match a file name.
+  bool
+  match_file_name(const char* file_name) const;
+
+  // Whether we match every file name.
   bool
-  match_name(const char* file_name, const char* section_name, bool* keep) const;
+  matches_all_files() const
+  {
+    return (this->filename_pattern_.empty()
+	    && this->filename_exclusions_.empty());
+  }
+
+  // Whether to keep the matching sections when garbage collecting.
+  bool
+  keep() const
+  { return this->keep_; }
 
   // Set the section address.
   void
@@ -1286,10 +1306,6 @@ class Output_section_element_input : public Output_section_element
 	    : strcmp(string, pattern) == 0);
   }
 
-  // See if we match a file name.
-  bool
-  match_file_name(const char* file_name) const;
-
   // The file name pattern.  If this is the empty string, we match all
   // files.
   std::string filename_pattern_;
@@ -1393,35 +1409,417 @@ Output_section_element_input::match_file_name(const char* file_name) const
   return true;
 }
 
-// See whether we match FILE_NAME and SECTION_NAME.  If we do then
-// KEEP indicates whether the section should survive garbage collection.
+// An index of the input section specifications of a SECTIONS clause.
+// Each section name pattern of each input section specification is a
+// rule, numbered in the order of the script, and an input section
+// goes to the output section of the first rule which matches it.
+// Trying each rule in turn costs the number of input sections times
+// the number of rules.  Instead we keep the rules with exact names in
+// a hash table, and file each wildcard pattern in a trie under its
+// literal prefix, or in a trie of reversed strings under its literal
+// suffix if that is longer.  A pattern with neither, such as "*foo*",
+// is filed in a third trie under its longest literal part, which we
+// look for at each position of the name.  Looking up a section walks
+// the tries along its name, and only passes the few rules it finds
+// there to fnmatch.  Patterns with no literal part which we can use
+// are always tried.  Whether a file name matches the file
+// name pattern of an input section specification is cached by file
+// name.  Sections are laid out by a single thread, so the index
+// does not need a lock.
+
+class Input_section_match_index
+{
+ public:
+  // A section name pattern of an input section specification.
+  struct Rule
+  {
+    Rule(Output_section_definition* o, const Output_section_element_input* e,
+	 int f, const char* p, bool w)
+      : osdef(o), element(e), file_index(f), pattern(p), is_wildcard(w)
+    { }
+
+    // The output section the matching sections go to.
+    Output_section_definition* osdef;
+    // The input section specification.
+    const Output_section_element_input* element;
+    // The index of the file name match in the cache, or -1 if the
+    // specification matches every file.
+    int file_index;
+    // The pattern, or NULL to match every section name.
+    const char* pattern;
+    // Whether the pattern is a wildcard.
+    bool is_wildcard;
+  };
+
+  Input_section_match_index()
+    : rules_(), exact_(), edges_(), nodes_(3), has_infix_(false), always_(),
+      elements_(), last_element_(NULL), file_index_count_(0),
+      file_matches_(), last_file_name_(), last_file_matches_(NULL)
+  { }
+
+  // Add a rule for PATTERN in ELEMENT of OSDEF.  PATTERN is NULL to
+  // match every section name.  The rules must be added in order.
+  void
+  add(Output_section_definition* osdef,
+      const Output_section_element_input* element, const char* pattern,
+      bool is_wildcard);
+
+  // Return the first rule which matches FILE_NAME and SECTION_NAME,
+  // or NULL if there is none.  FILE_NAME may be NULL for a section
+  // created by the linker.
+  const Rule*
+  find(const char* file_name, const char* section_name);
+
+  // Return whether to keep an input section from FILE_NAME which
+  // matches no rule.  For compatibility this comes from the last
+  // input section specification whose file name pattern matches.
+  bool
+  keep_unmatched(const char* file_name);
+
+ private:
+  // The numbers of the rules, in order.
+  typedef std::vector<int> Rule_list;
+  // Map from an exact section name to the rules for it.
+  typedef Unordered_map<std::string, Rule_list> Exact;
+  // Map from a node and a character to the child node.
+  typedef Unordered_map<uint64_t, unsigned int> Edges;
+  // Map from a file name to the cached results of the file name
+  // matches: 0 if not known, 1 if not matched, 2 if matched.  The
+  // last entry caches keep_unmatched in the same way.
+  typedef Unordered_map<std::string, std::vector<char> > File_matches;
+
+  // The roots of the prefix, suffix and infix tries.
+  static const unsigned int prefix_root = 0;
+  static const unsigned int suffix_root = 1;
+  static const unsigned int infix_root = 2;
+
+  // The key of the edge from NODE for the character C.
+  static uint64_t
+  edge_key(unsigned int node, char c)
+  { return (static_cast<uint64_t>(node) << 8) | static_cast<unsigned char>(c); }
+
+  // Return the child of NODE for C, or 0 if there is none.
+  unsigned int
+  child(unsigned int node, char c) const
+  {
+    Edges::const_iterator p = this->edges_.find(edge_key(node, c));
+    return p == this->edges_.end() ? 0 : p->second;
+  }
+
+  // File rule INDEX under the LEN characters at KEY in the trie at
+  // ROOT.  The characters are read backward if REVERSE.
+  void
+  add_to_trie(unsigned int root, const char* key, size_t len, bool reverse,
+	      int index);
+
+  // Walk the trie at ROOT along the characters from P to END, and
+  // look for a matching rule under each node we reach.
+  int
+  find_in_trie(unsigned int root, const char* p, const char* end,
+	       bool reverse, const char* file_name,
+	       std::vector<char>* file_matches, const char* section_name,
+	       int best) const;
+
+  // Return the cached file name matches for FILE_NAME.
+  std::vector<char>*
+  get_file_matches(const char* file_name);
+
+  // Return the first rule in RULES before BEST which matches
+  // FILE_NAME and SECTION_NAME, or BEST if there is none.
+  int
+  find_in(const Rule_list& rules, const char* file_name,
+	  std::vector<char>* file_matches, const char* section_name,
+	  int best) const;
+
+  // All the rules.
+  std::vector<Rule> rules_;
+  // The rules with exact section names.
+  Exact exact_;
+  // The edges of the tries.
+  Edges edges_;
+  // The rules filed under each node of the tries.
+  std::vector<Rule_list> nodes_;
+  // Whether there are any rules in the infix trie.
+  bool has_infix_;
+  // The rules with neither a prefix nor a suffix.
+  Rule_list always_;
+  // The input section specifications, in order.
+  std::vector<const Output_section_element_input*> elements_;
+  // The element of the last rule we added.
+  const Output_section_element_input* last_element_;
+  // The number of elements which do not match every file.
+  int file_index_count_;
+  // The cached file name matches.
+  File_matches file_matches_;
+  // The last file name we looked up, and its matches.
+  std::string last_file_name_;
+  std::vector<char>* last_file_matches_;
+};
+
+void
+Input_section_match_index::add(Output_section_definition* osdef,
+			       const Output_section_element_input* element,
+			       const char* pattern, bool is_wildcard)
+{
+  if (element != this->last_element_)
+    {
+      this->elements_.push_back(element);
+      if (!element->matches_all_files())
+	++this->file_index_count_;
+      this->last_element_ = element;
+    }
+  int file_index = (element->matches_all_files()
+		    ? -1
+		    : this->file_index_count_ - 1);
+
+  int index = this->rules_.size();
+  this->rules_.push_back(Rule(osdef, element, file_index, pattern,
+			      is_wildcard));
+
+  if (pattern == NULL)
+    {
+      this->always_.push_back(index);
+      return;
+    }
+
+  if (!is_wildcard)
+    {
+      this->exact_[pattern].push_back(index);
+      return;
+    }
+
+  // We do not use fnmatch with FNM_NOESCAPE, so the literal prefix
+  // stops at a backslash, and we only use the suffix of a pattern
+  // without a backslash or a bracket expression.
+  size_t len = strlen(pattern);
+  size_t prefix_len = strcspn(pattern, "*?[\\");
+  size_t suffix_len = 0;
+  if (strpbrk(pattern, "[\\") == NULL)
+    {
+      while (suffix_len < len
+	     && pattern[len - suffix_len - 1] != '*'
+	     && pattern[len - suffix_len - 1] != '?')
+	++suffix_len;
+    }
+
+  if (prefix_len > 0 || suffix_len > 0)
+    {
+      if (prefix_len >= suffix_len)
+	this->add_to_trie(prefix_root, pattern, prefix_len, false, index);
+      else
+	this->add_to_trie(suffix_root, pattern + len - 1, suffix_len, true,
+			  index);
+      return;
+    }
+
+  // Find the longest literal part of the pattern.
+  const char* infix = NULL;
+  size_t infix_len = 0;
+  if (strpbrk(pattern, "[\\") == NULL)
+    {
+      const char* p = pattern;
+      while (*p != '\0')
+	{
+	  size_t n = strcspn(p, "*?");
+	  if (n > infix_len)
+	    {
+	      infix = p;
+	      infix_len = n;
+	    }
+	  p += n;
+	  if (*p != '\0')
+	    ++p;
+	}
+    }
+
+  if (infix_len > 0)
+    {
+      this->add_to_trie(infix_root, infix, infix_len, false, index);
+      this->has_infix_ = true;
+    }
+  else
+    this->always_.push_back(index);
+}
+
+void
+Input_section_match_index::add_to_trie(unsigned int root, const char* key,
+				       size_t len, bool reverse, int index)
+{
+  unsigned int node = root;
+  for (size_t i = 0; i < len; ++i)
+    {
+      char c = reverse ? key[-static_cast<ptrdiff_t>(i)] : key[i];
+      std::pair<Edges::iterator, bool> ins =
+	this->edges_.insert(std::make_pair(edge_key(node, c), 0U));
+      if (ins.second)
+	{
+	  ins.first->second = this->nodes_.size();
+	  this->nodes_.push_back(Rule_list());
+	}
+      node = ins.first->second;
+    }
+  this->nodes_[node].push_back(index);
+}
+
+int
+Input_section_match_index::find_in_trie(unsigned int root, const char* p,
+					const char* end, bool reverse,
+					const char* file_name,
+					std::vector<char>* file_matches,
+					const char* section_name,
+					int best) const
+{
+  unsigned int node = root;
+  while (p != end)
+    {
+      node = this->child(node, reverse ? *--p : *p++);
+      if (node == 0)
+	break;
+      best = this->find_in(this->nodes_[node], file_name, file_matches,
+			   section_name, best);
+    }
+  return best;
+}
+
+std::vector<char>*
+Input_section_match_index::get_file_matches(const char* file_name)
+{
+  // The sections of an object are laid out together, so we usually
+  // see the same file name as last time.
+  if (this->last_file_matches_ != NULL
+      && this->last_file_name_ == file_name)
+    return this->last_file_matches_;
+
+  std::vector<char>* matches = &this->file_matches_[file_name];
+  if (matches->empty())
+    matches->resize(this->file_index_count_ + 1, 0);
+  this->last_file_name_ = file_name;
+  this->last_file_matches_ = matches;
+  return matches;
+}
+
+int
+Input_section_match_index::find_in(const Rule_list& rules,
+				   const char* file_name,
+				   std::vector<char>* file_matches,
+				   const char* section_name,
+				   int best) const
+{
+  for (Rule_list::const_iterator p = rules.begin();
+       p != rules.end() && *p < best;
+       ++p)
+    {
+      const Rule& rule(this->rules_[*p]);
+
+      if (rule.file_index >= 0)
+	{
+	  if (file_name == NULL)
+	    {
+	      if (!rule.element->match_file_name(NULL))
+		continue;
+	    }
+	  else
+	    {
+	      char& match((*file_matches)[rule.file_index]);
+	      if (match == 0)
+		match = rule.element->match_file_name(file_name) ? 2 : 1;
+	      if (match != 2)
+		continue;
+	    }
+	}
+
+      if (rule.is_wildcard && fnmatch(rule.pattern, section_name, 0) != 0)
+	continue;
+
+      return *p;
+    }
+  return best;
+}
+
+const Input_section_match_index::Rule*
+Input_section_match_index::find(const char* file_name,
+				const char* section_name)
+{
+  std::vector<char>* file_matches = NULL;
+  if (file_name != NULL && this->file_index_count_ > 0)
+    file_matches = this->get_file_matches(file_name);
+
+  int best = this->rules_.size();
+
+  Exact::const_iterator pe = this->exact_.find(section_name);
+  if (pe != this->exact_.end())
+    best = this->find_in(pe->second, file_name, file_matches, section_name,
+			 best);
+
+  const char* end = section_name + strlen(section_name);
+  best = this->find_in_trie(prefix_root, section_name, end, false, file_name,
+			    file_matches, section_name, best);
+  best = this->find_in_trie(suffix_root, end, section_name, true, file_name,
+			    file_matches, section_name, best);
+  if (this->has_infix_)
+    {
+      for (const char* p = section_name; p != end; ++p)
+	best = this->find_in_trie(infix_root, p, end, false, file_name,
+				  file_matches, section_name, best);
+    }
+
+  best = this->find_in(this->always_, file_name, file_matches, section_name,
+		       best);
+
+  if (static_cast<size_t>(best) >= this->rules_.size())
+    return NULL;
+  return &this->rules_[best];
+}
 
 bool
-Output_section_element_input::match_name(const char* file_name,
-					 const char* section_name,
-					 bool *keep) const
+Input_section_match_index::keep_unmatched(const char* file_name)
 {
-  if (!this->match_file_name(file_name))
-    return false;
+  char* cached = NULL;
+  if (file_name != NULL)
+    {
+      cached = &this->get_file_matches(file_name)->back();
+      if (*cached != 0)
+	return *cached == 2;
+    }
 
-  *keep = this->keep_;
+  bool keep = false;
+  for (std::vector<const Output_section_element_input*>::const_reverse_iterator
+	 p = this->elements_.rbegin();
+       p != this->elements_.rend();
+       ++p)
+    {
+      if ((*p)->match_file_name(file_name))
+	{
+	  keep = (*p)->keep();
+	  break;
+	}
+    }
+
+  if (cached != NULL)
+    *cached = keep ? 2 : 1;
+  return keep;
+}
 
-  // If there are no section name patterns, then we match.
+// Add our input section patterns to INDEX.
+
+void
+Output_section_element_input::add_match_rules(
+    Input_section_match_index* index,
+    Output_section_definition* osdef) const
+{
+  // If there are no section name patterns, then we match every
+  // section.
   if (this->input_section_patterns_.empty())
-    return true;
+    {
+      index->add(osdef, this, NULL, false);
+      return;
+    }
 
-  // See whether we match the section name patterns.
   for (Input_section_patterns::const_iterator p =
 	 this->input_section_patterns_.begin();
        p != this->input_section_patterns_.end();
        ++p)
-    {
-      if (match(section_name, p->pattern.c_str(), p->pattern_is_wildcard))
-	return true;
-    }
-
-  // We didn't match any section names, so we didn't match.
-  return false;
+    index->add(osdef, this, p->pattern.c_str(), p->pattern_is_wildcard);
 }
 
 // Information we use to sort the input sections.
@@ -1594,6 +1992,11 @@ Output_section_element_input::set_section_addresses(
   // each one which matches to one of the elements of
   // MATCHING_SECTIONS.
 
+  // The sections of an object are usually next to each other, so we
+  // remember whether we matched the file name of the last object.
+  Relobj* last_relobj = NULL;
+  bool last_file_matches = false;
+
   Input_section_list::iterator p = input_sections->begin();
   while (p != input_sections->end())
     {
@@ -1626,7 +2029,13 @@ Output_section_element_input::set_section_addresses(
 	  }
       }
 
-      if (!this->match_file_name(relobj->name().c_str()))
+      if (relobj != last_relobj)
+	{
+	  last_relobj = relobj;
+	  last_file_matches = this->match_file_name(relobj->name().c_str());
+	}
+
+      if (!last_file_matches)
 	++p;
       else if (this->input_section_patterns_.empty())
 	{
@@ -1892,12 +2301,15 @@ class Output_section_definition : public Sections_element
   void
   finalize_symbols(Symbol_table*, const Layout*, uint64_t*);
 
-  // Return the output section name to use for an input file name and
-  // section name.
+  // Add the input section specifications to INDEX.
+  void
+  add_match_rules(Input_section_match_index* index);
+
+  // Return the output section name to use for an input section which
+  // matches one of our input section specifications.
   const char*
-  output_section_name(const char* file_name, const char* section_name,
-		      Output_section***, Script_sections::Section_type*,
-		      bool*);
+  matched_output_section_name(Output_section***,
+			      Script_sections::Section_type*);
 
   // Initialize OSP with an output section.
   void
@@ -2175,33 +2587,28 @@ Output_section_definition::finalize_symbols(Symbol_table* symtab,
     (*p)->finalize_symbols(symtab, layout, dot_value, &dot_section);
 }
 
-// Return the output section name to use for an input section name.
+// Add the input section specifications to INDEX.
 
-const char*
-Output_section_definition::output_section_name(
-    const char* file_name,
-    const char* section_name,
-    Output_section*** slot,
-    Script_sections::Section_type* psection_type,
-    bool* keep)
+void
+Output_section_definition::add_match_rules(Input_section_match_index* index)
 {
-  // Ask each element whether it matches NAME.
   for (Output_section_elements::const_iterator p = this->elements_.begin();
        p != this->elements_.end();
        ++p)
-    {
-      if ((*p)->match_name(file_name, section_name, keep))
-	{
-	  // We found a match for NAME, which means that it should go
-	  // into this output section.
-	  *slot = &this->output_section_;
-	  *psection_type = this->section_type();
-	  return this->name_.c_str();
-	}
-    }
+    (*p)->add_match_rules(index, this);
+}
 
-  // We don't know about this section name.
-  return NULL;
+// Return the output section name to use for an input section which
+// matches one of our input section specifications.
+
+const char*
+Output_section_definition::matched_output_section_name(
+    Output_section*** slot,
+    Script_sections::Section_type* psection_type)
+{
+  *slot = &this->output_section_;
+  *psection_type = this->section_type();
+  return this->name_.c_str();
 }
 
 // Return true if memory from START to START + LENGTH is contained
@@ -3206,7 +3613,8 @@ Script_sections::Script_sections()
     saw_data_segment_align_(false),
     saw_relro_end_(false),
     saw_segment_start_expression_(false),
-    segments_created_(false)
+    segments_created_(false),
+    match_index_(NULL)
 {
 }
 
@@ -3314,6 +3722,10 @@ Script_sections::finish_output_section(
   gold_assert(this->output_section_ != NULL);
   this->output_section_->finish(trailer);
   this->output_section_ = NULL;
+
+  // The output section may have new input section specifications.
+  delete this->match_index_;
+  this->match_index_ = NULL;
 }
 
 // Add a data item to the current output section.
@@ -3430,28 +3842,38 @@ Script_sections::output_section_name(
     Script_sections::Section_type* psection_type,
     bool* keep)
 {
-  for (Sections_elements::const_iterator p = this->sections_elements_->begin();
-       p != this->sections_elements_->end();
-       ++p)
+  if (this->match_index_ == NULL)
     {
-      const char* ret = (*p)->output_section_name(file_name, section_name,
-						  output_section_slot,
-						  psection_type, keep);
+      this->match_index_ = new Input_section_match_index();
+      for (Sections_elements::const_iterator p =
+	     this->sections_elements_->begin();
+	   p != this->sections_elements_->end();
+	   ++p)
+	(*p)->add_match_rules(this->match_index_);
+    }
 
-      if (ret != NULL)
+  const Input_section_match_index::Rule* rule =
+    this->match_index_->find(file_name, section_name);
+  if (rule != NULL)
+    {
+      *keep = rule->element->keep();
+      const char* ret =
+	rule->osdef->matched_output_section_name(output_section_slot,
+						 psection_type);
+
+      // The special name /DISCARD/ means that the input section
+      // should be discarded.
+      if (strcmp(ret, "/DISCARD/") == 0)
 	{
-	  // The special name /DISCARD/ means that the input section
-	  // should be discarded.
-	  if (strcmp(ret, "/DISCARD/") == 0)
-	    {
-	      *output_section_slot = NULL;
-	      *psection_type = Script_sections::ST_NONE;
-	      return NULL;
-	    }
-	  return ret;
+	  *output_section_slot = NULL;
+	  *psection_type = Script_sections::ST_NONE;
+	  return NULL;
 	}
+      return ret;
     }
 
+  *keep = this->match_index_->keep_unmatched(file_name);
+
   // If we couldn't find a mapping for the name, the output section
   // gets the name of the input section.
 
@@ -44,6 +44,7 @@ class Output_section_definition;
 class Output_section;
 class Output_segment;
 class Orphan_section_placement;
+class Input_section_match_index;
 
 class Script_sections
 {
@@ -321,6 +322,9 @@ class Script_sections
   bool saw_segment_start_expression_;
   // Whether we have created all necessary segments.
   bool segments_created_;
+  // The index used to find the output section for an input section,
+  // built when it is first needed.
+  Input_section_match_index* match_index_;
 };
 
 // Attributes for memory regions.
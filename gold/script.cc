@@ -1937,33 +1937,92 @@ struct Version_tree
   const struct Version_dependency_list* dependencies;
 };
 
-// Helper class that calls cplus_demangle when needed and takes care of freeing
-// the result.
+// A cache of demangled symbol names.  A C++ symbol defined in many
+// objects, such as an inline function, is looked up in the version
+// script for each definition, and demangling it costs much more than
+// the lookup.  Symbols may be looked up by several threads at once.
+
+class Demangle_cache
+{
+ public:
+  Demangle_cache(int options)
+    : options_(options), names_(), lock_(NULL)
+  {
+    if (parameters->options_valid() && parameters->options().threads())
+      this->lock_ = new Lock();
+  }
+
+  ~Demangle_cache();
+
+  // Return the demangled name of SYMBOL, or NULL if it can not be
+  // demangled.
+  const char*
+  get(const char* symbol);
+
+ private:
+  // Map from a symbol name to its demangled name.
+  typedef Unordered_map<std::string, char*> Names;
+
+  // Option flags to pass to cplus_demangle.
+  const int options_;
+  // The names we have demangled.
+  Names names_;
+  // Lock for NAMES_, or NULL if we are not using threads.
+  Lock* lock_;
+};
+
+Demangle_cache::~Demangle_cache()
+{
+  for (Names::iterator p = this->names_.begin(); p != this->names_.end(); ++p)
+    free(p->second);
+  delete this->lock_;
+}
+
+const char*
+Demangle_cache::get(const char* symbol)
+{
+  {
+    Hold_optional_lock hl(this->lock_);
+    Names::const_iterator p = this->names_.find(symbol);
+    if (p != this->names_.end())
+      return p->second;
+  }
+
+  // Demangle without holding the lock.  If another thread demangled
+  // the same symbol in the meantime, we use its result.
+  char* demangled = cplus_demangle(symbol, this->options_);
+  Hold_optional_lock hl(this->lock_);
+  std::pair<Names::iterator, bool> ins =
+    this->names_.insert(std::make_pair(std::string(symbol), demangled));
+  if (!ins.second)
+    free(demangled);
+  return ins.first->second;
+}
+
+// Helper class that asks the cache for the demangled name when
+// needed, and remembers it for the rest of the lookup.
 
 class Lazy_demangler
 {
  public:
-  Lazy_demangler(const char* symbol, int options)
-    : symbol_(symbol), options_(options), demangled_(NULL), did_demangle_(false)
+  Lazy_demangler(const char* symbol, Demangle_cache* cache)
+    : symbol_(symbol), cache_(cache), demangled_(NULL), did_demangle_(false)
   { }
 
-  ~Lazy_demangler()
-  { free(this->demangled_); }
-
   // Return the demangled name. The actual demangling happens on the first call,
   // and the result is later cached.
-  inline char*
+  inline const char*
   get();
 
  private:
   // The symbol to demangle.
   const char* symbol_;
-  // Option flags to pass to cplus_demagle.
-  const int options_;
+  // The cache of demangled names for the language.
+  Demangle_cache* cache_;
   // The cached demangled value, or NULL if demangling didn't happen yet or
   // failed.
-  char* demangled_;
-  // Whether we already called cplus_demangle
+  const char* demangled_;
+  // Whether we already asked the cache.
   bool did_demangle_;
 };
 
@@ -1971,17 +2030,178 @@ class Lazy_demangler
 // and the result is later cached. Returns NULL if the symbol cannot be
 // demangled.
 
-inline char*
+inline const char*
 Lazy_demangler::get()
 {
   if (!this->did_demangle_)
     {
-      this->demangled_ = cplus_demangle(this->symbol_, this->options_);
+      this->demangled_ = this->cache_->get(this->symbol_);
       this->did_demangle_ = true;
     }
   return this->demangled_;
 }
 
+// An index of the glob patterns of a version script for one
+// language.  Each pattern is filed in a trie under its literal
+// prefix, the characters before the first wildcard, or in a trie of
+// reversed strings under its literal suffix if that is longer.
+// Looking up a name walks both tries along the name, which finds the
+// few patterns which can match it, and only those are passed to
+// fnmatch.  Patterns with neither a prefix nor a suffix, such as
+// "*foo*", are always tried.  The index is read only once it is
+// built, so several threads may look up names at once.
+
+class Version_glob_index
+{
+ public:
+  Version_glob_index()
+    : edges_(), nodes_(2), always_()
+  { }
+
+  // Add PATTERN, which is glob number INDEX.  The globs must be added
+  // in order.
+  void
+  add(const char* pattern, int index);
+
+  // Return the number of the last glob which matches NAME, if it is
+  // greater than BEST, and otherwise return BEST.
+  int
+  find(const char* name, int best) const;
+
+ private:
+  // A glob pattern.
+  struct Entry
+  {
+    Entry(const char* p, int i)
+      : pattern(p), index(i)
+    { }
+
+    const char* pattern;
+    int index;
+  };
+
+  typedef std::vector<Entry> Entries;
+
+  // The roots of the prefix and suffix tries.
+  static const unsigned int prefix_root = 0;
+  static const unsigned int suffix_root = 1;
+
+  // The key of the edge from NODE for the character C.
+  static uint64_t
+  edge_key(unsigned int node, char c)
+  { return (static_cast<uint64_t>(node) << 8) | static_cast<unsigned char>(c); }
+
+  // Return the child of NODE for C, or 0 if there is none.
+  unsigned int
+  child(unsigned int node, char c) const
+  {
+    Edges::const_iterator p = this->edges_.find(edge_key(node, c));
+    return p == this->edges_.end() ? 0 : p->second;
+  }
+
+  // Return the last glob in ENTRIES which matches NAME, if it is
+  // greater than BEST, and otherwise return BEST.
+  static int
+  find_in(const Entries& entries, const char* name, int best);
+
+  // Map from a node and a character to the child node.
+  typedef Unordered_map<uint64_t, unsigned int> Edges;
+
+  Edges edges_;
+  // The patterns filed under each node, in order.
+  std::vector<Entries> nodes_;
+  // The patterns with neither a prefix nor a suffix, in order.
+  Entries always_;
+};
+
+void
+Version_glob_index::add(const char* pattern, int index)
+{
+  size_t len = strlen(pattern);
+  size_t prefix_len = strcspn(pattern, "*?[");
+
+  // Inside a bracket expression a character is not literal, so we
+  // only use the suffix of a pattern without one.
+  size_t suffix_len = 0;
+  if (strchr(pattern, '[') == NULL)
+    {
+      while (suffix_len < len
+	     && pattern[len - suffix_len - 1] != '*'
+	     && pattern[len - suffix_len - 1] != '?')
+	++suffix_len;
+    }
+
+  Entry entry(pattern, index);
+  if (prefix_len == 0 && suffix_len == 0)
+    {
+      this->always_.push_back(entry);
+      return;
+    }
+
+  bool use_prefix = prefix_len >= suffix_len;
+  unsigned int node;
+  size_t n;
+  if (use_prefix)
+    {
+      node = prefix_root;
+      n = prefix_len;
+    }
+  else
+    {
+      node = suffix_root;
+      n = suffix_len;
+    }
+  for (size_t i = 0; i < n; ++i)
+    {
+      char c = use_prefix ? pattern[i] : pattern[len - i - 1];
+      std::pair<Edges::iterator, bool> ins =
+	this->edges_.insert(std::make_pair(edge_key(node, c), 0U));
+      if (ins.second)
+	{
+	  ins.first->second = this->nodes_.size();
+	  this->nodes_.push_back(Entries());
+	}
+      node = ins.first->second;
+    }
+  this->nodes_[node].push_back(entry);
+}
+
+int
+Version_glob_index::find_in(const Entries& entries, const char* name,
+			    int best)
+{
+  for (Entries::const_reverse_iterator p = entries.rbegin();
+       p != entries.rend() && p->index > best;
+       ++p)
+    if (fnmatch(p->pattern, name, FNM_NOESCAPE) == 0)
+      return p->index;
+  return best;
+}
+
+int
+Version_glob_index::find(const char* name, int best) const
+{
+  unsigned int node = prefix_root;
+  for (const char* p = name; *p != '\0'; ++p)
+    {
+      node = this->child(node, *p);
+      if (node == 0)
+	break;
+      best = find_in(this->nodes_[node], name, best);
+    }
+
+  node = suffix_root;
+  for (const char* p = name + strlen(name); p > name; --p)
+    {
+      node = this->child(node, p[-1]);
+      if (node == 0)
+	break;
+      best = find_in(this->nodes_[node], name, best);
+    }
+
+  return find_in(this->always_, name, best);
+}
+
 // Class Version_script_info.
 
 Version_script_info::Version_script_info()
@@ -1989,11 +2209,20 @@ Version_script_info::Version_script_info()
     default_version_(NULL), default_is_global_(false), is_finalized_(false)
 {
   for (int i = 0; i < LANGUAGE_COUNT; ++i)
-    this->exact_[i] = NULL;
+    {
+      this->exact_[i] = NULL;
+      this->glob_index_[i] = NULL;
+      this->demangle_cache_[i] = NULL;
+    }
 }
 
 Version_script_info::~Version_script_info()
 {
+  for (int i = 0; i < LANGUAGE_COUNT; ++i)
+    {
+      delete this->glob_index_[i];
+      delete this->demangle_cache_[i];
+    }
 }
 
 // Forget all the known version script information.
@@ -2145,6 +2374,23 @@ Version_script_info::build_lookup_tables()
       this->build_expression_list_lookup(v->local, v, false);
       this->build_expression_list_lookup(v->global, v, true);
     }
+
+  for (size_t j = 0; j < this->globs_.size(); ++j)
+    {
+      const Version_expression* exp = this->globs_[j].expression;
+      if (this->glob_index_[exp->language] == NULL)
+	this->glob_index_[exp->language] = new Version_glob_index();
+      this->glob_index_[exp->language]->add(exp->pattern.c_str(), j);
+    }
+
+  if (this->exact_[LANGUAGE_CXX] != NULL
+      || this->glob_index_[LANGUAGE_CXX] != NULL)
+    this->demangle_cache_[LANGUAGE_CXX] =
+      new Demangle_cache(DMGL_ANSI | DMGL_PARAMS);
+  if (this->exact_[LANGUAGE_JAVA] != NULL
+      || this->glob_index_[LANGUAGE_JAVA] != NULL)
+    this->demangle_cache_[LANGUAGE_JAVA] =
+      new Demangle_cache(DMGL_ANSI | DMGL_PARAMS | DMGL_JAVA);
 }
 
 // If a pattern has backlashes but no unquoted wildcard characters,
@@ -2306,9 +2552,10 @@ Version_script_info::get_symbol_version(const char* symbol_name,
 					std::string* pversion,
 					bool* p_is_global) const
 {
-  Lazy_demangler cpp_demangled_name(symbol_name, DMGL_ANSI | DMGL_PARAMS);
+  Lazy_demangler cpp_demangled_name(symbol_name,
+				    this->demangle_cache_[LANGUAGE_CXX]);
   Lazy_demangler java_demangled_name(symbol_name,
-				     DMGL_ANSI | DMGL_PARAMS | DMGL_JAVA);
+				     this->demangle_cache_[LANGUAGE_JAVA]);
 
   gold_assert(this->is_finalized_);
   for (int i = 0; i < LANGUAGE_COUNT; ++i)
@@ -2356,29 +2603,32 @@ Version_script_info::get_symbol_version(const char* symbol_name,
 	}
     }
 
-  // Look through the glob patterns in reverse order.
+  // Find the last glob pattern which matches.
 
-  for (Globs::const_reverse_iterator p = this->globs_.rbegin();
-       p != this->globs_.rend();
-       ++p)
+  int best = -1;
+  for (int i = 0; i < LANGUAGE_COUNT; ++i)
     {
-      int language = p->expression->language;
-      const char* name_to_match = this->get_name_to_match(symbol_name,
-							  language,
+      const Version_glob_index* glob_index = this->glob_index_[i];
+      if (glob_index == NULL)
+	continue;
+
+      const char* name_to_match = this->get_name_to_match(symbol_name, i,
 							  &cpp_demangled_name,
 							  &java_demangled_name);
       if (name_to_match == NULL)
 	continue;
 
-      if (fnmatch(p->expression->pattern.c_str(), name_to_match,
-		  FNM_NOESCAPE) == 0)
-	{
-	  if (pversion != NULL)
-	    *pversion = p->version->tag;
-	  if (p_is_global != NULL)
-	    *p_is_global = p->is_global;
-	  return true;
-	}
+      best = glob_index->find(name_to_match, best);
+    }
+
+  if (best >= 0)
+    {
+      const Glob& glob(this->globs_[best]);
+      if (pversion != NULL)
+	*pversion = glob.version->tag;
+      if (p_is_global != NULL)
+	*p_is_global = glob.is_global;
+      return true;
     }
 
   // Finally, there may be a wildcard.
@@ -58,6 +58,8 @@ struct Version_expression_list;
 struct Version_tree;
 struct Version_expression;
 class Lazy_demangler;
+class Demangle_cache;
+class Version_glob_index;
 class Incremental_script_entry;
 
 // This class represents an expression in a linker script.
@@ -312,6 +314,10 @@ class Version_script_info
   Exact* exact_[LANGUAGE_COUNT];
   // A vector of glob patterns mapping to Version_trees.
   Globs globs_;
+  // Indexes of the glob patterns in GLOBS_, by language.
+  Version_glob_index* glob_index_[LANGUAGE_COUNT];
+  // Cached demangled names of symbols, by language.
+  Demangle_cache* demangle_cache_[LANGUAGE_COUNT];
   // The default version to use, if there is one.  This is from a
   // pattern of "*".
   const Version_tree* default_version_;
@@ -227,7 +227,21 @@ class Stringpool_template
   // Add string S of length LEN characters to the pool.  If COPY is
   // true, S need not be null terminated.
   const Stringpool_char*
-  add_with_length(const Stringpool_char* s, size_t len, bool copy, Key* pkey);
+  add_with_length(const Stringpool_char* s, size_t len, bool copy, Key* pkey)
+  { return this->add_with_hash(s, len, string_hash(s, len), copy, pkey); }
+
+  // Add string S of length LEN characters to the pool, where
+  // HASH_CODE is the value string_hash returns for S.  This lets a
+  // caller compute the hash codes ahead of time, perhaps in another
+  // thread.
+  const Stringpool_char*
+  add_with_hash(const Stringpool_char* s, size_t len, size_t hash_code,
+		bool copy, Key* pkey);
+
+  // Compute a hash code for a string.  LENGTH is the length of the
+  // string in characters.
+  static size_t
+  string_hash(const Stringpool_char*, size_t length);
 
   // If the string S is present in the pool, return the canonical
   // string pointer.  Otherwise, return NULL.  If PKEY is not NULL,
@@ -297,11 +311,6 @@ class Stringpool_template
   static bool
   string_equal(const Stringpool_char*, const Stringpool_char*);
 
-  // Compute a hash code for a string.  LENGTH is the length of the
-  // string in characters.
-  static size_t
-  string_hash(const Stringpool_char*, size_t length);
-
   // We store the actual data in a list of these buffers.
   struct Stringdata
   {
@@ -353,6 +362,10 @@ class Stringpool_template
     Hashkey(const Stringpool_char* s, size_t len)
       : string(s), length(len), hash_code(string_hash(s, len))
     { }
+
+    Hashkey(const Stringpool_char* s, size_t len, size_t hash)
+      : string(s), length(len), hash_code(hash)
+    { }
   };
 
   // Hash function.  This is trivial, since we have already computed
@@ -31,12 +31,14 @@
 #include "demangle.h"
 
 #include "gc.h"
+#include "icf.h"
 #include "object.h"
 #include "dwarf_reader.h"
 #include "dynobj.h"
 #include "output.h"
 #include "target.h"
 #include "workqueue.h"
+#include "gold-threads.h"
 #include "symtab.h"
 #include "script.h"
 #include "plugin.h"
@@ -558,20 +560,179 @@ Symbol::set_undefined()
   this->is_predefined_ = false;
 }
 
+// Class Symbol_table::Symbol_table_type.
+
+Symbol_table::Symbol_table_type::Symbol_table_type(unsigned int count,
+						   bool compact)
+  : compact_(compact), map_(compact ? 1 : count),
+    keys_(compact ? compact_slot_count(0) : 0),
+    symbols_(compact ? compact_slot_count(0) : 0), count_(0)
+{
+}
+
+// Return the number of buckets.
+
+size_t
+Symbol_table::Symbol_table_type::bucket_count() const
+{
+  if (this->compact_)
+    return this->keys_.size();
+#if defined(HAVE_TR1_UNORDERED_MAP) || defined(HAVE_EXT_HASH_MAP)
+  return this->map_.bucket_count();
+#else
+  return 0;
+#endif
+}
+
+// Remove the entry P.
+
+void
+Symbol_table::Symbol_table_type::erase(iterator p)
+{
+  if (this->compact_)
+    this->erase_slot(p.slot_);
+  else
+    this->map_.erase(p.p_);
+}
+
+// Remove the entry for KEY, if there is one.
+
+void
+Symbol_table::Symbol_table_type::erase(const Symbol_table_key& key)
+{
+  if (!this->compact_)
+    {
+      this->map_.erase(key);
+      return;
+    }
+  size_t slot = this->find_slot(this->compact_key(key));
+  if (this->keys_[slot].first != 0)
+    this->erase_slot(slot);
+}
+
+// Remove the entry in SLOT of the compact table.  Rather than leave a
+// marker behind, we move any later entry of the same probe sequence
+// which may use the slot back into it.
+
+void
+Symbol_table::Symbol_table_type::erase_slot(size_t slot)
+{
+  size_t mask = this->keys_.size() - 1;
+  size_t next = slot;
+  while (true)
+    {
+      next = (next + 1) & mask;
+      if (this->keys_[next].first == 0)
+	break;
+      size_t home = this->hash(this->keys_[next]) & mask;
+      if (((next - home) & mask) >= ((next - slot) & mask))
+	{
+	  this->keys_[slot] = this->keys_[next];
+	  this->symbols_[slot] = this->symbols_[next];
+	  slot = next;
+	}
+    }
+  this->keys_[slot] = Compact_key(0, 0);
+  this->symbols_[slot] = NULL;
+  --this->count_;
+}
+
+// Double the number of slots of the compact table.
+
+void
+Symbol_table::Symbol_table_type::grow()
+{
+  std::vector<Compact_key> keys(this->keys_.size() * 2);
+  std::vector<Symbol*> symbols(keys.size());
+  this->keys_.swap(keys);
+  this->symbols_.swap(symbols);
+  for (size_t i = 0; i < keys.size(); ++i)
+    {
+      if (keys[i].first != 0)
+	{
+	  size_t slot = this->find_slot(keys[i]);
+	  this->keys_[slot] = keys[i];
+	  this->symbols_[slot] = symbols[i];
+	}
+    }
+}
+
+// Return the number of slots a compact table would have for COUNT
+// entries.
+
+size_t
+Symbol_table::Symbol_table_type::compact_slot_count(size_t count)
+{
+  size_t slots = initial_compact_slots;
+  while (count * 4 > slots * 3)
+    slots *= 2;
+  return slots;
+}
+
+// Class Symbol_table::Symbol_arena.
+
+Symbol_table::Symbol_arena::~Symbol_arena()
+{
+  for (size_t i = 0; i < this->chunks_.size(); ++i)
+    delete[] this->chunks_[i];
+}
+
 // Class Symbol_table.
 
 Symbol_table::Symbol_table(unsigned int count,
                            const Version_script_info& version_script)
-  : saw_undefined_(0), offset_(0), table_(count), namepool_(),
-    forwarders_(), commons_(), tls_commons_(), small_commons_(),
-    large_commons_(), forced_locals_(), warnings_(),
-    version_script_(version_script), gc_(NULL), icf_(NULL)
+  : offset_(0), count_(count),
+    compact_(parameters->options_valid()
+	     && parameters->options().compact_symbols()),
+    shards_(), shard_workqueue_(NULL),
+    shard_blockers_(), shard_tasks_blocker_(NULL), shard_task_count_(0),
+    weak_alias_lock_(NULL),
+    warnings_(), odr_lines_(), odr_objects_(), odr_candidates_(),
+    odr_lines_blocker_(NULL), version_script_(version_script), gc_(NULL),
+    icf_(NULL)
 {
-  namepool_.reserve(count);
+  this->shards_.push_back(new Symbol_table_shard(count, this->compact_));
 }
 
 Symbol_table::~Symbol_table()
 {
+  for (size_t i = 0; i < this->shards_.size(); ++i)
+    delete this->shards_[i];
+  for (size_t i = 0; i < this->shard_blockers_.size(); ++i)
+    delete this->shard_blockers_[i];
+  delete this->shard_tasks_blocker_;
+  delete this->weak_alias_lock_;
+  delete this->odr_lines_blocker_;
+}
+
+// Split the symbol table into COUNT shards.
+
+void
+Symbol_table::set_shard_count(unsigned int count)
+{
+  gold_assert(this->shards_.size() == 1
+	      && this->shards_[0]->table.empty()
+	      && count > 1);
+  delete this->shards_[0];
+  this->shards_.clear();
+  for (unsigned int i = 0; i < count; ++i)
+    this->shards_.push_back(new Symbol_table_shard(this->count_ / count,
+						   this->compact_));
+  this->shard_blockers_.resize(count, NULL);
+  this->shard_tasks_blocker_ = new Task_token(true);
+  this->weak_alias_lock_ = new Lock();
+}
+
+// Return a blocker to wait for if there are symbols still being
+// added in the background.
+
+Task_token*
+Symbol_table::shard_tasks_blocker() const
+{
+  if (this->shard_tasks_blocker_ != NULL
+      && this->shard_tasks_blocker_->is_blocked())
+    return this->shard_tasks_blocker_;
+  return NULL;
 }
 
 // The symbol table key equality function.  This is called with
@@ -597,6 +758,21 @@ Symbol_table::is_section_folded(Relobj* obj, unsigned int shndx) const
 void 
 Symbol_table::gc_mark_undef_symbols(Layout* layout)
 {
+  // Symbols seen while adding symbols to a sharded symbol table.
+  for (size_t i = 0; i < this->shards_.size(); ++i)
+    {
+      std::vector<Gc_symbol>& gc_symbols(this->shards_[i]->gc_symbols);
+      for (std::vector<Gc_symbol>::const_iterator p = gc_symbols.begin();
+	   p != gc_symbols.end();
+	   ++p)
+	{
+	  if (p->second.first != NULL)
+	    this->gc_->worklist().push_back(p->second);
+	  parameters->target().gc_mark_symbol(this, p->first);
+	}
+      std::vector<Gc_symbol>().swap(gc_symbols);
+    }
+
   for (options::String_set::const_iterator p =
 	 parameters->options().undefined_begin();
        p != parameters->options().undefined_end();
@@ -659,6 +835,29 @@ Symbol_table::gc_mark_symbol(Symbol* sym)
   parameters->target().gc_mark_symbol(this, sym);
 }
 
+// Keep SYM when garbage collecting.  If the symbol table is sharded,
+// symbols may be being added in the background while Object::layout
+// updates the worklist, so just remember SYM in its SHARD until
+// gc_mark_undef_symbols.  We record the section now, since the symbol
+// may be overridden before then.
+
+void
+Symbol_table::gc_mark_symbol(Symbol_table_shard* shard, Symbol* sym)
+{
+  if (!this->is_sharded())
+    {
+      this->gc_mark_symbol(sym);
+      return;
+    }
+
+  bool is_ordinary;
+  unsigned int shndx = sym->shndx(&is_ordinary);
+  Relobj* relobj = NULL;
+  if (is_ordinary && shndx != elfcpp::SHN_UNDEF && !sym->object()->is_dynamic())
+    relobj = static_cast<Relobj*>(sym->object());
+  shard->gc_symbols.push_back(Gc_symbol(sym, Section_id(relobj, shndx)));
+}
+
 // When doing garbage collection, keep symbols that have been seen in
 // dynamic objects.
 inline void 
@@ -666,7 +865,7 @@ Symbol_table::gc_mark_dyn_syms(Symbol* sym)
 {
   if (sym->in_dyn() && sym->source() == Symbol::FROM_OBJECT
       && !sym->object()->is_dynamic())
-    this->gc_mark_symbol(sym);
+    this->gc_mark_symbol(this->shard(sym), sym);
 }
 
 // Make TO a symbol which forwards to FROM.
@@ -676,7 +875,7 @@ Symbol_table::make_forwarder(Symbol* from, Symbol* to)
 {
   gold_assert(from != to);
   gold_assert(!from->is_forwarder() && !to->is_forwarder());
-  this->forwarders_[from] = to;
+  this->shard(from)->forwarders[from] = to;
   from->set_forwarder();
 }
 
@@ -686,9 +885,11 @@ Symbol*
 Symbol_table::resolve_forwards(const Symbol* from) const
 {
   gold_assert(from->is_forwarder());
+  const Unordered_map<const Symbol*, Symbol*>& forwarders =
+    this->shard(from)->forwarders;
   Unordered_map<const Symbol*, Symbol*>::const_iterator p =
-    this->forwarders_.find(from);
-  gold_assert(p != this->forwarders_.end());
+    forwarders.find(from);
+  gold_assert(p != forwarders.end());
   return p->second;
 }
 
@@ -697,24 +898,26 @@ Symbol_table::resolve_forwards(const Symbol* from) const
 Symbol*
 Symbol_table::lookup(const char* name, const char* version) const
 {
+  const Symbol_table_shard* shard = this->shard(name, strlen(name));
+
   Stringpool::Key name_key;
-  name = this->namepool_.find(name, &name_key);
+  name = shard->namepool.find(name, &name_key);
   if (name == NULL)
     return NULL;
 
   Stringpool::Key version_key = 0;
   if (version != NULL)
     {
-      version = this->namepool_.find(version, &version_key);
+      version = shard->namepool.find(version, &version_key);
       if (version == NULL)
 	return NULL;
     }
 
   Symbol_table_key key(name_key, version_key);
-  Symbol_table::Symbol_table_type::const_iterator p = this->table_.find(key);
-  if (p == this->table_.end())
+  Symbol_table::Symbol_table_type::const_iterator p = shard->table.find(key);
+  if (p == shard->table.end())
     return NULL;
-  return p->second;
+  return *p;
 }
 
 // Resolve a Symbol with another Symbol.  This is only used in the
@@ -750,7 +953,7 @@ Symbol_table::resolve(Sized_symbol<size>* to, const Sized_symbol<size>* from)
 // by visibility.
 
 void
-Symbol_table::force_local(Symbol* sym)
+Symbol_table::force_local(Symbol_table_shard* shard, Symbol* sym)
 {
   if (!sym->is_defined() && !sym->is_common())
     return;
@@ -760,15 +963,16 @@ Symbol_table::force_local(Symbol* sym)
       return;
     }
   sym->set_is_forced_local();
-  this->forced_locals_.push_back(sym);
+  shard->forced_locals.push_back(sym);
 }
 
-// Adjust NAME for wrapping, and update *NAME_KEY if necessary.  This
-// is only called for undefined symbols, when at least one --wrap
-// option was used.
+// Adjust NAME for wrapping, and update *NAME_KEY and *PSHARD if
+// necessary.  This is only called for undefined symbols, when at
+// least one --wrap option was used.
 
 const char*
-Symbol_table::wrap_symbol(const char* name, Stringpool::Key* name_key)
+Symbol_table::wrap_symbol(const char* name, Stringpool::Key* name_key,
+			  Symbol_table_shard** pshard)
 {
   // For some targets, we need to ignore a specific character when
   // wrapping, and add it back later.
@@ -788,10 +992,11 @@ Symbol_table::wrap_symbol(const char* name, Stringpool::Key* name_key)
       s += "__wrap_";
       s += name;
 
-      // This will give us both the old and new name in NAMEPOOL_, but
-      // that is OK.  Only the versions we need will wind up in the
-      // real string table in the output file.
-      return this->namepool_.add(s.c_str(), true, name_key);
+      // This will give us both the old and new name in the name
+      // pool, but that is OK.  Only the versions we need will wind
+      // up in the real string table in the output file.
+      *pshard = this->shard(s.c_str(), s.length());
+      return (*pshard)->namepool.add(s.c_str(), true, name_key);
     }
 
   const char* const real_prefix = "__real_";
@@ -804,7 +1009,8 @@ Symbol_table::wrap_symbol(const char* name, Stringpool::Key* name_key)
       if (prefix != '\0')
 	s += prefix;
       s += name + real_prefix_length;
-      return this->namepool_.add(s.c_str(), true, name_key);
+      *pshard = this->shard(s.c_str(), s.length());
+      return (*pshard)->namepool.add(s.c_str(), true, name_key);
     }
 
   return name;
@@ -827,10 +1033,10 @@ Symbol_table::define_default_version(Sized_symbol<size>* sym,
       // This is the first time we have seen NAME/NULL.  Make
       // NAME/NULL point to NAME/VERSION, and mark SYM as the default
       // version.
-      pdef->second = sym;
+      *pdef = sym;
       sym->set_is_default();
     }
-  else if (pdef->second == sym)
+  else if (*pdef == sym)
     {
       // NAME/NULL already points to NAME/VERSION.  Don't mark the
       // symbol as the default if it is not already the default.
@@ -866,26 +1072,59 @@ Symbol_table::define_default_version(Sized_symbol<size>* sym,
       // Otherwise, we just resolve the symbols as though they were
       // the same.
 
-      if (pdef->second->version() != NULL)
-	gold_assert(pdef->second->version() != sym->version());
+      if ((*pdef)->version() != NULL)
+	gold_assert((*pdef)->version() != sym->version());
       else if (sym->visibility() != elfcpp::STV_DEFAULT
-	       && pdef->second->is_from_dynobj())
+	       && (*pdef)->is_from_dynobj())
 	;
-      else if (pdef->second->visibility() != elfcpp::STV_DEFAULT
+      else if ((*pdef)->visibility() != elfcpp::STV_DEFAULT
 	       && sym->is_from_dynobj())
 	;
       else
 	{
 	  const Sized_symbol<size>* symdef;
-	  symdef = this->get_sized_symbol<size>(pdef->second);
+	  symdef = this->get_sized_symbol<size>(*pdef);
 	  Symbol_table::resolve<size, big_endian>(sym, symdef);
-	  this->make_forwarder(pdef->second, sym);
-	  pdef->second = sym;
+	  this->make_forwarder(*pdef, sym);
+	  *pdef = sym;
 	  sym->set_is_default();
 	}
     }
 }
 
+// Return a new symbol to add to SHARD.  This returns NULL if the
+// target makes its own symbols and does not want this one.
+
+template<int size, bool big_endian>
+Sized_symbol<size>*
+Symbol_table::new_symbol(Symbol_table_shard* shard)
+{
+  Sized_target<size, big_endian>* target =
+    parameters->sized_target<size, big_endian>();
+  Sized_symbol<size>* sym;
+  if (target->has_make_symbol())
+    sym = target->make_symbol();
+  else if (this->compact_)
+    sym = shard->arena.allocate<size>();
+  else
+    sym = new Sized_symbol<size>();
+  if (sym != NULL)
+    ++shard->symbol_count;
+  return sym;
+}
+
+// Free SYM, which was returned by new_symbol but not added to the
+// symbol table.  A symbol allocated from a shard arena is freed with
+// the arena.
+
+template<int size>
+void
+Symbol_table::free_symbol(Sized_symbol<size>* sym)
+{
+  if (!this->uses_symbol_arena())
+    delete sym;
+}
+
 // Add one symbol from OBJECT to the symbol table.  NAME is symbol
 // name and VERSION is the version; both are canonicalized.  DEF is
 // whether this is the default version.  ST_SHNDX is the symbol's
@@ -907,7 +1146,7 @@ Symbol_table::define_default_version(Sized_symbol<size>* sym,
 // independent entries in the symbol table.  We can't simply change
 // the symbol table entry, because we have pointers to the entries
 // attached to the object files.  So we mark the entry attached to the
-// object file as a forwarder, and record it in the forwarders_ map.
+// object file as a forwarder, and record it in the forwarders map.
 // Note that entries in the hash table will never be marked as
 // forwarders.
 //
@@ -918,7 +1157,8 @@ Symbol_table::define_default_version(Sized_symbol<size>* sym,
 
 template<int size, bool big_endian>
 Sized_symbol<size>*
-Symbol_table::add_from_object(Object* object,
+Symbol_table::add_from_object(Symbol_table_shard* shard,
+			      Object* object,
 			      const char* name,
 			      Stringpool::Key name_key,
 			      const char* version,
@@ -943,7 +1183,7 @@ Symbol_table::add_from_object(Object* object,
   if (orig_st_shndx == elfcpp::SHN_UNDEF
       && parameters->options().any_wrap())
     {
-      const char* wrap_name = this->wrap_symbol(name, &name_key);
+      const char* wrap_name = this->wrap_symbol(name, &name_key, &shard);
       if (wrap_name != name)
 	{
 	  // If we see a reference to malloc with version GLIBC_2.0,
@@ -957,24 +1197,28 @@ Symbol_table::add_from_object(Object* object,
 	}
     }
 
+  Symbol_table_type& table(shard->table);
+  // Make sure that adding NAME/NULL does not move NAME/VERSION.
+  if (is_default_version)
+    table.reserve(table.size() + 2);
+
   Symbol* const snull = NULL;
   std::pair<typename Symbol_table_type::iterator, bool> ins =
-    this->table_.insert(std::make_pair(std::make_pair(name_key, version_key),
-				       snull));
+    table.insert(std::make_pair(std::make_pair(name_key, version_key),
+				snull));
 
   std::pair<typename Symbol_table_type::iterator, bool> insdefault =
-    std::make_pair(this->table_.end(), false);
+    std::make_pair(table.end(), false);
   if (is_default_version)
     {
       const Stringpool::Key vnull_key = 0;
-      insdefault = this->table_.insert(std::make_pair(std::make_pair(name_key,
-								     vnull_key),
-						      snull));
+      insdefault = table.insert(std::make_pair(std::make_pair(name_key,
+							      vnull_key),
+					       snull));
     }
 
-  // ins.first: an iterator, which is a pointer to a pair.
-  // ins.first->first: the key (a pair of name and version).
-  // ins.first->second: the value (Symbol*).
+  // ins.first: an iterator for the entry.
+  // *ins.first: the value (Symbol*).
   // ins.second: true if new entry was inserted, false if not.
 
   Sized_symbol<size>* ret;
@@ -983,13 +1227,16 @@ Symbol_table::add_from_object(Object* object,
   if (!ins.second)
     {
       // We already have an entry for NAME/VERSION.
-      ret = this->get_sized_symbol<size>(ins.first->second);
+      ret = this->get_sized_symbol<size>(*ins.first);
       gold_assert(ret != NULL);
 
       was_undefined = ret->is_undefined();
       // Commons from plugins are just placeholders.
       was_common = ret->is_common() && ret->object()->pluginobj() == NULL;
 
+      // Weak aliases may be in other shards.
+      Hold_optional_lock hl(ret->has_alias() ? this->weak_alias_lock_ : NULL);
+
       this->resolve(ret, sym, st_shndx, is_ordinary, orig_st_shndx, object,
 		    version);
       if (parameters->options().gc_sections())
@@ -1002,62 +1249,57 @@ Symbol_table::add_from_object(Object* object,
   else
     {
       // This is the first time we have seen NAME/VERSION.
-      gold_assert(ins.first->second == NULL);
+      gold_assert(*ins.first == NULL);
 
       if (is_default_version && !insdefault.second)
 	{
 	  // We already have an entry for NAME/NULL.  If we override
 	  // it, then change it to NAME/VERSION.
-	  ret = this->get_sized_symbol<size>(insdefault.first->second);
+	  ret = this->get_sized_symbol<size>(*insdefault.first);
 
 	  was_undefined = ret->is_undefined();
 	  // Commons from plugins are just placeholders.
 	  was_common = ret->is_common() && ret->object()->pluginobj() == NULL;
 
+	  Hold_optional_lock hl(ret->has_alias()
+				? this->weak_alias_lock_
+				: NULL);
 	  this->resolve(ret, sym, st_shndx, is_ordinary, orig_st_shndx, object,
 			version);
           if (parameters->options().gc_sections())
             this->gc_mark_dyn_syms(ret);
-	  ins.first->second = ret;
+	  *ins.first = ret;
 	}
       else
 	{
 	  was_undefined = false;
 	  was_common = false;
 
-	  Sized_target<size, big_endian>* target =
-	    parameters->sized_target<size, big_endian>();
-	  if (!target->has_make_symbol())
-	    ret = new Sized_symbol<size>();
-	  else
+	  ret = this->new_symbol<size, big_endian>(shard);
+	  if (ret == NULL)
 	    {
-	      ret = target->make_symbol();
-	      if (ret == NULL)
+	      // This means that we don't want a symbol table entry
+	      // after all.
+	      if (!is_default_version)
+		table.erase(ins.first);
+	      else
 		{
-		  // This means that we don't want a symbol table
-		  // entry after all.
-		  if (!is_default_version)
-		    this->table_.erase(ins.first);
-		  else
-		    {
-		      this->table_.erase(insdefault.first);
-		      // Inserting INSDEFAULT invalidated INS.
-		      this->table_.erase(std::make_pair(name_key,
-							version_key));
-		    }
-		  return NULL;
+		  table.erase(insdefault.first);
+		  // Inserting INSDEFAULT invalidated INS.
+		  table.erase(std::make_pair(name_key, version_key));
 		}
+	      return NULL;
 	    }
 
 	  ret->init_object(name, version, object, sym, st_shndx, is_ordinary);
 
-	  ins.first->second = ret;
+	  *ins.first = ret;
 	  if (is_default_version)
 	    {
 	      // This is the first time we have seen NAME/NULL.  Point
 	      // it at the new entry for NAME/VERSION.
 	      gold_assert(insdefault.second);
-	      insdefault.first->second = ret;
+	      *insdefault.first = ret;
 	    }
 	}
 
@@ -1069,7 +1311,7 @@ Symbol_table::add_from_object(Object* object,
   // archive groups.
   if (!was_undefined && ret->is_undefined())
     {
-      ++this->saw_undefined_;
+      ++shard->saw_undefined;
       if (parameters->options().has_plugins())
 	parameters->options().plugins()->new_undefined_symbol(ret);
     }
@@ -1081,15 +1323,15 @@ Symbol_table::add_from_object(Object* object,
   if (!was_common && ret->is_common() && ret->object()->pluginobj() == NULL)
     {
       if (ret->type() == elfcpp::STT_TLS)
-	this->tls_commons_.push_back(ret);
+	shard->tls_commons.push_back(ret);
       else if (!is_ordinary
 	       && st_shndx == parameters->target().small_common_shndx())
-	this->small_commons_.push_back(ret);
+	shard->small_commons.push_back(ret);
       else if (!is_ordinary
 	       && st_shndx == parameters->target().large_common_shndx())
-	this->large_commons_.push_back(ret);
+	shard->large_commons.push_back(ret);
       else
-	this->commons_.push_back(ret);
+	shard->commons.push_back(ret);
     }
 
   // If we're not doing a relocatable link, then any symbol with
@@ -1100,12 +1342,139 @@ Symbol_table::add_from_object(Object* object,
 	  || ret->binding() == elfcpp::STB_GNU_UNIQUE
 	  || ret->binding() == elfcpp::STB_WEAK)
       && !parameters->options().relocatable())
-    this->force_local(ret);
+    this->force_local(shard, ret);
 
   return ret;
 }
 
-// Add all the symbols in a relocatable object to the hash table.
+// The external symbols of a relocatable object which hash to one
+// shard of the symbol table, waiting to be added to that shard in the
+// background.  The symbols and their names are copied, since the
+// views of the object are released as soon as Add_symbols is done
+// with it.
+
+template<int size, bool big_endian>
+struct Pending_shard_symbols
+{
+  // What we have already worked out about a symbol while the object
+  // was locked.
+  struct Entry
+  {
+    // The index of the symbol in SYMPOINTERS.
+    unsigned int index;
+    // The section index, after adjusting for discarded sections.
+    unsigned int st_shndx;
+    // The section index before adjusting for discarded sections.
+    unsigned int orig_st_shndx;
+    // Whether ST_SHNDX is an ordinary section index.
+    bool is_ordinary;
+    // Whether the symbol is defined in a discarded section.
+    bool is_defined_in_discarded_section;
+    // The offset of the symbol name in NAMES.
+    size_t name_offset;
+  };
+
+  Pending_shard_symbols(
+      Sized_relobj_file<size, big_endian>* a_relobj,
+      typename Sized_relobj_file<size, big_endian>::Symbols* a_sympointers,
+      unsigned int a_shard)
+    : relobj(a_relobj), sympointers(a_sympointers), shard(a_shard),
+      entries(), syms(), names()
+  { }
+
+  // Add the symbol P, named NAME of length LEN.
+  void
+  add(const Entry& entry, const unsigned char* p, const char* name,
+      size_t len)
+  {
+    const int sym_size = elfcpp::Elf_sizes<size>::sym_size;
+    this->entries.push_back(entry);
+    this->entries.back().name_offset = this->names.size();
+    this->syms.insert(this->syms.end(), p, p + sym_size);
+    this->names.append(name, len + 1);
+  }
+
+  // The object.
+  Sized_relobj_file<size, big_endian>* relobj;
+  // Where to store the symbols we add.
+  typename Sized_relobj_file<size, big_endian>::Symbols* sympointers;
+  // The shard of the symbol table.
+  unsigned int shard;
+  // The symbols to add.
+  std::vector<Entry> entries;
+  // The ELF symbols, in the same order as ENTRIES.
+  std::vector<unsigned char> syms;
+  // The null terminated symbol names.
+  std::string names;
+};
+
+// A task to add the symbols of a relocatable object to one shard of
+// the symbol table.  The tasks for a shard are chained with blockers,
+// so that the symbols in each shard are resolved in the same order as
+// they would be if they were added one object at a time.
+
+template<int size, bool big_endian>
+class Add_shard_symbols : public Task
+{
+ public:
+  Add_shard_symbols(Symbol_table* symtab,
+		    Pending_shard_symbols<size, big_endian>* pending,
+		    Task_token* this_blocker, Task_token* next_blocker,
+		    Task_token* shard_tasks_blocker)
+    : symtab_(symtab), pending_(pending), this_blocker_(this_blocker),
+      next_blocker_(next_blocker), shard_tasks_blocker_(shard_tasks_blocker)
+  { }
+
+  ~Add_shard_symbols()
+  {
+    if (this->this_blocker_ != NULL)
+      delete this->this_blocker_;
+    // next_blocker_ is deleted by the task for the next object in
+    // the same shard, or by the symbol table.
+    delete this->pending_;
+  }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->this_blocker_ != NULL && this->this_blocker_->is_blocked())
+      return this->this_blocker_;
+    return NULL;
+  }
+
+  void
+  locks(Task_locker* tl)
+  {
+    tl->add(this, this->next_blocker_);
+    tl->add(this, this->shard_tasks_blocker_);
+  }
+
+  void
+  run(Workqueue*)
+  { this->symtab_->add_pending_symbols(this->pending_); }
+
+  std::string
+  get_name() const
+  {
+    char buf[32];
+    snprintf(buf, sizeof buf, " shard %u", this->pending_->shard);
+    return "Add_shard_symbols " + this->pending_->relobj->name() + buf;
+  }
+
+ private:
+  Symbol_table* symtab_;
+  Pending_shard_symbols<size, big_endian>* pending_;
+  Task_token* this_blocker_;
+  Task_token* next_blocker_;
+  Task_token* shard_tasks_blocker_;
+};
+
+// Add all the symbols in a relocatable object to the hash table.  If
+// we have a workqueue for a sharded symbol table, we only do the
+// work which needs the object here, and queue a task for each shard
+// to add the symbols in the background.
 
 template<int size, bool big_endian>
 void
@@ -1125,7 +1494,17 @@ Symbol_table::add_from_relobj(
 
   const int sym_size = elfcpp::Elf_sizes<size>::sym_size;
 
-  const bool just_symbols = relobj->just_symbols();
+  // Symbols of an object linked with --just-symbols are converted
+  // using section addresses read from the object.
+  std::vector<Pending_shard_symbols<size, big_endian>*> pending;
+  if (this->shard_workqueue_ != NULL && !relobj->just_symbols())
+    {
+      pending.resize(this->shards_.size());
+      for (unsigned int i = 0; i < pending.size(); ++i)
+	pending[i] = new Pending_shard_symbols<size, big_endian>(relobj,
+								 sympointers,
+								 i);
+    }
 
   const unsigned char* p = syms;
   for (size_t i = 0; i < count; ++i, p += sym_size)
@@ -1144,10 +1523,6 @@ Symbol_table::add_from_relobj(
 
       const char* name = sym_names + st_name;
 
-      if (strcmp (name, "__gnu_lto_slim") == 0)
-        gold_info(_("%s: plugin needed to handle lto object"),
-		  relobj->name().c_str());
-
       bool is_ordinary;
       unsigned int st_shndx = relobj->adjust_sym_shndx(i + symndx_offset,
 						       sym.get_st_shndx(),
@@ -1171,142 +1546,232 @@ Symbol_table::add_from_relobj(
 	  is_defined_in_discarded_section = true;
 	}
 
-      // In an object file, an '@' in the name separates the symbol
-      // name from the version name.  If there are two '@' characters,
-      // this is the default version.
-      const char* ver = strchr(name, '@');
-      Stringpool::Key ver_key = 0;
-      int namelen = 0;
-      // IS_DEFAULT_VERSION: is the version default?
-      // IS_FORCED_LOCAL: is the symbol forced local?
-      bool is_default_version = false;
-      bool is_forced_local = false;
-
-      // FIXME: For incremental links, we don't store version information,
-      // so we need to ignore version symbols for now.
-      if (parameters->incremental_update() && ver != NULL)
+      if (!pending.empty())
 	{
-	  namelen = ver - name;
-	  ver = NULL;
+	  size_t len = strlen(name);
+	  const char* ver = static_cast<const char*>(memchr(name, '@', len));
+	  size_t namelen = ver == NULL ? len : ver - name;
+	  typename Pending_shard_symbols<size, big_endian>::Entry entry;
+	  entry.index = i;
+	  entry.st_shndx = st_shndx;
+	  entry.orig_st_shndx = orig_st_shndx;
+	  entry.is_ordinary = is_ordinary;
+	  entry.is_defined_in_discarded_section =
+	    is_defined_in_discarded_section;
+	  pending[this->shard_index(name, namelen)]->add(entry, p, name, len);
+	  continue;
 	}
 
-      if (ver != NULL)
-        {
-          // The symbol name is of the form foo@VERSION or foo@@VERSION
-          namelen = ver - name;
-          ++ver;
-	  if (*ver == '@')
-	    {
-	      is_default_version = true;
-	      ++ver;
-	    }
-	  ver = this->namepool_.add(ver, true, &ver_key);
-        }
-      // We don't want to assign a version to an undefined symbol,
-      // even if it is listed in the version script.  FIXME: What
-      // about a common symbol?
-      else
+      (*sympointers)[i] =
+	this->add_relobj_symbol(relobj, p, name, st_shndx, is_ordinary,
+				orig_st_shndx,
+				is_defined_in_discarded_section);
+    }
+
+  for (unsigned int i = 0; i < pending.size(); ++i)
+    {
+      if (pending[i]->entries.empty())
 	{
-	  namelen = strlen(name);
-	  if (!this->version_script_.empty()
-	      && st_shndx != elfcpp::SHN_UNDEF)
+	  delete pending[i];
+	  continue;
+	}
+
+      Task_token* next_blocker = new Task_token(true);
+      next_blocker->add_blocker();
+      this->shard_workqueue_->add_blocker(this->shard_tasks_blocker_);
+      this->shard_workqueue_->queue(
+	  new Add_shard_symbols<size, big_endian>(this, pending[i],
+						  this->shard_blockers_[i],
+						  next_blocker,
+						  this->shard_tasks_blocker_));
+      this->shard_blockers_[i] = next_blocker;
+      ++this->shard_task_count_;
+    }
+}
+
+// Add the symbols of a relocatable object which hash to one shard.
+
+template<int size, bool big_endian>
+void
+Symbol_table::add_pending_symbols(
+    Pending_shard_symbols<size, big_endian>* pending)
+{
+  typedef Pending_shard_symbols<size, big_endian> Pending;
+  const int sym_size = elfcpp::Elf_sizes<size>::sym_size;
+
+  const unsigned char* p = &pending->syms[0];
+  const char* names = pending->names.data();
+  for (typename std::vector<typename Pending::Entry>::const_iterator e =
+	 pending->entries.begin();
+       e != pending->entries.end();
+       ++e, p += sym_size)
+    (*pending->sympointers)[e->index] =
+      this->add_relobj_symbol(pending->relobj, p, names + e->name_offset,
+			      e->st_shndx, e->is_ordinary, e->orig_st_shndx,
+			      e->is_defined_in_discarded_section);
+}
+
+// Add one external symbol from a relocatable object to the hash
+// table.  P points to the ELF symbol and NAME to its name.  ST_SHNDX
+// and IS_ORDINARY are the adjusted section index, and ORIG_ST_SHNDX
+// is the section index before checking for discarded sections.
+
+template<int size, bool big_endian>
+Sized_symbol<size>*
+Symbol_table::add_relobj_symbol(
+    Sized_relobj_file<size, big_endian>* relobj,
+    const unsigned char* p,
+    const char* name,
+    unsigned int st_shndx,
+    bool is_ordinary,
+    unsigned int orig_st_shndx,
+    bool is_defined_in_discarded_section)
+{
+  const int sym_size = elfcpp::Elf_sizes<size>::sym_size;
+
+  elfcpp::Sym<size, big_endian> sym(p);
+
+  if (strcmp (name, "__gnu_lto_slim") == 0)
+    gold_info(_("%s: plugin needed to handle lto object"),
+	      relobj->name().c_str());
+
+  // In an object file, an '@' in the name separates the symbol
+  // name from the version name.  If there are two '@' characters,
+  // this is the default version.
+  const char* ver = strchr(name, '@');
+  Stringpool::Key ver_key = 0;
+  int namelen = 0;
+  // IS_DEFAULT_VERSION: is the version default?
+  // IS_FORCED_LOCAL: is the symbol forced local?
+  bool is_default_version = false;
+  bool is_forced_local = false;
+
+  // FIXME: For incremental links, we don't store version information,
+  // so we need to ignore version symbols for now.
+  if (parameters->incremental_update() && ver != NULL)
+    {
+      namelen = ver - name;
+      ver = NULL;
+    }
+
+  Symbol_table_shard* shard;
+  if (ver != NULL)
+    {
+      // The symbol name is of the form foo@VERSION or foo@@VERSION
+      namelen = ver - name;
+      shard = this->shard(name, namelen);
+      ++ver;
+      if (*ver == '@')
+	{
+	  is_default_version = true;
+	  ++ver;
+	}
+      ver = shard->namepool.add(ver, true, &ver_key);
+    }
+  // We don't want to assign a version to an undefined symbol,
+  // even if it is listed in the version script.  FIXME: What
+  // about a common symbol?
+  else
+    {
+      namelen = strlen(name);
+      shard = this->shard(name, namelen);
+      if (!this->version_script_.empty()
+	  && st_shndx != elfcpp::SHN_UNDEF)
+	{
+	  // The symbol name did not have a version, but the
+	  // version script may assign a version anyway.
+	  std::string version;
+	  bool is_global;
+	  if (this->version_script_.get_symbol_version(name, &version,
+						       &is_global))
 	    {
-	      // The symbol name did not have a version, but the
-	      // version script may assign a version anyway.
-	      std::string version;
-	      bool is_global;
-	      if (this->version_script_.get_symbol_version(name, &version,
-							   &is_global))
+	      if (!is_global)
+		is_forced_local = true;
+	      else if (!version.empty())
 		{
-		  if (!is_global)
-		    is_forced_local = true;
-		  else if (!version.empty())
-		    {
-		      ver = this->namepool_.add_with_length(version.c_str(),
-							    version.length(),
-							    true,
-							    &ver_key);
-		      is_default_version = true;
-		    }
+		  ver = shard->namepool.add_with_length(version.c_str(),
+							version.length(),
+							true,
+							&ver_key);
+		  is_default_version = true;
 		}
 	    }
 	}
+    }
 
-      elfcpp::Sym<size, big_endian>* psym = &sym;
-      unsigned char symbuf[sym_size];
-      elfcpp::Sym<size, big_endian> sym2(symbuf);
-      if (just_symbols)
+  elfcpp::Sym<size, big_endian>* psym = &sym;
+  unsigned char symbuf[sym_size];
+  elfcpp::Sym<size, big_endian> sym2(symbuf);
+  if (relobj->just_symbols())
+    {
+      memcpy(symbuf, p, sym_size);
+      elfcpp::Sym_write<size, big_endian> sw(symbuf);
+      if (orig_st_shndx != elfcpp::SHN_UNDEF
+	  && is_ordinary
+	  && relobj->e_type() == elfcpp::ET_REL)
+	{
+	  // Symbol values in relocatable object files are section
+	  // relative.  This is normally what we want, but since here
+	  // we are converting the symbol to absolute we need to add
+	  // the section address.  The section address in an object
+	  // file is normally zero, but people can use a linker
+	  // script to change it.
+	  sw.put_st_value(sym.get_st_value()
+			  + relobj->section_address(orig_st_shndx));
+	}
+      st_shndx = elfcpp::SHN_ABS;
+      is_ordinary = false;
+      psym = &sym2;
+    }
+
+  // Fix up visibility if object has no-export set.
+  if (relobj->no_export()
+      && (orig_st_shndx != elfcpp::SHN_UNDEF || !is_ordinary))
+    {
+      // We may have copied symbol already above.
+      if (psym != &sym2)
 	{
 	  memcpy(symbuf, p, sym_size);
-	  elfcpp::Sym_write<size, big_endian> sw(symbuf);
-	  if (orig_st_shndx != elfcpp::SHN_UNDEF
-	      && is_ordinary
-	      && relobj->e_type() == elfcpp::ET_REL)
-	    {
-	      // Symbol values in relocatable object files are section
-	      // relative.  This is normally what we want, but since here
-	      // we are converting the symbol to absolute we need to add
-	      // the section address.  The section address in an object
-	      // file is normally zero, but people can use a linker
-	      // script to change it.
-	      sw.put_st_value(sym.get_st_value()
-			      + relobj->section_address(orig_st_shndx));
-	    }
-	  st_shndx = elfcpp::SHN_ABS;
-	  is_ordinary = false;
 	  psym = &sym2;
 	}
 
-      // Fix up visibility if object has no-export set.
-      if (relobj->no_export()
-	  && (orig_st_shndx != elfcpp::SHN_UNDEF || !is_ordinary))
-        {
-	  // We may have copied symbol already above.
-	  if (psym != &sym2)
-	    {
-	      memcpy(symbuf, p, sym_size);
-	      psym = &sym2;
-	    }
-
-	  elfcpp::STV visibility = sym2.get_st_visibility();
-	  if (visibility == elfcpp::STV_DEFAULT
-	      || visibility == elfcpp::STV_PROTECTED)
-	    {
-	      elfcpp::Sym_write<size, big_endian> sw(symbuf);
-	      unsigned char nonvis = sym2.get_st_nonvis();
-	      sw.put_st_other(elfcpp::STV_HIDDEN, nonvis);
-	    }
-        }
-
-      Stringpool::Key name_key;
-      name = this->namepool_.add_with_length(name, namelen, true,
-					     &name_key);
+      elfcpp::STV visibility = sym2.get_st_visibility();
+      if (visibility == elfcpp::STV_DEFAULT
+	  || visibility == elfcpp::STV_PROTECTED)
+	{
+	  elfcpp::Sym_write<size, big_endian> sw(symbuf);
+	  unsigned char nonvis = sym2.get_st_nonvis();
+	  sw.put_st_other(elfcpp::STV_HIDDEN, nonvis);
+	}
+    }
 
-      Sized_symbol<size>* res;
-      res = this->add_from_object(relobj, name, name_key, ver, ver_key,
-				  is_default_version, *psym, st_shndx,
-				  is_ordinary, orig_st_shndx);
-      
-      if (is_forced_local)
-	this->force_local(res);
+  Stringpool::Key name_key;
+  name = shard->namepool.add_with_length(name, namelen, true, &name_key);
 
-      // Do not treat this symbol as garbage if this symbol will be
-      // exported to the dynamic symbol table.  This is true when
-      // building a shared library or using --export-dynamic and
-      // the symbol is externally visible.
-      if (parameters->options().gc_sections()
-	  && res->is_externally_visible()
-	  && !res->is_from_dynobj()
-          && (parameters->options().shared()
-	      || parameters->options().export_dynamic()
-	      || parameters->options().in_dynamic_list(res->name())))
-        this->gc_mark_symbol(res);
+  Sized_symbol<size>* res;
+  res = this->add_from_object(shard, relobj, name, name_key, ver, ver_key,
+			      is_default_version, *psym, st_shndx,
+			      is_ordinary, orig_st_shndx);
 
-      if (is_defined_in_discarded_section)
-	res->set_is_defined_in_discarded_section();
+  if (is_forced_local)
+    this->force_local(shard, res);
+
+  // Do not treat this symbol as garbage if this symbol will be
+  // exported to the dynamic symbol table.  This is true when
+  // building a shared library or using --export-dynamic and
+  // the symbol is externally visible.
+  if (parameters->options().gc_sections()
+      && res->is_externally_visible()
+      && !res->is_from_dynobj()
+      && (parameters->options().shared()
+	  || parameters->options().export_dynamic()
+	  || parameters->options().in_dynamic_list(res->name())))
+    this->gc_mark_symbol(shard, res);
+
+  if (is_defined_in_discarded_section)
+    res->set_is_defined_in_discarded_section();
 
-      (*sympointers)[i] = res;
-    }
+  return res;
 }
 
 // Add a symbol from a plugin-claimed file.
@@ -1322,13 +1787,15 @@ Symbol_table::add_from_pluginobj(
   unsigned int st_shndx = sym->get_st_shndx();
   bool is_ordinary = st_shndx < elfcpp::SHN_LORESERVE;
 
+  Symbol_table_shard* shard = this->shard(name, strlen(name));
+
   Stringpool::Key ver_key = 0;
   bool is_default_version = false;
   bool is_forced_local = false;
 
   if (ver != NULL)
     {
-      ver = this->namepool_.add(ver, true, &ver_key);
+      ver = shard->namepool.add(ver, true, &ver_key);
     }
   // We don't want to assign a version to an undefined symbol,
   // even if it is listed in the version script.  FIXME: What
@@ -1349,10 +1816,10 @@ Symbol_table::add_from_pluginobj(
 		is_forced_local = true;
 	      else if (!version.empty())
                 {
-                  ver = this->namepool_.add_with_length(version.c_str(),
-                                                        version.length(),
-                                                        true,
-                                                        &ver_key);
+                  ver = shard->namepool.add_with_length(version.c_str(),
+                                                       version.length(),
+                                                       true,
+                                                       &ver_key);
                   is_default_version = true;
                 }
             }
@@ -1360,15 +1827,15 @@ Symbol_table::add_from_pluginobj(
     }
 
   Stringpool::Key name_key;
-  name = this->namepool_.add(name, true, &name_key);
+  name = shard->namepool.add(name, true, &name_key);
 
   Sized_symbol<size>* res;
-  res = this->add_from_object(obj, name, name_key, ver, ver_key,
+  res = this->add_from_object(shard, obj, name, name_key, ver, ver_key,
 		              is_default_version, *sym, st_shndx,
 			      is_ordinary, st_shndx);
 
   if (is_forced_local)
-    this->force_local(res);
+    this->force_local(shard, res);
 
   return res;
 }
@@ -1461,6 +1928,7 @@ Symbol_table::add_from_dynobj(
 	}
 
       const char* name = sym_names + st_name;
+      Symbol_table_shard* shard = this->shard(name, strlen(name));
 
       bool is_ordinary;
       unsigned int st_shndx = dynobj->adjust_sym_shndx(i, psym->get_st_shndx(),
@@ -1474,8 +1942,8 @@ Symbol_table::add_from_dynobj(
       if (versym == NULL)
 	{
 	  Stringpool::Key name_key;
-	  name = this->namepool_.add(name, true, &name_key);
-	  res = this->add_from_object(dynobj, name, name_key, NULL, 0,
+	  name = shard->namepool.add(name, true, &name_key);
+	  res = this->add_from_object(shard, dynobj, name, name_key, NULL, 0,
 				      false, *psym, st_shndx, is_ordinary,
 				      st_shndx);
 	}
@@ -1504,13 +1972,13 @@ Symbol_table::add_from_dynobj(
 
 	  // At this point we are definitely going to add this symbol.
 	  Stringpool::Key name_key;
-	  name = this->namepool_.add(name, true, &name_key);
+	  name = shard->namepool.add(name, true, &name_key);
 
 	  if (v == static_cast<unsigned int>(elfcpp::VER_NDX_LOCAL)
 	      || v == static_cast<unsigned int>(elfcpp::VER_NDX_GLOBAL))
 	    {
 	      // This symbol does not have a version.
-	      res = this->add_from_object(dynobj, name, name_key, NULL, 0,
+	      res = this->add_from_object(shard, dynobj, name, name_key, NULL, 0,
 					  false, *psym, st_shndx, is_ordinary,
 					  st_shndx);
 	    }
@@ -1532,7 +2000,7 @@ Symbol_table::add_from_dynobj(
 		}
 
 	      Stringpool::Key version_key;
-	      version = this->namepool_.add(version, true, &version_key);
+	      version = shard->namepool.add(version, true, &version_key);
 
 	      // If this is an absolute symbol, and the version name
 	      // and symbol name are the same, then this is the
@@ -1542,17 +2010,17 @@ Symbol_table::add_from_dynobj(
 	      if (st_shndx == elfcpp::SHN_ABS
 		  && !is_ordinary
 		  && name_key == version_key)
-		res = this->add_from_object(dynobj, name, name_key, NULL, 0,
-					    false, *psym, st_shndx, is_ordinary,
-					    st_shndx);
+		res = this->add_from_object(shard, dynobj, name, name_key,
+					    NULL, 0, false, *psym, st_shndx,
+					    is_ordinary, st_shndx);
 	      else
 		{
 		  const bool is_default_version =
 		    !hidden && st_shndx != elfcpp::SHN_UNDEF;
-		  res = this->add_from_object(dynobj, name, name_key, version,
-					      version_key, is_default_version,
-					      *psym, st_shndx,
-					      is_ordinary, st_shndx);
+		  res = this->add_from_object(shard, dynobj, name, name_key,
+					      version, version_key,
+					      is_default_version, *psym,
+					      st_shndx, is_ordinary, st_shndx);
 		}
 	    }
 	}
@@ -1586,20 +2054,22 @@ Symbol_table::add_from_incrobj(
   unsigned int st_shndx = sym->get_st_shndx();
   bool is_ordinary = st_shndx < elfcpp::SHN_LORESERVE;
 
+  Symbol_table_shard* shard = this->shard(name, strlen(name));
+
   Stringpool::Key ver_key = 0;
   bool is_default_version = false;
   bool is_forced_local = false;
 
   Stringpool::Key name_key;
-  name = this->namepool_.add(name, true, &name_key);
+  name = shard->namepool.add(name, true, &name_key);
 
   Sized_symbol<size>* res;
-  res = this->add_from_object(obj, name, name_key, ver, ver_key,
+  res = this->add_from_object(shard, obj, name, name_key, ver, ver_key,
 		              is_default_version, *sym, st_shndx,
 			      is_ordinary, st_shndx);
 
   if (is_forced_local)
-    this->force_local(res);
+    this->force_local(shard, res);
 
   return res;
 }
@@ -1728,10 +2198,13 @@ Symbol_table::define_special_symbol(const char** pname, const char** pversion,
   Symbol* oldsym;
   Sized_symbol<size>* sym;
 
+  Symbol_table_shard* shard = this->shard(*pname, strlen(*pname));
+  Symbol_table_type& table(shard->table);
+
   bool add_to_table = false;
-  typename Symbol_table_type::iterator add_loc = this->table_.end();
+  typename Symbol_table_type::iterator add_loc = table.end();
   bool add_def_to_table = false;
-  typename Symbol_table_type::iterator add_def_loc = this->table_.end();
+  typename Symbol_table_type::iterator add_def_loc = table.end();
 
   if (only_if_ref)
     {
@@ -1743,7 +2216,7 @@ Symbol_table::define_special_symbol(const char** pname, const char** pversion,
 
       *pname = oldsym->name();
       if (is_default_version)
-	*pversion = this->namepool_.add(*pversion, true, NULL);
+	*pversion = shard->namepool.add(*pversion, true, NULL);
       else
 	*pversion = oldsym->version();
     }
@@ -1751,33 +2224,35 @@ Symbol_table::define_special_symbol(const char** pname, const char** pversion,
     {
       // Canonicalize NAME and VERSION.
       Stringpool::Key name_key;
-      *pname = this->namepool_.add(*pname, true, &name_key);
+      *pname = shard->namepool.add(*pname, true, &name_key);
 
       Stringpool::Key version_key = 0;
       if (*pversion != NULL)
-	*pversion = this->namepool_.add(*pversion, true, &version_key);
+	*pversion = shard->namepool.add(*pversion, true, &version_key);
+
+      // Make sure that adding NAME/NULL does not move NAME/VERSION.
+      if (is_default_version)
+	table.reserve(table.size() + 2);
 
       Symbol* const snull = NULL;
       std::pair<typename Symbol_table_type::iterator, bool> ins =
-	this->table_.insert(std::make_pair(std::make_pair(name_key,
-							  version_key),
-					   snull));
+	table.insert(std::make_pair(std::make_pair(name_key, version_key),
+				    snull));
 
       std::pair<typename Symbol_table_type::iterator, bool> insdefault =
-	std::make_pair(this->table_.end(), false);
+	std::make_pair(table.end(), false);
       if (is_default_version)
 	{
 	  const Stringpool::Key vnull = 0;
-	  insdefault =
-	    this->table_.insert(std::make_pair(std::make_pair(name_key,
-							      vnull),
-					       snull));
+	  insdefault = table.insert(std::make_pair(std::make_pair(name_key,
+								  vnull),
+						   snull));
 	}
 
       if (!ins.second)
 	{
 	  // We already have a symbol table entry for NAME/VERSION.
-	  oldsym = ins.first->second;
+	  oldsym = *ins.first;
 	  gold_assert(oldsym != NULL);
 
 	  if (is_default_version)
@@ -1792,7 +2267,7 @@ Symbol_table::define_special_symbol(const char** pname, const char** pversion,
       else
 	{
 	  // We haven't seen this symbol before.
-	  gold_assert(ins.first->second == NULL);
+	  gold_assert(*ins.first == NULL);
 
 	  add_to_table = true;
 	  add_loc = ins.first;
@@ -1801,7 +2276,7 @@ Symbol_table::define_special_symbol(const char** pname, const char** pversion,
 	    {
 	      // We are adding NAME/VERSION, and it is the default
 	      // version.  We already have an entry for NAME/NULL.
-	      oldsym = insdefault.first->second;
+	      oldsym = *insdefault.first;
 	      *resolve_oldsym = true;
 	    }
 	  else
@@ -1817,25 +2292,17 @@ Symbol_table::define_special_symbol(const char** pname, const char** pversion,
 	}
     }
 
-  const Target& target = parameters->target();
-  if (!target.has_make_symbol())
-    sym = new Sized_symbol<size>();
-  else
-    {
-      Sized_target<size, big_endian>* sized_target =
-	parameters->sized_target<size, big_endian>();
-      sym = sized_target->make_symbol();
-      if (sym == NULL)
-        return NULL;
-    }
+  sym = this->new_symbol<size, big_endian>(shard);
+  if (sym == NULL)
+    return NULL;
 
   if (add_to_table)
-    add_loc->second = sym;
+    *add_loc = sym;
   else
     gold_assert(oldsym != NULL);
 
   if (add_def_to_table)
-    add_def_loc->second = sym;
+    *add_def_loc = sym;
 
   *poldsym = this->get_sized_symbol<size>(oldsym);
 
@@ -1953,7 +2420,7 @@ Symbol_table::do_define_in_output_data(
     return sym;
   else
     {
-      delete sym;
+      this->free_symbol(sym);
       return oldsym;
     }
 }
@@ -2067,7 +2534,7 @@ Symbol_table::do_define_in_output_segment(
     return sym;
   else
     {
-      delete sym;
+      this->free_symbol(sym);
       return oldsym;
     }
 }
@@ -2186,7 +2653,7 @@ Symbol_table::do_define_as_constant(
     return sym;
   else
     {
-      delete sym;
+      this->free_symbol(sym);
       return oldsym;
     }
 }
@@ -2395,7 +2862,7 @@ Symbol_table::add_undefined_symbol_from_command_line(const char* name)
 
   sym->init_undefined(name, version, elfcpp::STT_NOTYPE, elfcpp::STB_GLOBAL,
 		      elfcpp::STV_DEFAULT, 0);
-  ++this->saw_undefined_;
+  ++this->shard(name, strlen(name))->saw_undefined;
 }
 
 // Set the dynamic symbol indexes.  INDEX is the index of the first
@@ -2415,60 +2882,68 @@ Symbol_table::set_dynsym_indexes(unsigned int index,
   if (parameters->target().has_custom_set_dynsym_indexes())
     {
       std::vector<Symbol*> dyn_symbols;
-      for (Symbol_table_type::iterator p = this->table_.begin();
-           p != this->table_.end();
-           ++p)
-        {
-          Symbol* sym = p->second;
-          if (!sym->should_add_dynsym_entry(this))
-            sym->set_dynsym_index(-1U);
-          else
-            dyn_symbols.push_back(sym);
-        }
+      for (size_t i = 0; i < this->shards_.size(); ++i)
+	{
+	  Symbol_table_type& table(this->shards_[i]->table);
+	  for (Symbol_table_type::iterator p = table.begin();
+	       p != table.end();
+	       ++p)
+	    {
+	      Symbol* sym = *p;
+	      if (!sym->should_add_dynsym_entry(this))
+		sym->set_dynsym_index(-1U);
+	      else
+		dyn_symbols.push_back(sym);
+	    }
+	}
 
       return parameters->target().set_dynsym_indexes(&dyn_symbols, index, syms,
                                                      dynpool, versions, this);
     }
 
-  for (Symbol_table_type::iterator p = this->table_.begin();
-       p != this->table_.end();
-       ++p)
+  for (size_t i = 0; i < this->shards_.size(); ++i)
     {
-      Symbol* sym = p->second;
+      Symbol_table_type& table(this->shards_[i]->table);
+      for (Symbol_table_type::iterator p = table.begin();
+	   p != table.end();
+	   ++p)
+	{
+	  Symbol* sym = *p;
 
-      // Note that SYM may already have a dynamic symbol index, since
-      // some symbols appear more than once in the symbol table, with
-      // and without a version.
+	  // Note that SYM may already have a dynamic symbol index, since
+	  // some symbols appear more than once in the symbol table, with
+	  // and without a version.
 
-      if (!sym->should_add_dynsym_entry(this))
-	sym->set_dynsym_index(-1U);
-      else if (!sym->has_dynsym_index())
-	{
-	  sym->set_dynsym_index(index);
-	  ++index;
-	  syms->push_back(sym);
-	  dynpool->add(sym->name(), false, NULL);
-
-	  // If the symbol is defined in a dynamic object and is
-	  // referenced strongly in a regular object, then mark the
-	  // dynamic object as needed.  This is used to implement
-	  // --as-needed.
-	  if (sym->is_from_dynobj()
-	      && sym->in_reg()
-	      && !sym->is_undef_binding_weak())
-	    sym->object()->set_is_needed();
-
-	  // Record any version information, except those from
-	  // as-needed libraries not seen to be needed.  Note that the
-	  // is_needed state for such libraries can change in this loop.
-	  if (sym->version() != NULL)
+	  if (!sym->should_add_dynsym_entry(this))
+	    sym->set_dynsym_index(-1U);
+	  else if (!sym->has_dynsym_index())
 	    {
-	      if (!sym->is_from_dynobj()
-		  || !sym->object()->as_needed()
-		  || sym->object()->is_needed())
-		versions->record_version(this, dynpool, sym);
-	      else
-		as_needed_sym.push_back(sym);
+	      sym->set_dynsym_index(index);
+	      ++index;
+	      syms->push_back(sym);
+	      dynpool->add(sym->name(), false, NULL);
+
+	      // If the symbol is defined in a dynamic object and is
+	      // referenced strongly in a regular object, then mark the
+	      // dynamic object as needed.  This is used to implement
+	      // --as-needed.
+	      if (sym->is_from_dynobj()
+		  && sym->in_reg()
+		  && !sym->is_undef_binding_weak())
+		sym->object()->set_is_needed();
+
+	      // Record any version information, except those from
+	      // as-needed libraries not seen to be needed.  Note that the
+	      // is_needed state for such libraries can change in this loop.
+	      if (sym->version() != NULL)
+		{
+		  if (!sym->is_from_dynobj()
+		      || !sym->object()->as_needed()
+		      || sym->object()->is_needed())
+		    versions->record_version(this, dynpool, sym);
+		  else
+		    as_needed_sym.push_back(sym);
+		}
 	    }
 	}
     }
@@ -2572,27 +3047,35 @@ Symbol_table::sized_finalize(off_t off, Stringpool* pool,
 
   // First do all the symbols which have been forced to be local, as
   // they must appear before all global symbols.
-  for (Forced_locals::iterator p = this->forced_locals_.begin();
-       p != this->forced_locals_.end();
-       ++p)
+  for (size_t i = 0; i < this->shards_.size(); ++i)
     {
-      Symbol* sym = *p;
-      gold_assert(sym->is_forced_local());
-      if (this->sized_finalize_symbol<size>(sym))
+      Forced_locals& forced_locals(this->shards_[i]->forced_locals);
+      for (Forced_locals::iterator p = forced_locals.begin();
+	   p != forced_locals.end();
+	   ++p)
 	{
-	  this->add_to_final_symtab<size>(sym, pool, &index, &off);
-	  ++*plocal_symcount;
+	  Symbol* sym = *p;
+	  gold_assert(sym->is_forced_local());
+	  if (this->sized_finalize_symbol<size>(sym))
+	    {
+	      this->add_to_final_symtab<size>(sym, pool, &index, &off);
+	      ++*plocal_symcount;
+	    }
 	}
     }
 
   // Now do all the remaining symbols.
-  for (Symbol_table_type::iterator p = this->table_.begin();
-       p != this->table_.end();
-       ++p)
+  for (size_t i = 0; i < this->shards_.size(); ++i)
     {
-      Symbol* sym = p->second;
-      if (this->sized_finalize_symbol<size>(sym))
-	this->add_to_final_symtab<size>(sym, pool, &index, &off);
+      Symbol_table_type& table(this->shards_[i]->table);
+      for (Symbol_table_type::iterator p = table.begin();
+	   p != table.end();
+	   ++p)
+	{
+	  Symbol* sym = *p;
+	  if (this->sized_finalize_symbol<size>(sym))
+	    this->add_to_final_symtab<size>(sym, pool, &index, &off);
+	}
     }
 
   this->output_count_ = index - orig_index;
@@ -2894,173 +3377,179 @@ Symbol_table::sized_write_globals(const Stringpool* sympool,
   else
     dynamic_view = of->get_output_view(this->dynamic_offset_, dynamic_size);
 
-  for (Symbol_table_type::const_iterator p = this->table_.begin();
-       p != this->table_.end();
-       ++p)
+  for (size_t i = 0; i < this->shards_.size(); ++i)
     {
-      Sized_symbol<size>* sym = static_cast<Sized_symbol<size>*>(p->second);
+      const Symbol_table_type& table(this->shards_[i]->table);
+      for (Symbol_table_type::const_iterator p = table.begin();
+	   p != table.end();
+	   ++p)
+	{
+	  Sized_symbol<size>* sym = static_cast<Sized_symbol<size>*>(*p);
 
-      // Possibly warn about unresolved symbols in shared libraries.
-      this->warn_about_undefined_dynobj_symbol(sym);
+	  // Possibly warn about unresolved symbols in shared libraries.
+	  this->warn_about_undefined_dynobj_symbol(sym);
 
-      unsigned int sym_index = sym->symtab_index();
-      unsigned int dynsym_index;
-      if (dynamic_view == NULL)
-	dynsym_index = -1U;
-      else
-	dynsym_index = sym->dynsym_index();
-
-      if (sym_index == -1U && dynsym_index == -1U)
-	{
-	  // This symbol is not included in the output file.
-	  continue;
-	}
+	  unsigned int sym_index = sym->symtab_index();
+	  unsigned int dynsym_index;
+	  if (dynamic_view == NULL)
+	    dynsym_index = -1U;
+	  else
+	    dynsym_index = sym->dynsym_index();
 
-      unsigned int shndx;
-      typename elfcpp::Elf_types<size>::Elf_Addr sym_value = sym->value();
-      typename elfcpp::Elf_types<size>::Elf_Addr dynsym_value = sym_value;
-      elfcpp::STB binding = sym->binding();
+	  if (sym_index == -1U && dynsym_index == -1U)
+	    {
+	      // This symbol is not included in the output file.
+	      continue;
+	    }
 
-      // If --weak-unresolved-symbols is set, change binding of unresolved
-      // global symbols to STB_WEAK.
-      if (parameters->options().weak_unresolved_symbols()
-	  && binding == elfcpp::STB_GLOBAL
-	  && sym->is_undefined())
-	binding = elfcpp::STB_WEAK;
+	  unsigned int shndx;
+	  typename elfcpp::Elf_types<size>::Elf_Addr sym_value = sym->value();
+	  typename elfcpp::Elf_types<size>::Elf_Addr dynsym_value = sym_value;
+	  elfcpp::STB binding = sym->binding();
 
-      // If --no-gnu-unique is set, change STB_GNU_UNIQUE to STB_GLOBAL.
-      if (binding == elfcpp::STB_GNU_UNIQUE
-	  && !parameters->options().gnu_unique())
-	binding = elfcpp::STB_GLOBAL;
+	  // If --weak-unresolved-symbols is set, change binding of unresolved
+	  // global symbols to STB_WEAK.
+	  if (parameters->options().weak_unresolved_symbols()
+	      && binding == elfcpp::STB_GLOBAL
+	      && sym->is_undefined())
+	    binding = elfcpp::STB_WEAK;
 
-      switch (sym->source())
-	{
-	case Symbol::FROM_OBJECT:
-	  {
-	    bool is_ordinary;
-	    unsigned int in_shndx = sym->shndx(&is_ordinary);
+	  // If --no-gnu-unique is set, change STB_GNU_UNIQUE to STB_GLOBAL.
+	  if (binding == elfcpp::STB_GNU_UNIQUE
+	      && !parameters->options().gnu_unique())
+	    binding = elfcpp::STB_GLOBAL;
 
-	    if (!is_ordinary
-		&& in_shndx != elfcpp::SHN_ABS
-		&& !Symbol::is_common_shndx(in_shndx))
-	      {
-		gold_error(_("%s: unsupported symbol section 0x%x"),
-			   sym->demangled_name().c_str(), in_shndx);
-		shndx = in_shndx;
-	      }
-	    else
+	  switch (sym->source())
+	    {
+	    case Symbol::FROM_OBJECT:
 	      {
-		Object* symobj = sym->object();
-		if (symobj->is_dynamic())
+		bool is_ordinary;
+		unsigned int in_shndx = sym->shndx(&is_ordinary);
+
+		if (!is_ordinary
+		    && in_shndx != elfcpp::SHN_ABS
+		    && !Symbol::is_common_shndx(in_shndx))
 		  {
-		    if (sym->needs_dynsym_value())
-		      dynsym_value = target.dynsym_value(sym);
-		    shndx = elfcpp::SHN_UNDEF;
-		    if (sym->is_undef_binding_weak())
-		      binding = elfcpp::STB_WEAK;
-		    else
-		      binding = elfcpp::STB_GLOBAL;
+		    gold_error(_("%s: unsupported symbol section 0x%x"),
+			       sym->demangled_name().c_str(), in_shndx);
+		    shndx = in_shndx;
 		  }
-		else if (symobj->pluginobj() != NULL)
-		  shndx = elfcpp::SHN_UNDEF;
-		else if (in_shndx == elfcpp::SHN_UNDEF
-			 || (!is_ordinary
-			     && (in_shndx == elfcpp::SHN_ABS
-				 || Symbol::is_common_shndx(in_shndx))))
-		  shndx = in_shndx;
 		else
 		  {
-		    Relobj* relobj = static_cast<Relobj*>(symobj);
-		    Output_section* os = relobj->output_section(in_shndx);
-                    if (this->is_section_folded(relobj, in_shndx))
-                      {
-                        // This global symbol must be written out even though
-                        // it is folded.
-                        // Get the os of the section it is folded onto.
-                        Section_id folded =
-                             this->icf_->get_folded_section(relobj, in_shndx);
-                        gold_assert(folded.first !=NULL);
-                        Relobj* folded_obj = 
-                          reinterpret_cast<Relobj*>(folded.first);
-                        os = folded_obj->output_section(folded.second);  
-                        gold_assert(os != NULL);
-                      }
-		    gold_assert(os != NULL);
-		    shndx = os->out_shndx();
-
-		    if (shndx >= elfcpp::SHN_LORESERVE)
+		    Object* symobj = sym->object();
+		    if (symobj->is_dynamic())
 		      {
-			if (sym_index != -1U)
-			  symtab_xindex->add(sym_index, shndx);
-			if (dynsym_index != -1U)
-			  dynsym_xindex->add(dynsym_index, shndx);
-			shndx = elfcpp::SHN_XINDEX;
+			if (sym->needs_dynsym_value())
+			  dynsym_value = target.dynsym_value(sym);
+			shndx = elfcpp::SHN_UNDEF;
+			if (sym->is_undef_binding_weak())
+			  binding = elfcpp::STB_WEAK;
+			else
+			  binding = elfcpp::STB_GLOBAL;
+		      }
+		    else if (symobj->pluginobj() != NULL)
+		      shndx = elfcpp::SHN_UNDEF;
+		    else if (in_shndx == elfcpp::SHN_UNDEF
+			     || (!is_ordinary
+				 && (in_shndx == elfcpp::SHN_ABS
+				     || Symbol::is_common_shndx(in_shndx))))
+		      shndx = in_shndx;
+		    else
+		      {
+			Relobj* relobj = static_cast<Relobj*>(symobj);
+			Output_section* os = relobj->output_section(in_shndx);
+			if (this->is_section_folded(relobj, in_shndx))
+			  {
+			    // This global symbol must be written out even though
+			    // it is folded.
+			    // Get the os of the section it is folded onto.
+			    Section_id folded =
+			      this->icf_->get_folded_section(relobj,
+							     in_shndx);
+			    gold_assert(folded.first !=NULL);
+			    Relobj* folded_obj = 
+			      reinterpret_cast<Relobj*>(folded.first);
+			    os = folded_obj->output_section(folded.second);  
+			    gold_assert(os != NULL);
+			  }
+			gold_assert(os != NULL);
+			shndx = os->out_shndx();
+
+			if (shndx >= elfcpp::SHN_LORESERVE)
+			  {
+			    if (sym_index != -1U)
+			      symtab_xindex->add(sym_index, shndx);
+			    if (dynsym_index != -1U)
+			      dynsym_xindex->add(dynsym_index, shndx);
+			    shndx = elfcpp::SHN_XINDEX;
+			  }
+
+			// In object files symbol values are section
+			// relative.
+			if (parameters->options().relocatable())
+			  sym_value -= os->address();
 		      }
-
-		    // In object files symbol values are section
-		    // relative.
-		    if (parameters->options().relocatable())
-		      sym_value -= os->address();
 		  }
 	      }
-	  }
-	  break;
+	      break;
 
-	case Symbol::IN_OUTPUT_DATA:
-	  {
-	    Output_data* od = sym->output_data();
-
-	    shndx = od->out_shndx();
-	    if (shndx >= elfcpp::SHN_LORESERVE)
+	    case Symbol::IN_OUTPUT_DATA:
 	      {
-		if (sym_index != -1U)
-		  symtab_xindex->add(sym_index, shndx);
-		if (dynsym_index != -1U)
-		  dynsym_xindex->add(dynsym_index, shndx);
-		shndx = elfcpp::SHN_XINDEX;
-	      }
+		Output_data* od = sym->output_data();
 
-	    // In object files symbol values are section
-	    // relative.
-	    if (parameters->options().relocatable())
-	      sym_value -= od->address();
-	  }
-	  break;
+		shndx = od->out_shndx();
+		if (shndx >= elfcpp::SHN_LORESERVE)
+		  {
+		    if (sym_index != -1U)
+		      symtab_xindex->add(sym_index, shndx);
+		    if (dynsym_index != -1U)
+		      dynsym_xindex->add(dynsym_index, shndx);
+		    shndx = elfcpp::SHN_XINDEX;
+		  }
 
-	case Symbol::IN_OUTPUT_SEGMENT:
-	  shndx = elfcpp::SHN_ABS;
-	  break;
+		// In object files symbol values are section
+		// relative.
+		if (parameters->options().relocatable())
+		  sym_value -= od->address();
+	      }
+	      break;
 
-	case Symbol::IS_CONSTANT:
-	  shndx = elfcpp::SHN_ABS;
-	  break;
+	    case Symbol::IN_OUTPUT_SEGMENT:
+	      shndx = elfcpp::SHN_ABS;
+	      break;
 
-	case Symbol::IS_UNDEFINED:
-	  shndx = elfcpp::SHN_UNDEF;
-	  break;
+	    case Symbol::IS_CONSTANT:
+	      shndx = elfcpp::SHN_ABS;
+	      break;
 
-	default:
-	  gold_unreachable();
-	}
+	    case Symbol::IS_UNDEFINED:
+	      shndx = elfcpp::SHN_UNDEF;
+	      break;
 
-      if (sym_index != -1U)
-	{
-	  sym_index -= first_global_index;
-	  gold_assert(sym_index < output_count);
-	  unsigned char* ps = psyms + (sym_index * sym_size);
-	  this->sized_write_symbol<size, big_endian>(sym, sym_value, shndx,
-						     binding, sympool, ps);
-	}
+	    default:
+	      gold_unreachable();
+	    }
 
-      if (dynsym_index != -1U)
-	{
-	  dynsym_index -= first_dynamic_global_index;
-	  gold_assert(dynsym_index < dynamic_count);
-	  unsigned char* pd = dynamic_view + (dynsym_index * sym_size);
-	  this->sized_write_symbol<size, big_endian>(sym, dynsym_value, shndx,
-						     binding, dynpool, pd);
-          // Allow a target to adjust dynamic symbol value.
-          parameters->target().adjust_dyn_symbol(sym, pd);
+	  if (sym_index != -1U)
+	    {
+	      sym_index -= first_global_index;
+	      gold_assert(sym_index < output_count);
+	      unsigned char* ps = psyms + (sym_index * sym_size);
+	      this->sized_write_symbol<size, big_endian>(sym, sym_value, shndx,
+							 binding, sympool, ps);
+	    }
+
+	  if (dynsym_index != -1U)
+	    {
+	      dynsym_index -= first_dynamic_global_index;
+	      gold_assert(dynsym_index < dynamic_count);
+	      unsigned char* pd = dynamic_view + (dynsym_index * sym_size);
+	      this->sized_write_symbol<size, big_endian>(sym, dynsym_value,
+							 shndx, binding,
+							 dynpool, pd);
+	      // Allow a target to adjust dynamic symbol value.
+	      parameters->target().adjust_dyn_symbol(sym, pd);
+	    }
 	}
     }
 
@@ -3219,14 +3708,102 @@ Symbol_table::sized_write_section_symbol(const Output_section* os,
 void
 Symbol_table::print_stats() const
 {
+  size_t entries = 0;
+  size_t buckets = 0;
+  for (size_t i = 0; i < this->shards_.size(); ++i)
+    {
+      entries += this->shards_[i]->table.size();
+#if defined(HAVE_TR1_UNORDERED_MAP) || defined(HAVE_EXT_HASH_MAP)
+      buckets += this->shards_[i]->table.bucket_count();
+#endif
+    }
 #if defined(HAVE_TR1_UNORDERED_MAP) || defined(HAVE_EXT_HASH_MAP)
   fprintf(stderr, _("%s: symbol table entries: %zu; buckets: %zu\n"),
-	  program_name, this->table_.size(), this->table_.bucket_count());
+	  program_name, entries, buckets);
 #else
   fprintf(stderr, _("%s: symbol table entries: %zu\n"),
-	  program_name, this->table_.size());
+	  program_name, entries);
 #endif
-  this->namepool_.print_stats("symbol table stringpool");
+  if (this->is_sharded())
+    {
+      size_t used = 0;
+      for (size_t i = 0; i < this->shards_.size(); ++i)
+	if (!this->shards_[i]->table.empty())
+	  ++used;
+      fprintf(stderr, _("%s: symbol table shards: %zu; used: %zu\n"),
+	      program_name, this->shards_.size(), used);
+      fprintf(stderr, _("%s: symbol table shard tasks: %zu\n"),
+	      program_name, this->shard_task_count_);
+    }
+  this->print_symbol_size_stats();
+  for (size_t i = 0; i < this->shards_.size(); ++i)
+    this->shards_[i]->namepool.print_stats("symbol table stringpool");
+  if (this->gc_ != NULL && this->gc_->is_worklist_ready())
+    this->gc_->print_stats();
+  if (this->icf_ != NULL && this->icf_->is_icf_ready())
+    this->icf_->print_stats();
+}
+
+// Return the number of bytes a typical malloc uses for a block of LEN
+// bytes: the block plus a size word, aligned to two pointers.
+
+static size_t
+malloc_block_size(size_t len)
+{
+  const size_t align = 2 * sizeof(void*);
+  return (len + sizeof(size_t) + align - 1) & ~(align - 1);
+}
+
+// Print the number of bytes used per symbol by the symbols and the
+// symbol hash table, both for the normal table and for the compact
+// table of --compact-symbols.  The figures for the table which is not
+// in use are estimates, as are those for the allocator overhead.
+
+void
+Symbol_table::print_symbol_size_stats() const
+{
+  size_t symbols = 0;
+  size_t normal_bytes = 0;
+  size_t compact_bytes = 0;
+  // An Unordered_map node holds a next pointer, the value, and the
+  // hash code.
+  const size_t node_size = malloc_block_size(sizeof(void*)
+					     + sizeof(Symbol_table_type::value_type)
+					     + sizeof(size_t));
+  for (size_t i = 0; i < this->shards_.size(); ++i)
+    {
+      const Symbol_table_shard* shard = this->shards_[i];
+      size_t entries = shard->table.size();
+      symbols += shard->symbol_count;
+      if (shard->table.is_compact())
+	{
+	  normal_bytes += entries * (node_size + sizeof(void*));
+	  compact_bytes += (shard->table.bucket_count()
+			    * Symbol_table_type::compact_slot_size);
+	}
+      else
+	{
+	  normal_bytes += (entries * node_size
+			   + shard->table.bucket_count() * sizeof(void*));
+	  compact_bytes += (Symbol_table_type::compact_slot_count(entries)
+			    * Symbol_table_type::compact_slot_size);
+	}
+    }
+  if (symbols == 0)
+    return;
+
+  size_t symbol_size;
+  if (parameters->target().get_size() == 32)
+    symbol_size = sizeof(Sized_symbol<32>);
+  else
+    symbol_size = sizeof(Sized_symbol<64>);
+  normal_bytes += symbols * malloc_block_size(symbol_size);
+  compact_bytes += symbols * symbol_size;
+
+  fprintf(stderr, _("%s: symbol table symbols: %zu; "
+		    "bytes per symbol: %zu normal, %zu compact\n"),
+	  program_name, symbols, normal_bytes / symbols,
+	  compact_bytes / symbols);
 }
 
 // We check for ODR violations by looking for symbols with the same
@@ -3264,32 +3841,6 @@ struct Odr_violation_compare
   }
 };
 
-// Returns all of the lines attached to LOC, not just the one the
-// instruction actually came from.
-std::vector<std::string>
-Symbol_table::linenos_from_loc(const Task* task,
-                               const Symbol_location& loc)
-{
-  // We need to lock the object in order to read it.  This
-  // means that we have to run in a singleton Task.  If we
-  // want to run this in a general Task for better
-  // performance, we will need one Task for object, plus
-  // appropriate locking to ensure that we don't conflict with
-  // other uses of the object.  Also note, one_addr2line is not
-  // currently thread-safe.
-  Task_lock_obj<Object> tl(task, loc.object);
-
-  std::vector<std::string> result;
-  Symbol_location code_loc = loc;
-  parameters->target().function_location(&code_loc);
-  // 16 is the size of the object-cache that one_addr2line should use.
-  std::string canonical_result = Dwarf_line_info::one_addr2line(
-      code_loc.object, code_loc.shndx, code_loc.offset, 16, &result);
-  if (!canonical_result.empty())
-    result.push_back(canonical_result);
-  return result;
-}
-
 // OutputIterator that records if it was ever assigned to.  This
 // allows it to be used with std::set_intersection() to check for
 // intersection rather than computing the intersection.
@@ -3319,28 +3870,313 @@ struct Check_intersection
   bool value_;
 };
 
-// Check candidate_odr_violations_ to find symbols with the same name
-// but apparently different definitions (different source-file/line-no
-// for each line assigned to the first instruction).
+// A task to read the line numbers of the candidate ODR violations
+// defined in one object.  Reading the line number information of an
+// object is slow, so we read it once for all the locations in the
+// object, and read different objects in parallel.
+
+class Odr_lines_task : public Task
+{
+ public:
+  Odr_lines_task(Symbol_table* symtab, unsigned int index, Object* object,
+		 Task_token* blocker)
+    : symtab_(symtab), index_(index), object_(object), blocker_(blocker)
+  { }
+
+  // We need to lock the object.
+  Task_token*
+  is_runnable()
+  { return this->object_->is_locked() ? this->object_->token() : NULL; }
+
+  // Lock the object, and unblock BLOCKER_ when done.
+  void
+  locks(Task_locker* tl)
+  {
+    Task_token* token = this->object_->token();
+    if (token != NULL)
+      tl->add(this, token);
+    tl->add(this, this->blocker_);
+  }
+
+  void
+  run(Workqueue*)
+  {
+    this->symtab_->read_odr_lines(this->index_);
+    this->object_->release();
+  }
+
+  std::string
+  get_name() const
+  { return "Odr_lines_task " + this->object_->name(); }
+
+ private:
+  Symbol_table* symtab_;
+  unsigned int index_;
+  Object* object_;
+  Task_token* blocker_;
+};
+
+// A task to check a range of the candidate ODR violations, once all
+// the line numbers have been read.
+
+class Odr_check_task : public Task
+{
+ public:
+  Odr_check_task(Symbol_table* symtab, size_t start, size_t end,
+		 Task_token* this_blocker, Task_token* next_blocker)
+    : symtab_(symtab), start_(start), end_(end),
+      this_blocker_(this_blocker), next_blocker_(next_blocker)
+  { }
+
+  // We must wait until the line numbers have been read.
+  Task_token*
+  is_runnable()
+  {
+    if (this->this_blocker_->is_blocked())
+      return this->this_blocker_;
+    return NULL;
+  }
+
+  // Unblock NEXT_BLOCKER_ when done.
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->next_blocker_); }
+
+  void
+  run(Workqueue*)
+  { this->symtab_->check_odr_candidates(this->start_, this->end_); }
+
+  std::string
+  get_name() const
+  { return "Odr_check_task"; }
+
+ private:
+  Symbol_table* symtab_;
+  size_t start_;
+  size_t end_;
+  // THIS_BLOCKER_ is owned by the symbol table.
+  Task_token* this_blocker_;
+  Task_token* next_blocker_;
+};
+
+// Sort candidate ODR violations by symbol name.
+
+struct Odr_candidate_compare
+{
+  template<typename Candidate>
+  bool
+  operator()(const Candidate& c1, const Candidate& c2) const
+  { return strcmp(c1.name, c2.name) < 0; }
+};
+
+// Sort the locations of a candidate ODR violation by the index of the
+// input object which defines them, and then by offset.
+
+class Odr_location_compare
+{
+ public:
+  Odr_location_compare(const Unordered_map<const Object*, unsigned int>& order)
+    : order_(order)
+  { }
+
+  bool
+  operator()(const Symbol_location& l1, const Symbol_location& l2) const
+  {
+    if (l1.object != l2.object)
+      {
+	unsigned int i1 = this->index(l1.object);
+	unsigned int i2 = this->index(l2.object);
+	if (i1 != i2)
+	  return i1 < i2;
+	return l1.object->name() < l2.object->name();
+      }
+    if (l1.offset != l2.offset)
+      return l1.offset < l2.offset;
+    return l1.shndx < l2.shndx;
+  }
+
+ private:
+  // Return the position of OBJECT on the command line, or -1U if it
+  // is not an input object.
+  unsigned int
+  index(const Object* object) const
+  {
+    Unordered_map<const Object*, unsigned int>::const_iterator p =
+      this->order_.find(object);
+    return p == this->order_.end() ? -1U : p->second;
+  }
+
+  const Unordered_map<const Object*, unsigned int>& order_;
+};
+
+// Queue the tasks which look for symbols with the same name but
+// apparently different definitions (different source-file/line-no
+// for each line assigned to the first instruction).  We collect the
+// candidates of all the shards, and the objects which define them,
+// before starting any task, so that the tasks only write to entries
+// which already exist.
 
 void
-Symbol_table::detect_odr_violations(const Task* task,
-				    const char* output_file_name) const
+Symbol_table::queue_odr_tasks(Workqueue* workqueue,
+			      const Input_objects* input_objects,
+			      int task_count, Task_token* blocker)
 {
-  for (Odr_map::const_iterator it = candidate_odr_violations_.begin();
-       it != candidate_odr_violations_.end();
-       ++it)
+  for (size_t i = 0; i < this->shards_.size(); ++i)
     {
-      const char* const symbol_name = it->first;
+      const Odr_map& candidates(this->shards_[i]->candidate_odr_violations);
+      for (Odr_map::const_iterator p = candidates.begin();
+	   p != candidates.end();
+	   ++p)
+	{
+	  this->odr_candidates_.push_back(Odr_candidate(p->first));
+	  this->odr_candidates_.back().locations.assign(p->second.begin(),
+							p->second.end());
+	}
+    }
 
-      std::string first_object_name;
-      std::vector<std::string> first_object_linenos;
+  if (this->odr_candidates_.empty())
+    return;
+
+  // The hash tables are filled in an order which depends on how the
+  // symbols were added, so put everything in input order.
+  Unordered_map<const Object*, unsigned int> input_order;
+  for (Input_objects::Relobj_iterator p = input_objects->relobj_begin();
+       p != input_objects->relobj_end();
+       ++p)
+    input_order.insert(std::make_pair(*p, input_order.size()));
+  for (Input_objects::Dynobj_iterator p = input_objects->dynobj_begin();
+       p != input_objects->dynobj_end();
+       ++p)
+    input_order.insert(std::make_pair(*p, input_order.size()));
+
+  std::sort(this->odr_candidates_.begin(), this->odr_candidates_.end(),
+	    Odr_candidate_compare());
+
+  Unordered_map<Object*, unsigned int> object_indexes;
+  for (std::vector<Odr_candidate>::iterator p = this->odr_candidates_.begin();
+       p != this->odr_candidates_.end();
+       ++p)
+    {
+      std::sort(p->locations.begin(), p->locations.end(),
+		Odr_location_compare(input_order));
+      for (std::vector<Symbol_location>::const_iterator q =
+	     p->locations.begin();
+	   q != p->locations.end();
+	   ++q)
+	{
+	  std::pair<Odr_lines_map::iterator, bool> ins =
+	    this->odr_lines_.insert(std::make_pair(*q, Odr_lines()));
+	  if (!ins.second)
+	    continue;
+	  std::pair<Unordered_map<Object*, unsigned int>::iterator, bool>
+	    oins = object_indexes.insert(std::make_pair(q->object, 0U));
+	  if (oins.second)
+	    {
+	      oins.first->second = this->odr_objects_.size();
+	      this->odr_objects_.push_back(Odr_object(q->object));
+	    }
+	  this->odr_objects_[oins.first->second].lines.push_back(&*ins.first);
+	}
+    }
 
-      Unordered_set<Symbol_location, Symbol_location_hash>::const_iterator
-          locs = it->second.begin();
-      const Unordered_set<Symbol_location, Symbol_location_hash>::const_iterator
-          locs_end = it->second.end();
-      for (; locs != locs_end && first_object_linenos.empty(); ++locs)
+  this->odr_lines_blocker_ = new Task_token(true);
+  for (unsigned int i = 0; i < this->odr_objects_.size(); ++i)
+    {
+      this->odr_lines_blocker_->add_blocker();
+      workqueue->queue(new Odr_lines_task(this, i,
+					  this->odr_objects_[i].object,
+					  this->odr_lines_blocker_));
+    }
+
+  size_t count = this->odr_candidates_.size();
+  size_t per_task = (count + task_count - 1) / task_count;
+  for (size_t start = 0; start < count; start += per_task)
+    {
+      blocker->add_blocker();
+      workqueue->queue(new Odr_check_task(this, start,
+					  std::min(start + per_task, count),
+					  this->odr_lines_blocker_, blocker));
+    }
+}
+
+// Read the line numbers of the candidate ODR violations defined in
+// one object.  For each location we record all of the lines attached
+// to it, not just the one the instruction actually came from.  This
+// helps the ODR checker avoid false positives.
+
+void
+Symbol_table::read_odr_lines(unsigned int i)
+{
+  const Odr_object& odr_object(this->odr_objects_[i]);
+  Object* object = odr_object.object;
+
+  Dwarf_line_info* lineinfo;
+  switch (parameters->size_and_endianness())
+    {
+#ifdef HAVE_TARGET_32_LITTLE
+    case Parameters::TARGET_32_LITTLE:
+      lineinfo = new Sized_dwarf_line_info<32, false>(object);
+      break;
+#endif
+#ifdef HAVE_TARGET_32_BIG
+    case Parameters::TARGET_32_BIG:
+      lineinfo = new Sized_dwarf_line_info<32, true>(object);
+      break;
+#endif
+#ifdef HAVE_TARGET_64_LITTLE
+    case Parameters::TARGET_64_LITTLE:
+      lineinfo = new Sized_dwarf_line_info<64, false>(object);
+      break;
+#endif
+#ifdef HAVE_TARGET_64_BIG
+    case Parameters::TARGET_64_BIG:
+      lineinfo = new Sized_dwarf_line_info<64, true>(object);
+      break;
+#endif
+    default:
+      gold_unreachable();
+    }
+
+  for (std::vector<Odr_lines_map::value_type*>::const_iterator p =
+	 odr_object.lines.begin();
+       p != odr_object.lines.end();
+       ++p)
+    {
+      Symbol_location code_loc = (*p)->first;
+      parameters->target().function_location(&code_loc);
+      Odr_lines* lines = &(*p)->second;
+      lines->canonical = lineinfo->addr2line(code_loc.shndx, code_loc.offset,
+					     &lines->linenos);
+      if (lines->canonical.empty())
+	lines->linenos.clear();
+      else
+	{
+	  // Sort by Odr_violation_compare to make std::set_intersection
+	  // work.
+	  lines->linenos.push_back(lines->canonical);
+	  std::sort(lines->linenos.begin(), lines->linenos.end(),
+		    Odr_violation_compare());
+	}
+    }
+
+  delete lineinfo;
+}
+
+// Check a range of the candidate ODR violations.
+
+void
+Symbol_table::check_odr_candidates(size_t start, size_t end)
+{
+  for (size_t i = start; i < end; ++i)
+    {
+      Odr_candidate* candidate = &this->odr_candidates_[i];
+
+      std::vector<Symbol_location>::const_iterator locs =
+	candidate->locations.begin();
+      const std::vector<Symbol_location>::const_iterator locs_end =
+	candidate->locations.end();
+      const Odr_lines_map::value_type* first = NULL;
+      for (; locs != locs_end && first == NULL; ++locs)
         {
           // Save the line numbers from the first definition to
           // compare to the other definitions.  Ideally, we'd compare
@@ -3348,63 +4184,80 @@ Symbol_table::detect_odr_violations(const Task* task,
           // take O(N^2) time to do this.  This shortcut may cause
           // false negatives that appear or disappear depending on the
           // link order, but it won't cause false positives.
-          first_object_name = locs->object->name();
-          first_object_linenos = this->linenos_from_loc(task, *locs);
+	  Odr_lines_map::const_iterator p = this->odr_lines_.find(*locs);
+	  gold_assert(p != this->odr_lines_.end());
+	  if (!p->second.linenos.empty())
+	    first = &*p;
         }
-      if (first_object_linenos.empty())
+      if (first == NULL)
 	continue;
 
-      // Sort by Odr_violation_compare to make std::set_intersection work.
-      std::string first_object_canonical_result = first_object_linenos.back();
-      std::sort(first_object_linenos.begin(), first_object_linenos.end(),
-                Odr_violation_compare());
-
       for (; locs != locs_end; ++locs)
         {
-          std::vector<std::string> linenos =
-              this->linenos_from_loc(task, *locs);
+	  Odr_lines_map::const_iterator p = this->odr_lines_.find(*locs);
+	  gold_assert(p != this->odr_lines_.end());
+	  const std::vector<std::string>& linenos(p->second.linenos);
           // linenos will be empty if we couldn't parse the debug info.
           if (linenos.empty())
             continue;
-          // Sort by Odr_violation_compare to make std::set_intersection work.
-          gold_assert(!linenos.empty());
-          std::string second_object_canonical_result = linenos.back();
-          std::sort(linenos.begin(), linenos.end(), Odr_violation_compare());
 
           Check_intersection intersection_result =
-              std::set_intersection(first_object_linenos.begin(),
-                                    first_object_linenos.end(),
+              std::set_intersection(first->second.linenos.begin(),
+                                    first->second.linenos.end(),
                                     linenos.begin(),
                                     linenos.end(),
                                     Check_intersection(),
                                     Odr_violation_compare());
           if (!intersection_result.had_intersection())
             {
-              gold_warning(_("while linking %s: symbol '%s' defined in "
-                             "multiple places (possible ODR violation):"),
-                           output_file_name, demangle(symbol_name).c_str());
-              // This only prints one location from each definition,
-              // which may not be the location we expect to intersect
-              // with another definition.  We could print the whole
-              // set of locations, but that seems too verbose.
-              fprintf(stderr, _("  %s from %s\n"),
-                      first_object_canonical_result.c_str(),
-                      first_object_name.c_str());
-              fprintf(stderr, _("  %s from %s\n"),
-                      second_object_canonical_result.c_str(),
-                      locs->object->name().c_str());
-              // Only print one broken pair, to avoid needing to
+              // Only report one broken pair, to avoid needing to
               // compare against a list of the disjoint definition
               // locations we've found so far.  (If we kept comparing
               // against just the first one, we'd get a lot of
               // redundant complaints about the second definition
               // location.)
+	      candidate->first = first;
+	      candidate->second = &*p;
               break;
             }
         }
     }
-  // We only call one_addr2line() in this function, so we can clear its cache.
-  Dwarf_line_info::clear_addr2line_cache();
+}
+
+// Report the ODR violations found by the check tasks.  We report
+// them here, in the order of the candidates, so that the warnings do
+// not depend on how the tasks ran.
+
+void
+Symbol_table::detect_odr_violations(const char* output_file_name)
+{
+  for (std::vector<Odr_candidate>::const_iterator p =
+	 this->odr_candidates_.begin();
+       p != this->odr_candidates_.end();
+       ++p)
+    {
+      if (p->first == NULL)
+	continue;
+      gold_warning(_("while linking %s: symbol '%s' defined in "
+		     "multiple places (possible ODR violation):"),
+		   output_file_name, demangle(p->name).c_str());
+      // This only prints one location from each definition, which
+      // may not be the location we expect to intersect with another
+      // definition.  We could print the whole set of locations, but
+      // that seems too verbose.
+      fprintf(stderr, _("  %s from %s\n"),
+	      p->first->second.canonical.c_str(),
+	      p->first->first.object->name().c_str());
+      fprintf(stderr, _("  %s from %s\n"),
+	      p->second->second.canonical.c_str(),
+	      p->second->first.object->name().c_str());
+    }
+
+  this->odr_candidates_.clear();
+  this->odr_objects_.clear();
+  this->odr_lines_.clear();
+  delete this->odr_lines_blocker_;
+  this->odr_lines_blocker_ = NULL;
 }
 
 // Warnings functions.
@@ -3412,10 +4265,9 @@ Symbol_table::detect_odr_violations(const Task* task,
 // Add a new warning.
 
 void
-Warnings::add_warning(Symbol_table* symtab, const char* name, Object* obj,
+Warnings::add_warning(const char* name, Object* obj,
 		      const std::string& warning)
 {
-  name = symtab->canonicalize_name(name);
   this->warnings_[name].set(obj, warning);
 }
 
@@ -3430,7 +4282,7 @@ Warnings::note_warnings(Symbol_table* symtab)
        p != this->warnings_.end();
        ++p)
     {
-      Symbol* sym = symtab->lookup(p->first, NULL);
+      Symbol* sym = symtab->lookup(p->first.c_str(), NULL);
       if (sym != NULL
 	  && sym->source() == Symbol::FROM_OBJECT
 	  && sym->object() == p->second.object)
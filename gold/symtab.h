@@ -60,6 +60,11 @@ class Output_file;
 class Output_symtab_xindex;
 class Garbage_collection;
 class Icf;
+class Workqueue;
+class Task_token;
+class Lock;
+template<int size, bool big_endian>
+struct Pending_shard_symbols;
 
 // The base class of an entry in the symbol table.  The symbol table
 // can have a lot of entries, so we don't want this class too big.
@@ -1275,8 +1280,7 @@ class Warnings
   // Add a warning for symbol NAME in object OBJ.  WARNING is the text
   // of the warning.
   void
-  add_warning(Symbol_table* symtab, const char* name, Object* obj,
-	      const std::string& warning);
+  add_warning(const char* name, Object* obj, const std::string& warning);
 
   // For each symbol for which we should give a warning, make a note
   // on the symbol.
@@ -1313,9 +1317,11 @@ class Warnings
     }
   };
 
-  // A mapping from warning symbol names (canonicalized in
-  // Symbol_table's namepool_ field) to warning information.
-  typedef Unordered_map<const char*, Warning_location> Warning_table;
+  // A mapping from warning symbol names to warning information.
+  // Warnings are added while Object::layout runs, when the symbol
+  // names can not be canonicalized in a sharded symbol table, so we
+  // keep a copy of the name.
+  typedef Unordered_map<std::string, Warning_location> Warning_table;
 
   Warning_table warnings_;
 };
@@ -1408,6 +1414,13 @@ class Symbol_table
 		  typename Sized_relobj_file<size, big_endian>::Symbols*,
 		  size_t* defined);
 
+  // Add the symbols of a relocatable object which were queued for
+  // one shard of the symbol table by add_from_relobj.  This is
+  // called by the task which adds them in the background.
+  template<int size, bool big_endian>
+  void
+  add_pending_symbols(Pending_shard_symbols<size, big_endian>*);
+
   // Add one external symbol from the plugin object OBJ to the symbol table.
   // Returns a pointer to the resolved symbol in the symbol table.
   template<int size, bool big_endian>
@@ -1504,7 +1517,38 @@ class Symbol_table
   // Return the count of undefined symbols seen.
   size_t
   saw_undefined() const
-  { return this->saw_undefined_; }
+  {
+    size_t count = 0;
+    for (size_t i = 0; i < this->shards_.size(); ++i)
+      count += this->shards_[i]->saw_undefined;
+    return count;
+  }
+
+  // Split the symbol table into COUNT shards by a hash of the symbol
+  // name.  This must be called before any symbols are added.
+  void
+  set_shard_count(unsigned int count);
+
+  // Return whether the symbol table is split into shards.
+  bool
+  is_sharded() const
+  { return this->shards_.size() > 1; }
+
+  // Set the workqueue used to add the symbols of relocatable objects
+  // in the background, one task per shard.  This is set by
+  // Add_symbols while it adds the symbols of an object in the main
+  // input chain, and is NULL otherwise, in which case symbols are
+  // added immediately.
+  void
+  set_shard_workqueue(Workqueue* workqueue)
+  { this->shard_workqueue_ = workqueue; }
+
+  // Return a blocker to wait for if symbols are still being added in
+  // the background, or NULL if there are none.  Any task which looks
+  // at the symbol table while reading the input files, other than
+  // Add_symbols for a relocatable object, must wait for this.
+  Task_token*
+  shard_tasks_blocker() const;
 
   // Allocate the common symbols
   void
@@ -1514,12 +1558,12 @@ class Symbol_table
   // of the warning.
   void
   add_warning(const char* name, Object* obj, const std::string& warning)
-  { this->warnings_.add_warning(this, name, obj, warning); }
+  { this->warnings_.add_warning(name, obj, warning); }
 
   // Canonicalize a symbol name for use in the hash table.
   const char*
   canonicalize_name(const char* name)
-  { return this->namepool_.add(name, true, NULL); }
+  { return this->shard(name, strlen(name))->namepool.add(name, true, NULL); }
 
   // Possibly issue a warning for a reference to SYM at LOCATION which
   // is in OBJ.
@@ -1530,10 +1574,31 @@ class Symbol_table
 		size_t relnum, off_t reloffset) const
   { this->warnings_.issue_warning(sym, relinfo, relnum, reloffset); }
 
-  // Check candidate_odr_violations_ to find symbols with the same name
-  // but apparently different definitions (different source-file/line-no).
+  // Queue tasks to read the line numbers of the candidate ODR
+  // violations, with one task for each object which defines them,
+  // and then to check the candidates with up to TASK_COUNT tasks.
+  // The last tasks unblock BLOCKER.  INPUT_OBJECTS gives the order
+  // in which the locations of a candidate are checked and reported.
+  void
+  queue_odr_tasks(Workqueue*, const Input_objects* input_objects,
+		  int task_count, Task_token* blocker);
+
+  // Read the line numbers of the candidate ODR violations defined in
+  // the object with index I of the objects found by queue_odr_tasks.
+  // This is called by a task which has locked the object.
+  void
+  read_odr_lines(unsigned int i);
+
+  // Check the candidate ODR violations from START up to END, after
+  // their line numbers have been read.
+  void
+  check_odr_candidates(size_t start, size_t end);
+
+  // Report the symbols with the same name but apparently different
+  // definitions (different source-file/line-no) found by the tasks
+  // queued by queue_odr_tasks.
   void
-  detect_odr_violations(const Task*, const char* output_file_name) const;
+  detect_odr_violations(const char* output_file_name);
 
   // Add any undefined symbols named on the command line to the symbol
   // table.
@@ -1618,12 +1683,16 @@ class Symbol_table
   void
   for_all_symbols(F f) const
   {
-    for (Symbol_table_type::const_iterator p = this->table_.begin();
-         p != this->table_.end();
-         ++p)
+    for (size_t i = 0; i < this->shards_.size(); ++i)
       {
-	Sized_symbol<size>* sym = static_cast<Sized_symbol<size>*>(p->second);
-	f(sym);
+	const Symbol_table_type& table(this->shards_[i]->table);
+	for (Symbol_table_type::const_iterator p = table.begin();
+	     p != table.end();
+	     ++p)
+	  {
+	    Sized_symbol<size>* sym = static_cast<Sized_symbol<size>*>(*p);
+	    f(sym);
+	  }
       }
   }
 
@@ -1663,8 +1732,294 @@ class Symbol_table
     operator()(const Symbol_table_key&, const Symbol_table_key&) const;
   };
 
-  typedef Unordered_map<Symbol_table_key, Symbol*, Symbol_table_hash,
-			Symbol_table_eq> Symbol_table_type;
+  // The symbol hash table, which maps a name/version pair of
+  // Stringpool keys to a Symbol.  Normally this is an Unordered_map.
+  // With --compact-symbols it is an open addressing table with linear
+  // probing instead: the keys are stored as a pair of 32-bit values in
+  // one array, and the symbols in a parallel array.  An entry then
+  // needs no allocation of its own, and a probe only reads the keys.
+  // The interface is the part of the Unordered_map interface that we
+  // use, except that dereferencing an iterator yields the Symbol
+  // pointer of the entry.
+  class Symbol_table_type
+  {
+   private:
+    typedef Unordered_map<Symbol_table_key, Symbol*, Symbol_table_hash,
+			  Symbol_table_eq> Map;
+
+    // A key in the compact table.  Stringpool keys start at 1, so a
+    // name key of 0 marks an empty slot.
+    typedef std::pair<uint32_t, uint32_t> Compact_key;
+
+    // An iterator over the table.  TABLE_POINTER is a pointer to the
+    // table, MAP_ITERATOR the iterator of the Unordered_map, and
+    // REFERENCE what dereferencing the iterator returns.
+    template<typename Table_pointer, typename Map_iterator,
+	     typename Reference>
+    class Iterator
+    {
+     public:
+      Iterator()
+	: table_(NULL), p_(), slot_(0)
+      { }
+
+      Iterator(Table_pointer table, Map_iterator p, size_t slot)
+	: table_(table), p_(p), slot_(slot)
+      { }
+
+      Reference
+      operator*() const
+      {
+	if (this->table_->compact_)
+	  return this->table_->symbols_[this->slot_];
+	return this->p_->second;
+      }
+
+      Iterator&
+      operator++()
+      {
+	if (this->table_->compact_)
+	  this->slot_ = this->table_->next_slot(this->slot_ + 1);
+	else
+	  ++this->p_;
+	return *this;
+      }
+
+      bool
+      operator==(const Iterator& i) const
+      {
+	if (this->table_->compact_)
+	  return this->slot_ == i.slot_;
+	return this->p_ == i.p_;
+      }
+
+      bool
+      operator!=(const Iterator& i) const
+      { return !(*this == i); }
+
+     private:
+      friend class Symbol_table_type;
+
+      Table_pointer table_;
+      Map_iterator p_;
+      size_t slot_;
+    };
+
+   public:
+    typedef std::pair<Symbol_table_key, Symbol*> value_type;
+    typedef Iterator<Symbol_table_type*, Map::iterator, Symbol*&> iterator;
+    typedef Iterator<const Symbol_table_type*, Map::const_iterator,
+		     Symbol* const&> const_iterator;
+
+    // COUNT is a guess at the number of entries.  COMPACT is true
+    // for --compact-symbols.
+    Symbol_table_type(unsigned int count, bool compact);
+
+    // Return whether this is the compact form of the table.
+    bool
+    is_compact() const
+    { return this->compact_; }
+
+    size_t
+    size() const
+    { return this->compact_ ? this->count_ : this->map_.size(); }
+
+    bool
+    empty() const
+    { return this->size() == 0; }
+
+    // Return the number of buckets, or of slots in the compact form.
+    size_t
+    bucket_count() const;
+
+    iterator
+    begin()
+    { return iterator(this, this->map_.begin(), this->next_slot(0)); }
+
+    iterator
+    end()
+    { return iterator(this, this->map_.end(), this->keys_.size()); }
+
+    const_iterator
+    begin() const
+    { return const_iterator(this, this->map_.begin(), this->next_slot(0)); }
+
+    const_iterator
+    end() const
+    { return const_iterator(this, this->map_.end(), this->keys_.size()); }
+
+    const_iterator
+    find(const Symbol_table_key& key) const
+    {
+      if (!this->compact_)
+	return const_iterator(this, this->map_.find(key), 0);
+      size_t slot = this->find_slot(this->compact_key(key));
+      if (this->keys_[slot].first == 0)
+	return this->end();
+      return const_iterator(this, this->map_.end(), slot);
+    }
+
+    // Add the entry V if there is no entry for its key.  Return an
+    // iterator for the entry, and whether it was added.  Adding an
+    // entry may move the other entries of the compact table, unless
+    // room was made for it by reserve.
+    std::pair<iterator, bool>
+    insert(const value_type& v)
+    {
+      if (!this->compact_)
+	{
+	  std::pair<Map::iterator, bool> ins = this->map_.insert(v);
+	  return std::make_pair(iterator(this, ins.first, 0), ins.second);
+	}
+      this->reserve(this->count_ + 1);
+      Compact_key key(this->compact_key(v.first));
+      size_t slot = this->find_slot(key);
+      bool is_new = this->keys_[slot].first == 0;
+      if (is_new)
+	{
+	  this->keys_[slot] = key;
+	  this->symbols_[slot] = v.second;
+	  ++this->count_;
+	}
+      return std::make_pair(iterator(this, this->map_.end(), slot), is_new);
+    }
+
+    // Make room for COUNT entries, so that adding entries up to that
+    // number does not move the entries of the compact table.
+    void
+    reserve(size_t count)
+    {
+      while (this->compact_ && count * 4 > this->keys_.size() * 3)
+	this->grow();
+    }
+
+    void
+    erase(iterator p);
+
+    void
+    erase(const Symbol_table_key& key);
+
+    // Return the number of slots a compact table would have for COUNT
+    // entries.
+    static size_t
+    compact_slot_count(size_t count);
+
+    // The number of bytes used by a slot of the compact table.
+    static const size_t compact_slot_size = (sizeof(Compact_key)
+					     + sizeof(Symbol*));
+
+   private:
+    // Return KEY as a compact key.
+    static Compact_key
+    compact_key(const Symbol_table_key& key)
+    {
+      gold_assert(key.first != 0
+		  && key.first <= 0xffffffffU
+		  && key.second <= 0xffffffffU);
+      return Compact_key(key.first, key.second);
+    }
+
+    // Return the slot of KEY in the compact table, or the empty slot
+    // where it would go.
+    size_t
+    find_slot(const Compact_key& key) const
+    {
+      size_t mask = this->keys_.size() - 1;
+      size_t slot = this->hash(key) & mask;
+      while (this->keys_[slot].first != 0 && this->keys_[slot] != key)
+	slot = (slot + 1) & mask;
+      return slot;
+    }
+
+    // The hash function for the compact table.  The Stringpool keys
+    // are small consecutive integers, so we mix them into the high
+    // bits and fold those back down.
+    static size_t
+    hash(const Compact_key& key)
+    {
+      uint64_t h = ((static_cast<uint64_t>(key.second) << 32)
+		    | key.first) * 0x9e3779b97f4a7c15ULL;
+      return h ^ (h >> 32);
+    }
+
+    // Return the first used slot of the compact table at or after
+    // SLOT, or the number of slots if there is none.
+    size_t
+    next_slot(size_t slot) const
+    {
+      while (slot < this->keys_.size() && this->keys_[slot].first == 0)
+	++slot;
+      return slot;
+    }
+
+    // Double the number of slots of the compact table.
+    void
+    grow();
+
+    // Remove the entry in SLOT of the compact table.
+    void
+    erase_slot(size_t slot);
+
+    // The initial number of slots of the compact table.
+    static const size_t initial_compact_slots = 1024;
+
+    // Whether this is the compact form.
+    bool compact_;
+    // The table, when not compact.
+    Map map_;
+    // The keys of the compact table.  The number of slots is a power
+    // of two.
+    std::vector<Compact_key> keys_;
+    // The symbols of the compact table, indexed by slot.
+    std::vector<Symbol*> symbols_;
+    // The number of entries in the compact table.
+    size_t count_;
+  };
+
+  // Storage for the symbols of a shard with --compact-symbols.  The
+  // symbols are carved out of large chunks, rather than allocated one
+  // at a time, and are freed together when the shard is deleted.
+  class Symbol_arena
+  {
+   public:
+    Symbol_arena()
+      : chunks_(), next_(NULL), left_(0)
+    { }
+
+    ~Symbol_arena();
+
+    // Return a new symbol.
+    template<int size>
+    Sized_symbol<size>*
+    allocate()
+    {
+      const size_t len = sizeof(Sized_symbol<size>);
+      if (this->left_ < len)
+	{
+	  this->next_ = new unsigned char[symbols_per_chunk * len];
+	  this->chunks_.push_back(this->next_);
+	  this->left_ = symbols_per_chunk * len;
+	}
+      void* p = this->next_;
+      this->next_ += len;
+      this->left_ -= len;
+      return new(p) Sized_symbol<size>();
+    }
+
+   private:
+    Symbol_arena(const Symbol_arena&);
+    Symbol_arena& operator=(const Symbol_arena&);
+
+    // The number of symbols in a chunk.
+    static const size_t symbols_per_chunk = 1024;
+
+    // The chunks.
+    std::vector<unsigned char*> chunks_;
+    // Where the next symbol goes in the current chunk.
+    unsigned char* next_;
+    // The number of bytes left in the current chunk.
+    size_t left_;
+  };
 
   // A map from symbol name (as a pointer into the namepool) to all
   // the locations the symbols is (weakly) defined (and certain other
@@ -1676,9 +2031,169 @@ class Symbol_table
     { return reinterpret_cast<uintptr_t>(loc.object) ^ loc.offset ^ loc.shndx; }
   };
 
-  typedef Unordered_map<const char*,
-                        Unordered_set<Symbol_location, Symbol_location_hash> >
-  Odr_map;
+  typedef Unordered_set<Symbol_location, Symbol_location_hash>
+  Odr_locations;
+
+  typedef Unordered_map<const char*, Odr_locations> Odr_map;
+
+  // The line numbers of one location of a candidate ODR violation.
+  struct Odr_lines
+  {
+    Odr_lines()
+      : canonical(), linenos()
+    { }
+
+    // The line which the first instruction came from, or the empty
+    // string if we could not find it.
+    std::string canonical;
+    // All the lines attached to the first instruction, sorted by
+    // Odr_violation_compare.
+    std::vector<std::string> linenos;
+  };
+
+  typedef Unordered_map<Symbol_location, Odr_lines, Symbol_location_hash>
+  Odr_lines_map;
+
+  // The locations of candidate ODR violations in one object, whose
+  // line numbers are read together.
+  struct Odr_object
+  {
+    Odr_object(Object* o)
+      : object(o), lines()
+    { }
+
+    Object* object;
+    std::vector<Odr_lines_map::value_type*> lines;
+  };
+
+  // A symbol which may violate the ODR.  If the definitions disagree,
+  // the check sets FIRST and SECOND to two of them.  The candidates
+  // are sorted by name, and the locations of each candidate by input
+  // object and offset, so that the warnings do not depend on the
+  // order in which the hash tables were filled.
+  struct Odr_candidate
+  {
+    Odr_candidate(const char* n)
+      : name(n), locations(), first(NULL), second(NULL)
+    { }
+
+    const char* name;
+    std::vector<Symbol_location> locations;
+    const Odr_lines_map::value_type* first;
+    const Odr_lines_map::value_type* second;
+  };
+
+  // The type of the list of symbols which have been forced local.
+  typedef std::vector<Symbol*> Forced_locals;
+
+  // A symbol which must not be garbage collected, and the section
+  // which defined it when it was seen, if any.
+  typedef std::pair<Symbol*, Section_id> Gc_symbol;
+
+  // One shard of the symbol table.  A shard holds the names, the
+  // symbol table entries, and the resolution state for all the
+  // symbols whose names hash to it, so that different shards may be
+  // updated at the same time.  A version name is stored in the shard
+  // of the symbol which uses it, so the Stringpool keys of a symbol
+  // table entry always come from the same shard.  When the symbol
+  // table is not sharded there is a single shard.
+  struct Symbol_table_shard
+  {
+    Symbol_table_shard(unsigned int count, bool compact)
+      : table(count, compact), arena(), symbol_count(0), namepool(),
+	forwarders(), saw_undefined(0), commons(), tls_commons(),
+	small_commons(), large_commons(), forced_locals(),
+	candidate_odr_violations(), gc_symbols()
+    { namepool.reserve(count); }
+
+    // The symbol hash table.
+    Symbol_table_type table;
+    // The symbols, with --compact-symbols.
+    Symbol_arena arena;
+    // The number of symbols we have created.
+    size_t symbol_count;
+    // A pool of symbol names.  Entries in the hash table point into
+    // this pool.
+    Stringpool namepool;
+    // Forwarding symbols.
+    Unordered_map<const Symbol*, Symbol*> forwarders;
+    // We increment this every time we see a new undefined symbol,
+    // for use in archive groups.
+    size_t saw_undefined;
+    // We don't expect there to be very many common symbols, so we
+    // keep a list of them.  When we find a common symbol we add it
+    // to this list.  It is possible that by the time we process the
+    // list the symbol is no longer a common symbol.  It may also
+    // have become a forwarder.
+    Commons_type commons;
+    // This is like the commons field, except that it holds TLS
+    // common symbols.
+    Commons_type tls_commons;
+    // This is for small common symbols.
+    Commons_type small_commons;
+    // This is for large common symbols.
+    Commons_type large_commons;
+    // A list of symbols which have been forced to be local.  We
+    // don't expect there to be very many of them, so we keep a list
+    // of them rather than walking the whole table to find them.
+    Forced_locals forced_locals;
+    // Potential One Definition Rule (ODR) violations.
+    Odr_map candidate_odr_violations;
+    // When the symbol table is sharded, symbols which must not be
+    // garbage collected.  They are added to the garbage collection
+    // worklist by gc_mark_undef_symbols, since the worklist is also
+    // updated by Object::layout while symbols are being added.
+    std::vector<Gc_symbol> gc_symbols;
+  };
+
+  // Return a new symbol to add to SHARD, or NULL if the target
+  // does not want one.
+  template<int size, bool big_endian>
+  Sized_symbol<size>*
+  new_symbol(Symbol_table_shard* shard);
+
+  // Free SYM, which was returned by new_symbol but not added to the
+  // symbol table.
+  template<int size>
+  void
+  free_symbol(Sized_symbol<size>* sym);
+
+  // Print the memory used per symbol for print_stats.
+  void
+  print_symbol_size_stats() const;
+
+  // Return whether new_symbol allocates symbols from the shard
+  // arenas.  A target which makes its own symbols allocates them
+  // itself.
+  bool
+  uses_symbol_arena() const
+  { return this->compact_ && !parameters->target().has_make_symbol(); }
+
+  // Return the shard which holds the symbol NAME of length LEN.
+  Symbol_table_shard*
+  shard(const char* name, size_t len) const
+  {
+    if (this->shards_.size() == 1)
+      return this->shards_[0];
+    return this->shards_[this->shard_index(name, len)];
+  }
+
+  // Return the shard which holds SYM.
+  Symbol_table_shard*
+  shard(const Symbol* sym) const
+  {
+    if (this->shards_.size() == 1)
+      return this->shards_[0];
+    return this->shard(sym->name(), strlen(sym->name()));
+  }
+
+  // Return the index of the shard for the symbol NAME of length LEN.
+  unsigned int
+  shard_index(const char* name, size_t len) const
+  {
+    size_t h = string_hash<char>(name, len);
+    return (h ^ (h >> 16)) % this->shards_.size();
+  }
 
   // Make FROM a forwarder symbol to TO.
   void
@@ -1687,12 +2202,22 @@ class Symbol_table
   // Add a symbol.
   template<int size, bool big_endian>
   Sized_symbol<size>*
-  add_from_object(Object*, const char* name, Stringpool::Key name_key,
+  add_from_object(Symbol_table_shard*, Object*, const char* name,
+		  Stringpool::Key name_key,
 		  const char* version, Stringpool::Key version_key,
 		  bool def, const elfcpp::Sym<size, big_endian>& sym,
 		  unsigned int st_shndx, bool is_ordinary,
 		  unsigned int orig_st_shndx);
 
+  // Add one external symbol from a relocatable object.
+  template<int size, bool big_endian>
+  Sized_symbol<size>*
+  add_relobj_symbol(Sized_relobj_file<size, big_endian>* relobj,
+		    const unsigned char* p, const char* name,
+		    unsigned int st_shndx, bool is_ordinary,
+		    unsigned int orig_st_shndx,
+		    bool is_defined_in_discarded_section);
+
   // Define a default symbol.
   template<int size, bool big_endian>
   void
@@ -1715,11 +2240,20 @@ class Symbol_table
   // Record that a symbol is forced to be local by a version script or
   // by visibility.
   void
-  force_local(Symbol*);
+  force_local(Symbol* sym)
+  { this->force_local(this->shard(sym), sym); }
+
+  void
+  force_local(Symbol_table_shard*, Symbol*);
+
+  // Keep SYM, from SHARD, when garbage collecting.
+  void
+  gc_mark_symbol(Symbol_table_shard*, Symbol*);
 
-  // Adjust NAME and *NAME_KEY for wrapping.
+  // Adjust NAME, *NAME_KEY and *PSHARD for wrapping.
   const char*
-  wrap_symbol(const char* name, Stringpool::Key* name_key);
+  wrap_symbol(const char* name, Stringpool::Key* name_key,
+	      Symbol_table_shard** pshard);
 
   // Whether we should override a symbol, based on flags in
   // resolve.cc.
@@ -1828,12 +2362,6 @@ class Symbol_table
   do_allocate_commons_list(Layout*, Commons_section_type, Commons_type*,
 			   Mapfile*, Sort_commons_order);
 
-  // Returns all of the lines attached to LOC, not just the one the
-  // instruction actually came from.  This helps the ODR checker avoid
-  // false positives.
-  static std::vector<std::string>
-  linenos_from_loc(const Task* task, const Symbol_location& loc);
-
   // Implement detect_odr_violations.
   template<int size, bool big_endian>
   void
@@ -1880,16 +2408,10 @@ class Symbol_table
   sized_write_section_symbol(const Output_section*, Output_symtab_xindex*,
 			     Output_file*, off_t) const;
 
-  // The type of the list of symbols which have been forced local.
-  typedef std::vector<Symbol*> Forced_locals;
-
   // A map from symbols with COPY relocs to the dynamic objects where
   // they are defined.
   typedef Unordered_map<const Symbol*, Dynobj*> Copied_symbol_dynobjs;
 
-  // We increment this every time we see a new undefined symbol, for
-  // use in archive groups.
-  size_t saw_undefined_;
   // The index of the first global symbol in the output file.
   unsigned int first_global_index_;
   // The file offset within the output symtab section where we should
@@ -1903,37 +2425,42 @@ class Symbol_table
   unsigned int first_dynamic_global_index_;
   // The number of global dynamic symbols, or 0 if none.
   unsigned int dynamic_count_;
-  // The symbol hash table.
-  Symbol_table_type table_;
-  // A pool of symbol names.  This is used for all global symbols.
-  // Entries in the hash table point into this pool.
-  Stringpool namepool_;
-  // Forwarding symbols.
-  Unordered_map<const Symbol*, Symbol*> forwarders_;
+  // The expected number of symbols, used to size the shards.
+  unsigned int count_;
+  // Whether to use the compact symbol table, for --compact-symbols.
+  bool compact_;
+  // The shards of the symbol table, indexed by shard_index.
+  std::vector<Symbol_table_shard*> shards_;
+  // The workqueue used to add symbols in the background, or NULL.
+  Workqueue* shard_workqueue_;
+  // For each shard, the blocker which is released when the last task
+  // queued to add symbols to that shard has run.  The tasks for a
+  // shard are chained so that symbols are added in command line
+  // order.
+  std::vector<Task_token*> shard_blockers_;
+  // A blocker which is blocked while any task queued to add symbols
+  // to a shard has not yet run.
+  Task_token* shard_tasks_blocker_;
+  // The number of tasks queued to add symbols to a shard, for
+  // --stats.
+  size_t shard_task_count_;
+  // Protects the symbols on a list of weak aliases, which may be in
+  // different shards, while symbols are added in the background.
+  Lock* weak_alias_lock_;
   // Weak aliases.  A symbol in this list points to the next alias.
   // The aliases point to each other in a circular list.
   Unordered_map<Symbol*, Symbol*> weak_aliases_;
-  // We don't expect there to be very many common symbols, so we keep
-  // a list of them.  When we find a common symbol we add it to this
-  // list.  It is possible that by the time we process the list the
-  // symbol is no longer a common symbol.  It may also have become a
-  // forwarder.
-  Commons_type commons_;
-  // This is like the commons_ field, except that it holds TLS common
-  // symbols.
-  Commons_type tls_commons_;
-  // This is for small common symbols.
-  Commons_type small_commons_;
-  // This is for large common symbols.
-  Commons_type large_commons_;
-  // A list of symbols which have been forced to be local.  We don't
-  // expect there to be very many of them, so we keep a list of them
-  // rather than walking the whole table to find them.
-  Forced_locals forced_locals_;
   // Manage symbol warnings.
   Warnings warnings_;
-  // Manage potential One Definition Rule (ODR) violations.
-  Odr_map candidate_odr_violations_;
+  // The line numbers of each location of a candidate ODR violation.
+  Odr_lines_map odr_lines_;
+  // The objects which define the locations in odr_lines_.
+  std::vector<Odr_object> odr_objects_;
+  // The candidate ODR violations of all the shards, in order.
+  std::vector<Odr_candidate> odr_candidates_;
+  // A blocker which is blocked until all the line numbers in
+  // odr_lines_ have been read.
+  Task_token* odr_lines_blocker_;
 
   // When we emit a COPY reloc for a symbol, we define it in an
   // Output_data.  When it's time to emit version information for it,
@@ -114,6 +114,70 @@ scan_relocs(
     }
 }
 
+// This function implements the generic part of prescanning relocs.
+// The template parameter Scan must provide two static functions,
+// local_needs_scan() and global_needs_scan(), which return whether
+// Scan::local() or Scan::global() might do anything for a reloc.
+// Those relocs are copied to STAGED, in order, so that only they need
+// to be passed to scan_relocs.  This is run for several objects in
+// parallel, so it must not change anything outside STAGED.
+
+template<int size, bool big_endian, int sh_type, typename Scan>
+inline void
+prescan_relocs(
+    Symbol_table* symtab,
+    Sized_relobj_file<size, big_endian>* object,
+    const unsigned char* prelocs,
+    size_t reloc_count,
+    size_t local_count,
+    const unsigned char* plocal_syms,
+    std::vector<unsigned char>* staged)
+{
+  typedef typename Reloc_types<sh_type, size, big_endian>::Reloc Reltype;
+  const int reloc_size = Reloc_types<sh_type, size, big_endian>::reloc_size;
+  const int sym_size = elfcpp::Elf_sizes<size>::sym_size;
+
+  staged->clear();
+  for (size_t i = 0; i < reloc_count; ++i, prelocs += reloc_size)
+    {
+      Reltype reloc(prelocs);
+
+      typename elfcpp::Elf_types<size>::Elf_WXword r_info = reloc.get_r_info();
+      unsigned int r_sym = elfcpp::elf_r_sym<size>(r_info);
+      unsigned int r_type = elfcpp::elf_r_type<size>(r_info);
+
+      bool needs_scan;
+      if (r_sym < local_count)
+	{
+	  gold_assert(plocal_syms != NULL);
+	  typename elfcpp::Sym<size, big_endian> lsym(plocal_syms
+						      + r_sym * sym_size);
+	  unsigned int shndx = lsym.get_st_shndx();
+	  bool is_ordinary;
+	  shndx = object->adjust_sym_shndx(r_sym, shndx, &is_ordinary);
+	  // This must match the test in scan_relocs.
+	  bool is_discarded = (is_ordinary
+			       && shndx != elfcpp::SHN_UNDEF
+			       && !object->is_section_included(shndx)
+			       && !symtab->is_section_folded(object, shndx));
+	  needs_scan = Scan::local_needs_scan(object, r_type, lsym,
+					      is_discarded);
+	}
+      else
+	{
+	  Symbol* gsym = object->global_symbol(r_sym);
+	  gold_assert(gsym != NULL);
+	  if (gsym->is_forwarder())
+	    gsym = symtab->resolve_forwards(gsym);
+
+	  needs_scan = Scan::global_needs_scan(object, r_type, gsym);
+	}
+
+      if (needs_scan)
+	staged->insert(staged->end(), prelocs, prelocs + reloc_size);
+    }
+}
+
 // Behavior for relocations to discarded comdat sections.
 
 enum Comdat_behavior
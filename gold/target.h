@@ -875,6 +875,31 @@ class Sized_target : public Target
 	      size_t local_symbol_count,
 	      const unsigned char* plocal_symbols) = 0;
 
+  // Prescan the relocs for a section before they are scanned.  This
+  // is called for several objects in parallel, so it must not change
+  // anything.  It should copy to STAGED, in order, every reloc for
+  // which scan_relocs might do anything, such as create a GOT or PLT
+  // entry or a dynamic reloc; scan_relocs is then only called for
+  // those relocs.  The symbols are in the state they are in before
+  // any relocs are scanned.  The arguments are as for scan_relocs.
+  // Return false if the relocs were not prescanned, in which case
+  // scan_relocs is called for all of them.  Most targets do not
+  // prescan relocs.
+  virtual bool
+  prescan_relocs(Symbol_table*,
+		 Layout*,
+		 Sized_relobj_file<size, big_endian>*,
+		 unsigned int /* data_shndx */,
+		 unsigned int /* sh_type */,
+		 const unsigned char* /* prelocs */,
+		 size_t /* reloc_count */,
+		 Output_section*,
+		 bool /* needs_special_offset_handling */,
+		 size_t /* local_symbol_count */,
+		 const unsigned char* /* plocal_symbols */,
+		 std::vector<unsigned char>* /* staged */)
+  { return false; }
+
   // Relocate section data.  SH_TYPE is the type of the relocation
   // section, SHT_REL or SHT_RELA.  PRELOCS points to the relocation
   // information.  RELOC_COUNT is the number of relocs.
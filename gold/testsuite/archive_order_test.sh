@@ -0,0 +1,74 @@
+#!/bin/sh
+
+# archive_order_test.sh -- test the order archive members are included.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# This file goes with archive_order_test.stderr, which is the --trace
+# output of linking archive_order_main.o with libarchive_order.a.  Each
+# line of archive_order_test.deps gives the number of a member of
+# libarchive_order.a, which defines archive_order_N, followed by the
+# numbers of the members it refers to.  Many of the references go
+# backward in the archive map, and only some of the members are
+# needed.
+
+# Work out the members that scanning the archive map again until
+# nothing new was included would add, in the order it would add them.
+expected=`awk '
+{ n = $1; refs[$1] = $0 }
+END {
+    undef[200] = 1
+    do {
+	added = 0
+	for (i = 1; i <= n; i++) {
+	    if (defined[i] || !undef[i])
+		continue
+	    defined[i] = 1
+	    print i
+	    added = 1
+	    k = split(refs[i], r, " ")
+	    for (j = 2; j <= k; j++)
+		if (!defined[r[j]])
+		    undef[r[j]] = 1
+	}
+    } while (added)
+}' archive_order_test.deps`
+
+actual=`sed -n -e 's/.*libarchive_order\.a(archive_order_\([0-9]*\)\.o)$/\1/p' archive_order_test.stderr`
+
+if test "$expected" != "$actual"
+then
+    echo "archive members included in the wrong order"
+    echo ""
+    echo "Expected:"
+    echo $expected
+    echo ""
+    echo "Actual:"
+    echo $actual
+    exit 1
+fi
+
+if ! ./archive_order_test
+then
+    echo "archive_order_test failed"
+    exit 1
+fi
+
+exit 0
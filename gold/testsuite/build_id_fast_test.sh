@@ -0,0 +1,55 @@
+#!/bin/sh
+
+# build_id_fast_test.sh -- test --build-id=fast.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# This file goes with build_id_fast_test_1 and build_id_fast_test_2,
+# which are linked from the same object with --build-id=fast, without
+# and with threads.  Both must have a 128-bit build ID, and it must be
+# the same.
+
+check()
+{
+    if ! grep -q "$2" "$1"
+    then
+	echo "Did not find expected output in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check build_id_fast_test_1.stdout 'Build ID: [0-9a-f]\{32\}$'
+check build_id_fast_test_2.stdout 'Build ID: [0-9a-f]\{32\}$'
+
+id1=`grep 'Build ID:' build_id_fast_test_1.stdout`
+id2=`grep 'Build ID:' build_id_fast_test_2.stdout`
+if test "$id1" != "$id2"
+then
+    echo "Build IDs differ:"
+    echo "   $id1"
+    echo "   $id2"
+    exit 1
+fi
+
+exit 0
@@ -0,0 +1,65 @@
+// call_graph_ordering_test.cc -- a test case for gold
+
+// Copyright (C) 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+// The goal of this program is to verify that --call-graph-ordering-file
+// places the functions named in the profile after the other functions,
+// with each callee following its most frequent caller.
+
+extern "C"
+{
+
+int
+callee_1(int x)
+{
+  return x + 1;
+}
+
+int
+other_1(int x)
+{
+  return x - 1;
+}
+
+int
+callee_2(int x)
+{
+  return callee_1(x) * 2;
+}
+
+int
+other_2(int x)
+{
+  return x * 3;
+}
+
+int
+caller(int x)
+{
+  return callee_2(x) + callee_1(x);
+}
+
+}
+
+int
+main()
+{
+  return caller(0) == 3 ? other_1(1) + other_2(0) : 1;
+}
@@ -0,0 +1,70 @@
+#!/bin/sh
+
+# call_graph_ordering_test.sh -- test --call-graph-ordering-file.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# The goal of this program is to verify that --call-graph-ordering-file
+# places the functions named in the profile after the other functions,
+# with each callee following its most frequent caller.
+
+set -e
+
+check()
+{
+    awk "
+BEGIN { saw1 = 0; saw2 = 0; err = 0; }
+/.*$2\$/ { saw1 = 1; }
+/.*$3\$/ {
+     saw2 = 1;
+     if (!saw1)
+       {
+	  printf \"layout of $2 and $3 is not right\\n\";
+	  err = 1;
+	  exit 1;
+       }
+    }
+END {
+      if (!saw1 && !err)
+	{
+	  printf \"did not see $2\\n\";
+	  exit 1;
+	}
+      if (!saw2 && !err)
+	{
+	  printf \"did not see $3\\n\";
+	  exit 1;
+	}
+    }" $1
+}
+
+check call_graph_ordering_test.stdout "other_1" "caller"
+check call_graph_ordering_test.stdout "other_2" "caller"
+check call_graph_ordering_test.stdout "caller" "callee_2"
+check call_graph_ordering_test.stdout "callee_2" "callee_1"
+
+# The --stats output compares the footprint of the profiled functions
+# in the input order and in the profile order.
+grep -q "call graph edges: 4; unresolved: 1; sections: 3" \
+    call_graph_ordering_test.err
+grep -q "call graph input order: " call_graph_ordering_test.err
+grep -q "call graph profile order: " call_graph_ordering_test.err
+
+exit 0
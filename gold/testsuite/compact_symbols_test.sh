@@ -0,0 +1,37 @@
+#!/bin/sh
+
+# compact_symbols_test.sh -- test --compact-symbols.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# The compact symbol table of --compact-symbols may change the order
+# of the symbols in the output symbol table, but the symbols and
+# their versions must be the same as with the normal symbol table.
+# The shared library defines a symbol with a default version and
+# refers to symbols with versions.
+
+if ! cmp -s compact_symbols_normal.stdout compact_symbols_compact.stdout
+then
+    echo "Symbols of compact_symbols_compact.so differ from compact_symbols_normal.so:"
+    diff compact_symbols_normal.stdout compact_symbols_compact.stdout
+    exit 1
+fi
+
+exit 0
@@ -0,0 +1,33 @@
+#!/bin/sh
+
+# compress_debug_parallel_test.sh -- test compressing debug sections
+# with --threads.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# The debug sections are compressed in independent chunks which are
+# joined in order, so the output must not depend on how many threads
+# did the work.  The parallel link must have compressed the chunks in
+# tasks.
+
+exec ${srcdir}/parallel_test_comm.sh \
+    compress_debug_serial compress_debug_parallel \
+    compress_debug_parallel.stderr \
+    "compressed sections: [1-9][0-9]*; chunks: [1-9][0-9]*; tasks: [1-9]"
@@ -117,6 +117,27 @@ then
   check debug_msg_cdebug.err "odr_violation2.cc:2[78]"
 fi
 
+# Check for the same error messages, in the same order, when the ODR
+# violations are checked in parallel.
+if test -r debug_msg_threads.err
+then
+  check debug_msg_threads.err ": symbol 'Ordering::operator()(int, int)' defined in multiple places (possible ODR violation):"
+  check debug_msg_threads.err "odr_violation1.cc:6"
+  check debug_msg_threads.err "odr_violation2.cc:1[25]"
+  check_missing debug_msg_threads.err "OdrDerived::~OdrDerived()"
+  check_missing debug_msg_threads.err "__adjust_heap"
+  check_missing debug_msg_threads.err ": symbol 'OverriddenCFunction' defined in multiple places (possible ODR violation):"
+  check debug_msg_threads.err ": symbol 'SometimesInlineFunction(int)' defined in multiple places (possible ODR violation):"
+  if ! sed -e 's/while linking debug_msg_threads:/while linking debug_msg:/' \
+	 debug_msg_threads.err | cmp -s debug_msg.err -
+  then
+    echo "debug_msg_threads.err differs from debug_msg.err:"
+    sed -e 's/while linking debug_msg_threads:/while linking debug_msg:/' \
+	debug_msg_threads.err | diff debug_msg.err -
+    exit 1
+  fi
+fi
+
 # When linking together .so's, we don't catch the line numbers, but we
 # still find all the undefined variables, and the ODR violation.
 check debug_msg_so.err "debug_msg.so: error: undefined reference to 'undef_fn1()'"
@@ -0,0 +1,80 @@
+#!/bin/sh
+
+# eh_frame_hdr_sort_test.sh -- test sorting a large .eh_frame_hdr table.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# This file goes with eh_frame_hdr_sort_test.stdout, which is the
+# objdump -s output of the .eh_frame_hdr section of
+# eh_frame_hdr_sort_serial.  That program has more than 256 functions,
+# laid out in the reverse of the order of their FDEs, so the binary
+# search table is sorted with the radix sort.  The table must be
+# sorted by PC, and linking with --threads, which parses the
+# .eh_frame sections while reading the symbols, must give the same
+# output as linking without it.
+
+if ! cmp -s eh_frame_hdr_sort_serial eh_frame_hdr_sort_parallel
+then
+    echo "eh_frame_hdr_sort_serial and eh_frame_hdr_sort_parallel differ"
+    exit 1
+fi
+
+# Read the little-endian table: a 4-byte header, the .eh_frame pointer,
+# the FDE count, and then pairs of 4-byte signed PC and FDE offsets.
+awk '
+function hex(s,   i, v) {
+    v = 0
+    for (i = 1; i <= length(s); i++)
+	v = v * 16 + index("0123456789abcdef", substr(s, i, 1)) - 1
+    return v
+}
+function word(i,   v) {
+    v = hex(b[i + 3] b[i + 2] b[i + 1] b[i])
+    return v >= 2147483648 ? v - 4294967296 : v
+}
+/^ [0-9a-f]+ / {
+    for (f = 2; f <= 5 && $f ~ /^[0-9a-f]+$/; f++)
+	for (k = 1; k < length($f); k += 2)
+	    b[n++] = substr($f, k, 2)
+}
+END {
+    if (b[0] != "01" || b[3] != "3b") {
+	print "unexpected .eh_frame_hdr encoding"
+	exit 1
+    }
+    count = word(8)
+    if (count < 256 || 12 + count * 8 > n) {
+	print "unexpected FDE count " count
+	exit 1
+    }
+    for (i = 1; i < count; i++)
+	if (word(12 + i * 8) <= word(12 + (i - 1) * 8)) {
+	    print "binary search table entry " i " is out of order"
+	    exit 1
+	}
+}' eh_frame_hdr_sort_test.stdout || exit 1
+
+if ! ./eh_frame_hdr_sort_serial
+then
+    echo "eh_frame_hdr_sort_serial failed"
+    exit 1
+fi
+
+exit 0
@@ -0,0 +1,33 @@
+#!/bin/sh
+
+# gc_parallel_test.sh -- test --parallel-gc.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# A link which marks the sections to keep in parallel must keep the
+# same sections as a link which marks them serially, so the output
+# must be identical.  The parallel link must have queued tasks to mark
+# the sections.
+
+exec ${srcdir}/parallel_test_comm.sh \
+    gc_parallel_test_serial gc_parallel_test_parallel \
+    gc_parallel_test_parallel.stderr \
+    "GC sections tracked: [1-9][0-9]*; marked: [1-9]" \
+    "GC mark tasks: [1-9]"
@@ -0,0 +1,32 @@
+#!/bin/sh
+
+# gdb_index_parallel_test.sh -- test --gdb-index with --threads.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# The index entries of each object are merged in input order, so an
+# index built by scanning the objects in parallel must be the same as
+# one built serially.  The parallel link must have scanned the objects
+# in tasks.
+
+exec ${srcdir}/parallel_test_comm.sh \
+    gdb_index_test_4.stdout gdb_index_test_5.stdout \
+    gdb_index_test_5.stderr \
+    "gdb index scan tasks: [1-9]"
@@ -0,0 +1,38 @@
+/* gnu_hash_main.c -- call functions in a library linked with --hash-optimize.
+
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This file is part of gold.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.  */
+
+/* This is linked against gnu_hash_test_2.so, so the dynamic linker
+   must find these functions through the table that --hash-optimize
+   sized.  */
+
+extern int gnu_hash_sym_1 (void);
+extern int gnu_hash_sym_9973 (void);
+extern int gnu_hash_sym_20000 (void);
+
+int
+main (void)
+{
+  if (gnu_hash_sym_1 () != 1
+      || gnu_hash_sym_9973 () != 9973
+      || gnu_hash_sym_20000 () != 20000)
+    return 1;
+  return 0;
+}
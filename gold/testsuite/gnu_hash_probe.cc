@@ -0,0 +1,261 @@
+// gnu_hash_probe.cc -- measure lookups in a .gnu.hash section
+
+// Copyright (C) 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+// This program reads the .gnu.hash section of an ELF file and looks
+// up names in it the way the dynamic linker does.  It looks up every
+// hashed dynamic symbol, and a name which is not in the table for
+// each of them, and reports the average number of hash chain entries
+// each lookup examines and how many missing names the bloom filter
+// rejects.  It is used by gnu_hash_test.sh to compare the tables
+// gold builds with and without --hash-optimize.
+
+#include "gold.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "elfcpp.h"
+
+namespace
+{
+
+// The GNU hash function, as in Dynobj::gnu_hash.
+
+uint32_t
+gnu_hash(const char* name)
+{
+  const unsigned char* nameu = reinterpret_cast<const unsigned char*>(name);
+  uint32_t h = 5381;
+  unsigned char c;
+  while ((c = *nameu++) != '\0')
+    h = (h << 5) + h + c;
+  return h;
+}
+
+// Look up NAME in the hash table described by the arguments.  Return
+// whether it was found.  Set *REJECTED if the bloom filter rejected
+// it, and add the number of chain entries examined to *PROBES.
+
+template<int size, bool big_endian>
+bool
+lookup(const char* name, const unsigned char* phash, const unsigned char* syms,
+       const char* strtab, size_t strtab_size, bool* rejected,
+       unsigned long* probes)
+{
+  typedef typename elfcpp::Elf_types<size>::Elf_WXword Word;
+  const uint32_t nbuckets = elfcpp::Swap<32, big_endian>::readval(phash);
+  const uint32_t symoffset = elfcpp::Swap<32, big_endian>::readval(phash + 4);
+  const uint32_t maskwords = elfcpp::Swap<32, big_endian>::readval(phash + 8);
+  const uint32_t shift2 = elfcpp::Swap<32, big_endian>::readval(phash + 12);
+  const unsigned char* bloom = phash + 16;
+  const unsigned char* buckets = bloom + maskwords * (size / 8);
+  const unsigned char* chain = buckets + nbuckets * 4;
+
+  const uint32_t h = gnu_hash(name);
+  Word word = elfcpp::Swap<size, big_endian>::readval(bloom
+						      + ((h / size) % maskwords)
+						      * (size / 8));
+  *rejected = ((word >> (h % size)) & (word >> ((h >> shift2) % size))
+	       & 1) == 0;
+  if (*rejected)
+    return false;
+
+  uint32_t i = elfcpp::Swap<32, big_endian>::readval(buckets
+						     + (h % nbuckets) * 4);
+  if (i == 0)
+    return false;
+  for (;; ++i)
+    {
+      ++*probes;
+      uint32_t hv = elfcpp::Swap<32, big_endian>::readval(chain
+							  + (i - symoffset)
+							  * 4);
+      if ((hv | 1) == (h | 1))
+	{
+	  elfcpp::Sym<size, big_endian> sym(syms
+					    + i * elfcpp::Elf_sizes<size>::sym_size);
+	  if (sym.get_st_name() < strtab_size
+	      && strcmp(strtab + sym.get_st_name(), name) == 0)
+	    return true;
+	}
+      if ((hv & 1) != 0)
+	return false;
+    }
+}
+
+template<int size, bool big_endian>
+int
+probe(const char* filename, const unsigned char* contents, size_t len)
+{
+  const int ehdr_size = elfcpp::Elf_sizes<size>::ehdr_size;
+  const int shdr_size = elfcpp::Elf_sizes<size>::shdr_size;
+  const int sym_size = elfcpp::Elf_sizes<size>::sym_size;
+  if (len < static_cast<size_t>(ehdr_size))
+    {
+      fprintf(stderr, "%s: file too short\n", filename);
+      return 1;
+    }
+
+  elfcpp::Ehdr<size, big_endian> ehdr(contents);
+  const unsigned int shnum = ehdr.get_e_shnum();
+  const size_t shoff = ehdr.get_e_shoff();
+  if (shoff + shnum * shdr_size > len)
+    {
+      fprintf(stderr, "%s: bad section headers\n", filename);
+      return 1;
+    }
+
+  unsigned int hash_shndx = 0;
+  for (unsigned int i = 1; i < shnum; ++i)
+    {
+      elfcpp::Shdr<size, big_endian> shdr(contents + shoff + i * shdr_size);
+      if (shdr.get_sh_type() == elfcpp::SHT_GNU_HASH)
+	{
+	  hash_shndx = i;
+	  break;
+	}
+    }
+  if (hash_shndx == 0)
+    {
+      fprintf(stderr, "%s: no .gnu.hash section\n", filename);
+      return 1;
+    }
+
+  elfcpp::Shdr<size, big_endian> hash_shdr(contents + shoff
+					   + hash_shndx * shdr_size);
+  elfcpp::Shdr<size, big_endian> sym_shdr(contents + shoff
+					  + hash_shdr.get_sh_link()
+					  * shdr_size);
+  elfcpp::Shdr<size, big_endian> str_shdr(contents + shoff
+					  + sym_shdr.get_sh_link()
+					  * shdr_size);
+  const unsigned char* phash = contents + hash_shdr.get_sh_offset();
+  const unsigned char* syms = contents + sym_shdr.get_sh_offset();
+  const char* strtab = reinterpret_cast<const char*>(contents
+						     + str_shdr.get_sh_offset());
+  const size_t strtab_size = str_shdr.get_sh_size();
+  const unsigned int symcount = sym_shdr.get_sh_size() / sym_size;
+
+  const uint32_t nbuckets = elfcpp::Swap<32, big_endian>::readval(phash);
+  const uint32_t symoffset = elfcpp::Swap<32, big_endian>::readval(phash + 4);
+  const uint32_t maskwords = elfcpp::Swap<32, big_endian>::readval(phash + 8);
+
+  unsigned long found_probes = 0;
+  unsigned long missing_probes = 0;
+  unsigned int found = 0;
+  unsigned int missing = 0;
+  unsigned int rejected = 0;
+  for (unsigned int i = symoffset; i < symcount; ++i)
+    {
+      elfcpp::Sym<size, big_endian> sym(syms + i * sym_size);
+      if (sym.get_st_name() >= strtab_size)
+	continue;
+      const char* name = strtab + sym.get_st_name();
+      bool is_rejected;
+      if (!lookup<size, big_endian>(name, phash, syms, strtab, strtab_size,
+				    &is_rejected, &found_probes))
+	{
+	  fprintf(stderr, "%s: failed to find %s\n", filename, name);
+	  return 1;
+	}
+      ++found;
+
+      std::string missing_name(name);
+      missing_name += "_missing";
+      if (lookup<size, big_endian>(missing_name.c_str(), phash, syms, strtab,
+				   strtab_size, &is_rejected, &missing_probes))
+	continue;
+      ++missing;
+      if (is_rejected)
+	++rejected;
+    }
+
+  if (found == 0 || missing == 0)
+    {
+      fprintf(stderr, "%s: no hashed symbols\n", filename);
+      return 1;
+    }
+
+  printf("symbols: %u\n", found);
+  printf("buckets: %u\n", nbuckets);
+  printf("bloom filter bits: %u\n", maskwords * size);
+  printf("found average probes: %.3f\n",
+	 static_cast<double>(found_probes) / found);
+  printf("missing bloom filter rejected: %.1f%%\n",
+	 100.0 * rejected / missing);
+  printf("missing average probes: %.3f\n",
+	 static_cast<double>(missing_probes) / missing);
+  return 0;
+}
+
+} // End anonymous namespace.
+
+int
+main(int argc, char** argv)
+{
+  if (argc != 2)
+    {
+      fprintf(stderr, "Usage: %s FILE\n", argv[0]);
+      return 1;
+    }
+
+  FILE* f = fopen(argv[1], "rb");
+  if (f == NULL)
+    {
+      perror(argv[1]);
+      return 1;
+    }
+  std::vector<unsigned char> contents;
+  unsigned char buf[8192];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof buf, f)) > 0)
+    contents.insert(contents.end(), buf, buf + n);
+  fclose(f);
+
+  if (contents.size() < static_cast<size_t>(elfcpp::EI_NIDENT)
+      || contents[elfcpp::EI_MAG0] != elfcpp::ELFMAG0
+      || contents[elfcpp::EI_MAG1] != elfcpp::ELFMAG1
+      || contents[elfcpp::EI_MAG2] != elfcpp::ELFMAG2
+      || contents[elfcpp::EI_MAG3] != elfcpp::ELFMAG3)
+    {
+      fprintf(stderr, "%s: not an ELF file\n", argv[1]);
+      return 1;
+    }
+
+  bool is_64 = contents[elfcpp::EI_CLASS] == elfcpp::ELFCLASS64;
+  bool big_endian = contents[elfcpp::EI_DATA] == elfcpp::ELFDATA2MSB;
+  if (is_64)
+    {
+      if (big_endian)
+	return probe<64, true>(argv[1], &contents[0], contents.size());
+      else
+	return probe<64, false>(argv[1], &contents[0], contents.size());
+    }
+  else
+    {
+      if (big_endian)
+	return probe<32, true>(argv[1], &contents[0], contents.size());
+      else
+	return probe<32, false>(argv[1], &contents[0], contents.size());
+    }
+}
@@ -0,0 +1,110 @@
+#!/bin/sh
+
+# gnu_hash_test.sh -- test --hash-optimize.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# gnu_hash_test_1.so and gnu_hash_test_2.so export the same 20000
+# functions; the first is linked with the default hash table sizes
+# and the second with --hash-optimize.  gnu_hash_probe looks up every
+# symbol, and a missing name for each, in their .gnu.hash sections.
+# The optimized table must reject at least as many missing names in
+# its bloom filter, and must not need noticeably more probes.  The
+# two libraries must have the same dynamic symbols, the optimized one
+# must have no more hash buckets, and gnu_hash_test, which is linked
+# against the optimized one, must run.
+
+value()
+{
+    sed -n -e "s/^$2: *\([0-9.]*\).*/\1/p" "$1"
+}
+
+for f in gnu_hash_test_1.stdout gnu_hash_test_2.stdout
+do
+    echo "$f:"
+    cat $f
+done
+
+if ! awk "BEGIN { exit !(`value gnu_hash_test_2.stdout 'missing bloom filter rejected'` >= `value gnu_hash_test_1.stdout 'missing bloom filter rejected'`) }"
+then
+    echo "--hash-optimize bloom filter rejects fewer missing names"
+    exit 1
+fi
+
+if ! awk "BEGIN { exit !(`value gnu_hash_test_2.stdout 'missing average probes'` <= `value gnu_hash_test_1.stdout 'missing average probes'`) }"
+then
+    echo "--hash-optimize needs more probes for missing names"
+    exit 1
+fi
+
+if ! awk "BEGIN { exit !(`value gnu_hash_test_2.stdout 'found average probes'` <= `value gnu_hash_test_1.stdout 'found average probes'` + 0.1) }"
+then
+    echo "--hash-optimize needs more probes to find symbols"
+    exit 1
+fi
+
+# The names of the dynamic symbols, sorted.
+dynsyms()
+{
+    awk '$1 ~ /^[0-9]+:$/ && NF >= 8 { print $8 }' "$1" | sort
+}
+
+dynsyms gnu_hash_test_1.syms > gnu_hash_test_1.names
+dynsyms gnu_hash_test_2.syms > gnu_hash_test_2.names
+if test `wc -l < gnu_hash_test_1.names` -lt 20000
+then
+    echo "Did not find the dynamic symbols in gnu_hash_test_1.syms"
+    exit 1
+fi
+if ! cmp -s gnu_hash_test_1.names gnu_hash_test_2.names
+then
+    echo "--hash-optimize changed the dynamic symbols:"
+    diff gnu_hash_test_1.names gnu_hash_test_2.names | head
+    exit 1
+fi
+rm -f gnu_hash_test_1.names gnu_hash_test_2.names
+
+# The number of buckets in the .gnu.hash histogram.
+buckets()
+{
+    sed -n -e "s/^Histogram for .\.gnu\.hash. .*(total of \([0-9]*\) buckets).*/\1/p" "$1"
+}
+
+b1=`buckets gnu_hash_test_1.hist`
+b2=`buckets gnu_hash_test_2.hist`
+if test -z "$b1" || test -z "$b2"
+then
+    echo "Did not find the .gnu.hash bucket counts:"
+    cat gnu_hash_test_1.hist gnu_hash_test_2.hist
+    exit 1
+fi
+if test "$b2" -gt "$b1"
+then
+    echo "--hash-optimize uses $b2 buckets, more than the default $b1"
+    exit 1
+fi
+
+if ! ./gnu_hash_test
+then
+    echo "gnu_hash_test failed"
+    exit 1
+fi
+
+exit 0
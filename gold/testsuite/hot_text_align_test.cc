@@ -0,0 +1,50 @@
+// hot_text_align_test.cc -- a test case for gold --hot-text-align
+
+// Copyright (C) 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+// The hot functions go in .text.hot sections, which
+// --hot-text-align moves to their own aligned output section.
+
+__attribute__ ((hot, noinline)) int
+hot_1(int i)
+{
+  return i * 3 + 1;
+}
+
+__attribute__ ((hot, noinline)) int
+hot_2(int i)
+{
+  return i ^ 0x55;
+}
+
+__attribute__ ((noinline)) int
+plain(int i)
+{
+  return i + 2;
+}
+
+int
+main()
+{
+  int sum = 0;
+  for (int i = 0; i < 100; ++i)
+    sum += hot_1(i) + hot_2(i);
+  return plain(sum) == 21774 ? 0 : 1;
+}
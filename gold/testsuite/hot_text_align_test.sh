@@ -0,0 +1,86 @@
+#!/bin/sh
+
+# hot_text_align_test.sh -- test --hot-text-align.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# This file goes with hot_text_align_test.cc, which is linked with
+# --hot-text-align=0x200000 into hot_text_align_test and without it
+# into hot_text_align_none.  With the option the hot functions should
+# be in a .text.hot output section whose alignment, address, file
+# offset and size are all multiples of 2MB.  Without it there should
+# be no .text.hot output section, and .text should not be 2MB aligned.
+
+align=2097152
+
+set -- `sed -n -e 's/^.*\] \.text\.hot  *PROGBITS  *//p' hot_text_align_test.stdout`
+if test $# -lt 8
+then
+    echo "Did not find .text.hot section in hot_text_align_test.stdout:"
+    cat hot_text_align_test.stdout
+    exit 1
+fi
+
+if test "$8" -ne $align
+then
+    echo ".text.hot alignment is $8, not $align"
+    exit 1
+fi
+
+for v in "$1" "$2" "$3"
+do
+    if test $((0x$v % $align)) -ne 0
+    then
+	echo ".text.hot is not aligned to $align: $1 $2 $3"
+	exit 1
+    fi
+done
+
+if grep -q '\] \.text\.hot ' hot_text_align_none.stdout
+then
+    echo "Found .text.hot section without --hot-text-align:"
+    cat hot_text_align_none.stdout
+    exit 1
+fi
+
+set -- `sed -n -e 's/^.*\] \.text  *PROGBITS  *//p' hot_text_align_none.stdout`
+if test $# -lt 8
+then
+    echo "Did not find .text section in hot_text_align_none.stdout:"
+    cat hot_text_align_none.stdout
+    exit 1
+fi
+
+if test "$8" -ge $align
+then
+    echo ".text alignment is $8 without --hot-text-align"
+    exit 1
+fi
+
+for p in hot_text_align_test hot_text_align_none
+do
+    if ! ./$p
+    then
+	echo "$p failed"
+	exit 1
+    fi
+done
+
+exit 0
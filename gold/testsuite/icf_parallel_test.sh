@@ -0,0 +1,34 @@
+#!/bin/sh
+
+# icf_parallel_test.sh -- test --parallel-icf.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# A link which finds identical sections in parallel must fold the same
+# sections as a serial link run until convergence, so the output must
+# be identical.  The parallel link must have split the sections among
+# several match shards and fingerprinting tasks, and folded some of
+# them.
+
+exec ${srcdir}/parallel_test_comm.sh icf_serial icf_parallel \
+    icf_parallel.stderr \
+    "ICF match shards: [1-9]" \
+    "ICF fingerprint tasks: [1-9]" \
+    "ICF folded sections: [1-9]"
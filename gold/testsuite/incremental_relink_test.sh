@@ -0,0 +1,56 @@
+#!/bin/sh
+
+# incremental_relink_test.sh -- time an incremental update after a
+# one-file edit.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# This file goes with incremental_relink_test.stderr, which holds the
+# --stats output of an incremental update in which one object file was
+# replaced by an identical copy.  None of the replaced symbols moved, so
+# the update should not have reapplied any incremental relocations.
+# The update time is printed so that it shows up in the test log.
+
+check()
+{
+    if ! grep -q "$2" "$1"
+    then
+	echo "Did not find expected output in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check incremental_relink_test.stderr "replaced symbols with new values: 0"
+check incremental_relink_test.stderr "replaced symbols with unchanged values: [1-9]"
+check incremental_relink_test.stderr "incremental relocations reapplied: 0"
+
+grep "total run time" incremental_relink_test.stderr
+
+if ! ./incremental_relink_test
+then
+    echo "incremental_relink_test failed"
+    exit 1
+fi
+
+exit 0
@@ -0,0 +1,51 @@
+#!/bin/sh
+
+# incremental_shards_test.sh -- test an incremental update with
+# --symtab-shards.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# This file goes with incremental_shards_test.stderr, which holds the
+# output of an incremental update linked with --symtab-shards=8.  The
+# unchanged objects of an incremental update have no input file, so
+# adding their symbols must not look at it.  The update should succeed
+# and the program should run.
+
+if grep -q "internal error" incremental_shards_test.stderr
+then
+    echo "incremental update failed:"
+    cat incremental_shards_test.stderr
+    exit 1
+fi
+
+if ! grep -q "incremental relocations reapplied" incremental_shards_test.stderr
+then
+    echo "incremental_shards_test was not an incremental update:"
+    cat incremental_shards_test.stderr
+    exit 1
+fi
+
+if ! ./incremental_shards_test
+then
+    echo "incremental_shards_test failed"
+    exit 1
+fi
+
+exit 0
@@ -0,0 +1,54 @@
+#!/bin/sh
+
+# input_cache_test.sh -- test --input-cache.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# This file goes with input_cache_test_1 and input_cache_test_2, which
+# are linked from the same archives with the same --input-cache
+# directory.  The first link starts with an empty cache and writes the
+# archive symbol maps to it; the second link reads them back.  The two
+# programs must be the same.
+
+check()
+{
+    if ! grep -q "$2" "$1"
+    then
+	echo "Did not find expected output in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check input_cache_test_1.stderr "archive symbol maps read from cache: 0"
+check input_cache_test_1.stderr "archive symbol maps written to cache: [1-9]"
+check input_cache_test_2.stderr "archive symbol maps read from cache: [1-9]"
+check input_cache_test_2.stderr "archive symbol maps written to cache: 0"
+
+if ! cmp -s input_cache_test_1 input_cache_test_2
+then
+    echo "input_cache_test_1 and input_cache_test_2 differ"
+    exit 1
+fi
+
+exit 0
@@ -0,0 +1,40 @@
+#!/bin/sh
+
+# merge_string_parallel.sh -- test --parallel-string-merge.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# The output of a link which merges strings in parallel must be
+# identical to the output of a link which merges them serially, and
+# the parallel link must have split the input into chunks and the
+# strings into shards.
+
+check()
+{
+    ${srcdir}/parallel_test_comm.sh "$@" \
+	"merged strings merge chunks: [1-9]" \
+	"merged strings merge shards: [1-9]" || exit 1
+}
+
+check merge_string_serial merge_string_parallel merge_string_parallel.stderr
+check merge_string_serial_O2 merge_string_parallel_O2 \
+    merge_string_parallel_O2.stderr
+
+exit 0
@@ -0,0 +1,33 @@
+#!/bin/sh
+
+# output_memory_limit_test.sh -- test --output-memory-limit.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# A link which writes the output file with pwrite through a small
+# memory budget must produce the same file, including the build ID,
+# as a link which maps the output file.  The streaming link must have
+# written the file through buffered views.
+
+exec ${srcdir}/parallel_test_comm.sh \
+    output_memory_limit_mmap output_memory_limit_stream \
+    output_memory_limit_stream.stderr \
+    "output file peak buffered bytes: [1-9]" \
+    "output file buffered views: [1-9]"
@@ -0,0 +1,62 @@
+#!/bin/sh
+
+# parallel_test_comm.sh -- common code for the parallel linking tests.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# Usage: parallel_test_comm.sh SERIAL PARALLEL STATS PATTERN...
+
+# SERIAL and PARALLEL are the outputs of the same link done serially
+# and with the parallel code path; they must be identical.  STATS is
+# the --stats output of the parallel link.  Each PATTERN must match a
+# line of STATS, so that the test fails if the parallel code path was
+# not actually taken.
+
+if test "$#" -lt 4
+then
+    echo "Usage: $0 SERIAL PARALLEL STATS PATTERN..."
+    exit 1
+fi
+
+serial=$1
+parallel=$2
+stats=$3
+shift 3
+
+if ! cmp -s "$serial" "$parallel"
+then
+    echo "Output of $parallel differs from $serial"
+    exit 1
+fi
+
+for pattern in "$@"
+do
+    if ! grep -q -- "$pattern" "$stats"
+    then
+	echo "Did not find expected output in $stats:"
+	echo "   $pattern"
+	echo ""
+	echo "Actual output below:"
+	cat "$stats"
+	exit 1
+    fi
+done
+
+exit 0
@@ -0,0 +1,33 @@
+#!/bin/sh
+
+# reloc_scan_parallel_test.sh -- test scanning relocations
+# with --threads.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# With --threads, the relocations are prescanned in parallel, and only
+# those which may need a GOT or PLT entry, a COPY reloc or a dynamic
+# reloc are scanned in order, so the output must be the same as when
+# scanning all the relocations serially.  The parallel link must have
+# prescanned the relocations and staged some of them.
+
+exec ${srcdir}/parallel_test_comm.sh \
+    reloc_scan_serial reloc_scan_parallel reloc_scan_parallel.stderr \
+    "relocs prescanned: [1-9][0-9]*; staged: [1-9]"
@@ -0,0 +1,89 @@
+// relr_test.cc -- a test case for gold -z pack-relative-relocs
+
+// Copyright (C) 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+// This is linked as a PIE with -z pack-relative-relocs.  The pointer
+// tables below need relative relocations in dense runs, in runs
+// separated by more than one bitmap word, and at an unaligned
+// address, which can not be packed.  We check that the dynamic
+// linker relocated all of them.
+
+int a[200];
+int g1;
+int g2;
+
+int* dense[] = { &a[0], &a[1], &a[5], &a[70], &a[150], &g1, &g2, &a[199] };
+
+int* sparse[300] =
+{
+  &a[3], &a[4], 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, &g1, &g2, &a[9], 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, &a[10]
+};
+
+struct Packed
+{
+  char c;
+  int* p;
+} __attribute__((packed));
+
+Packed packed = { 1, &g1 };
+
+class Base
+{
+ public:
+  virtual ~Base() { }
+  virtual int f() const = 0;
+};
+
+class Derived : public Base
+{
+ public:
+  int f() const { return 42; }
+};
+
+Derived derived;
+Base* base = &derived;
+
+int
+main()
+{
+  volatile int i = 0;
+  if (dense[0] != &a[i] || dense[1] != &a[i + 1] || dense[2] != &a[i + 5]
+      || dense[3] != &a[i + 70] || dense[4] != &a[i + 150]
+      || dense[5] != &g1 || dense[6] != &g2 || dense[7] != &a[i + 199])
+    return 1;
+  if (sparse[0] != &a[i + 3] || sparse[1] != &a[i + 4]
+      || sparse[62] != &g1 || sparse[63] != &g2 || sparse[64] != &a[i + 9]
+      || sparse[130] != &a[i + 10])
+    return 2;
+  for (int j = 0; j < 300; ++j)
+    if (j > 1 && (j < 62 || j > 64) && j != 130 && sparse[j] != 0)
+      return 3;
+  if (packed.p != &g1)
+    return 4;
+  if (base->f() != 42)
+    return 5;
+  return 0;
+}
@@ -0,0 +1,64 @@
+#!/bin/sh
+
+# relr_test.sh -- test -z pack-relative-relocs.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# This file goes with relr_test.cc, which is linked as a PIE with
+# -z pack-relative-relocs.  The relative relocations should be in a
+# .relr.dyn section, except for the one at an unaligned address.
+# Running the program checks that the dynamic linker found them all.
+
+check()
+{
+    if ! grep -q "$2" "$1"
+    then
+	echo "Did not find expected output in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check_count()
+{
+    if test "`grep -c "$2" "$1"`" != "$3"
+    then
+	echo "Did not find $3 occurrences of expected output in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check relr_test.stdout " \.relr\.dyn "
+check_count relr_test.stdout "R_X86_64_RELATIVE" 1
+
+if ! ./relr_test
+then
+    echo "relr_test failed"
+    exit 1
+fi
+
+exit 0
@@ -0,0 +1,171 @@
+// relr_unittest.cc -- test the packed relative relocation encoding
+
+// Copyright (C) 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+#include "gold.h"
+
+#include <vector>
+
+#include "elfcpp.h"
+#include "output.h"
+
+#include "test.h"
+
+namespace gold_testsuite
+{
+
+using namespace gold;
+
+// Decode the NENTRIES entries at POV the way the dynamic linker
+// does, and return the addresses they relocate.
+
+template<int size, bool big_endian>
+std::vector<typename elfcpp::Elf_types<size>::Elf_Addr>
+decode_relr(const unsigned char* pov, size_t nentries)
+{
+  typedef typename elfcpp::Elf_types<size>::Elf_Addr Address;
+  const int word_size = size / 8;
+  std::vector<Address> ret;
+  Address where = 0;
+  for (size_t i = 0; i < nentries; ++i)
+    {
+      Address entry =
+	elfcpp::Swap<size, big_endian>::readval(pov + i * word_size);
+      if ((entry & 1) == 0)
+	{
+	  ret.push_back(entry);
+	  where = entry + word_size;
+	}
+      else
+	{
+	  for (int bit = 0; bit < size - 1; ++bit)
+	    if ((entry >> (bit + 1)) & 1)
+	      ret.push_back(where + bit * word_size);
+	  where += (size - 1) * word_size;
+	}
+    }
+  return ret;
+}
+
+// Encode OFFSETS from BASE, decode them again, and check that we get
+// back the same addresses.  Check that we used NENTRIES entries.
+
+template<int size, bool big_endian>
+void
+Sized_relr_round_trip(
+    typename elfcpp::Elf_types<size>::Elf_Addr base,
+    const std::vector<typename elfcpp::Elf_types<size>::Elf_Addr>& offsets,
+    size_t nentries)
+{
+  typedef typename elfcpp::Elf_types<size>::Elf_Addr Address;
+  typedef Output_data_relr<size, big_endian> Relr;
+
+  size_t count = Relr::encode(base, &offsets[0], offsets.size(), NULL);
+  CHECK(count == nentries);
+
+  std::vector<unsigned char> buf(count * (size / 8));
+  CHECK(Relr::encode(base, &offsets[0], offsets.size(), &buf[0]) == count);
+
+  std::vector<Address> addrs = decode_relr<size, big_endian>(&buf[0], count);
+  CHECK(addrs.size() == offsets.size());
+  for (size_t i = 0; i < offsets.size(); ++i)
+    CHECK(addrs[i] == base + offsets[i]);
+}
+
+template<int size, bool big_endian>
+bool
+Sized_relr_test()
+{
+  typedef typename elfcpp::Elf_types<size>::Elf_Addr Address;
+  const Address word_size = size / 8;
+  const Address nbits = size - 1;
+  const Address base = 0x10000;
+  std::vector<Address> offsets;
+
+  // A single word needs just an address entry.
+  offsets.push_back(0);
+  Sized_relr_round_trip<size, big_endian>(base, offsets, 1);
+
+  // A run of consecutive words fits in one bitmap entry.
+  for (Address i = 1; i < 10; ++i)
+    offsets.push_back(i * word_size);
+  Sized_relr_round_trip<size, big_endian>(base, offsets, 2);
+
+  // The last word covered by the first bitmap, and the first word
+  // covered by the next one.
+  offsets.push_back(nbits * word_size);
+  Sized_relr_round_trip<size, big_endian>(base, offsets, 2);
+  offsets.push_back((nbits + 1) * word_size);
+  Sized_relr_round_trip<size, big_endian>(base, offsets, 3);
+
+  // A gap of more than one bitmap needs a new address entry.
+  offsets.push_back((4 * nbits) * word_size);
+  Sized_relr_round_trip<size, big_endian>(base, offsets, 4);
+  offsets.push_back((4 * nbits + 2) * word_size);
+  Sized_relr_round_trip<size, big_endian>(base, offsets, 5);
+
+  // Every word in a long run.
+  offsets.clear();
+  for (Address i = 0; i < 1000; ++i)
+    offsets.push_back(i * word_size);
+  Sized_relr_round_trip<size, big_endian>(base, offsets,
+					  1 + (999 + nbits - 1) / nbits);
+
+  // Every other word.
+  offsets.clear();
+  for (Address i = 0; i < 1000; i += 2)
+    offsets.push_back(i * word_size);
+  Sized_relr_round_trip<size, big_endian>(base, offsets,
+					  1 + (998 + nbits - 1) / nbits);
+
+  return true;
+}
+
+bool
+Relr_test(Test_report*)
+{
+  int fail = 0;
+
+#ifdef HAVE_TARGET_32_LITTLE
+  if (!Sized_relr_test<32, false>())
+    ++fail;
+#endif
+
+#ifdef HAVE_TARGET_32_BIG
+  if (!Sized_relr_test<32, true>())
+    ++fail;
+#endif
+
+#ifdef HAVE_TARGET_64_LITTLE
+  if (!Sized_relr_test<64, false>())
+    ++fail;
+#endif
+
+#ifdef HAVE_TARGET_64_BIG
+  if (!Sized_relr_test<64, true>())
+    ++fail;
+#endif
+
+  return fail == 0;
+}
+
+Register_test relr_register("Relr", Relr_test);
+
+} // End namespace gold_testsuite.
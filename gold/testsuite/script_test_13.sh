@@ -0,0 +1,54 @@
+#!/bin/sh
+
+# script_test_13.sh -- test that an input section goes to the first
+# output section of script_test_13.t which matches it.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# This file goes with script_test_13.t.  Each function of
+# script_test_13a.c and script_test_13b.c is in an input section
+# matched by one or more of the input section specifications of the
+# script, and must be in the output section of the first one.
+
+check()
+{
+    if ! grep -q "$2" "$1"
+    then
+	echo "Did not find expected section in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check script_test_13.stdout " \.first	.* f_exact$"
+check script_test_13.stdout " \.prefix	.* f_prefix$"
+check script_test_13.stdout " \.prefix	.* f_prefix_suffix$"
+check script_test_13.stdout " \.suffix	.* f_suffix$"
+check script_test_13.stdout " \.suffix	.* f_suffix_infix$"
+check script_test_13.stdout " \.infix	.* f_infix$"
+check script_test_13.stdout " \.bracket	.* f_bracket$"
+check script_test_13.stdout " \.exclude	.* f_exclude_1$"
+check script_test_13.stdout " \.exclude_other	.* f_exclude_2$"
+check script_test_13.stdout " \.text\.orphan	.* f_orphan$"
+
+exit 0
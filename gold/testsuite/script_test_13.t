@@ -0,0 +1,36 @@
+/* script_test_13.t -- linker script test 13 for gold
+
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This file is part of gold.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.
+
+   gold files the section name patterns below in different places of
+   its index: exact names, literal prefixes, literal suffixes, and
+   literal parts in the middle.  An input section matched by several
+   of them must still go to the first matching output section.  */
+
+SECTIONS
+{
+  .first : { *(.text.pfx_win_sfx) }
+  .prefix : { *(.text.pfx_*) }
+  .suffix : { *(.t*_sfx_tail) }
+  .infix : { *(*_mid_*) }
+  .bracket : { *(.text.[xy]_br) }
+  .exclude : { *(EXCLUDE_FILE(*script_test_13b.o) .text.excl_*) }
+  .exclude_other : { *(.text.excl_*) }
+}
@@ -0,0 +1,37 @@
+/* script_test_13a.c -- a test case for gold
+
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This file is part of gold.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.
+
+   Each function is in a section matched by one or more of the input
+   section specifications of script_test_13.t.  */
+
+#define FUNCTION(name, secname)					\
+  int name (void) __attribute__ ((section (secname)));		\
+  int name (void) { return 1; }
+
+FUNCTION (f_exact, ".text.pfx_win_sfx")
+FUNCTION (f_prefix, ".text.pfx_a")
+FUNCTION (f_prefix_suffix, ".text.pfx_a_sfx_tail")
+FUNCTION (f_suffix, ".text.q_sfx_tail")
+FUNCTION (f_suffix_infix, ".text.q_mid_sfx_tail")
+FUNCTION (f_infix, ".text.r_mid_s")
+FUNCTION (f_bracket, ".text.x_br")
+FUNCTION (f_exclude_1, ".text.excl_1")
+FUNCTION (f_orphan, ".text.orphan")
@@ -0,0 +1,34 @@
+#!/bin/sh
+
+# symtab_shards_test.sh -- test --symtab-shards.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# Adding the symbols to a sharded symbol table may change the order
+# of the symbols in the output symbol table, but the symbols must
+# resolve to the same values as when they are added serially.  The
+# parallel link must have queued tasks to add symbols to more than one
+# shard.
+
+exec ${srcdir}/parallel_test_comm.sh \
+    symtab_shards_serial.stdout symtab_shards_parallel.stdout \
+    symtab_shards_parallel.stderr \
+    "symbol table shards: 8; used: [2-8]" \
+    "symbol table shard tasks: [1-9]"
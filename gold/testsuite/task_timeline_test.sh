@@ -0,0 +1,46 @@
+#!/bin/sh
+
+# task_timeline_test.sh -- test --task-timeline.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# This file goes with basic_test.o, linked with --task-timeline.  The
+# timeline must be a Chrome trace with an event for each task.
+
+check()
+{
+    if ! grep -q "$2" "$1"
+    then
+	echo "Did not find expected output in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check task_timeline_test.json '^{"displayTimeUnit": "ms", "traceEvents": \['
+check task_timeline_test.json '"name": "Task_function Layout_task_runner", "cat": "task", "ph": "X"'
+check task_timeline_test.json '"blocked_on": "blocker [0-9]*", "released_by": [0-9]*}}'
+check task_timeline_test.json '"ph": "M", "pid": 1, "tid": 0, "args": {"name": "thread 0"}}'
+check task_timeline_test.json '^]}$'
+
+exit 0
@@ -0,0 +1,37 @@
+// ver_glob_def.cc - test glob matching rules in ver_glob_script.map
+
+// Copyright (C) 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+extern "C" {
+void api_call() {} // V1
+void api_new_call() {} // V2
+void api_newer() {} // V1
+void old_compat() {} // V1
+void old2_compat() {} // V2
+void sym_a_x() {} // V3
+void sym_b_x() {} // V1
+void internal() {} // local
+};
+
+namespace glob_ns
+{
+void f() {} // V1
+void new_f() {} // V2
+}
@@ -0,0 +1,67 @@
+#!/bin/sh
+
+# ver_glob_test.sh -- test that the last matching glob wins.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# This file goes with ver_glob_def.cc, linked with ver_glob_script.map.
+# Most symbols match several of the wildcard patterns in the script,
+# which are filed in different places in the index gold builds for
+# them.  The last pattern in the script must still win.
+
+check()
+{
+    if ! grep -q "$2" "$1"
+    then
+	echo "Did not find expected symbol in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check_missing()
+{
+    if grep -q "$2" "$1"
+    then
+	echo "Found unexpected symbol in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check ver_glob_test.stdout "V1  *api_call$"
+check ver_glob_test.stdout "V2  *api_new_call$"
+check ver_glob_test.stdout "V1  *api_newer$"
+check ver_glob_test.stdout "V1  *old_compat$"
+check ver_glob_test.stdout "V2  *old2_compat$"
+check ver_glob_test.stdout "V3  *sym_a_x$"
+check ver_glob_test.stdout "V1  *sym_b_x$"
+check ver_glob_test.stdout "V1  *glob_ns::f()$"
+check ver_glob_test.stdout "V2  *glob_ns::new_f()$"
+
+check_missing ver_glob_test.stdout "internal"
+
+exit 0
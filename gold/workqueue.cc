@@ -22,6 +22,13 @@
 
 #include "gold.h"
 
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <sys/time.h>
+
 #include "debug.h"
 #include "options.h"
 #include "timer.h"
@@ -114,6 +121,207 @@ class Workqueue_threader_single : public Workqueue_threader
   { return false; }
 };
 
+// An entry in the task timeline, recording when a Task was queued
+// and run, and what it waited for.
+
+struct Task_timeline_entry
+{
+  Task_timeline_entry(int i, uint64_t q)
+    : id(i), name(), thread(-1), queued(q), start(0), end(0),
+      blocked_on(NULL), blocked_on_blocker(false), released_by(-1)
+  { }
+
+  // The index of the entry in the timeline.
+  int id;
+  // The name of the Task.
+  std::string name;
+  // The thread which ran the Task, or -1 if it did not run.
+  int thread;
+  // When the Task was queued, started and finished, in microseconds
+  // since the timeline started.
+  uint64_t queued;
+  uint64_t start;
+  uint64_t end;
+  // The last token the Task waited for, or NULL if it never waited.
+  const Task_token* blocked_on;
+  // Whether BLOCKED_ON is a blocker rather than a lock.
+  bool blocked_on_blocker;
+  // The index of the entry of the Task which released BLOCKED_ON, or
+  // -1.
+  int released_by;
+};
+
+// The timeline of the tasks run by a Workqueue, for --task-timeline.
+// We write it in the Chrome trace event format, which can be loaded
+// into chrome://tracing or Perfetto.  Each Task is a complete event on
+// the thread which ran it, and a flow event connects the Task which
+// released a token to the Task which was waiting for it, so the chain
+// of tasks which kept the link busy can be followed.  Entries are
+// only added with the Workqueue lock held, and each entry is then
+// only updated by the thread which runs its Task.
+
+class Task_timeline
+{
+ public:
+  Task_timeline()
+    : start_(Task_timeline::microseconds()), entries_()
+  { }
+
+  ~Task_timeline()
+  {
+    for (size_t i = 0; i < this->entries_.size(); ++i)
+      delete this->entries_[i];
+  }
+
+  // Return the time in microseconds since the timeline started.
+  uint64_t
+  now() const
+  { return Task_timeline::microseconds() - this->start_; }
+
+  // Add a new entry for a Task queued now.
+  Task_timeline_entry*
+  add()
+  {
+    Task_timeline_entry* entry = new Task_timeline_entry(this->entries_.size(),
+							 this->now());
+    this->entries_.push_back(entry);
+    return entry;
+  }
+
+  // Write the timeline to FILENAME.
+  void
+  write(const char* filename) const;
+
+ private:
+  // Return the current time in microseconds.
+  static uint64_t
+  microseconds()
+  {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return static_cast<uint64_t>(tv.tv_sec) * 1000000 + tv.tv_usec;
+  }
+
+  // Write S to F as a JSON string.
+  static void
+  write_string(FILE* f, const std::string& s);
+
+  // When the timeline started.
+  uint64_t start_;
+  // The entries, in the order in which the Tasks were queued.
+  std::vector<Task_timeline_entry*> entries_;
+};
+
+// Write S to F as a JSON string.
+
+void
+Task_timeline::write_string(FILE* f, const std::string& s)
+{
+  putc('"', f);
+  for (std::string::const_iterator p = s.begin(); p != s.end(); ++p)
+    {
+      unsigned char c = *p;
+      if (c == '"' || c == '\\')
+	fprintf(f, "\\%c", c);
+      else if (c < 0x20)
+	fprintf(f, "\\u%04x", c);
+      else
+	putc(c, f);
+    }
+  putc('"', f);
+}
+
+// Write the timeline to FILENAME.  Tokens are numbered in the order
+// in which we first see them, which makes it easy to find the tasks
+// which waited for the same token.
+
+void
+Task_timeline::write(const char* filename) const
+{
+  FILE* f = fopen(filename, "w");
+  if (f == NULL)
+    {
+      gold_error(_("cannot open task timeline %s: %s"), filename,
+		 strerror(errno));
+      return;
+    }
+
+  Unordered_map<const Task_token*, unsigned int> tokens;
+  std::vector<bool> threads;
+  const char* sep = "";
+  fprintf(f, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [");
+  for (std::vector<Task_timeline_entry*>::const_iterator p =
+	 this->entries_.begin();
+       p != this->entries_.end();
+       ++p)
+    {
+      const Task_timeline_entry* entry = *p;
+      if (entry->thread < 0)
+	continue;
+
+      if (static_cast<size_t>(entry->thread) >= threads.size())
+	threads.resize(entry->thread + 1);
+      threads[entry->thread] = true;
+
+      fprintf(f, "%s\n{\"name\": ", sep);
+      sep = ",";
+      write_string(f, entry->name);
+      fprintf(f, ", \"cat\": \"task\", \"ph\": \"X\", \"pid\": 1, "
+	      "\"tid\": %d, \"ts\": %llu, \"dur\": %llu, "
+	      "\"args\": {\"id\": %d, \"queued\": %llu, \"wait\": %llu",
+	      entry->thread, static_cast<unsigned long long>(entry->start),
+	      static_cast<unsigned long long>(entry->end - entry->start),
+	      entry->id, static_cast<unsigned long long>(entry->queued),
+	      static_cast<unsigned long long>(entry->start - entry->queued));
+      if (entry->blocked_on != NULL)
+	{
+	  std::pair<Unordered_map<const Task_token*, unsigned int>::iterator,
+		    bool> ins =
+	    tokens.insert(std::make_pair(entry->blocked_on, 0U));
+	  if (ins.second)
+	    ins.first->second = tokens.size();
+	  fprintf(f, ", \"blocked_on\": \"%s %u\"",
+		  entry->blocked_on_blocker ? "blocker" : "lock",
+		  ins.first->second);
+	}
+      if (entry->released_by >= 0)
+	fprintf(f, ", \"released_by\": %d", entry->released_by);
+      fprintf(f, "}}");
+
+      if (entry->released_by >= 0)
+	{
+	  const Task_timeline_entry* releaser =
+	    this->entries_[entry->released_by];
+	  fprintf(f, ",\n{\"name\": \"release\", \"cat\": \"token\", "
+		  "\"ph\": \"s\", \"id\": %d, \"pid\": 1, \"tid\": %d, "
+		  "\"ts\": %llu}",
+		  entry->id, releaser->thread,
+		  static_cast<unsigned long long>(releaser->end));
+	  fprintf(f, ",\n{\"name\": \"release\", \"cat\": \"token\", "
+		  "\"ph\": \"f\", \"bp\": \"e\", \"id\": %d, "
+		  "\"pid\": 1, \"tid\": %d, \"ts\": %llu}",
+		  entry->id, entry->thread,
+		  static_cast<unsigned long long>(entry->start));
+	}
+    }
+
+  for (size_t i = 0; i < threads.size(); ++i)
+    {
+      if (!threads[i])
+	continue;
+      fprintf(f, "%s\n{\"name\": \"thread_name\", \"ph\": \"M\", "
+	      "\"pid\": 1, \"tid\": %d, "
+	      "\"args\": {\"name\": \"thread %d\"}}",
+	      sep, static_cast<int>(i), static_cast<int>(i));
+      sep = ",";
+    }
+  fprintf(f, "\n]}\n");
+
+  if (fclose(f) != 0)
+    gold_error(_("cannot write task timeline %s: %s"), filename,
+	       strerror(errno));
+}
+
 // Workqueue methods.
 
 Workqueue::Workqueue(const General_options& options)
@@ -123,8 +331,12 @@ Workqueue::Workqueue(const General_options& options)
     running_(0),
     waiting_(0),
     condvar_(this->lock_),
-    threader_(NULL)
+    threader_(NULL),
+    timeline_(NULL)
 {
+  if (options.task_timeline() != NULL)
+    this->timeline_ = new Task_timeline();
+
   bool threads = options.threads();
 #ifndef ENABLE_THREADS
   threads = false;
@@ -143,6 +355,33 @@ Workqueue::Workqueue(const General_options& options)
 
 Workqueue::~Workqueue()
 {
+  delete this->timeline_;
+}
+
+// Record that T is waiting for TOKEN.  This must be called with the
+// workqueue lock held.
+
+inline void
+Workqueue::note_waiting(Task* t, Task_token* token)
+{
+  Task_timeline_entry* entry = t->timeline_entry();
+  if (entry != NULL)
+    {
+      entry->blocked_on = token;
+      entry->blocked_on_blocker = token->is_blocker();
+      entry->released_by = -1;
+    }
+}
+
+// Record that T was released by RELEASER.  This must be called with
+// the workqueue lock held.
+
+inline void
+Workqueue::note_released(Task* t, Task* releaser)
+{
+  Task_timeline_entry* entry = t->timeline_entry();
+  if (entry != NULL && releaser->timeline_entry() != NULL)
+    entry->released_by = releaser->timeline_entry()->id;
 }
 
 // Add a task to the end of a specific queue, or put it on the list
@@ -153,9 +392,13 @@ Workqueue::add_to_queue(Task_list* queue, Task* t, bool front)
 {
   Hold_lock hl(this->lock_);
 
+  if (this->timeline_ != NULL)
+    t->set_timeline_entry(this->timeline_->add());
+
   Task_token* token = t->is_runnable();
   if (token != NULL)
     {
+      this->note_waiting(t, token);
       if (front)
 	token->add_waiting_front(t);
       else
@@ -222,6 +465,7 @@ Workqueue::find_runnable_in_list(Task_list* tasks)
       if (token == NULL)
 	return t;
 
+      this->note_waiting(t, token);
       token->add_waiting(t);
       ++this->waiting_;
     }
@@ -316,8 +560,19 @@ Workqueue::find_and_run_task(int thread_number)
       if (is_debugging_enabled(DEBUG_TASK))
         timer.start();
 
+      Task_timeline_entry* entry = t->timeline_entry();
+      if (entry != NULL)
+	{
+	  entry->name = t->name();
+	  entry->thread = thread_number;
+	  entry->start = this->timeline_->now();
+	}
+
       t->run(this);
 
+      if (entry != NULL)
+	entry->end = this->timeline_->now();
+
       if (is_debugging_enabled(DEBUG_TASK))
         {
           Timer::TimeStats elapsed = timer.get_elapsed_time();
@@ -400,6 +655,7 @@ Workqueue::return_or_queue(Task* t, bool is_blocker, Task** pret)
 
   if (token != NULL)
     {
+      this->note_waiting(t, token);
       token->add_waiting(t);
       ++this->waiting_;
       return false;
@@ -456,11 +712,12 @@ Workqueue::release_locks(Task* t, Task_locker* tl)
 	    {
 	      // The token has been unblocked.  Every waiting Task may
 	      // now be runnable.
-	      Task* t;
-	      while ((t = token->remove_first_waiting()) != NULL)
+	      Task* w;
+	      while ((w = token->remove_first_waiting()) != NULL)
 		{
 		  --this->waiting_;
-		  this->return_or_queue(t, true, &ret);
+		  this->note_released(w, t);
+		  this->return_or_queue(w, true, &ret);
 		}
 	    }
 	}
@@ -473,11 +730,12 @@ Workqueue::release_locks(Task* t, Task_locker* tl)
 	  // move all the Tasks to the runnable queue, to avoid a
 	  // potential deadlock if the locking status changes before
 	  // we run the next thread.
-	  Task* t;
-	  while ((t = token->remove_first_waiting()) != NULL)
+	  Task* w;
+	  while ((w = token->remove_first_waiting()) != NULL)
 	    {
 	      --this->waiting_;
-	      if (this->return_or_queue(t, false, &ret))
+	      this->note_released(w, t);
+	      if (this->return_or_queue(w, false, &ret))
 		break;
 	    }
 	}
@@ -509,6 +767,16 @@ Workqueue::set_thread_count(int threads)
   this->condvar_.broadcast();
 }
 
+// Write the task timeline to FILENAME.
+
+void
+Workqueue::write_timeline(const char* filename)
+{
+  Hold_lock hl(this->lock_);
+  gold_assert(this->timeline_ != NULL);
+  this->timeline_->write(filename);
+}
+
 // Add a new blocker to an existing Task_token.
 
 void
@@ -37,6 +37,8 @@ namespace gold
 
 class General_options;
 class Workqueue;
+class Task_timeline;
+struct Task_timeline_entry;
 
 // The superclass for tasks to be placed on the workqueue.  Each
 // specific task class will inherit from this one.
@@ -45,7 +47,8 @@ class Task
 {
  public:
   Task()
-    : list_next_(NULL), name_(), should_run_soon_(false)
+    : list_next_(NULL), name_(), should_run_soon_(false),
+      timeline_entry_(NULL)
   { }
   virtual ~Task()
   { }
@@ -96,6 +99,18 @@ class Task
   clear_list_next()
   { this->list_next_ = NULL; }
 
+  // Get the entry for this Task in the task timeline, or NULL if we
+  // are not recording one.  Called by Workqueue.
+  Task_timeline_entry*
+  timeline_entry() const
+  { return this->timeline_entry_; }
+
+  // Set the entry for this Task in the task timeline.  Called by
+  // Workqueue.
+  void
+  set_timeline_entry(Task_timeline_entry* entry)
+  { this->timeline_entry_ = entry; }
+
   // Return the name of the Task.  This is only used for debugging
   // purposes.
   const std::string&
@@ -127,6 +142,9 @@ class Task
   // Whether this Task should be executed soon.  This is used for
   // Tasks which can be run after some data is read.
   bool should_run_soon_;
+  // The entry for this Task in the task timeline, for
+  // --task-timeline.  This is owned by the timeline.
+  Task_timeline_entry* timeline_entry_;
 };
 
 // An interface for Task_function.  This is a convenience class to run
@@ -233,6 +251,11 @@ class Workqueue
   void
   add_blocker(Task_token*);
 
+  // Write the timeline of the tasks which have run to FILENAME, for
+  // --task-timeline.  This is called after all the tasks have run.
+  void
+  write_timeline(const char* filename);
+
  private:
   // This class can not be copied.
   Workqueue(const Workqueue&);
@@ -270,6 +293,14 @@ class Workqueue
   bool
   should_cancel_thread(int thread_number);
 
+  // Record that T is waiting for TOKEN.
+  void
+  note_waiting(Task* t, Task_token* token);
+
+  // Record that T was released by RELEASER.
+  void
+  note_released(Task* t, Task* releaser);
+
   // Master Workqueue lock.  This controls access to the following
   // member variables.
   Lock lock_;
@@ -288,6 +319,8 @@ class Workqueue
   // The threading implementation.  This is set at construction time
   // and not changed thereafter.
   Workqueue_threader* threader_;
+  // The timeline of the tasks, for --task-timeline, or NULL.
+  Task_timeline* timeline_;
 };
 
 } // End namespace gold.
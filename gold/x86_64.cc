@@ -417,12 +417,15 @@ class Target_x86_64 : public Sized_target<size, false>
   // In the x86_64 ABI (p 68), it says "The AMD64 ABI architectures
   // uses only Elf64_Rela relocation entries with explicit addends."
   typedef Output_data_reloc<elfcpp::SHT_RELA, true, size, false> Reloc_section;
+  // Relative relocations packed for -z pack-relative-relocs.
+  typedef Output_data_relr<size, false> Relr_section;
 
   Target_x86_64(const Target::Target_info* info = &x86_64_info)
     : Sized_target<size, false>(info),
       got_(NULL), plt_(NULL), got_plt_(NULL), got_irelative_(NULL),
       got_tlsdesc_(NULL), global_offset_table_(NULL), rela_dyn_(NULL),
-      rela_irelative_(NULL), copy_relocs_(elfcpp::R_X86_64_COPY),
+      relr_dyn_(NULL), rela_irelative_(NULL),
+      copy_relocs_(elfcpp::R_X86_64_COPY),
       got_mod_index_offset_(-1U), tlsdesc_reloc_info_(),
       tls_base_symbol_defined_(false)
   { }
@@ -459,6 +462,21 @@ class Target_x86_64 : public Sized_target<size, false>
 	      size_t local_symbol_count,
 	      const unsigned char* plocal_symbols);
 
+  // Prescan the relocations to find the ones to scan.
+  bool
+  prescan_relocs(Symbol_table* symtab,
+		 Layout* layout,
+		 Sized_relobj_file<size, false>* object,
+		 unsigned int data_shndx,
+		 unsigned int sh_type,
+		 const unsigned char* prelocs,
+		 size_t reloc_count,
+		 Output_section* output_section,
+		 bool needs_special_offset_handling,
+		 size_t local_symbol_count,
+		 const unsigned char* plocal_symbols,
+		 std::vector<unsigned char>* staged);
+
   // Finalize the sections.
   void
   do_finalize_sections(Layout*, const Input_objects*, Symbol_table*);
@@ -697,6 +715,16 @@ class Target_x86_64 : public Sized_target<size, false>
     static inline int
     get_reference_flags(unsigned int r_type);
 
+    static inline bool
+    local_needs_scan(Sized_relobj_file<size, false>* object,
+		     unsigned int r_type,
+		     const elfcpp::Sym<size, false>& lsym,
+		     bool is_discarded);
+
+    static inline bool
+    global_needs_scan(Sized_relobj_file<size, false>* object,
+		      unsigned int r_type, Symbol* gsym);
+
     inline void
     local(Symbol_table* symtab, Layout* layout, Target_x86_64* target,
 	  Sized_relobj_file<size, false>* object,
@@ -948,6 +976,21 @@ class Target_x86_64 : public Sized_target<size, false>
   Reloc_section*
   rela_dyn_section(Layout*);
 
+  // Get the packed relative reloc section, creating it if necessary.
+  Relr_section*
+  relr_dyn_section(Layout*);
+
+  // Return whether to pack R_X86_64_RELATIVE relocations.  The
+  // dynamic linker only supports DT_RELR for 64-bit words, and we
+  // don't know how to update the packed section incrementally.
+  static bool
+  pack_relative_relocs()
+  {
+    return (size == 64
+	    && parameters->options().pack_relative_relocs()
+	    && !parameters->incremental());
+  }
+
   // Get the section to use for TLSDESC relocations.
   Reloc_section*
   rela_tlsdesc_section(Layout*) const;
@@ -1014,6 +1057,8 @@ class Target_x86_64 : public Sized_target<size, false>
   Symbol* global_offset_table_;
   // The dynamic reloc section.
   Reloc_section* rela_dyn_;
+  // The packed relative reloc section.
+  Relr_section* relr_dyn_;
   // The section to use for IRELATIVE relocs.
   Reloc_section* rela_irelative_;
   // Relocs saved to avoid a COPY reloc.
@@ -1186,6 +1231,23 @@ Target_x86_64<size>::rela_dyn_section(Layout* layout)
   return this->rela_dyn_;
 }
 
+// Get the packed relative reloc section, creating it if necessary.
+
+template<int size>
+typename Target_x86_64<size>::Relr_section*
+Target_x86_64<size>::relr_dyn_section(Layout* layout)
+{
+  if (this->relr_dyn_ == NULL)
+    {
+      gold_assert(layout != NULL);
+      this->relr_dyn_ = new Relr_section();
+      layout->add_output_section_data(".relr.dyn", elfcpp::SHT_RELR,
+				      elfcpp::SHF_ALLOC, this->relr_dyn_,
+				      ORDER_DYNAMIC_RELOCS, false);
+    }
+  return this->relr_dyn_;
+}
+
 // Get the section to use for IRELATIVE relocs, creating it if
 // necessary.  These go in .rela.dyn, but only after all other dynamic
 // relocations.  They need to follow the other dynamic relocations so
@@ -2344,6 +2406,56 @@ Target_x86_64<size>::Scan::reloc_needs_plt_for_ifunc(
   return flags != 0;
 }
 
+// Return whether Scan::local might do anything for a relocation of
+// type R_TYPE against the local symbol LSYM.  This is used when
+// prescanning relocations, so it must not change anything.
+
+template<int size>
+inline bool
+Target_x86_64<size>::Scan::local_needs_scan(
+    Sized_relobj_file<size, false>*,
+    unsigned int r_type,
+    const elfcpp::Sym<size, false>& lsym,
+    bool is_discarded)
+{
+  if (is_discarded)
+    return false;
+
+  // A local STT_GNU_IFUNC symbol may require a PLT entry.
+  if (lsym.get_st_type() == elfcpp::STT_GNU_IFUNC)
+    return true;
+
+  switch (r_type)
+    {
+    case elfcpp::R_X86_64_NONE:
+    case elfcpp::R_X86_64_GNU_VTINHERIT:
+    case elfcpp::R_X86_64_GNU_VTENTRY:
+    case elfcpp::R_X86_64_PC64:
+    case elfcpp::R_X86_64_PC32:
+    case elfcpp::R_X86_64_PC32_BND:
+    case elfcpp::R_X86_64_PC16:
+    case elfcpp::R_X86_64_PC8:
+    case elfcpp::R_X86_64_PLT32:
+    case elfcpp::R_X86_64_PLT32_BND:
+    case elfcpp::R_X86_64_TLSDESC_CALL:
+    case elfcpp::R_X86_64_DTPOFF32:
+    case elfcpp::R_X86_64_DTPOFF64:
+      return false;
+
+    case elfcpp::R_X86_64_64:
+    case elfcpp::R_X86_64_32:
+    case elfcpp::R_X86_64_32S:
+    case elfcpp::R_X86_64_16:
+    case elfcpp::R_X86_64_8:
+      // These need a dynamic relocation in position-independent
+      // output.
+      return parameters->options().output_is_position_independent();
+
+    default:
+      return true;
+    }
+}
+
 // Scan a relocation for a local symbol.
 
 template<int size>
@@ -2386,6 +2498,16 @@ Target_x86_64<size>::Scan::local(Symbol_table* symtab,
       // relocate it easily.
       if (parameters->options().output_is_position_independent())
 	{
+	  if (!is_ifunc
+	      && target->pack_relative_relocs()
+	      && Relr_section::can_pack(object, data_shndx,
+					reloc.get_r_offset()))
+	    {
+	      Relr_section* relr_dyn = target->relr_dyn_section(layout);
+	      relr_dyn->add_input_section(output_section, object, data_shndx,
+					  reloc.get_r_offset());
+	      break;
+	    }
 	  unsigned int r_sym = elfcpp::elf_r_sym<size>(reloc.get_r_info());
 	  Reloc_section* rela_dyn = target->rela_dyn_section(layout);
 	  rela_dyn->add_local_relative(object, r_sym,
@@ -2520,9 +2642,14 @@ Target_x86_64<size>::Scan::local(Symbol_table* symtab,
 		  {
 		    unsigned int got_offset =
 		      object->local_got_offset(r_sym, GOT_TYPE_STANDARD);
-		    rela_dyn->add_local_relative(object, r_sym,
-						 elfcpp::R_X86_64_RELATIVE,
-						 got, got_offset, 0, is_ifunc);
+		    if (!is_ifunc && target->pack_relative_relocs())
+		      target->relr_dyn_section(layout)->add_output_data(
+			  got, got_offset);
+		    else
+		      rela_dyn->add_local_relative(object, r_sym,
+						   elfcpp::R_X86_64_RELATIVE,
+						   got, got_offset, 0,
+						   is_ifunc);
 		  }
 		else
 		  {
@@ -2771,6 +2898,63 @@ Target_x86_64<size>::Scan::global_reloc_may_be_function_pointer(
 	  || possible_function_pointer_reloc(r_type));
 }
 
+// Return whether Scan::global might do anything for a relocation of
+// type R_TYPE against GSYM.  This is used when prescanning
+// relocations, before any relocations are scanned, so it must not
+// change anything, and it must allow for the changes which scanning
+// the relocations of other objects may make to GSYM.
+
+template<int size>
+inline bool
+Target_x86_64<size>::Scan::global_needs_scan(
+    Sized_relobj_file<size, false>*,
+    unsigned int r_type,
+    Symbol* gsym)
+{
+  // A STT_GNU_IFUNC symbol may require a PLT entry.  An undefined
+  // symbol may be defined by the linker while scanning, a common
+  // symbol has not been allocated yet, and a symbol from a dynamic
+  // object may get a COPY reloc, so we always scan those.
+  if (gsym->type() == elfcpp::STT_GNU_IFUNC
+      || gsym->is_undefined()
+      || gsym->is_common()
+      || gsym->is_from_dynobj())
+    return true;
+
+  switch (r_type)
+    {
+    case elfcpp::R_X86_64_NONE:
+    case elfcpp::R_X86_64_GNU_VTINHERIT:
+    case elfcpp::R_X86_64_GNU_VTENTRY:
+    case elfcpp::R_X86_64_TLSDESC_CALL:
+    case elfcpp::R_X86_64_DTPOFF32:
+    case elfcpp::R_X86_64_DTPOFF64:
+      return false;
+
+    case elfcpp::R_X86_64_64:
+    case elfcpp::R_X86_64_32:
+    case elfcpp::R_X86_64_32S:
+    case elfcpp::R_X86_64_16:
+    case elfcpp::R_X86_64_8:
+    case elfcpp::R_X86_64_PC64:
+    case elfcpp::R_X86_64_PC32:
+    case elfcpp::R_X86_64_PC32_BND:
+    case elfcpp::R_X86_64_PC16:
+    case elfcpp::R_X86_64_PC8:
+      // Making a PLT entry for the symbol can only remove the need
+      // for a dynamic relocation, so this is safe to ask now.
+      return (gsym->needs_plt_entry()
+	      || gsym->needs_dynamic_reloc(Scan::get_reference_flags(r_type)));
+
+    case elfcpp::R_X86_64_PLT32:
+    case elfcpp::R_X86_64_PLT32_BND:
+      return !gsym->final_value_is_known() && gsym->is_preemptible();
+
+    default:
+      return true;
+    }
+}
+
 // Scan a relocation for a global symbol.
 
 template<int size>
@@ -2848,6 +3032,16 @@ Target_x86_64<size>::Scan::global(Symbol_table* symtab,
 		      || (size == 32 && r_type == elfcpp::R_X86_64_32))
 		     && gsym->can_use_relative_reloc(false))
 	      {
+		if (target->pack_relative_relocs()
+		    && Relr_section::can_pack(object, data_shndx,
+					      reloc.get_r_offset()))
+		  {
+		    Relr_section* relr_dyn = target->relr_dyn_section(layout);
+		    relr_dyn->add_input_section(output_section, object,
+						data_shndx,
+						reloc.get_r_offset());
+		    break;
+		  }
 		Reloc_section* rela_dyn = target->rela_dyn_section(layout);
 		rela_dyn->add_global_relative(gsym, elfcpp::R_X86_64_RELATIVE,
 					      output_section, object,
@@ -2976,9 +3170,14 @@ Target_x86_64<size>::Scan::global(Symbol_table* symtab,
 		if (is_new)
 		  {
 		    unsigned int got_off = gsym->got_offset(GOT_TYPE_STANDARD);
-		    rela_dyn->add_global_relative(gsym,
-						  elfcpp::R_X86_64_RELATIVE,
-						  got, got_off, 0, false);
+		    if (gsym->type() != elfcpp::STT_GNU_IFUNC
+			&& target->pack_relative_relocs())
+		      target->relr_dyn_section(layout)->add_output_data(
+			  got, got_off);
+		    else
+		      rela_dyn->add_global_relative(gsym,
+						    elfcpp::R_X86_64_RELATIVE,
+						    got, got_off, 0, false);
 		  }
 	      }
 	  }
@@ -3231,6 +3430,40 @@ Target_x86_64<size>::scan_relocs(Symbol_table* symtab,
     plocal_symbols);
 }
 
+// Prescan relocations for a section.  We don't prescan a section
+// whose offsets need special handling, since the mapping of its
+// offsets may not be known yet.
+
+template<int size>
+bool
+Target_x86_64<size>::prescan_relocs(Symbol_table* symtab,
+				    Layout*,
+				    Sized_relobj_file<size, false>* object,
+				    unsigned int,
+				    unsigned int sh_type,
+				    const unsigned char* prelocs,
+				    size_t reloc_count,
+				    Output_section*,
+				    bool needs_special_offset_handling,
+				    size_t local_symbol_count,
+				    const unsigned char* plocal_symbols,
+				    std::vector<unsigned char>* staged)
+{
+  if (sh_type == elfcpp::SHT_REL || needs_special_offset_handling)
+    return false;
+
+  gold::prescan_relocs<size, false, elfcpp::SHT_RELA,
+		       typename Target_x86_64<size>::Scan>(
+    symtab,
+    object,
+    prelocs,
+    reloc_count,
+    local_symbol_count,
+    plocal_symbols,
+    staged);
+  return true;
+}
+
 // Finalize the sections.
 
 template<int size>
@@ -3245,6 +3478,8 @@ Target_x86_64<size>::do_finalize_sections(
 				  : this->plt_->rela_plt());
   layout->add_target_dynamic_tags(false, this->got_plt_, rel_plt,
 				  this->rela_dyn_, true, false);
+  if (this->relr_dyn_ != NULL)
+    layout->add_relr_dynamic_tags(this->relr_dyn_);
 
   // Fill in some more dynamic tags.
   Output_data_dynamic* const odyn = layout->dynamic_data();